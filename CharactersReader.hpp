@@ -24,6 +24,16 @@
 #define XML_CHARACTERS_READER_HPP__f66b9cdaf20734ef11086d0851a9c563
 
 #include <istream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XML_ENCODING_SSE2
+#endif
 
 /**
 	@file CharactersReader.hpp
@@ -129,6 +139,46 @@ namespace Xml
 					@b -2 if there was an error while reading character.
 			*/
 			virtual int ReadCharacter(char32_t& result) = 0;
+
+			/**
+				@brief Reads a block of characters from the specifically encoded source
+					and translates them to the Unicode characters.
+
+				Reading stops when the destination buffer is full or when
+				the ReadCharacter method wouldn't return @b 1. All the characters
+				stored in the destination buffer are valid, so the position of the first
+				unsuccessful read is equal to the returned number of characters.
+				Default implementation calls ReadCharacter method for each character,
+				derived classes should override it to avoid a virtual call per character.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive @b 1 if the buffer was filled
+					without any problem, otherwise the result of the unsuccessful read:
+					@b 0 if there are no more characters to read.
+					@b -1 if character is not allowed in XML document.
+					@b -2 if there was an error while reading character.
+				@return Number of characters stored in the destination buffer.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+		protected:
+			/**
+				@brief Reads a block of characters by the non-virtual
+					ReadCharacter method of the derived class.
+
+				@sa ReadCharacters.
+			*/
+			template <typename TReader>
+			static std::size_t ReadCharactersBy(TReader& reader,
+				char32_t* destination, std::size_t capacity, int& result);
+		private:
+			// Sets of the BMP characters (see IsInBmpSet method).
+			static const unsigned int NameStartCharSet = 0;
+			static const unsigned int NameCharSet = 1;
+
+			// Checks the bit of the BMP character in the bitmap of the set.
+			static bool IsInBmpSet(unsigned int characterSet, char32_t codePoint);
 		};
 
 		/**
@@ -145,6 +195,24 @@ namespace Xml
 					character is invalid.
 			*/
 			static unsigned int GetBytesCount(unsigned char leadingByte);
+
+			/**
+				@brief Decodes a block of UTF-8 encoded characters.
+
+				Runs of printable ASCII characters are decoded 16 bytes (SSE2)
+				or 8 bytes at a time. Decoding stops before the first sequence
+				which is incomplete or for which ReadCharacter method
+				wouldn't return @b 1, so such sequence is left to ReadCharacter.
+
+				@param[in,out] first Pointer to the first byte. Receives
+					the pointer to the first byte that was not decoded.
+				@param last Pointer past the last byte.
+				@param[out] destination Buffer that will receive the Unicode characters.
+					It must be able to hold (last - first) characters.
+				@return Number of characters stored in the destination buffer.
+			*/
+			static std::size_t DecodeCharacters(const unsigned char*& first,
+				const unsigned char* last, char32_t* destination);
 		public:
 			/**
 				@brief Destructor.
@@ -187,6 +255,18 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the pointer to the input stream.
 			*/
@@ -251,6 +331,17 @@ namespace Xml
 		private:
 			TInputIterator iterBegin;
 			TInputIterator iterEnd;
+
+			// Pointers to bytes are decoded by blocks.
+			typedef std::integral_constant<bool,
+				std::is_pointer<TInputIterator>::value &&
+				sizeof(typename std::iterator_traits<TInputIterator>::value_type) == 1> IsBytesPointer;
+
+			std::size_t ReadCharacters(char32_t* destination,
+				std::size_t capacity, int& result, std::true_type);
+
+			std::size_t ReadCharacters(char32_t* destination,
+				std::size_t capacity, int& result, std::false_type);
 		public:
 			/**
 				@brief Constructor.
@@ -282,6 +373,18 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the first iterator.
 			*/
@@ -304,10 +407,70 @@ namespace Xml
 			void ResetIterators(TInputIterator first, TInputIterator last);
 		};
 
+		/**
+			@brief Abstract UTF-16 characters reader base class.
+		*/
+		class Utf16ReaderBase : public CharactersReader
+		{
+		protected:
+			/**
+				@brief Decodes one UTF-16 encoded character.
+
+				The character is checked in the same way as in ReadCharacter
+				method of UTF-16 stream readers.
+
+				@param[in,out] first Pointer to the first byte. Receives
+					the pointer past the decoded character, unless more bytes are needed.
+				@param last Pointer past the last byte.
+				@param[out] result Variable that will receive the Unicode character.
+				@param bigEndian Byte order of code units.
+				@return @b 1 if the character was decoded successfully.
+					@b 0 if there are not enough bytes to decode the character.
+					@b -1 if character is not allowed in XML document.
+			*/
+			static int DecodeCharacter(const unsigned char*& first,
+				const unsigned char* last, char32_t& result, bool bigEndian);
+
+			/**
+				@brief Decodes a block of UTF-16 encoded characters.
+
+				Code units from 0x20 to 0xD7FF are decoded 8 at a time (SSE2).
+				Decoding stops before the first character for which
+				DecodeCharacter method wouldn't return @b 1.
+
+				@param[in,out] first Pointer to the first byte. Receives
+					the pointer to the first byte that was not decoded.
+				@param last Pointer past the last byte.
+				@param[out] destination Buffer that will receive the Unicode characters.
+					It must be able to hold (last - first) / 2 characters.
+				@param bigEndian Byte order of code units.
+				@return Number of characters stored in the destination buffer.
+			*/
+			static std::size_t DecodeCharacters(const unsigned char*& first,
+				const unsigned char* last, char32_t* destination, bool bigEndian);
+
+			/**
+				@brief Reads a block of characters from the UTF-16 encoded stream.
+
+				The stream is never read beyond the last character
+				stored in the destination buffer, unless the character
+				after it is not allowed in XML document.
+
+				@sa CharactersReader::ReadCharacters.
+			*/
+			static std::size_t ReadStreamCharacters(std::istream* inputStream,
+				char32_t* destination, std::size_t capacity, int& result, bool bigEndian);
+		public:
+			/**
+				@brief Destructor.
+			*/
+			virtual ~Utf16ReaderBase();
+		};
+
 		/**
 			@brief UTF-16 (big endian) characters reader from input stream.
 		*/
-		class Utf16BEStreamReader : public CharactersReader
+		class Utf16BEStreamReader : public Utf16ReaderBase
 		{
 		private:
 			std::istream* in;
@@ -339,6 +502,18 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the pointer to the input stream.
 			*/
@@ -353,7 +528,7 @@ namespace Xml
 		/**
 			@brief UTF-16 (little endian) characters reader from the input stream.
 		*/
-		class Utf16LEStreamReader : public CharactersReader
+		class Utf16LEStreamReader : public Utf16ReaderBase
 		{
 		private:
 			std::istream* in;
@@ -385,6 +560,18 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the pointer to the input stream.
 			*/
@@ -431,6 +618,18 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the pointer to the input stream.
 			*/
@@ -477,6 +676,18 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the pointer to the input stream.
 			*/
@@ -489,28 +700,37 @@ namespace Xml
 		};
 
 		/**
-			@brief ISO-8859-1 characters reader from the input stream.
+			@brief Characters reader from the input stream
+				with a single byte encoding described by the map.
+
+			All the supported single byte encodings share this reader.
+			Derived classes only provide their maps.
 		*/
-		class ISO_8859_1_StreamReader : public CharactersReader
+		class SingleByteStreamReader : public CharactersReader
 		{
 		private:
 			std::istream* in;
+			const char16_t* map;
+			bool asciiCompatible;
 		public:
 			/**
 				@brief Constructor.
 
 				@param[in,out] inputStream Input stream from which
-					an ISO-8859-1 characters will be extracted.
+					a characters will be extracted.
+				@param characterMap Map of 256 bytes to the Unicode characters.
+					Characters not allowed in XML document must be mapped to 0.
+					The map is not copied, so it must exist as long as the reader.
 			*/
-			ISO_8859_1_StreamReader(std::istream* inputStream);
+			SingleByteStreamReader(std::istream* inputStream, const char16_t* characterMap);
 
 			/**
 				@brief Destructor.
 			*/
-			virtual ~ISO_8859_1_StreamReader();
+			virtual ~SingleByteStreamReader();
 
 			/**
-				@brief Reads one ISO-8859-1 character.
+				@brief Reads one character.
 
 				@param[out] result Variable that will receive the Unicode character.
 				@return @b 1 if the character was read successfully.
@@ -520,6 +740,22 @@ namespace Xml
 			*/
 			virtual int ReadCharacter(char32_t& result);
 
+			/**
+				@brief Reads a block of Unicode characters.
+
+				Bytes are read from the stream by blocks and translated
+				by the map. Printable ASCII characters are copied 16 at a time (SSE2)
+				if the map doesn't change them.
+
+				@param[out] destination Buffer that will receive the Unicode characters.
+				@param capacity Maximum number of characters to read.
+				@param[out] result Variable that will receive the result of the last read.
+				@return Number of characters stored in the destination buffer.
+				@sa CharactersReader::ReadCharacters.
+			*/
+			virtual std::size_t ReadCharacters(
+				char32_t* destination, std::size_t capacity, int& result);
+
 			/**
 				@brief Gets the pointer to the input stream.
 			*/
@@ -529,58 +765,77 @@ namespace Xml
 				@brief Replaces the pointer to the input stream.
 			*/
 			void ResetInputStream(std::istream* inputStream);
+
+			/**
+				@brief Replaces the map of the encoding.
+
+				The reader can be reused for documents in other single byte
+				encodings without allocating a new one.
+
+				@param characterMap Map of 256 bytes to the Unicode characters.
+			*/
+			void ResetCharacterMap(const char16_t* characterMap);
 		};
 
 		/**
-			@brief ISO-8859-2 characters reader from the input stream.
+			@brief ISO-8859-1 characters reader from the input stream.
 		*/
-		class ISO_8859_2_StreamReader : public CharactersReader
+		class ISO_8859_1_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
 
 				@param[in,out] inputStream Input stream from which
-					an ISO-8859-2 characters will be extracted.
+					an ISO-8859-1 characters will be extracted.
 			*/
-			ISO_8859_2_StreamReader(std::istream* inputStream);
+			ISO_8859_1_StreamReader(std::istream* inputStream);
 
 			/**
 				@brief Destructor.
 			*/
-			virtual ~ISO_8859_2_StreamReader();
+			virtual ~ISO_8859_1_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-2 character.
+				@brief Gets the map of ISO-8859-1 characters to the Unicode characters.
 
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			virtual int ReadCharacter(char32_t& result);
+			static const char16_t* GetCharacterMap();
+		};
 
+		/**
+			@brief ISO-8859-2 characters reader from the input stream.
+		*/
+		class ISO_8859_2_StreamReader : public SingleByteStreamReader
+		{
+		public:
 			/**
-				@brief Gets the pointer to the input stream.
+				@brief Constructor.
+
+				@param[in,out] inputStream Input stream from which
+					an ISO-8859-2 characters will be extracted.
 			*/
-			std::istream* GetInputStream() const;
+			ISO_8859_2_StreamReader(std::istream* inputStream);
 
 			/**
-				@brief Replaces the pointer to the input stream.
+				@brief Destructor.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			virtual ~ISO_8859_2_StreamReader();
+
+			/**
+				@brief Gets the map of ISO-8859-2 characters to the Unicode characters.
+
+				Characters not allowed in XML document are mapped to 0.
+			*/
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-3 characters reader from the input stream.
 		*/
-		class ISO_8859_3_StreamReader : public CharactersReader
+		class ISO_8859_3_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -596,34 +851,18 @@ namespace Xml
 			virtual ~ISO_8859_3_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-3 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-3 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-4 characters reader from the input stream.
 		*/
-		class ISO_8859_4_StreamReader : public CharactersReader
+		class ISO_8859_4_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -639,34 +878,18 @@ namespace Xml
 			virtual ~ISO_8859_4_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-4 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-4 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-5 characters reader from the input stream.
 		*/
-		class ISO_8859_5_StreamReader : public CharactersReader
+		class ISO_8859_5_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -682,34 +905,18 @@ namespace Xml
 			virtual ~ISO_8859_5_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-5 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-5 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-6 characters reader from the input stream.
 		*/
-		class ISO_8859_6_StreamReader : public CharactersReader
+		class ISO_8859_6_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -725,34 +932,18 @@ namespace Xml
 			virtual ~ISO_8859_6_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-6 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-6 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-7 characters reader from the input stream.
 		*/
-		class ISO_8859_7_StreamReader : public CharactersReader
+		class ISO_8859_7_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -768,34 +959,18 @@ namespace Xml
 			virtual ~ISO_8859_7_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-7 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-7 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-8 characters reader from the input stream.
 		*/
-		class ISO_8859_8_StreamReader : public CharactersReader
+		class ISO_8859_8_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -811,34 +986,18 @@ namespace Xml
 			virtual ~ISO_8859_8_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-8 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-8 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-9 characters reader from the input stream.
 		*/
-		class ISO_8859_9_StreamReader : public CharactersReader
+		class ISO_8859_9_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -854,34 +1013,18 @@ namespace Xml
 			virtual ~ISO_8859_9_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-9 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-9 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-10 characters reader from the input stream.
 		*/
-		class ISO_8859_10_StreamReader : public CharactersReader
+		class ISO_8859_10_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -897,34 +1040,18 @@ namespace Xml
 			virtual ~ISO_8859_10_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-10 character.
+				@brief Gets the map of ISO-8859-10 characters to the Unicode characters.
 
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
-
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-13 characters reader from the input stream.
 		*/
-		class ISO_8859_13_StreamReader : public CharactersReader
+		class ISO_8859_13_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -940,34 +1067,18 @@ namespace Xml
 			virtual ~ISO_8859_13_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-13 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-13 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-14 characters reader from the input stream.
 		*/
-		class ISO_8859_14_StreamReader : public CharactersReader
+		class ISO_8859_14_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -983,34 +1094,18 @@ namespace Xml
 			virtual ~ISO_8859_14_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-14 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-14 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-15 characters reader from the input stream.
 		*/
-		class ISO_8859_15_StreamReader : public CharactersReader
+		class ISO_8859_15_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1026,34 +1121,18 @@ namespace Xml
 			virtual ~ISO_8859_15_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-15 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-15 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief ISO-8859-16 characters reader from the input stream.
 		*/
-		class ISO_8859_16_StreamReader : public CharactersReader
+		class ISO_8859_16_StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1069,34 +1148,18 @@ namespace Xml
 			virtual ~ISO_8859_16_StreamReader();
 
 			/**
-				@brief Reads one ISO-8859-16 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of ISO-8859-16 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief TIS-620 characters reader from the input stream.
 		*/
-		class TIS620StreamReader : public CharactersReader
+		class TIS620StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1112,34 +1175,18 @@ namespace Xml
 			virtual ~TIS620StreamReader();
 
 			/**
-				@brief Reads one TIS-620 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of TIS-620 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-874 characters reader from the input stream.
 		*/
-		class Windows874StreamReader : public CharactersReader
+		class Windows874StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1155,34 +1202,18 @@ namespace Xml
 			virtual ~Windows874StreamReader();
 
 			/**
-				@brief Reads one windows-874 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-874 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1250 characters reader from the input stream.
 		*/
-		class Windows1250StreamReader : public CharactersReader
+		class Windows1250StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1198,34 +1229,18 @@ namespace Xml
 			virtual ~Windows1250StreamReader();
 
 			/**
-				@brief Reads one windows-1250 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1250 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1251 characters reader from the input stream.
 		*/
-		class Windows1251StreamReader : public CharactersReader
+		class Windows1251StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1241,34 +1256,18 @@ namespace Xml
 			virtual ~Windows1251StreamReader();
 
 			/**
-				@brief Reads one windows-1251 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1251 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1252 characters reader from the input stream.
 		*/
-		class Windows1252StreamReader : public CharactersReader
+		class Windows1252StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1284,34 +1283,18 @@ namespace Xml
 			virtual ~Windows1252StreamReader();
 
 			/**
-				@brief Reads one windows-1252 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1252 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1253 characters reader from the input stream.
 		*/
-		class Windows1253StreamReader : public CharactersReader
+		class Windows1253StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1327,34 +1310,18 @@ namespace Xml
 			virtual ~Windows1253StreamReader();
 
 			/**
-				@brief Reads one windows-1253 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1253 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1254 characters reader from the input stream.
 		*/
-		class Windows1254StreamReader : public CharactersReader
+		class Windows1254StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1370,34 +1337,18 @@ namespace Xml
 			virtual ~Windows1254StreamReader();
 
 			/**
-				@brief Reads one windows-1254 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1254 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1255 characters reader from the input stream.
 		*/
-		class Windows1255StreamReader : public CharactersReader
+		class Windows1255StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1413,34 +1364,18 @@ namespace Xml
 			virtual ~Windows1255StreamReader();
 
 			/**
-				@brief Reads one windows-1255 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1255 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1256 characters reader from the input stream.
 		*/
-		class Windows1256StreamReader : public CharactersReader
+		class Windows1256StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1456,34 +1391,18 @@ namespace Xml
 			virtual ~Windows1256StreamReader();
 
 			/**
-				@brief Reads one windows-1256 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1256 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		/**
 			@brief windows-1257 characters reader from the input stream.
 		*/
-		class Windows1257StreamReader : public CharactersReader
+		class Windows1257StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1499,34 +1418,18 @@ namespace Xml
 			virtual ~Windows1257StreamReader();
 
 			/**
-				@brief Reads one windows-1257 character.
+				@brief Gets the map of windows-1257 characters to the Unicode characters.
 
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
-
-			/**
-				@brief Replaces the pointer to the input stream.
-			*/
-			void ResetInputStream(std::istream* inputStream);
-		};
+			static const char16_t* GetCharacterMap();
+		};
 
 		/**
 			@brief windows-1258 characters reader from the input stream.
 		*/
-		class Windows1258StreamReader : public CharactersReader
+		class Windows1258StreamReader : public SingleByteStreamReader
 		{
-		private:
-			std::istream* in;
 		public:
 			/**
 				@brief Constructor.
@@ -1542,25 +1445,11 @@ namespace Xml
 			virtual ~Windows1258StreamReader();
 
 			/**
-				@brief Reads one windows-1258 character.
-
-				@param[out] result Variable that will receive the Unicode character.
-				@return @b 1 if the character was read successfully.
-					@b 0 if there are no more characters to read.
-					@b -1 if character is not allowed in XML document.
-					@b -2 if there was an error while reading character.
-			*/
-			virtual int ReadCharacter(char32_t& result);
-
-			/**
-				@brief Gets the pointer to the input stream.
-			*/
-			std::istream* GetInputStream() const;
+				@brief Gets the map of windows-1258 characters to the Unicode characters.
 
-			/**
-				@brief Replaces the pointer to the input stream.
+				Characters not allowed in XML document are mapped to 0.
 			*/
-			void ResetInputStream(std::istream* inputStream);
+			static const char16_t* GetCharacterMap();
 		};
 
 		//
@@ -1572,6 +1461,39 @@ namespace Xml
 		
 		}
 
+		inline std::size_t CharactersReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			std::size_t count = 0;
+			result = 1;
+			while (count < capacity)
+			{
+				result = ReadCharacter(destination[count]);
+				if (result != 1)
+					break;
+				++count;
+			}
+			return count;
+		}
+
+		template <typename TReader>
+		inline std::size_t CharactersReader::ReadCharactersBy(TReader& reader,
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			// Qualified name suppresses the virtual call,
+			// so the ReadCharacter method could be inlined.
+			std::size_t count = 0;
+			result = 1;
+			while (count < capacity)
+			{
+				result = reader.TReader::ReadCharacter(destination[count]);
+				if (result != 1)
+					break;
+				++count;
+			}
+			return count;
+		}
+
 		inline bool CharactersReader::IsChar(char32_t codePoint)
 		{
 			if (codePoint < 0xD800)
@@ -1594,77 +1516,82 @@ namespace Xml
 
 		inline bool CharactersReader::IsNameStartChar(char32_t codePoint)
 		{
-			static const char Allowed1Byte[256] =
-			{
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
-				0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
-				0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1
-			};
-			if (codePoint <= 0xFF)
-				return (Allowed1Byte[static_cast<unsigned char>(codePoint)] != 0);
-
-			return (
-				(codePoint <= 0x2FF) ||
-				(codePoint >= 0x370 && codePoint <= 0x37D) ||
-				(codePoint >= 0x37F && codePoint <= 0x1FFF) ||
-				(codePoint >= 0x200C && codePoint <= 0x200D) ||
-				(codePoint >= 0x2070 && codePoint <= 0x218F) ||
-				(codePoint >= 0x2C00 && codePoint <= 0x2FEF) ||
-				(codePoint >= 0x3001 && codePoint <= 0xD7FF) ||
-				(codePoint >= 0xF900 && codePoint <= 0xFDCF) ||
-				(codePoint >= 0xFDF0 && codePoint <= 0xFFFD) ||
-				(codePoint >= 0x10000 && codePoint <= 0xEFFFF));
+			if (codePoint <= 0xFFFF)
+				return IsInBmpSet(NameStartCharSet, codePoint);
+			return (codePoint <= 0xEFFFF);
 		}
 
 		inline bool CharactersReader::IsNameChar(char32_t codePoint)
 		{
-			static const char Allowed1Byte[256] =
+			if (codePoint <= 0xFFFF)
+				return IsInBmpSet(NameCharSet, codePoint);
+			return (codePoint <= 0xEFFFF);
+		}
+
+		inline bool CharactersReader::IsInBmpSet(unsigned int characterSet, char32_t codePoint)
+		{
+			// Two level bitmaps of the BMP. The high byte of the character selects
+			// one of the shared blocks of 256 bits, the low byte selects the bit.
+			// Most blocks are completely allowed or completely forbidden, so only
+			// 13 different blocks are needed for both sets.
+			static const unsigned char Blocks[2][256] =
 			{
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-				0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
-				0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-				1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1
+				{
+					0, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					3, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 1, 1, 1, 6,
+					7, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 5, 5, 5, 5, 5, 5, 5, 5,
+					5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+					5, 5, 5, 5, 5, 5, 5, 5, 5, 1, 1, 1, 1, 8, 1, 9
+				},
+				{
+					10, 1, 1, 11, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					12, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 1, 1, 1, 6,
+					7, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+					1, 1, 1, 1, 1, 1, 1, 1, 5, 5, 5, 5, 5, 5, 5, 5,
+					5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+					5, 5, 5, 5, 5, 5, 5, 5, 5, 1, 1, 1, 1, 8, 1, 9
+				}
 			};
-			if (codePoint <= 0xFF)
-				return (Allowed1Byte[static_cast<unsigned char>(codePoint)] != 0);
-
-			return (
-				(codePoint <= 0x2FF) ||
-				(codePoint >= 0x300 && codePoint <= 0x37D) ||
-				(codePoint >= 0x37F && codePoint <= 0x1FFF) ||
-				(codePoint >= 0x200C && codePoint <= 0x200D) ||
-				(codePoint >= 0x203F && codePoint <= 0x2040) ||
-				(codePoint >= 0x2070 && codePoint <= 0x218F) ||
-				(codePoint >= 0x2C00 && codePoint <= 0x2FEF) ||
-				(codePoint >= 0x3001 && codePoint <= 0xD7FF) ||
-				(codePoint >= 0xF900 && codePoint <= 0xFDCF) ||
-				(codePoint >= 0xFDF0 && codePoint <= 0xFFFD) ||
-				(codePoint >= 0x10000 && codePoint <= 0xEFFFF));
+			static const std::uint_least32_t Bitmaps[13][8] =
+			{
+				{ 0x00000000, 0x04000000, 0x87FFFFFE, 0x07FFFFFE, 0x00000000, 0x00000000, 0xFF7FFFFF, 0xFF7FFFFF },
+				{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+				{ 0x00000000, 0x00000000, 0x00000000, 0xBFFF0000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+				{ 0x00003000, 0x00000000, 0x00000000, 0xFFFF0000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+				{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF, 0x00000000, 0x00000000, 0x00000000 },
+				{ 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+				{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF },
+				{ 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+				{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF, 0xFFFF0000 },
+				{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x3FFFFFFF },
+				{ 0x00000000, 0x07FF6000, 0x87FFFFFE, 0x07FFFFFE, 0x00000000, 0x00800000, 0xFF7FFFFF, 0xFF7FFFFF },
+				{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xBFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+				{ 0x00003000, 0x80000000, 0x00000001, 0xFFFF0000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }
+			};
+
+			const std::uint_least32_t* bitmap = Bitmaps[Blocks[characterSet][codePoint >> 8]];
+			return ((bitmap[(codePoint >> 5) & 0x07] >> (codePoint & 0x1F)) & 1) != 0;
 		}
 
 		inline bool CharactersReader::IsEncNameStartChar(char32_t codePoint)
@@ -1772,6 +1699,112 @@ namespace Xml
 			return BytesCount[leadingByte];
 		}
 
+		inline std::size_t Utf8ReaderBase::DecodeCharacters(const unsigned char*& first,
+			const unsigned char* last, char32_t* destination)
+		{
+			const unsigned char* p = first;
+			char32_t* out = destination;
+			while (p != last)
+			{
+#if defined(XML_ENCODING_SSE2)
+				if (last - p >= 16)
+				{
+					__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+					// Signed comparison, so the bytes above 0x7F are also less than 0x20.
+					unsigned int mask = static_cast<unsigned int>(
+						_mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(0x20))));
+
+					// Destination has enough space for all 16 characters.
+					__m128i zero = _mm_setzero_si128();
+					__m128i low = _mm_unpacklo_epi8(bytes, zero);
+					__m128i high = _mm_unpackhi_epi8(bytes, zero);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(low, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(low, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(high, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(high, zero));
+
+					if (mask == 0)
+					{
+						p += 16;
+						out += 16;
+						continue;
+					}
+
+					// Keep the printable ASCII characters before the first other byte.
+					unsigned int printable = 0;
+					while ((mask & (1u << printable)) == 0)
+						++printable;
+					p += printable;
+					out += printable;
+				}
+#else
+				if (last - p >= 8)
+				{
+					std::uint_least64_t word;
+					std::memcpy(&word, p, 8);
+
+					// Every byte must be less than 0x80 and not less than 0x20.
+					if (((word | ~(word + UINT64_C(0x6060606060606060))) &
+						UINT64_C(0x8080808080808080)) == 0)
+					{
+						for (int i = 0; i < 8; ++i)
+							out[i] = static_cast<char32_t>(p[i]);
+						p += 8;
+						out += 8;
+						continue;
+					}
+				}
+#endif
+				if (p == last)
+					break;
+
+				unsigned int bytesCount = GetBytesCount(*p);
+				if (bytesCount == 1)
+				{
+					*out++ = static_cast<char32_t>(*p++);
+					continue;
+				}
+
+				if (bytesCount == 0 || static_cast<std::size_t>(last - p) < bytesCount)
+					break;
+
+				// 0x1F, 0x0F or 0x07 mask for the leading byte.
+				char32_t codePoint = static_cast<char32_t>(*p & (0xFF >> (bytesCount + 1)));
+				unsigned int i = 1;
+				for ( ; i < bytesCount; ++i)
+				{
+					if ((p[i] & 0xC0) != 0x80)
+						break;
+					codePoint = (codePoint << 6) | static_cast<char32_t>(p[i] & 0x3F);
+				}
+
+				if (i != bytesCount)
+					break;
+
+				if (bytesCount == 2)
+				{
+					if (codePoint <= 0x7F)
+						break;
+				}
+				else if (bytesCount == 3)
+				{
+					if (!((codePoint > 0x07FF && codePoint < 0xD800) ||
+						(codePoint > 0xDFFF && codePoint <= 0xFFFD)))
+						break;
+				}
+				else if (codePoint <= 0xFFFF || codePoint > 0x10FFFF)
+				{
+					break;
+				}
+
+				*out++ = codePoint;
+				p += bytesCount;
+			}
+			first = p;
+			return static_cast<std::size_t>(out - destination);
+		}
+
 		inline Utf8ReaderBase::~Utf8ReaderBase()
 		{
 		
@@ -1888,6 +1921,75 @@ namespace Xml
 			return -2; // Something terrible with the stream.
 		}
 
+		inline std::size_t Utf8StreamReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			if (in == nullptr)
+				return ReadCharactersBy(*this, destination, capacity, result);
+
+			// Extra space for the rest of the last character.
+			const std::size_t blockSize = 256;
+			unsigned char bytes[blockSize + 3];
+
+			std::size_t count = 0;
+			while (count < capacity)
+			{
+				// Every character has at least 1 byte, so the stream
+				// is never read beyond the last requested character.
+				std::size_t size = capacity - count;
+				if (size > blockSize)
+					size = blockSize;
+
+				in->read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(size));
+				const unsigned char* last = bytes + in->gcount();
+				const unsigned char* first = bytes;
+				count += DecodeCharacters(first, last, destination + count);
+
+				if (first == last)
+				{
+					if (last == bytes + size)
+						continue;
+
+					if ((in->rdstate() & std::istream::eofbit) != 0)
+						result = 0; // End of the stream.
+					else
+						result = -2; // Something terrible with the stream.
+					return count;
+				}
+
+				// Read the rest of the last character if it's incomplete.
+				bool truncated = false;
+				std::size_t available = static_cast<std::size_t>(last - first);
+				std::size_t bytesCount = GetBytesCount(*first);
+				if (bytesCount > available)
+				{
+					truncated = true;
+					if (last == bytes + size)
+					{
+						std::size_t missing = bytesCount - available;
+						in->read(reinterpret_cast<char*>(bytes + size), static_cast<std::streamsize>(missing));
+						last += in->gcount();
+						truncated = (static_cast<std::size_t>(in->gcount()) != missing);
+					}
+				}
+
+				// The character at first needs the detailed check.
+				Utf8IteratorsReader<const unsigned char*> rest(first, last);
+				result = rest.Utf8IteratorsReader<const unsigned char*>::ReadCharacter(destination[count]);
+				if (result == -1 && truncated && rest.GetFirstIterator() == last &&
+					(in->rdstate() & std::istream::eofbit) == 0)
+				{
+					result = -2; // Something terrible with the stream.
+					return count;
+				}
+				if (result != 1)
+					return count;
+				++count;
+			}
+			result = 1;
+			return count;
+		}
+
 		inline std::istream* Utf8StreamReader::GetInputStream() const
 		{
 			return in;
@@ -1996,6 +2098,47 @@ namespace Xml
 			return 0;
 		}
 
+		template <typename TInputIterator>
+		inline std::size_t Utf8IteratorsReader<TInputIterator>::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			return ReadCharacters(destination, capacity, result, IsBytesPointer());
+		}
+
+		template <typename TInputIterator>
+		inline std::size_t Utf8IteratorsReader<TInputIterator>::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result, std::true_type)
+		{
+			std::size_t count = 0;
+			while (count < capacity)
+			{
+				const unsigned char* first = reinterpret_cast<const unsigned char*>(iterBegin);
+				std::size_t size = static_cast<std::size_t>(iterEnd - iterBegin);
+				if (size > capacity - count)
+					size = capacity - count;
+
+				count += DecodeCharacters(first, first + size, destination + count);
+				iterBegin += first - reinterpret_cast<const unsigned char*>(iterBegin);
+				if (count == capacity)
+					break;
+
+				// Invalid, incomplete or the last character.
+				result = Utf8IteratorsReader::ReadCharacter(destination[count]);
+				if (result != 1)
+					return count;
+				++count;
+			}
+			result = 1;
+			return count;
+		}
+
+		template <typename TInputIterator>
+		inline std::size_t Utf8IteratorsReader<TInputIterator>::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result, std::false_type)
+		{
+			return ReadCharactersBy(*this, destination, capacity, result);
+		}
+
 		template <typename TInputIterator>
 		inline TInputIterator Utf8IteratorsReader<TInputIterator>::GetFirstIterator() const
 		{
@@ -2016,6 +2159,177 @@ namespace Xml
 			iterEnd = last;
 		}
 
+		//
+		// Utf16ReaderBase implementation.
+		//
+
+		inline int Utf16ReaderBase::DecodeCharacter(const unsigned char*& first,
+			const unsigned char* last, char32_t& result, bool bigEndian)
+		{
+			if (last - first < 2)
+				return 0;
+
+			char32_t codeUnit = bigEndian ?
+				static_cast<char32_t>((first[0] << 8) | first[1]) :
+				static_cast<char32_t>((first[1] << 8) | first[0]);
+
+			if (codeUnit < 0xD800)
+			{
+				first += 2;
+				result = codeUnit;
+				if (codeUnit >= 0x20 ||
+					codeUnit == 0x09 ||
+					codeUnit == 0x0A ||
+					codeUnit == 0x0D)
+					return 1;
+				return -1;
+			}
+			if (codeUnit > 0xDFFF)
+			{
+				first += 2;
+				result = codeUnit;
+				if (codeUnit <= 0xFFFD)
+					return 1;
+				return -1;
+			}
+
+			// We have lead surrogate, so next code unit should be a trail surrogate.
+			if (last - first < 4)
+				return 0;
+
+			char32_t trailSurrogate = bigEndian ?
+				static_cast<char32_t>((first[2] << 8) | first[3]) :
+				static_cast<char32_t>((first[3] << 8) | first[2]);
+
+			first += 4;
+			result = codeUnit;
+			if (trailSurrogate >= 0xDC00 && trailSurrogate <= 0xDFFF)
+			{
+				result -= 0xD800;
+				result <<= 10;
+				result |= (trailSurrogate - 0xDC00);
+				result += 0x10000;
+				return 1;
+			}
+			return -1;
+		}
+
+		inline std::size_t Utf16ReaderBase::DecodeCharacters(const unsigned char*& first,
+			const unsigned char* last, char32_t* destination, bool bigEndian)
+		{
+			const unsigned char* p = first;
+			char32_t* out = destination;
+			while (p != last)
+			{
+#if defined(XML_ENCODING_SSE2)
+				if (last - p >= 16)
+				{
+					__m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+					if (bigEndian)
+						units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+
+					// Unsigned comparison 0x20 <= unit < 0xD800 by the signed one.
+					__m128i shifted = _mm_xor_si128(
+						_mm_sub_epi16(units, _mm_set1_epi16(0x20)),
+						_mm_set1_epi16(static_cast<short>(0x8000)));
+					unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+						_mm_cmplt_epi16(shifted, _mm_set1_epi16(0x57E0))));
+
+					// Destination has enough space for all 8 characters.
+					__m128i zero = _mm_setzero_si128();
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(units, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(units, zero));
+
+					if (mask == 0xFFFF)
+					{
+						p += 16;
+						out += 8;
+						continue;
+					}
+
+					// Keep the characters before the first other code unit.
+					unsigned int simple = 0;
+					while ((mask & (1u << (simple * 2))) != 0)
+						++simple;
+					p += simple * 2;
+					out += simple;
+				}
+#endif
+				const unsigned char* next = p;
+				if (DecodeCharacter(next, last, *out, bigEndian) != 1)
+					break;
+				p = next;
+				++out;
+			}
+			first = p;
+			return static_cast<std::size_t>(out - destination);
+		}
+
+		inline std::size_t Utf16ReaderBase::ReadStreamCharacters(std::istream* inputStream,
+			char32_t* destination, std::size_t capacity, int& result, bool bigEndian)
+		{
+			// Extra space for the trail surrogate of the last character.
+			const std::size_t blockSize = 512;
+			unsigned char bytes[blockSize + 2];
+
+			std::size_t count = 0;
+			while (count < capacity)
+			{
+				// Every character has at least 2 bytes, so the stream
+				// is never read beyond the last requested character.
+				std::size_t size = 2 * (capacity - count);
+				if (size > blockSize)
+					size = blockSize;
+
+				inputStream->read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(size));
+				const unsigned char* last = bytes + inputStream->gcount();
+				const unsigned char* first = bytes;
+				count += DecodeCharacters(first, last, destination + count, bigEndian);
+
+				if (first == last)
+				{
+					if (last == bytes + size)
+						continue;
+
+					if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+						result = 0; // End of the stream.
+					else
+						result = -2; // Something terrible with the stream.
+					return count;
+				}
+
+				result = DecodeCharacter(first, last, destination[count], bigEndian);
+				if (result == 0 && last == bytes + size)
+				{
+					// Lead surrogate at the end of the block. Read the trail surrogate.
+					inputStream->read(reinterpret_cast<char*>(bytes + size), 2);
+					last += inputStream->gcount();
+					result = DecodeCharacter(first, last, destination[count], bigEndian);
+				}
+
+				if (result == 0)
+				{
+					// The stream ended inside the character.
+					if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+						result = -1; // Invalid character.
+					else
+						result = -2; // Something terrible with the stream.
+					return count;
+				}
+
+				if (result != 1)
+					return count;
+				++count;
+			}
+			result = 1;
+			return count;
+		}
+
+		inline Utf16ReaderBase::~Utf16ReaderBase()
+		{
+		
+		}
+
 		//
 		// Utf16BEStreamReader implementation.
 		//
@@ -2118,6 +2432,14 @@ namespace Xml
 			return -2; // Something terrible with the stream.
 		}
 
+		inline std::size_t Utf16BEStreamReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			if (in == nullptr)
+				return ReadCharactersBy(*this, destination, capacity, result);
+			return ReadStreamCharacters(in, destination, capacity, result, true);
+		}
+
 		inline std::istream* Utf16BEStreamReader::GetInputStream() const
 		{
 			return in;
@@ -2228,6 +2550,14 @@ namespace Xml
 			return -2; // Something terrible with the stream.
 		}
 
+		inline std::size_t Utf16LEStreamReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			if (in == nullptr)
+				return ReadCharactersBy(*this, destination, capacity, result);
+			return ReadStreamCharacters(in, destination, capacity, result, false);
+		}
+
 		inline std::istream* Utf16LEStreamReader::GetInputStream() const
 		{
 			return in;
@@ -2319,6 +2649,12 @@ namespace Xml
 			return -2; // Something terrible with the stream.
 		}
 
+		inline std::size_t Utf32BEStreamReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			return ReadCharactersBy(*this, destination, capacity, result);
+		}
+
 		inline std::istream* Utf32BEStreamReader::GetInputStream() const
 		{
 			return in;
@@ -2409,6 +2745,12 @@ namespace Xml
 			return -2; // Something terrible with the stream.
 		}
 
+		inline std::size_t Utf32LEStreamReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			return ReadCharactersBy(*this, destination, capacity, result);
+		}
+
 		inline std::istream* Utf32LEStreamReader::GetInputStream() const
 		{
 			return in;
@@ -2420,42 +2762,23 @@ namespace Xml
 		}
 
 		//
-		// ISO_8859_1_StreamReader implementation.
+		// SingleByteStreamReader implementation.
 		//
 
-		inline ISO_8859_1_StreamReader::ISO_8859_1_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+		inline SingleByteStreamReader::SingleByteStreamReader(
+			std::istream* inputStream, const char16_t* characterMap)
+			: in(inputStream), map(nullptr), asciiCompatible(true)
 		{
-		
+			ResetCharacterMap(characterMap);
 		}
 
-		inline ISO_8859_1_StreamReader::~ISO_8859_1_StreamReader()
+		inline SingleByteStreamReader::~SingleByteStreamReader()
 		{
 		
 		}
 
-		inline int ISO_8859_1_StreamReader::ReadCharacter(char32_t& result)
+		inline int SingleByteStreamReader::ReadCharacter(char32_t& result)
 		{
-			static const unsigned char map[256] =
-			{
-				0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0A, 0x00, 0x00, 0x0D, 0x00, 0x00,
-				0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-				0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
-				0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
-				0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
-				0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
-				0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
-				0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
-				0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
-				0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
-				0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
-				0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
-				0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
-				0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
-				0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
-				0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
-			};
-
 			if (in != nullptr)
 			{
 				int oneByte = in->get();
@@ -2476,32 +2799,113 @@ namespace Xml
 			return -2;
 		}
 
-		inline std::istream* ISO_8859_1_StreamReader::GetInputStream() const
+		inline std::size_t SingleByteStreamReader::ReadCharacters(
+			char32_t* destination, std::size_t capacity, int& result)
+		{
+			if (in == nullptr)
+				return ReadCharactersBy(*this, destination, capacity, result);
+
+			const std::size_t blockSize = 512;
+			unsigned char bytes[blockSize];
+
+			std::size_t count = 0;
+			while (count < capacity)
+			{
+				// One byte per character, so the stream is never
+				// read beyond the last requested character.
+				std::size_t size = capacity - count;
+				if (size > blockSize)
+					size = blockSize;
+
+				in->read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(size));
+				std::size_t gotten = static_cast<std::size_t>(in->gcount());
+				char32_t* out = destination + count;
+				std::size_t i = 0;
+				while (i < gotten)
+				{
+#if defined(XML_ENCODING_SSE2)
+					if (asciiCompatible && gotten - i >= 16)
+					{
+						__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+
+						// Signed comparison, so the bytes above 0x7F are also less than 0x20.
+						if (_mm_movemask_epi8(_mm_cmplt_epi8(chunk, _mm_set1_epi8(0x20))) == 0)
+						{
+							__m128i zero = _mm_setzero_si128();
+							__m128i low = _mm_unpacklo_epi8(chunk, zero);
+							__m128i high = _mm_unpackhi_epi8(chunk, zero);
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(low, zero));
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(low, zero));
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpacklo_epi16(high, zero));
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), _mm_unpackhi_epi16(high, zero));
+							i += 16;
+							continue;
+						}
+					}
+#endif
+					out[i] = static_cast<char32_t>(map[bytes[i]]);
+					if (out[i] == 0)
+					{
+						result = -1; // Invalid character.
+						return count + i;
+					}
+					++i;
+				}
+				count += gotten;
+
+				if (gotten != size)
+				{
+					if ((in->rdstate() & std::istream::eofbit) != 0)
+						result = 0; // End of the stream.
+					else
+						result = -2; // Something terrible with the stream.
+					return count;
+				}
+			}
+			result = 1;
+			return count;
+		}
+
+		inline std::istream* SingleByteStreamReader::GetInputStream() const
 		{
 			return in;
 		}
 
-		inline void ISO_8859_1_StreamReader::ResetInputStream(std::istream* inputStream)
+		inline void SingleByteStreamReader::ResetInputStream(std::istream* inputStream)
 		{
 			in = inputStream;
 		}
 
+		inline void SingleByteStreamReader::ResetCharacterMap(const char16_t* characterMap)
+		{
+			map = characterMap;
+			asciiCompatible = true;
+			for (unsigned int i = 0x20; i < 0x80; ++i)
+			{
+				if (map[i] != i)
+				{
+					asciiCompatible = false;
+					break;
+				}
+			}
+		}
+
 		//
-		// ISO_8859_2_StreamReader implementation.
+		// ISO_8859_1_StreamReader implementation.
 		//
 
-		inline ISO_8859_2_StreamReader::ISO_8859_2_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+		inline ISO_8859_1_StreamReader::ISO_8859_1_StreamReader(std::istream* inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
 
-		inline ISO_8859_2_StreamReader::~ISO_8859_2_StreamReader()
+		inline ISO_8859_1_StreamReader::~ISO_8859_1_StreamReader()
 		{
 		
 		}
 
-		inline int ISO_8859_2_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_1_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2515,42 +2919,53 @@ namespace Xml
 				0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x007F,
 				0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087, 0x0088, 0x0089, 0x008A, 0x008B, 0x008C, 0x008D, 0x008E, 0x008F,
 				0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097, 0x0098, 0x0099, 0x009A, 0x009B, 0x009C, 0x009D, 0x009E, 0x009F,
-				0x00A0, 0x0104, 0x02D8, 0x0141, 0x00A4, 0x013D, 0x015A, 0x00A7, 0x00A8, 0x0160, 0x015E, 0x0164, 0x0179, 0x00AD, 0x017D, 0x017B,
-				0x00B0, 0x0105, 0x02DB, 0x0142, 0x00B4, 0x013E, 0x015B, 0x02C7, 0x00B8, 0x0161, 0x015F, 0x0165, 0x017A, 0x02DD, 0x017E, 0x017C,
-				0x0154, 0x00C1, 0x00C2, 0x0102, 0x00C4, 0x0139, 0x0106, 0x00C7, 0x010C, 0x00C9, 0x0118, 0x00CB, 0x011A, 0x00CD, 0x00CE, 0x010E,
-				0x0110, 0x0143, 0x0147, 0x00D3, 0x00D4, 0x0150, 0x00D6, 0x00D7, 0x0158, 0x016E, 0x00DA, 0x0170, 0x00DC, 0x00DD, 0x0162, 0x00DF,
-				0x0155, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x013A, 0x0107, 0x00E7, 0x010D, 0x00E9, 0x0119, 0x00EB, 0x011B, 0x00ED, 0x00EE, 0x010F,
-				0x0111, 0x0144, 0x0148, 0x00F3, 0x00F4, 0x0151, 0x00F6, 0x00F7, 0x0159, 0x016F, 0x00FA, 0x0171, 0x00FC, 0x00FD, 0x0163, 0x02D9
+				0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A4, 0x00A5, 0x00A6, 0x00A7, 0x00A8, 0x00A9, 0x00AA, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x00AF,
+				0x00B0, 0x00B1, 0x00B2, 0x00B3, 0x00B4, 0x00B5, 0x00B6, 0x00B7, 0x00B8, 0x00B9, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BE, 0x00BF,
+				0x00C0, 0x00C1, 0x00C2, 0x00C3, 0x00C4, 0x00C5, 0x00C6, 0x00C7, 0x00C8, 0x00C9, 0x00CA, 0x00CB, 0x00CC, 0x00CD, 0x00CE, 0x00CF,
+				0x00D0, 0x00D1, 0x00D2, 0x00D3, 0x00D4, 0x00D5, 0x00D6, 0x00D7, 0x00D8, 0x00D9, 0x00DA, 0x00DB, 0x00DC, 0x00DD, 0x00DE, 0x00DF,
+				0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
+				0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF
 			};
+			return map;
+		}
 
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
+		//
+		// ISO_8859_2_StreamReader implementation.
+		//
 
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
+		inline ISO_8859_2_StreamReader::ISO_8859_2_StreamReader(std::istream* inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
+		{
+		
 		}
 
-		inline std::istream* ISO_8859_2_StreamReader::GetInputStream() const
+		inline ISO_8859_2_StreamReader::~ISO_8859_2_StreamReader()
 		{
-			return in;
+		
 		}
 
-		inline void ISO_8859_2_StreamReader::ResetInputStream(std::istream* inputStream)
+		inline const char16_t* ISO_8859_2_StreamReader::GetCharacterMap()
 		{
-			in = inputStream;
+			static const char16_t map[256] =
+			{
+				0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0009, 0x000A, 0x0000, 0x0000, 0x000D, 0x0000, 0x0000,
+				0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+				0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+				0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+				0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+				0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F,
+				0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+				0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x007F,
+				0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087, 0x0088, 0x0089, 0x008A, 0x008B, 0x008C, 0x008D, 0x008E, 0x008F,
+				0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097, 0x0098, 0x0099, 0x009A, 0x009B, 0x009C, 0x009D, 0x009E, 0x009F,
+				0x00A0, 0x0104, 0x02D8, 0x0141, 0x00A4, 0x013D, 0x015A, 0x00A7, 0x00A8, 0x0160, 0x015E, 0x0164, 0x0179, 0x00AD, 0x017D, 0x017B,
+				0x00B0, 0x0105, 0x02DB, 0x0142, 0x00B4, 0x013E, 0x015B, 0x02C7, 0x00B8, 0x0161, 0x015F, 0x0165, 0x017A, 0x02DD, 0x017E, 0x017C,
+				0x0154, 0x00C1, 0x00C2, 0x0102, 0x00C4, 0x0139, 0x0106, 0x00C7, 0x010C, 0x00C9, 0x0118, 0x00CB, 0x011A, 0x00CD, 0x00CE, 0x010E,
+				0x0110, 0x0143, 0x0147, 0x00D3, 0x00D4, 0x0150, 0x00D6, 0x00D7, 0x0158, 0x016E, 0x00DA, 0x0170, 0x00DC, 0x00DD, 0x0162, 0x00DF,
+				0x0155, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x013A, 0x0107, 0x00E7, 0x010D, 0x00E9, 0x0119, 0x00EB, 0x011B, 0x00ED, 0x00EE, 0x010F,
+				0x0111, 0x0144, 0x0148, 0x00F3, 0x00F4, 0x0151, 0x00F6, 0x00F7, 0x0159, 0x016F, 0x00FA, 0x0171, 0x00FC, 0x00FD, 0x0163, 0x02D9
+			};
+			return map;
 		}
 
 		//
@@ -2558,7 +2973,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_3_StreamReader::ISO_8859_3_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2568,7 +2983,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_3_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_3_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2589,35 +3004,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x0000, 0x00E4, 0x010B, 0x0109, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x0000, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x0121, 0x00F6, 0x00F7, 0x011D, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x016D, 0x015D, 0x02D9,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_3_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_3_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -2625,7 +3012,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_4_StreamReader::ISO_8859_4_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2635,7 +3022,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_4_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_4_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2656,35 +3043,7 @@ namespace Xml
 				0x0101, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x012F, 0x010D, 0x00E9, 0x0119, 0x00EB, 0x0117, 0x00ED, 0x00EE, 0x012B,
 				0x0111, 0x0146, 0x014D, 0x0137, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x0173, 0x00FA, 0x00FB, 0x00FC, 0x0169, 0x016B, 0x02D9,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_4_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_4_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -2692,7 +3051,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_5_StreamReader::ISO_8859_5_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2702,7 +3061,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_5_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_5_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2723,35 +3082,7 @@ namespace Xml
 				0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447, 0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F,
 				0x2116, 0x0451, 0x0452, 0x0453, 0x0454, 0x0455, 0x0456, 0x0457, 0x0458, 0x0459, 0x045A, 0x045B, 0x045C, 0x00A7, 0x045E, 0x045F,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_5_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_5_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -2759,7 +3090,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_6_StreamReader::ISO_8859_6_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2769,7 +3100,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_6_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_6_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2790,35 +3121,7 @@ namespace Xml
 				0x0640, 0x0641, 0x0642, 0x0643, 0x0644, 0x0645, 0x0646, 0x0647, 0x0648, 0x0649, 0x064A, 0x064B, 0x064C, 0x064D, 0x064E, 0x064F,
 				0x0650, 0x0651, 0x0652, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_6_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_6_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -2826,7 +3129,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_7_StreamReader::ISO_8859_7_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2836,7 +3139,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_7_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_7_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2857,35 +3160,7 @@ namespace Xml
 				0x03B0, 0x03B1, 0x03B2, 0x03B3, 0x03B4, 0x03B5, 0x03B6, 0x03B7, 0x03B8, 0x03B9, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BE, 0x03BF,
 				0x03C0, 0x03C1, 0x03C2, 0x03C3, 0x03C4, 0x03C5, 0x03C6, 0x03C7, 0x03C8, 0x03C9, 0x03CA, 0x03CB, 0x03CC, 0x03CD, 0x03CE, 0x0000,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_7_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_7_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -2893,7 +3168,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_8_StreamReader::ISO_8859_8_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2903,7 +3178,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_8_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_8_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2924,35 +3199,7 @@ namespace Xml
 				0x05D0, 0x05D1, 0x05D2, 0x05D3, 0x05D4, 0x05D5, 0x05D6, 0x05D7, 0x05D8, 0x05D9, 0x05DA, 0x05DB, 0x05DC, 0x05DD, 0x05DE, 0x05DF,
 				0x05E0, 0x05E1, 0x05E2, 0x05E3, 0x05E4, 0x05E5, 0x05E6, 0x05E7, 0x05E8, 0x05E9, 0x05EA, 0x0000, 0x0000, 0x200E, 0x200F, 0x0000,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_8_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_8_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -2960,7 +3207,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_9_StreamReader::ISO_8859_9_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -2970,7 +3217,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_9_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_9_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -2991,35 +3238,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x011F, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x0131, 0x015F, 0x00FF,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_9_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_9_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3027,7 +3246,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_10_StreamReader::ISO_8859_10_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3037,7 +3256,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_10_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_10_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3058,35 +3277,7 @@ namespace Xml
 				0x0101, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x012F, 0x010D, 0x00E9, 0x0119, 0x00EB, 0x0117, 0x00ED, 0x00EE, 0x00EF,
 				0x00F0, 0x0146, 0x014D, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x0169, 0x00F8, 0x0173, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x0138,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_10_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_10_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3094,7 +3285,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_13_StreamReader::ISO_8859_13_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3104,7 +3295,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_13_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_13_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3125,35 +3316,7 @@ namespace Xml
 				0x0105, 0x012F, 0x0101, 0x0107, 0x00E4, 0x00E5, 0x0119, 0x0113, 0x010D, 0x00E9, 0x017A, 0x0117, 0x0123, 0x0137, 0x012B, 0x013C,
 				0x0161, 0x0144, 0x0146, 0x00F3, 0x014D, 0x00F5, 0x00F6, 0x00F7, 0x0173, 0x0142, 0x015B, 0x016B, 0x00FC, 0x017C, 0x017E, 0x2019,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_13_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_13_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3161,7 +3324,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_14_StreamReader::ISO_8859_14_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3171,7 +3334,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_14_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_14_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3192,35 +3355,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x0175, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x1E6B, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x0177, 0x00FF,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_14_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_14_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3228,7 +3363,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_15_StreamReader::ISO_8859_15_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3238,7 +3373,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_15_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_15_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3259,35 +3394,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_15_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_15_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3295,7 +3402,7 @@ namespace Xml
 		//
 
 		inline ISO_8859_16_StreamReader::ISO_8859_16_StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3305,7 +3412,7 @@ namespace Xml
 		
 		}
 
-		inline int ISO_8859_16_StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* ISO_8859_16_StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3326,35 +3433,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x0107, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x0111, 0x0144, 0x00F2, 0x00F3, 0x00F4, 0x0151, 0x00F6, 0x015B, 0x0171, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x0119, 0x021B, 0x00FF,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* ISO_8859_16_StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void ISO_8859_16_StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3362,7 +3441,7 @@ namespace Xml
 		//
 
 		inline TIS620StreamReader::TIS620StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3372,7 +3451,7 @@ namespace Xml
 		
 		}
 
-		inline int TIS620StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* TIS620StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3393,35 +3472,7 @@ namespace Xml
 				0x0E40, 0x0E41, 0x0E42, 0x0E43, 0x0E44, 0x0E45, 0x0E46, 0x0E47, 0x0E48, 0x0E49, 0x0E4A, 0x0E4B, 0x0E4C, 0x0E4D, 0x0E4E, 0x0E4F,
 				0x0E50, 0x0E51, 0x0E52, 0x0E53, 0x0E54, 0x0E55, 0x0E56, 0x0E57, 0x0E58, 0x0E59, 0x0E5A, 0x0E5B, 0x0000, 0x0000, 0x0000, 0x0000,
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* TIS620StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void TIS620StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3429,7 +3480,7 @@ namespace Xml
 		//
 
 		inline Windows874StreamReader::Windows874StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3439,7 +3490,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows874StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows874StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3456,39 +3507,11 @@ namespace Xml
 				0x00A0, 0x0E01, 0x0E02, 0x0E03, 0x0E04, 0x0E05, 0x0E06, 0x0E07, 0x0E08, 0x0E09, 0x0E0A, 0x0E0B, 0x0E0C, 0x0E0D, 0x0E0E, 0x0E0F,
 				0x0E10, 0x0E11, 0x0E12, 0x0E13, 0x0E14, 0x0E15, 0x0E16, 0x0E17, 0x0E18, 0x0E19, 0x0E1A, 0x0E1B, 0x0E1C, 0x0E1D, 0x0E1E, 0x0E1F,
 				0x0E20, 0x0E21, 0x0E22, 0x0E23, 0x0E24, 0x0E25, 0x0E26, 0x0E27, 0x0E28, 0x0E29, 0x0E2A, 0x0E2B, 0x0E2C, 0x0E2D, 0x0E2E, 0x0E2F,
-				0x0E30, 0x0E31, 0x0E32, 0x0E33, 0x0E34, 0x0E35, 0x0E36, 0x0E37, 0x0E38, 0x0E39, 0x0E3A, 0x0000, 0x0000, 0x0000, 0x0000, 0x0E3F,
-				0x0E40, 0x0E41, 0x0E42, 0x0E43, 0x0E44, 0x0E45, 0x0E46, 0x0E47, 0x0E48, 0x0E49, 0x0E4A, 0x0E4B, 0x0E4C, 0x0E4D, 0x0E4E, 0x0E4F,
-				0x0E50, 0x0E51, 0x0E52, 0x0E53, 0x0E54, 0x0E55, 0x0E56, 0x0E57, 0x0E58, 0x0E59, 0x0E5A, 0x0E5B, 0x0000, 0x0000, 0x0000, 0x0000
-			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows874StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows874StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+				0x0E30, 0x0E31, 0x0E32, 0x0E33, 0x0E34, 0x0E35, 0x0E36, 0x0E37, 0x0E38, 0x0E39, 0x0E3A, 0x0000, 0x0000, 0x0000, 0x0000, 0x0E3F,
+				0x0E40, 0x0E41, 0x0E42, 0x0E43, 0x0E44, 0x0E45, 0x0E46, 0x0E47, 0x0E48, 0x0E49, 0x0E4A, 0x0E4B, 0x0E4C, 0x0E4D, 0x0E4E, 0x0E4F,
+				0x0E50, 0x0E51, 0x0E52, 0x0E53, 0x0E54, 0x0E55, 0x0E56, 0x0E57, 0x0E58, 0x0E59, 0x0E5A, 0x0E5B, 0x0000, 0x0000, 0x0000, 0x0000
+			};
+			return map;
 		}
 
 		//
@@ -3496,7 +3519,7 @@ namespace Xml
 		//
 
 		inline Windows1250StreamReader::Windows1250StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3506,7 +3529,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1250StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1250StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3527,35 +3550,7 @@ namespace Xml
 				0x0155, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x013A, 0x0107, 0x00E7, 0x010D, 0x00E9, 0x0119, 0x00EB, 0x011B, 0x00ED, 0x00EE, 0x010F,
 				0x0111, 0x0144, 0x0148, 0x00F3, 0x00F4, 0x0151, 0x00F6, 0x00F7, 0x0159, 0x016F, 0x00FA, 0x0171, 0x00FC, 0x00FD, 0x0163, 0x02D9
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1250StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1250StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3563,7 +3558,7 @@ namespace Xml
 		//
 
 		inline Windows1251StreamReader::Windows1251StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3573,7 +3568,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1251StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1251StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3594,35 +3589,7 @@ namespace Xml
 				0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437, 0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
 				0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447, 0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1251StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1251StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3630,7 +3597,7 @@ namespace Xml
 		//
 
 		inline Windows1252StreamReader::Windows1252StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3640,7 +3607,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1252StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1252StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3661,35 +3628,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1252StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1252StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3697,7 +3636,7 @@ namespace Xml
 		//
 
 		inline Windows1253StreamReader::Windows1253StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3707,7 +3646,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1253StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1253StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3728,35 +3667,7 @@ namespace Xml
 				0x03B0, 0x03B1, 0x03B2, 0x03B3, 0x03B4, 0x03B5, 0x03B6, 0x03B7, 0x03B8, 0x03B9, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BE, 0x03BF,
 				0x03C0, 0x03C1, 0x03C2, 0x03C3, 0x03C4, 0x03C5, 0x03C6, 0x03C7, 0x03C8, 0x03C9, 0x03CA, 0x03CB, 0x03CC, 0x03CD, 0x03CE, 0x0000
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1253StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1253StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3764,7 +3675,7 @@ namespace Xml
 		//
 
 		inline Windows1254StreamReader::Windows1254StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3774,7 +3685,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1254StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1254StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3795,35 +3706,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
 				0x011F, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x0131, 0x015F, 0x00FF
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1254StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1254StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3831,7 +3714,7 @@ namespace Xml
 		//
 
 		inline Windows1255StreamReader::Windows1255StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3841,7 +3724,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1255StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1255StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3862,35 +3745,7 @@ namespace Xml
 				0x05D0, 0x05D1, 0x05D2, 0x05D3, 0x05D4, 0x05D5, 0x05D6, 0x05D7, 0x05D8, 0x05D9, 0x05DA, 0x05DB, 0x05DC, 0x05DD, 0x05DE, 0x05DF,
 				0x05E0, 0x05E1, 0x05E2, 0x05E3, 0x05E4, 0x05E5, 0x05E6, 0x05E7, 0x05E8, 0x05E9, 0x05EA, 0x0000, 0x0000, 0x200E, 0x200F, 0x0000
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1255StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1255StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3898,7 +3753,7 @@ namespace Xml
 		//
 
 		inline Windows1256StreamReader::Windows1256StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3908,7 +3763,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1256StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1256StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3929,35 +3784,7 @@ namespace Xml
 				0x00E0, 0x0644, 0x00E2, 0x0645, 0x0646, 0x0647, 0x0648, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x0649, 0x064A, 0x00EE, 0x00EF,
 				0x064B, 0x064C, 0x064D, 0x064E, 0x00F4, 0x064F, 0x0650, 0x00F7, 0x0651, 0x00F9, 0x0652, 0x00FB, 0x00FC, 0x200E, 0x200F, 0x06D2
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1256StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1256StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -3965,7 +3792,7 @@ namespace Xml
 		//
 
 		inline Windows1257StreamReader::Windows1257StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -3975,7 +3802,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1257StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1257StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -3996,35 +3823,7 @@ namespace Xml
 				0x0105, 0x012F, 0x0101, 0x0107, 0x00E4, 0x00E5, 0x0119, 0x0113, 0x010D, 0x00E9, 0x017A, 0x0117, 0x0123, 0x0137, 0x012B, 0x013C,
 				0x0161, 0x0144, 0x0146, 0x00F3, 0x014D, 0x00F5, 0x00F6, 0x00F7, 0x0173, 0x0142, 0x015B, 0x016B, 0x00FC, 0x017C, 0x017E, 0x02D9
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1257StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1257StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 
 		//
@@ -4032,7 +3831,7 @@ namespace Xml
 		//
 
 		inline Windows1258StreamReader::Windows1258StreamReader(std::istream* inputStream)
-			: in(inputStream)
+			: SingleByteStreamReader(inputStream, GetCharacterMap())
 		{
 		
 		}
@@ -4042,7 +3841,7 @@ namespace Xml
 		
 		}
 
-		inline int Windows1258StreamReader::ReadCharacter(char32_t& result)
+		inline const char16_t* Windows1258StreamReader::GetCharacterMap()
 		{
 			static const char16_t map[256] =
 			{
@@ -4063,35 +3862,7 @@ namespace Xml
 				0x00E0, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x0301, 0x00ED, 0x00EE, 0x00EF,
 				0x0111, 0x00F1, 0x0323, 0x00F3, 0x00F4, 0x01A1, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x01B0, 0x20AB, 0x00FF
 			};
-
-			if (in != nullptr)
-			{
-				int oneByte = in->get();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((in->rdstate() & std::istream::eofbit) != 0)
-						return 0; // End of the stream.
-					return -2;
-				}
-
-				result = static_cast<char32_t>(map[static_cast<unsigned char>(oneByte)]);
-				if (result > 0)
-					return 1;
-				else
-					return -1;
-			}
-			return -2;
-		}
-
-		inline std::istream* Windows1258StreamReader::GetInputStream() const
-		{
-			return in;
-		}
-
-		inline void Windows1258StreamReader::ResetInputStream(std::istream* inputStream)
-		{
-			in = inputStream;
+			return map;
 		}
 	}
 }
@@ -53,6 +53,16 @@ namespace Xml
 				@param codePoint Code point of the Unicode character to write.
 			*/
 			static void WriteCharacter(StringType& stringDestination, char32_t codePoint);
+
+			/**
+				@brief Inserts the Unicode characters into the UTF-8 encoded string.
+
+				@param[out] stringDestination String where the characters should be inserted.
+				@param first,last Pointers to the initial and final positions
+					in a sequence of code points. The range used is [first,last).
+			*/
+			static void WriteCharacters(StringType& stringDestination,
+				const char32_t* first, const char32_t* last);
 		};
 
 		/**
@@ -75,6 +85,16 @@ namespace Xml
 				@param codePoint Code point of the Unicode character to write.
 			*/
 			static void WriteCharacter(StringType& stringDestination, char32_t codePoint);
+
+			/**
+				@brief Inserts the Unicode characters into the UTF-16 encoded string.
+
+				@param[out] stringDestination String where the characters should be inserted.
+				@param first,last Pointers to the initial and final positions
+					in a sequence of code points. The range used is [first,last).
+			*/
+			static void WriteCharacters(StringType& stringDestination,
+				const char32_t* first, const char32_t* last);
 		};
 
 		/**
@@ -97,6 +117,16 @@ namespace Xml
 				@param codePoint Code point of Unicode character to write.
 			*/
 			static void WriteCharacter(StringType& stringDestination, char32_t codePoint);
+
+			/**
+				@brief Inserts the Unicode characters into the UTF-32 encoded string.
+
+				@param[out] stringDestination String where the characters should be inserted.
+				@param first,last Pointers to the initial and final positions
+					in a sequence of code points. The range used is [first,last).
+			*/
+			static void WriteCharacters(StringType& stringDestination,
+				const char32_t* first, const char32_t* last);
 		};
 
 		inline void Utf8Writer::WriteCharacter(
@@ -164,6 +194,28 @@ namespace Xml
 			}
 		}
 
+		inline void Utf8Writer::WriteCharacters(StringType& stringDestination,
+			const char32_t* first, const char32_t* last)
+		{
+			const char32_t* i = first;
+			while (i != last && *i <= 0x7F)
+				++i;
+
+			if (i == last)
+			{
+				// ASCII characters only, so append them at once.
+				StringType::size_type size = stringDestination.size();
+				stringDestination.resize(size + static_cast<StringType::size_type>(last - first));
+				StringType::value_type* destination = &stringDestination[size];
+				for ( ; first != last; ++first, ++destination)
+					*destination = static_cast<StringType::value_type>(*first);
+				return;
+			}
+
+			for ( ; first != last; ++first)
+				WriteCharacter(stringDestination, *first);
+		}
+
 		inline void Utf16Writer::WriteCharacter(
 			StringType& stringDestination, char32_t codePoint)
 		{
@@ -182,11 +234,35 @@ namespace Xml
 			}
 		}
 
+		inline void Utf16Writer::WriteCharacters(StringType& stringDestination,
+			const char32_t* first, const char32_t* last)
+		{
+			const char32_t* i = first;
+			while (i != last && *i <= 0xD7FF)
+				++i;
+
+			if (i == last)
+			{
+				// No surrogate pairs, so append the characters at once.
+				stringDestination.append(first, last);
+				return;
+			}
+
+			for ( ; first != last; ++first)
+				WriteCharacter(stringDestination, *first);
+		}
+
 		inline void Utf32Writer::WriteCharacter(
 			StringType& stringDestination, char32_t codePoint)
 		{
 			stringDestination.push_back(static_cast<StringType::value_type>(codePoint));
 		}
+
+		inline void Utf32Writer::WriteCharacters(StringType& stringDestination,
+			const char32_t* first, const char32_t* last)
+		{
+			stringDestination.append(first, last);
+		}
 	}
 }
 
@@ -31,9 +31,63 @@
 #include <istream>
 #include <fstream>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <deque>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+#include <type_traits>
 #include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <system_error>
+#include <chrono>
+
+#if defined(_WIN32)
+// Keep min and max macros and rarely used APIs of windows.h
+// away from the code including this header.
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#define XML_INSPECTOR_LEAN_AND_MEAN
+#endif
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#define XML_INSPECTOR_NOMINMAX
+#endif
+#include <windows.h>
+#if defined(XML_INSPECTOR_LEAN_AND_MEAN)
+#undef WIN32_LEAN_AND_MEAN
+#undef XML_INSPECTOR_LEAN_AND_MEAN
+#endif
+#if defined(XML_INSPECTOR_NOMINMAX)
+#undef NOMINMAX
+#undef XML_INSPECTOR_NOMINMAX
+#endif
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#if defined(XML_INSPECTOR_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define XML_INSPECTOR_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
 
 /**
 	@file XmlInspector.hpp
@@ -261,7 +315,15 @@ namespace Xml
 			@brief Prefix 'xml' is reserved for use by the XML and has a fixed
 				namespace URI http://www.w3.org/XML/1998/namespace.
 		*/
-		InvalidXmlPrefixDeclaration
+		InvalidXmlPrefixDeclaration,
+
+		/**
+			@brief The next token isn't fed completely yet.
+				It's not an error of the document. Feed more bytes by
+				Xml::Inspector::Feed method or finish the document by
+				Xml::Inspector::FinishFeed method and try again.
+		*/
+		NeedMoreData
 	};
 
 	/**
@@ -280,6 +342,67 @@ namespace Xml
 		DoubleQuote
 	};
 
+	/**
+		@brief Read-only view of the characters of a string, similar to
+			@c std::string_view from C++17.
+
+		View doesn't own the characters, so they must outlive it.
+
+		@sa Inspector::GetValueView().
+	*/
+	template <typename TCharacter>
+	class StringView
+	{
+	private:
+		const TCharacter* data;
+		std::size_t size;
+	public:
+		/**
+			@brief Constructs an empty view.
+		*/
+		StringView();
+
+		/**
+			@brief Constructs a view of the characters.
+
+			@param first Pointer to the first character.
+			@param count Number of the characters.
+		*/
+		StringView(const TCharacter* first, std::size_t count);
+
+		/**
+			@brief Gets the pointer to the first character.
+
+			Characters are not terminated by the null character.
+		*/
+		const TCharacter* GetData() const;
+
+		/**
+			@brief Gets the number of the characters.
+		*/
+		std::size_t GetSize() const;
+
+		/**
+			@brief Gets a value indicating whether the view is empty.
+		*/
+		bool IsEmpty() const;
+
+		/**
+			@brief Gets the pointer to the first character (for range-based for loops).
+		*/
+		const TCharacter* begin() const;
+
+		/**
+			@brief Gets the pointer past the last character (for range-based for loops).
+		*/
+		const TCharacter* end() const;
+
+		/**
+			@brief Copies the characters to the string.
+		*/
+		std::basic_string<TCharacter> ToString() const;
+	};
+
 	/**
 		@brief Class for storing attribute data like name and value.
 	*/
@@ -337,6 +460,8 @@ namespace Xml
 			@endverbatim
 			Row number of @c attrName is 3.
 
+			With Xml::LazyPositions policy it's used by the parser and it isn't the row number.
+
 			@sa Column.
 		*/
 		SizeType Row;
@@ -350,17 +475,164 @@ namespace Xml
 			@endverbatim
 			Column number of @c attrName is 7.
 
+			With Xml::LazyPositions policy it's used by the parser and it isn't the column number.
+
 			@warning Carriage return characters (U+000D) are ignored.
 			@sa Row.
 		*/
 		SizeType Column;
 
+		/**
+			@brief Offset of the first byte of the attribute name
+				from the beginning of the source (including BOM).
+
+			@sa Inspector::GetByteOffset().
+		*/
+		SizeType ByteOffset;
+
 		/**
 			@brief Delimiter of the attribute value.
 		*/
 		QuotationMark Delimiter;
 	};
 
+	/**
+		@brief Read-only memory mapping of the whole file.
+
+		Mapped file could be used as a source of Xml::Inspector object.
+		Bytes are decoded directly from the mapped memory, so there is
+		no copying between the kernel and the user buffers and no input
+		stream involved. The operating system is informed that the file
+		will be read sequentially.
+
+		Example:
+		@code{.cpp}
+        Xml::MappedFile file("catalog.xml");
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&file);
+        while (inspector.Inspect())
+        {
+            // ...
+        }
+		@endcode
+
+		@warning Mapped file must live longer than the Xml::Inspector
+			object that parses it. Changing the file during parsing
+			leads to undefined behavior.
+	*/
+	class MappedFile
+	{
+	private:
+		const char* data;
+		std::size_t size;
+		bool opened;
+#if defined(_WIN32)
+		HANDLE fileHandle;
+		HANDLE mappingHandle;
+#endif
+
+		// Copy constructor is inaccessible for this class.
+		MappedFile(const MappedFile&);
+
+		// Assignment operator is inaccessible for this class.
+		MappedFile& operator=(const MappedFile&);
+	public:
+		/**
+			@brief Initializes a new instance of the MappedFile class
+				without any file.
+		*/
+		MappedFile();
+
+		/**
+			@brief Initializes a new instance of the MappedFile class
+				and maps the specified file.
+
+			@sa IsOpen().
+		*/
+		MappedFile(const char* filePath);
+
+		/**
+			@brief Initializes a new instance of the MappedFile class
+				and maps the specified file.
+
+			@sa IsOpen().
+		*/
+		MappedFile(const std::string& filePath);
+
+		/**
+			@brief Destructor.
+		*/
+		~MappedFile();
+
+		/**
+			@brief Unmaps the current file and maps the specified file.
+
+			@return True if the file was mapped successfully.
+		*/
+		bool Open(const char* filePath);
+
+		/**
+			@brief Unmaps the current file and maps the specified file.
+
+			@return True if the file was mapped successfully.
+		*/
+		bool Open(const std::string& filePath);
+
+		/**
+			@brief Unmaps the file.
+		*/
+		void Close();
+
+		/**
+			@brief Gets a value indicating whether the file is mapped.
+
+			Empty file is treated as mapped, but without any data.
+		*/
+		bool IsOpen() const;
+
+		/**
+			@brief Gets the pointer to the first byte of the file.
+
+			@return Pointer to the first byte or @c nullptr
+				if the file is not mapped or empty.
+		*/
+		const char* GetData() const;
+
+		/**
+			@brief Gets the size of the file in bytes.
+		*/
+		std::size_t GetSize() const;
+	};
+
+	/**
+		@brief File descriptor of the source.
+
+		Descriptor is wrapped by this class, so @c NULL or 0 passed
+		to Inspector constructor or Reset method isn't taken
+		for the standard input.
+
+		@code{.cpp}
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(
+            Xml::FileDescriptor(STDIN_FILENO));
+		@endcode
+	*/
+	class FileDescriptor
+	{
+	private:
+		int descriptor;
+	public:
+		/**
+			@brief Wraps the file descriptor.
+
+			@param fd Descriptor of the file, pipe or socket opened for reading.
+		*/
+		explicit FileDescriptor(int fd);
+
+		/**
+			@brief Gets the file descriptor.
+		*/
+		int Get() const;
+	};
+
 	/// @cond DETAILS
 	namespace Details
 	{
@@ -381,6 +653,93 @@ namespace Xml
 		template <typename TInputIterator>
 		Bom ReadBom(TInputIterator& first, TInputIterator& last);
 
+		enum class Declaration
+		{
+			// Not enough bytes to decide.
+			Unknown,
+			// There is no XML declaration or it has no encoding declaration.
+			NoEncoding,
+			// XML declaration with the encoding declaration.
+			Encoding
+		};
+
+		// Character sets of the encoding declaration.
+		enum class Charset : unsigned char
+		{
+			Unknown,
+			Utf8,
+			Utf16,
+			Utf16BE,
+			Utf16LE,
+			Utf32,
+			Utf32BE,
+			Utf32LE,
+			ISO_8859_1,
+			ISO_8859_2,
+			ISO_8859_3,
+			ISO_8859_4,
+			ISO_8859_5,
+			ISO_8859_6,
+			ISO_8859_7,
+			ISO_8859_8,
+			ISO_8859_9,
+			ISO_8859_10,
+			ISO_8859_13,
+			ISO_8859_14,
+			ISO_8859_15,
+			ISO_8859_16,
+			TIS620,
+			Windows874,
+			Windows1250,
+			Windows1251,
+			Windows1252,
+			Windows1253,
+			Windows1254,
+			Windows1255,
+			Windows1256,
+			Windows1257,
+			Windows1258
+		};
+
+		// FNV-1a hash of the character set name continuing the specified hash.
+		// Bytes are ORed with 0x20, so ASCII letters are case insensitive.
+		constexpr std::uint_least32_t CharsetHash(const char* name,
+			std::uint_least32_t hash = 2166136261u);
+
+		struct CharsetName
+		{
+			constexpr CharsetName(const char* name, Charset value)
+				: Hash(CharsetHash(name)), Name(name), Value(value)
+			{
+
+			}
+
+			std::uint_least32_t Hash;
+			const char* Name;
+			Charset Value;
+		};
+
+		// Checks that the hashes of the names are increasing.
+		constexpr bool IsSortedByHash(const CharsetName* first, const CharsetName* last);
+
+		// Finds the character set by its name or alias registered by IANA.
+		// Names are case insensitive.
+		template <typename TCharacter>
+		Charset FindCharset(const TCharacter* first, const TCharacter* last);
+
+		// Returns the map of the single byte character set or nullptr.
+		const char16_t* CharacterMap(Charset charset);
+
+		// Detects the encoding declaration in the first bytes of a document
+		// without the byte order mark (see Appendix F of the XML recommendation).
+		// Only the ASCII compatible encodings are detected. Documents which
+		// don't start with the ASCII bytes of '<?xml' (UTF-16 without the byte
+		// order mark too) are reported as Declaration::NoEncoding and are read
+		// as UTF-8. Declaration::Unknown is reported if more bytes are needed
+		// or the declaration has a syntax error.
+		Declaration SniffDeclaration(const char* first, const char* last,
+			const char*& encodingFirst, const char*& encodingLast);
+
 		template <
 			typename TInputIterator,
 			typename TCharacterType,
@@ -419,6 +778,337 @@ namespace Xml
 			}
 		};
 
+		// Iterators to the bytes stored contiguously in memory.
+		// Such ranges are parsed directly without any stream buffer.
+		template <typename TInputIterator>
+		struct IsContiguousIterator
+		{
+			typedef typename std::iterator_traits<TInputIterator>::value_type ValueType;
+
+			static const bool value =
+				((std::is_pointer<TInputIterator>::value &&
+					(std::is_same<ValueType, char>::value ||
+					std::is_same<ValueType, signed char>::value ||
+					std::is_same<ValueType, unsigned char>::value)) ||
+				std::is_same<TInputIterator, std::string::iterator>::value ||
+				std::is_same<TInputIterator, std::string::const_iterator>::value ||
+				std::is_same<TInputIterator, std::vector<char>::iterator>::value ||
+				std::is_same<TInputIterator, std::vector<char>::const_iterator>::value ||
+				std::is_same<TInputIterator, std::vector<unsigned char>::iterator>::value ||
+				std::is_same<TInputIterator, std::vector<unsigned char>::const_iterator>::value);
+		};
+
+		// Writes the characters by the WriteCharacters method
+		// if the characters writer provides it.
+		template <typename TCharactersWriter>
+		inline auto WriteCharacters(typename TCharactersWriter::StringType& destination,
+			const char32_t* first, const char32_t* last, int)
+			-> decltype(TCharactersWriter::WriteCharacters(destination, first, last))
+		{
+			TCharactersWriter::WriteCharacters(destination, first, last);
+		}
+
+		template <typename TCharactersWriter>
+		inline void WriteCharacters(typename TCharactersWriter::StringType& destination,
+			const char32_t* first, const char32_t* last, long)
+		{
+			for ( ; first != last; ++first)
+				TCharactersWriter::WriteCharacter(destination, *first);
+		}
+
+		template <typename TCharactersWriter>
+		inline void WriteCharacters(typename TCharactersWriter::StringType& destination,
+			const char32_t* first, const char32_t* last)
+		{
+			WriteCharacters<TCharactersWriter>(destination, first, last, 0);
+		}
+
+		// Skips the run characters by 4 at a time: tab, line feed and ASCII
+		// characters from 0x20 except the delimiters (the same delimiter can be
+		// passed more than once). Returns the first block with other character,
+		// the rest must be checked one by one.
+		inline const char32_t* SkipRunCharacters(const char32_t* first, const char32_t* last,
+			char32_t firstDelimiter, char32_t secondDelimiter, char32_t thirdDelimiter)
+		{
+#if defined(XML_ENCODING_SSE2)
+			const __m128i space = _mm_set1_epi32(0x1F);
+			const __m128i ascii = _mm_set1_epi32(0x80);
+			const __m128i delimiter1 = _mm_set1_epi32(static_cast<int>(firstDelimiter));
+			const __m128i delimiter2 = _mm_set1_epi32(static_cast<int>(secondDelimiter));
+			const __m128i delimiter3 = _mm_set1_epi32(static_cast<int>(thirdDelimiter));
+			const __m128i tab = _mm_set1_epi32(0x09);
+			const __m128i lineFeed = _mm_set1_epi32(0x0A);
+			while (last - first >= 4)
+			{
+				// Characters are less than 0x110000, so the signed comparison is enough.
+				__m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+				__m128i printable = _mm_and_si128(
+					_mm_cmpgt_epi32(characters, space),
+					_mm_cmplt_epi32(characters, ascii));
+				__m128i delimiter = _mm_or_si128(
+					_mm_or_si128(
+						_mm_cmpeq_epi32(characters, delimiter1),
+						_mm_cmpeq_epi32(characters, delimiter2)),
+					_mm_cmpeq_epi32(characters, delimiter3));
+				__m128i white = _mm_or_si128(
+					_mm_cmpeq_epi32(characters, tab),
+					_mm_cmpeq_epi32(characters, lineFeed));
+				__m128i text = _mm_or_si128(_mm_andnot_si128(delimiter, printable), white);
+				if (_mm_movemask_epi8(text) != 0xFFFF)
+					break;
+				first += 4;
+			}
+#else
+			(void)last;
+			(void)firstDelimiter;
+			(void)secondDelimiter;
+			(void)thirdDelimiter;
+#endif
+			return first;
+		}
+
+		// Skips the attribute value characters by 4 at a time: ASCII characters
+		// from 0x20 except quotes, '<' and '&'. White spaces other than space
+		// are normalized, so they aren't skipped. Returns the first block with
+		// other character, the rest must be checked one by one.
+		inline const char32_t* SkipAttributeValueCharacters(const char32_t* first, const char32_t* last)
+		{
+#if defined(XML_ENCODING_SSE2)
+			const __m128i space = _mm_set1_epi32(0x1F);
+			const __m128i ascii = _mm_set1_epi32(0x80);
+			const __m128i quote = _mm_set1_epi32(0x22);
+			const __m128i apostrophe = _mm_set1_epi32(0x27);
+			const __m128i lessThan = _mm_set1_epi32(0x3C);
+			const __m128i ampersand = _mm_set1_epi32(0x26);
+			while (last - first >= 4)
+			{
+				// Characters are less than 0x110000, so the signed comparison is enough.
+				__m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+				__m128i printable = _mm_and_si128(
+					_mm_cmpgt_epi32(characters, space),
+					_mm_cmplt_epi32(characters, ascii));
+				__m128i delimiter = _mm_or_si128(
+					_mm_or_si128(
+						_mm_cmpeq_epi32(characters, quote),
+						_mm_cmpeq_epi32(characters, apostrophe)),
+					_mm_or_si128(
+						_mm_cmpeq_epi32(characters, lessThan),
+						_mm_cmpeq_epi32(characters, ampersand)));
+				if (_mm_movemask_epi8(_mm_andnot_si128(delimiter, printable)) != 0xFFFF)
+					break;
+				first += 4;
+			}
+#else
+			(void)last;
+#endif
+			return first;
+		}
+
+		// Skips the UTF-8 encoded characters by 16 bytes at a time: bytes
+		// above 0x7F and ASCII characters from 0x20 except '"', '&', '\'', '-',
+		// '<', '?' and ']', which end some of the runs. Skips at most limit
+		// characters and adds the number of skipped characters to count.
+		// Returns the first block with other byte, the rest must be
+		// checked one by one.
+		inline const unsigned char* SkipRunBytes(const unsigned char* first,
+			const unsigned char* last, std::size_t limit, std::size_t& count)
+		{
+#if defined(XML_ENCODING_SSE2)
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i space = _mm_set1_epi8(0x20);
+			const __m128i quote = _mm_set1_epi8(0x22);
+			const __m128i ampersand = _mm_set1_epi8(0x26);
+			const __m128i apostrophe = _mm_set1_epi8(0x27);
+			const __m128i minus = _mm_set1_epi8(0x2D);
+			const __m128i lessThan = _mm_set1_epi8(0x3C);
+			const __m128i question = _mm_set1_epi8(0x3F);
+			const __m128i bracket = _mm_set1_epi8(0x5D);
+			const __m128i continuationMask = _mm_set1_epi8(static_cast<char>(0xC0));
+			const __m128i continuation = _mm_set1_epi8(static_cast<char>(0x80));
+			// Every byte could be a character, so the block never
+			// ends after the last character which is allowed to skip.
+			while (last - first >= 16 && limit - count >= 16)
+			{
+				__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+				// Signed comparison, so the bytes above 0x7F are less than 0.
+				__m128i other = _mm_or_si128(
+					_mm_andnot_si128(_mm_cmplt_epi8(bytes, zero), _mm_cmplt_epi8(bytes, space)),
+					_mm_or_si128(
+						_mm_or_si128(
+							_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, ampersand)),
+							_mm_or_si128(_mm_cmpeq_epi8(bytes, apostrophe), _mm_cmpeq_epi8(bytes, minus))),
+						_mm_or_si128(
+							_mm_or_si128(_mm_cmpeq_epi8(bytes, lessThan), _mm_cmpeq_epi8(bytes, question)),
+							_mm_cmpeq_epi8(bytes, bracket))));
+				if (_mm_movemask_epi8(other) != 0)
+					break;
+
+				// Continuation bytes don't start a character.
+				unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+					_mm_cmpeq_epi8(_mm_and_si128(bytes, continuationMask), continuation)));
+				std::size_t characters = 16;
+				for ( ; mask != 0; mask &= mask - 1)
+					--characters;
+				count += characters;
+				first += 16;
+			}
+#else
+			(void)last;
+			(void)limit;
+			(void)count;
+#endif
+			return first;
+		}
+
+		// Stream buffer over the bytes in memory. Characters readers
+		// extract bytes directly from the get area without any virtual call.
+		class MemoryBuf : public std::streambuf
+		{
+		public:
+			MemoryBuf()
+				: std::streambuf()
+			{
+			
+			}
+
+			void Reset(const char* first, const char* last)
+			{
+				setg(const_cast<char*>(first),
+					const_cast<char*>(first),
+					const_cast<char*>(last));
+			}
+
+			const char* GetPosition() const
+			{
+				return gptr();
+			}
+		};
+
+		// Bytes of the document parsed in the push mode.
+		// Besides storing them it scans the code units for the end
+		// of the last complete token, so the parser never reaches
+		// the end of fed bytes in the middle of a token.
+		class FeedBuffer
+		{
+		private:
+			// Scanner states.
+			static const int ScanContent = 0;       // Text or space between tokens.
+			static const int ScanTagOpen = 1;       // <
+			static const int ScanExclamation = 2;   // <!
+			static const int ScanCommentOpen = 3;   // <!-
+			static const int ScanComment = 4;       // <!--
+			static const int ScanCDATA = 5;         // <![
+			static const int ScanQuestion = 6;      // <?
+			static const int ScanTag = 7;           // <a or </a
+			static const int ScanQuoted = 8;        // <a b="
+			static const int ScanDOCTYPE = 9;       // <!D
+			static const int ScanSubset = 10;       // <!DOCTYPE a [
+			static const int ScanSubsetClose = 11;  // <!DOCTYPE a [ ]
+
+			std::string bytes;
+			std::size_t start; // First byte after BOM.
+			std::size_t scanned;
+			std::size_t limit; // End of the last complete token.
+			std::size_t unitSize; // 0 until BOM is known.
+			bool bigEndian;
+			int state;
+			int matched; // Number of matched characters of the terminator.
+			char32_t quote;
+			bool text;
+			// The last code unit before the limit is '<' of the incomplete token.
+			bool tagOpened;
+			bool finished;
+
+			char32_t GetUnit(std::size_t position) const;
+
+			void Scan();
+		public:
+			FeedBuffer();
+
+			void Clear();
+
+			void Append(const char* data, std::size_t size);
+
+			// Marks the end of the document, so all the bytes are available.
+			void Finish();
+
+			// Removes the bytes consumed by the parser.
+			void Erase(std::size_t count);
+
+			bool IsFinished() const;
+
+			const char* GetData() const;
+
+			std::size_t GetSize() const;
+
+			std::size_t GetStart() const;
+
+			std::size_t GetLimit() const;
+
+			// Returns the size of the code unit or 0 until BOM is known.
+			std::size_t GetUnitSize() const;
+
+			bool IsTagOpened() const;
+		};
+
+		// Stream buffer reading the file descriptor (for example a pipe
+		// or a socket) into a large buffer.
+		class FdBuf : public std::streambuf
+		{
+		private:
+			int fd;
+			std::unique_ptr<char[]> buffer;
+			std::size_t bufferSize;
+			bool ended;
+
+			// Copy constructor is inaccessible for this class.
+			FdBuf(const FdBuf&);
+
+			// Assignment operator is inaccessible for this class.
+			FdBuf& operator=(const FdBuf&);
+		protected:
+			virtual int_type underflow();
+		public:
+			FdBuf();
+
+			// Descriptor isn't closed by this class.
+			void Open(int fileDescriptor, std::size_t size);
+
+			void Close();
+
+			bool IsOpen() const;
+
+			const char* GetFirst() const;
+
+			const char* GetLast() const;
+
+			void Consume(std::size_t count);
+
+			// Reads until at least the specified number of bytes
+			// is buffered or the end of the data is reached.
+			// Returns false if the descriptor can't be read.
+			bool Refill(std::size_t minimum);
+		};
+
+		// UTF-8 characters reader decoding directly from the buffer of FdBuf.
+		// Position is shared with the buffer, so a stream over the same
+		// buffer continues where this reader stopped.
+		class Utf8FdReader : public Encoding::Utf8ReaderBase
+		{
+		private:
+			FdBuf* buf;
+
+			// Buffers the bytes of the next character if possible.
+			bool Prepare();
+		public:
+			Utf8FdReader(FdBuf* fdBuf);
+
+			virtual int ReadCharacter(char32_t& result);
+
+			virtual std::size_t ReadCharacters(char32_t* destination,
+				std::size_t capacity, int& result);
+		};
+
 		template <typename TStringType>
 		class NamespaceDeclaration
 		{
@@ -431,6 +1121,51 @@ namespace Xml
 			SizeType TagIndex; // Counting from 0.
 		};
 
+		// Position in the characters with normalized line ends
+		// (CR LF and CR are LF), computed from the decoded characters.
+		class PositionCheckpoint
+		{
+		public:
+			std::uint_least64_t Row;
+			std::uint_least64_t Column;
+			bool AfterLineFeed; // Previous normalized character is LF.
+			bool AfterCarriageReturn; // Previous character is CR, so LF is skipped.
+
+			PositionCheckpoint()
+				: Row(1),
+				Column(0),
+				AfterLineFeed(false),
+				AfterCarriageReturn(false)
+			{
+
+			}
+
+			void Advance(const char32_t* first, const char32_t* last)
+			{
+				for ( ; first != last; ++first)
+				{
+					if (AfterCarriageReturn)
+					{
+						AfterCarriageReturn = false;
+						if (*first == 0x0A)
+							continue;
+					}
+
+					if (AfterLineFeed)
+					{
+						++Row;
+						Column = 1;
+					}
+					else
+					{
+						++Column;
+					}
+					AfterLineFeed = (*first == 0x0A || *first == 0x0D);
+					AfterCarriageReturn = (*first == 0x0D);
+				}
+			}
+		};
+
 		template <typename TStringType>
 		class UnclosedTag
 		{
@@ -445,809 +1180,2572 @@ namespace Xml
 			SizeType Row;
 			SizeType Column;
 		};
-	}
-	/// @endcond
 
-	/**
-		@brief Streaming XML parser class.
+		// Stream buffer over the ring of byte blocks. The producer thread
+		// fills free blocks from the source, while the consumer (parser)
+		// reads the previous ones. Indices of the ring are atomic, so the
+		// mutex is locked only to sleep when the ring is empty or full.
+		class ReadAheadBuf : public std::streambuf
+		{
+		private:
+			std::ifstream file;
+			std::istream* source;
+			std::size_t blockSize;
+			std::size_t ringDepth;
+			std::unique_ptr<char[]> blocks;
+			std::unique_ptr<std::size_t[]> sizes;
+			std::atomic<std::size_t> produced; // Number of filled blocks.
+			std::atomic<std::size_t> consumed; // Number of released blocks.
+			std::atomic<bool> finished;
+			std::atomic<bool> failed;
+			std::atomic<bool> stopping;
+			std::atomic<bool> producerWaiting;
+			std::atomic<bool> consumerWaiting;
+			std::mutex mutex;
+			std::condition_variable dataReady;
+			std::condition_variable spaceReady;
+			std::atomic<std::int_least64_t> readNanoseconds;
+			std::int_least64_t waitNanoseconds;
+			bool holding; // Get area points to the block at consumed index.
+			std::thread producer;
+
+			// Copy constructor is inaccessible for this class.
+			ReadAheadBuf(const ReadAheadBuf&);
+
+			// Assignment operator is inaccessible for this class.
+			ReadAheadBuf& operator=(const ReadAheadBuf&);
+
+			// Fills the block from the source.
+			// Returns false at the end of the source or error.
+			bool ReadBlock(std::size_t slot);
+
+			void Produce();
+		protected:
+			virtual int_type underflow();
+		public:
+			ReadAheadBuf(std::size_t blockSize, std::size_t ringDepth);
 
-		Example:
-		@code{.cpp}
-        #include "XmlInspector.hpp"
-        #include &lt;iostream&gt;
-        #include &lt;cstdlib&gt
+			virtual ~ReadAheadBuf();
 
-        int main()
-        {
-            Xml::Inspector<Xml::Encoding::Utf8Writer> inspector("test.xml");
+			bool Open(const char* filePath);
 
-            while (inspector.Inspect())
-            {
-                switch (inspector.GetInspected())
-                {
-                    case Xml::Inspected::StartTag:
-                        std::cout << "[StartTag] name(" << inspector.GetName() <<
-                            "), value(" << inspector.GetValue() << ").\n";
-                        break;
-                    case Xml::Inspected::EndTag:
-                        std::cout << "[EndTag] name(" << inspector.GetName() <<
-                            "), value(" << inspector.GetValue() << ").\n";
-                        break;
-                    case Xml::Inspected::EmptyElementTag:
-                        std::cout << "[EmptyElementTag] name(" << inspector.GetName() <<
-                            "), value(" << inspector.GetValue() << ").\n";
-                        break;
-                    case Xml::Inspected::Text:
-                        std::cout << "[Text] value(" << inspector.GetValue() << ").";
-                        break;
-                    case Xml::Inspected::Whitespace:
-                        // Ignore white spaces between markup.
-                        break;
-                    default:
-                        std::cout << "[...] name(" << inspector.GetName() <<
-                            "), value(" << inspector.GetValue() << ").\n";
-                        break;
-                }
-            }
+			// Starts the producer thread. If the thread cannot
+			// be started, blocks are read on demand.
+			void Start(std::istream* inputStream);
 
-            if (inspector.GetErrorCode() != Xml::ErrorCode::None)
-            {
-                std::cout << "Error: " << inspector.GetErrorMessage() <<
-                " At row: " << inspector.GetRow() <<
-				", column: " << inspector.GetColumn() << "\n";
-            }
+			bool IsOpen() const;
 
-            return EXIT_SUCCESS;
-        }
-		@endcode
+			std::size_t GetBlockSize() const;
 
-		@tparam TCharactersWriter Writer with a specified encoding. You don't need to care how the XML file is encoded.
-			You can choose how you want to store the strings between Xml::Encoding::Utf8Writer, Xml::Encoding::Utf16Writer
-			and Xml::Encoding::Utf32Writer class from CharactersWriter.hpp file. They respectively store the strings in
-			@c std::string, @c std::u16string and @c std::u32string. You can also write your own fancy way of
-			storing strings. For example you may want to use @c std::wstring and even other than Unicode encoding.
-	*/
-	template <typename TCharactersWriter>
-	class Inspector
-	{
-	public:
-		/**
-			@brief Alias of the characters writer type that is used to write strings.
-		*/
-		typedef TCharactersWriter CharactersWriterType;
+			std::size_t GetRingDepth() const;
 
-		/**
-			@brief String type provided by the CharactersWriterType.
-		*/
-		typedef typename TCharactersWriter::StringType StringType;
+			std::chrono::nanoseconds GetReadTime() const;
 
-		/**
-			@brief Attribute type.
-		*/
-		typedef InspectedAttribute<StringType> AttributeType;
+			std::chrono::nanoseconds GetWaitTime() const;
+		};
 
-		/**
-			@brief Unsigned integer type definition for determining location in the XML document.
-				This type should be enough to store any file size or memory buffer size.
-		*/
-		typedef std::uint_least64_t SizeType;
-	private:
-		typedef typename StringType::size_type StringSizeType;
-		typedef Details::UnclosedTag<StringType> UnclosedTagType;
-		typedef Details::NamespaceDeclaration<StringType> NamespaceDeclarationType;
-		typedef typename std::deque<AttributeType>::size_type AttributesSizeType;
-		typedef typename std::deque<UnclosedTagType>::size_type UnclosedTagsSizeType;
-		typedef typename std::deque<NamespaceDeclarationType>::size_type NamespacesSizeType;
+#if defined(XML_INSPECTOR_IO_URING)
+		// Minimal io_uring submission and completion queues
+		// used without any library, only by system calls.
+		class IoUring
+		{
+		private:
+			int ringDescriptor;
+			void* submissionRing;
+			std::size_t submissionRingSize;
+			void* completionRing;
+			std::size_t completionRingSize;
+			io_uring_sqe* entries;
+			std::size_t entriesSize;
+			unsigned* submissionTail;
+			unsigned* submissionMask;
+			unsigned* submissionArray;
+			unsigned* completionHead;
+			unsigned* completionTail;
+			unsigned* completionMask;
+			io_uring_cqe* completions;
+			unsigned toSubmit;
+
+			// Copy constructor is inaccessible for this class.
+			IoUring(const IoUring&);
+
+			// Assignment operator is inaccessible for this class.
+			IoUring& operator=(const IoUring&);
+		public:
+			IoUring();
 
-		static const unsigned char Space = 0x20;                  // ' '
-		static const unsigned char LineFeed = 0x0A;               // '\n'
-		static const unsigned char CarriageReturn = 0x0D;         // '\r'
-		static const unsigned char LessThan = 0x3C;               // '<'
-		static const unsigned char GreaterThan = 0x3E;            // '>'
-		static const unsigned char Equals = 0x3D;                 // '='
-		static const unsigned char SingleQuote = 0x27;            // '\''
-		static const unsigned char DoubleQuote = 0x22;            // '\"'
-		static const unsigned char Slash = 0x2F;                  // '/'
-		static const unsigned char Question = 0x3F;               // '?'
-		static const unsigned char Exclamation = 0x21;            // '!'
-		static const unsigned char Minus = 0x2D;                  // '-'
-		static const unsigned char Ampersand = 0x26;              // '&'
-		static const unsigned char Hash = 0x23;                   // '#'
-		static const unsigned char X = 0x78;                      // 'x'
-		static const unsigned char Colon = 0x3A;                  // ':'
-		static const unsigned char Semicolon = 0x3B;              // ';'
-		static const unsigned char LeftSquareBracket = 0x5B;      // '['
-		static const unsigned char RightSquareBracket = 0x5D;     // ']'
-		static const unsigned char Dot = 0x2E;                    // '.'
-		static const unsigned char LowerXml[3];                   // "xml"
-		static const unsigned char UpperXml[3];                   // "XML"
-		static const unsigned char Xmlns[5];                      // "xmlns"
-		static const unsigned char XmlUri[36];                    // "http://www.w3.org/XML/1998/namespace"
-		static const unsigned char XmlnsUri[29];                  // "http://www.w3.org/2000/xmlns/"
-		static const unsigned char XmlDeclarationVersion[7];      // "version"
-		static const unsigned char XmlDeclarationEncoding[8];     // "encoding"
-		static const unsigned char XmlDeclarationStandalone[10];  // "standalone"
-		static const unsigned char Yes[3];                        // "yes"
-		static const unsigned char No[2];                         // "no"
-		static const unsigned char CDATA[5];                      // "CDATA"
-		static const unsigned char DOCTYPE[7];                    // "DOCTYPE"
-		static const unsigned char LtEntityName[2];               // "lt"
-		static const unsigned char GtEntityName[2];               // "gt"
-		static const unsigned char AmpEntityName[3];              // "amp"
-		static const unsigned char AposEntityName[4];             // "apos"
-		static const unsigned char QuotEntityName[4];             // "quot"
+			~IoUring();
 
-		// Use only for 1-byte characters!
-		static const unsigned char ToLower[256];
+			// Returns false if io_uring is not available.
+			bool Open(unsigned entriesCount);
 
-		// Source types.
-		static const int SourceNone = 0; // Inspector() constructor.
-		static const int SourcePath = 1; // Inspector(const char*) or Inspector(const std::string&) constructor.
-		static const int SourceStream = 2; // Inspector(std::istream*) constructor.
-		static const int SourceIterators = 3; // Inspector(InputIterator first, InputIterator last) constructor.
-		static const int SourceReader = 4; // Inspector(Encoding::CharactersReader*) constructor.
-		
-		static const StringSizeType NameReserve = 31;
-		static const StringSizeType ValueReserve = 63;
-		static const StringSizeType LocalNameReserve = 15;
-		static const StringSizeType PrefixReserve = 15;
-		static const StringSizeType NamespaceUriReserve = 63;
+			void Close();
 
-		SizeType row;
-		SizeType column;
-		SizeType currentRow;
-		SizeType currentColumn;
-		Inspected node;
-		ErrorCode err;
-		const char* errMsg;
-		std::string fPath;
-		std::ifstream fileStream;
-		std::istream* inputStreamPtr;
-		Encoding::CharactersReader* reader;
-		int sourceType;
-		bool afterBom;
-		Details::Bom bom;
-		StringType name;
-		StringType value;
-		StringType localName;
-		StringType prefix;
-		StringType namespaceUri;
-		StringType entityName;
-		std::u32string comparingName;
-		SizeType entityNameCharCount;
-		char32_t currentCharacter;
-		char32_t bufferedCharacter;
-		bool foundElement;
-		bool foundDOCTYPE;
-		bool eof;
-		StringType lowerXmlString;
-		StringType xmlnsString;
-		StringType xmlUriString;
-		StringType xmlnsUriString;
-		// Instead of removing objects from collection I decrement size.
-		// It's a fake size, but I don't want to
-		// allocate strings in objects after each element node and each XML document.
-		// To clear these collections you can call Inspector::Clear method.
-		std::deque<AttributeType> attributes;
-		AttributesSizeType attributesSize;
-		std::deque<UnclosedTagType> unclosedTags;
-		UnclosedTagsSizeType unclosedTagsSize;
-		std::deque<NamespaceDeclarationType> namespaces;
-		NamespacesSizeType namespacesSize;
+			bool IsOpen() const;
 
-		// We don't need to check carriage return
-		// while NextCharBad method removes them for us.
-		// That's why I use this method instead of
-		// Xml::Encoding::CharactersReader::IsWhiteSpace.
-		static bool IsWhiteSpace(char32_t codePoint);
+			// Queues the read of the file at the specified offset.
+			void PrepareRead(int fileDescriptor, const iovec* vector,
+				std::uint_least64_t offset, std::uint_least64_t userData);
 
-		void SetError(ErrorCode errorCode);
+			// Passes the queued reads to the kernel.
+			bool Submit();
 
-		void SavePosition();
+			// Submits the queued reads and waits for the next completion.
+			bool WaitCompletion(std::uint_least64_t& userData, int& result);
+		};
+#endif
 
-		// Extracts the next character and sets the error flag
-		// if eof (only if insideTag flag), invalid character or stream error.
-		// Returns true if error or eof (insideTag == false) happened.
-		bool NextCharBad(bool insideTag);
+#if !defined(_WIN32)
+		// Stream buffer over the file blocks, which are read by several
+		// requests in flight (io_uring) or one by one by pread function.
+		class UringFileBuf : public std::streambuf
+		{
+		private:
+			int fileDescriptor;
+			std::uint_least64_t blocksCount;
+			std::uint_least64_t fileSize;
+			std::size_t blockSize;
+			std::size_t queueDepth;
+			std::unique_ptr<char[]> blocks;
+			std::unique_ptr<std::size_t[]> filled; // Bytes read into the slot.
+			std::uint_least64_t current; // Block in the get area.
+			bool holding;
+			bool failed;
+#if defined(XML_INSPECTOR_IO_URING)
+			IoUring ring;
+			std::unique_ptr<iovec[]> vectors;
+			std::unique_ptr<bool[]> done;
+			std::size_t inFlight;
+
+			// Queues the read of the block into its slot. If the first
+			// flag is false, only the rest of a short read is requested.
+			void SubmitBlock(std::uint_least64_t block, bool first);
+
+			// Waits for the completions until the block is read.
+			bool WaitBlock(std::uint_least64_t block);
+#endif
 
-		void ParseBom();
+			// Copy constructor is inaccessible for this class.
+			UringFileBuf(const UringFileBuf&);
 
-		bool ParseElement();
+			// Assignment operator is inaccessible for this class.
+			UringFileBuf& operator=(const UringFileBuf&);
 
-		bool ParseAttributes();
+			std::size_t GetBlockLength(std::uint_least64_t block) const;
 
-		bool ParseEndTag();
+			// Reads the block by pread function.
+			bool ReadBlock(std::uint_least64_t block);
+		protected:
+			virtual int_type underflow();
+		public:
+			UringFileBuf(std::size_t blockSize, std::size_t queueDepth);
 
-		bool ParseText();
+			virtual ~UringFileBuf();
 
-		bool ParseQuestion();
+			bool Open(const char* filePath, bool useUring);
 
-		bool ParseXmlDeclaration();
+			bool IsOpen() const;
 
-		bool ParseProcessingInstruction();
+			bool IsUringUsed() const;
 
-		bool ParseExclamation();
+			std::size_t GetBlockSize() const;
 
-		bool ParseComment();
+			std::size_t GetQueueDepth() const;
+		};
 
-		bool ParseCDATA();
+		// Stream buffer reading the regular file with O_DIRECT flag into
+		// the aligned buffer, so the file doesn't pass through the page cache.
+		class DirectFileBuf : public std::streambuf
+		{
+		private:
+			// Alignment of the buffer, file offsets and sizes of the reads.
+			static const std::size_t Alignment = 4096;
 
-		bool ParseDOCTYPE();
+			int fileDescriptor;
+			std::uint_least64_t fileSize;
+			std::uint_least64_t offset; // Offset of the next block.
+			std::size_t blockSize;
+			char* buffer;
+			bool direct;
+			bool failed;
 
-		void PrepareNode();
+			// Copy constructor is inaccessible for this class.
+			DirectFileBuf(const DirectFileBuf&);
 
-		bool NamespacesStuff();
+			// Assignment operator is inaccessible for this class.
+			DirectFileBuf& operator=(const DirectFileBuf&);
 
-		// Returns false if error.
-		bool ParseCharacterReference(char32_t& result, bool insideTag);
+			// Reads the next block. Returns the number of bytes or -1 if error.
+			std::ptrdiff_t ReadBlock();
 
-		// Returns 1 if predefined entity, 0 if unknown entity, -1 if error.
-		int ParseEntityReference(bool insideTag);
+			// Turns off the direct I/O after the file system refused it.
+			bool DisableDirect();
+		protected:
+			virtual int_type underflow();
+		public:
+			DirectFileBuf(std::size_t blockSize);
 
-		bool AttributeUniqueness();
+			virtual ~DirectFileBuf();
 
-		bool ResolveEncoding(const AttributeType& encoding);
+			bool Open(const char* filePath, bool useDirect);
 
-		bool IsUtf8Charset();
+			bool IsOpen() const;
 
-		bool IsUtf16Charset();
+			bool IsDirect() const;
 
-		bool IsUtf16BECharset();
+			std::size_t GetBlockSize() const;
+		};
+#endif
 
-		bool IsUtf16LECharset();
+#if defined(XML_INSPECTOR_ZLIB)
+		// Stream buffer inflating gzip or zlib data from another stream
+		// buffer. Concatenated gzip members are decompressed one by one.
+		class GzipBuf : public std::streambuf
+		{
+		private:
+			static const std::size_t InputSize = 64 * 1024;
+			static const std::size_t OutputSize = 64 * 1024;
 
-		bool IsUtf32Charset();
+			std::streambuf* source;
+			z_stream inflater;
+			bool initialized;
+			bool memberEnd; // Inflater is between members.
+			bool failed;
+			std::unique_ptr<char[]> input;
+			std::unique_ptr<char[]> output;
 
-		bool IsUtf32BECharset();
+			// Copy constructor is inaccessible for this class.
+			GzipBuf(const GzipBuf&);
 
-		bool IsUtf32LECharset();
+			// Assignment operator is inaccessible for this class.
+			GzipBuf& operator=(const GzipBuf&);
+		protected:
+			virtual int_type underflow();
+		public:
+			GzipBuf();
 
-		bool IsISO_8859_1_Charset();
+			virtual ~GzipBuf();
 
-		bool IsISO_8859_2_Charset();
+			// Returns false if the inflater cannot be initialized.
+			bool Open(std::streambuf* compressed);
 
-		bool IsISO_8859_3_Charset();
+			void Close();
 
-		bool IsISO_8859_4_Charset();
+			bool IsOpen() const;
+		};
 
-		bool IsISO_8859_5_Charset();
+		// Stream buffer which serves the saved bytes before the bytes
+		// of another stream buffer.
+		class PrefixBuf : public std::streambuf
+		{
+		private:
+			static const std::size_t BufferSize = 64 * 1024;
 
-		bool IsISO_8859_6_Charset();
+			std::streambuf* source;
+			std::vector<char> prefix;
+			std::unique_ptr<char[]> buffer;
 
-		bool IsISO_8859_7_Charset();
+			// Copy constructor is inaccessible for this class.
+			PrefixBuf(const PrefixBuf&);
 
-		bool IsISO_8859_8_Charset();
+			// Assignment operator is inaccessible for this class.
+			PrefixBuf& operator=(const PrefixBuf&);
+		protected:
+			virtual int_type underflow();
+		public:
+			PrefixBuf();
 
-		bool IsISO_8859_9_Charset();
+			void Reset(const char* first, const char* last, std::streambuf* next);
+		};
 
-		bool IsISO_8859_10_Charset();
+		// Stream buffer inflating BGZF data (gzip members with the size of
+		// the member in the extra field) on the worker threads. Members are
+		// read by the consumer, inflated concurrently and served in order.
+		// Data which is not BGZF is inflated sequentially.
+		class ParallelGzipBuf : public std::streambuf
+		{
+		private:
+			// States of the job.
+			static const int JobFree = 0;
+			static const int JobQueued = 1;
+			static const int JobRunning = 2;
+			static const int JobDone = 3;
+			static const int JobFailed = 4;
+
+			// Results of reading the member.
+			static const int MemberRead = 0;
+			static const int MemberEnd = 1;
+			static const int MemberOther = 2;
+			static const int MemberTruncated = 3;
+
+			// Size of BGZF member header with "BC" extra subfield.
+			static const std::size_t HeaderSize = 18;
+
+			static const std::size_t SequentialSize = 64 * 1024;
+
+			struct Job
+			{
+				std::vector<char> input;
+				std::vector<char> output;
+				int state;
+			};
+
+			std::streambuf* source;
+			std::size_t threadsCount;
+			std::size_t queueDepth;
+			std::unique_ptr<Job[]> jobs;
+			std::size_t next; // Number of the job to consume.
+			std::size_t queued; // Number of created jobs.
+			bool sourceEnd;
+			bool sourceFailed;
+			bool failed;
+			bool holding;
+			bool sequentialPending;
+			bool sequential;
+			char header[HeaderSize];
+			std::size_t headerSize;
+			std::deque<std::size_t> queue;
+			std::mutex mutex;
+			std::condition_variable jobReady;
+			std::condition_variable jobDone;
+			bool stopping;
+			std::vector<std::thread> workers;
+			z_stream inflater;
+			bool inflaterInitialized;
+			PrefixBuf prefix;
+			GzipBuf gzip;
+			std::unique_ptr<char[]> sequentialBuffer;
+
+			// Copy constructor is inaccessible for this class.
+			ParallelGzipBuf(const ParallelGzipBuf&);
+
+			// Assignment operator is inaccessible for this class.
+			ParallelGzipBuf& operator=(const ParallelGzipBuf&);
+
+			int ReadMember(Job& job);
+
+			// Reads members into free jobs and queues them for the workers.
+			void Fill();
+
+			void StartWorkers();
+
+			void Work();
+
+			static bool Inflate(z_stream& stream, Job& job);
+		protected:
+			virtual int_type underflow();
+		public:
+			ParallelGzipBuf(std::size_t threadsCount, std::size_t queueDepth);
 
-		bool IsISO_8859_13_Charset();
+			virtual ~ParallelGzipBuf();
 
-		bool IsISO_8859_14_Charset();
+			void Open(std::streambuf* compressed);
 
-		bool IsISO_8859_15_Charset();
+			bool IsOpen() const;
 
-		bool IsISO_8859_16_Charset();
+			std::size_t GetThreadsCount() const;
+		};
+#endif
+	}
+	/// @endcond
 
-		bool IsTIS620Charset();
+	/**
+		@brief Input stream which reads the source ahead on a background thread.
 
-		bool IsWindows874Charset();
+		The producer thread fills a ring of large byte blocks from the file
+		or from another stream, while the parser decodes the previous blocks,
+		so the latency of storage is hidden behind parsing. Pass the stream
+		to the Xml::Inspector::Inspector(std::istream*) constructor.
 
-		bool IsWindows1250Charset();
+		Example:
+		@code{.cpp}
+        Xml::ReadAheadStream stream("catalog.xml", 4 << 20, 8);
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+        while (inspector.Inspect())
+        {
+            // ...
+        }
+        // Time when the parser waited for the storage.
+        std::chrono::nanoseconds ioWait = stream.GetWaitTime();
+		@endcode
 
-		bool IsWindows1251Charset();
+		Errors of the source are reported by the Inspector as
+		ErrorCode::StreamError.
 
-		bool IsWindows1252Charset();
+		@warning Stream must live longer than the Xml::Inspector
+			object that parses it. The source stream passed to the
+			constructor cannot be used by other code until this
+			stream is destroyed.
+	*/
+	class ReadAheadStream : public std::istream
+	{
+	private:
+		Details::ReadAheadBuf buf;
 
-		bool IsWindows1253Charset();
+		// Copy constructor is inaccessible for this class.
+		ReadAheadStream(const ReadAheadStream&);
 
-		bool IsWindows1254Charset();
+		// Assignment operator is inaccessible for this class.
+		ReadAheadStream& operator=(const ReadAheadStream&);
+	public:
+		/**
+			@brief Default size of the block in bytes.
+		*/
+		static const std::size_t DefaultBlockSize = 1 << 20;
 
-		bool IsWindows1255Charset();
+		/**
+			@brief Default number of blocks in the ring.
+		*/
+		static const std::size_t DefaultRingDepth = 4;
 
-		bool IsWindows1256Charset();
+		/**
+			@brief Initializes a new instance of the ReadAheadStream class
+				and starts reading the specified file.
 
-		bool IsWindows1257Charset();
+			@param filePath Path to the file.
+			@param blockSize Number of bytes read at once.
+			@param ringDepth Number of blocks in the ring (at least 2).
 
-		bool IsWindows1258Charset();
+			@sa IsOpen().
+		*/
+		ReadAheadStream(const char* filePath,
+			std::size_t blockSize = DefaultBlockSize,
+			std::size_t ringDepth = DefaultRingDepth);
 
-		AttributeType& NewAttribute();
+		/**
+			@brief Initializes a new instance of the ReadAheadStream class
+				and starts reading the specified file.
 
-		UnclosedTagType& NewUnclosedTag();
+			@param filePath Path to the file.
+			@param blockSize Number of bytes read at once.
+			@param ringDepth Number of blocks in the ring (at least 2).
 
-		NamespaceDeclarationType& NewNamespace();
+			@sa IsOpen().
+		*/
+		ReadAheadStream(const std::string& filePath,
+			std::size_t blockSize = DefaultBlockSize,
+			std::size_t ringDepth = DefaultRingDepth);
 
-		bool CharsetEqual(const char32_t* charset);
+		/**
+			@brief Initializes a new instance of the ReadAheadStream class
+				and starts reading the specified stream.
 
-		bool CharsetEqual(const unsigned char* charset, std::size_t len);
+			@param inputStream Source stream.
+			@param blockSize Number of bytes read at once.
+			@param ringDepth Number of blocks in the ring (at least 2).
+		*/
+		ReadAheadStream(std::istream* inputStream,
+			std::size_t blockSize = DefaultBlockSize,
+			std::size_t ringDepth = DefaultRingDepth);
 
-		void InitStrings();
+		/**
+			@brief Destructor. Stops the background thread.
+		*/
+		~ReadAheadStream();
 
-		// Copy constructor is inaccessible for this class.
-		Inspector(const Inspector&) { };
+		/**
+			@brief Gets a value indicating whether the source is opened.
+		*/
+		bool IsOpen() const;
 
-		// Assignment operator is inaccessible for this class.
-		Inspector& operator=(const Inspector&) { return *this; };
-	public:
 		/**
-			@brief Initializes a new instance of the Inspector class.
+			@brief Gets the size of the block in bytes.
 		*/
-		Inspector();
+		std::size_t GetBlockSize() const;
 
 		/**
-			@brief Initializes a new instance of the Inspector class
-				with the specified file path.
+			@brief Gets the number of blocks in the ring.
 		*/
-		Inspector(const char* filePath);
+		std::size_t GetRingDepth() const;
 
 		/**
-			@brief Initializes a new instance of the Inspector class
-				with the specified file path.
+			@brief Gets the time spent by the background thread
+				on reading the source.
 		*/
-		Inspector(const std::string& filePath);
+		std::chrono::nanoseconds GetReadTime() const;
 
 		/**
-			@brief Initializes a new instance of the Inspector class
-				with the specified stream.
+			@brief Gets the time spent by the reading thread (parser)
+				on waiting for the next block.
+
+			It's the time of I/O not hidden behind parsing. Parsing time
+			is the rest of the time spent on reading this stream.
 		*/
-		Inspector(std::istream* inputStream);
+		std::chrono::nanoseconds GetWaitTime() const;
+	};
 
-		/**
-			@brief Initializes a new instance of the Inspector class
-				with the specified iterators.
+#if !defined(_WIN32)
+	/**
+		@brief Input stream which reads the file by several large reads in flight.
 
-			@param first,last Input iterators to the initial
-				and final positions in a sequence of bytes. The range used
-				is [first,last), which contains all the bytes
-				between first and last, including the byte pointed
-				by first but not the byte pointed by last.
-		*/
-		template <typename TInputIterator>
-		Inspector(TInputIterator first, TInputIterator last);
+		On Linux the file is read with io_uring: a few blocks are requested
+		from the kernel at once, and each block consumed by the parser is
+		immediately requested again for the next part of the file. If io_uring
+		is not available, blocks are read one by one by @c pread function,
+		still without any intermediate buffer of the standard library.
+		Pass the stream to the Xml::Inspector::Inspector(std::istream*) constructor.
+
+		Example:
+		@code{.cpp}
+        Xml::UringFileStream stream("catalog.xml");
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+        while (inspector.Inspect())
+        {
+            // ...
+        }
+		@endcode
+
+		Read errors are reported by the Inspector as ErrorCode::StreamError.
 
+		@warning Stream must live longer than the Xml::Inspector
+			object that parses it. Available on POSIX systems only.
+	*/
+	class UringFileStream : public std::istream
+	{
+	private:
+		Details::UringFileBuf buf;
+
+		// Copy constructor is inaccessible for this class.
+		UringFileStream(const UringFileStream&);
+
+		// Assignment operator is inaccessible for this class.
+		UringFileStream& operator=(const UringFileStream&);
+	public:
 		/**
-			@brief Initializes a new instance of the Inspector class
-				with the specified characters reader interface.
+			@brief Default size of the block in bytes.
 		*/
-		Inspector(Encoding::CharactersReader* reader);
+		static const std::size_t DefaultBlockSize = 1 << 20;
 
 		/**
-			@brief Destructor.
+			@brief Default number of reads in flight.
 		*/
-		~Inspector();
+		static const std::size_t DefaultQueueDepth = 4;
 
 		/**
-			@brief Inspects the next node from the stream.
+			@brief Initializes a new instance of the UringFileStream class
+				and starts reading the specified file.
 
-			@return True if the next node was inspected successfully.
-				False if there are no more nodes to inspect.
+			@param filePath Path to the file.
+			@param blockSize Number of bytes of the single read.
+			@param queueDepth Number of reads in flight.
+			@param useUring False to always read by @c pread function.
+
+			@sa IsOpen().
 		*/
-		bool Inspect();
+		UringFileStream(const char* filePath,
+			std::size_t blockSize = DefaultBlockSize,
+			std::size_t queueDepth = DefaultQueueDepth,
+			bool useUring = true);
 
 		/**
-			@brief Gets the last inspected node.
+			@brief Initializes a new instance of the UringFileStream class
+				and starts reading the specified file.
+
+			@param filePath Path to the file.
+			@param blockSize Number of bytes of the single read.
+			@param queueDepth Number of reads in flight.
+			@param useUring False to always read by @c pread function.
+
+			@sa IsOpen().
 		*/
-		Inspected GetInspected() const;
+		UringFileStream(const std::string& filePath,
+			std::size_t blockSize = DefaultBlockSize,
+			std::size_t queueDepth = DefaultQueueDepth,
+			bool useUring = true);
 
 		/**
-			@brief Gets the qualified name of the last inspected node.
+			@brief Destructor.
 		*/
-		const StringType& GetName() const;
+		~UringFileStream();
 
 		/**
-			@brief Gets the value of the last inspected node.
+			@brief Gets a value indicating whether the file is opened.
 		*/
-		const StringType& GetValue() const;
+		bool IsOpen() const;
 
 		/**
-			@brief Gets the local name of the last inspected node.
+			@brief Gets a value indicating whether the file is read with io_uring.
+
+			False means that io_uring is not available and the file
+			is read by @c pread function.
 		*/
-		const StringType& GetLocalName() const;
+		bool IsUringUsed() const;
 
 		/**
-			@brief Gets the namespace prefix of the last inspected node.
+			@brief Gets the size of the block in bytes.
 		*/
-		const StringType& GetPrefix() const;
+		std::size_t GetBlockSize() const;
 
 		/**
-			@brief Gets the namespace URI of the last inspected node.
+			@brief Gets the number of reads in flight.
 		*/
-		const StringType& GetNamespaceUri() const;
+		std::size_t GetQueueDepth() const;
+	};
+
+	/**
+		@brief Input stream which reads the file bypassing the page cache.
+
+		Meant for the huge documents which are parsed once. The file is opened
+		with @c O_DIRECT flag (@c F_NOCACHE on macOS) and read by large blocks
+		into the page-aligned buffer, so other files stay in the page cache.
+		The last block of the file doesn't need to be aligned. If the file system
+		doesn't support direct I/O, the file is read as usual and the read
+		pages are dropped from the cache. Pass the stream to the
+		Xml::Inspector::Inspector(std::istream*) constructor, the bytes
+		are decoded like the bytes of the file passed by the path.
+
+		Example:
+		@code{.cpp}
+        Xml::DirectFileStream stream("dump.xml");
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+        while (inspector.Inspect())
+        {
+            // ...
+        }
+		@endcode
+
+		Read errors are reported by the Inspector as ErrorCode::StreamError.
+
+		@warning Stream must live longer than the Xml::Inspector
+			object that parses it. Available on POSIX systems only.
+	*/
+	class DirectFileStream : public std::istream
+	{
+	private:
+		Details::DirectFileBuf buf;
 
+		// Copy constructor is inaccessible for this class.
+		DirectFileStream(const DirectFileStream&);
+
+		// Assignment operator is inaccessible for this class.
+		DirectFileStream& operator=(const DirectFileStream&);
+	public:
 		/**
-			@brief Gets a value indicating whether the last inspected node has any attributes.
+			@brief Default size of the block in bytes.
 		*/
-		bool HasAttributes() const;
+		static const std::size_t DefaultBlockSize = 4 << 20;
 
 		/**
-			@brief Gets the number of attributes on the last inspected node.
+			@brief Initializes a new instance of the DirectFileStream class
+				and opens the specified file.
+
+			@param filePath Path to the file.
+			@param blockSize Number of bytes of the single read. It's rounded
+				up to the multiple of 4096.
+			@param useDirect False to read the file through the page cache,
+				dropping the read pages from it.
+
+			@sa IsOpen().
 		*/
-		SizeType GetAttributesCount() const;
+		DirectFileStream(const char* filePath,
+			std::size_t blockSize = DefaultBlockSize,
+			bool useDirect = true);
 
 		/**
-			@brief Returns attribute at the specified index on the last inspected node.
+			@brief Initializes a new instance of the DirectFileStream class
+				and opens the specified file.
 
-			@param index Index of the attribute.
-			@return Constant reference to the chosen attribute.
-			@exception std::out_of_range Index starting value is 0,
-				and GetAttributesCount() result should be greater than index.
+			@param filePath Path to the file.
+			@param blockSize Number of bytes of the single read. It's rounded
+				up to the multiple of 4096.
+			@param useDirect False to read the file through the page cache,
+				dropping the read pages from it.
+
+			@sa IsOpen().
 		*/
-		const AttributeType& GetAttributeAt(SizeType index) const;
+		DirectFileStream(const std::string& filePath,
+			std::size_t blockSize = DefaultBlockSize,
+			bool useDirect = true);
 
 		/**
-			@brief Gets the last error message.
+			@brief Destructor.
 		*/
-		const char* GetErrorMessage() const;
+		~DirectFileStream();
 
 		/**
-			@brief Gets the last error code.
+			@brief Gets a value indicating whether the file is opened.
 		*/
-		ErrorCode GetErrorCode() const;
+		bool IsOpen() const;
 
 		/**
-			@brief Gets the current row number.
-
-			Starting value is 1. For example:
-			@verbatim
-			<root>
-			   <a>aaa</a>
-			   <b>
-				   bbb
-			   </b>
-			</root>
-			@endverbatim
-			Row number of @c bbb is 4.
+			@brief Gets a value indicating whether the file is read
+				bypassing the page cache.
 
-			@sa GetColumn() and GetDepth().
+			False means that the file system doesn't support direct I/O.
 		*/
-		SizeType GetRow() const;
+		bool IsDirect() const;
 
 		/**
-			@brief Gets the current column number.
+			@brief Gets the size of the block in bytes.
+		*/
+		std::size_t GetBlockSize() const;
+	};
+#endif
 
-			Starting value is 1. For example:
-			@verbatim
-			<root>
-			abcdef<mytag />
-			</root>
-			@endverbatim
-			Column number of <tt>&lt;mytag /&gt;</tt> is 7.
+#if defined(XML_INSPECTOR_ZLIB)
+	/**
+		@brief Input stream which decompresses gzip or zlib data on the fly.
 
-			@sa GetRow() and GetDepth().
-		*/
-		SizeType GetColumn() const;
+		Compressed bytes are inflated by small fixed-size blocks,
+		so the memory usage doesn't depend on the size of the document.
+		Concatenated gzip members are read as a single document.
+		Pass the stream to the Xml::Inspector::Inspector(std::istream*) constructor.
+		Files passed by the path to Xml::Inspector are recognized by the
+		gzip header and decompressed automatically.
 
-		/**
-			@brief Gets the depth of the last inspected node in the XML document.
+		Available only if @c XML_INSPECTOR_ZLIB macro is defined
+		before the header is included. Program needs to be linked with zlib.
 
-			Example:
-			@verbatim
-			<root>
-			   <a>aaa</a>
-			   <b>
-				   bbb
-			   </b>
-			</root>
-			@endverbatim
-			Depth of @c aaa is 2, the same as depth of @c bbb.
-			Depht of &lt;@c a&gt; tag, the same as closing tag &lt;/@c a&gt; is 1.
+		Example:
+		@code{.cpp}
+        Xml::GzipStream stream("catalog.xml.gz");
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+        while (inspector.Inspect())
+        {
+            // ...
+        }
+		@endcode
 
-			@sa GetRow() and GetColumn().
-		*/
-		SizeType GetDepth() const;
+		Corrupted or truncated data is reported by the Inspector
+		as ErrorCode::StreamError.
 
-		/**
-			@brief Removes the association with the source and resets
-				the state of Inspector object.
+		@warning Stream must live longer than the Xml::Inspector
+			object that parses it. The source stream passed to the
+			constructor cannot be used by other code until this
+			stream is destroyed.
+	*/
+	class GzipStream : public std::istream
+	{
+	private:
+		std::ifstream file;
+		Details::GzipBuf buf;
 
-			It doesn't clear the helpful containers to reduce the number of
-			string allocations in future reading nodes. To completely
-			clear those containers you should call the Clear method instead.
+		// Copy constructor is inaccessible for this class.
+		GzipStream(const GzipStream&);
 
-			@sa Clear().
+		// Assignment operator is inaccessible for this class.
+		GzipStream& operator=(const GzipStream&);
+	public:
+		/**
+			@brief Initializes a new instance of the GzipStream class
+				and opens the specified compressed file.
+
+			@sa IsOpen().
 		*/
-		void Reset();
+		GzipStream(const char* filePath);
 
 		/**
-			@brief Resets the state of Inspector object and assign
-				the source to the specified file path.
-
-			It doesn't clear the helpful containers to reduce the number of
-			string allocations in future reading nodes. To completely
-			clear those containers you can call the Clear method.
+			@brief Initializes a new instance of the GzipStream class
+				and opens the specified compressed file.
 
-			@sa Clear().
+			@sa IsOpen().
 		*/
-		void Reset(const char* filePath);
+		GzipStream(const std::string& filePath);
 
 		/**
-			@brief Resets the state of Inspector object and assign
-				the source to the specified file path.
-
-			It doesn't clear the helpful containers to reduce the number of
-			string allocations in future reading nodes. To completely
-			clear those containers you can call the Clear method.
+			@brief Initializes a new instance of the GzipStream class
+				with the specified stream of compressed bytes.
+		*/
+		GzipStream(std::istream* compressedStream);
 
-			@sa Clear().
+		/**
+			@brief Destructor.
 		*/
-		void Reset(const std::string& filePath);
+		~GzipStream();
 
 		/**
-			@brief Resets the state of Inspector object and assign
-				the source to the specified stream.
+			@brief Gets a value indicating whether the source is opened.
+		*/
+		bool IsOpen() const;
+	};
+#endif
 
-			It doesn't clear the helpful containers to reduce the number of
-			string allocations in future reading nodes. To completely
-			clear those containers you can call the Clear method.
+#if defined(XML_INSPECTOR_ZLIB)
+	/**
+		@brief Input stream which decompresses BGZF data on several threads.
 
-			@sa Clear().
-		*/
-		void Reset(std::istream* inputStream);
+		BGZF (blocked gzip) consists of many independently compressed gzip
+		members with the size of each member stored in its header. Members
+		are read in order, inflated concurrently on the worker threads
+		and served to the parser in order. Data which is not BGZF (for example
+		a single gzip member) is inflated sequentially like by Xml::GzipStream.
+		Pass the stream to the Xml::Inspector::Inspector(std::istream*) constructor.
 
-		/**
-			@brief Resets the state of Inspector object and assign
-				the source to the specified byte sequence.
+		Available only if @c XML_INSPECTOR_ZLIB macro is defined
+		before the header is included. Program needs to be linked with zlib.
 
-			@param first,last Input iterators to the initial
-				and final positions in a sequence of bytes. The range used
-				is [first,last), which contains all the bytes
-				between first and last, including the element pointed
-				by first but not the element pointed by last.
+		Example:
+		@code{.cpp}
+        Xml::ParallelGzipStream stream("catalog.xml.gz", 4);
+        Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+        while (inspector.Inspect())
+        {
+            // ...
+        }
+		@endcode
 
-			It doesn't clear the helpful containers to reduce the number of
-			string allocations in future reading nodes. To completely
-			clear those containers you can call the Clear method.
+		Corrupted or truncated data is reported by the Inspector
+		as ErrorCode::StreamError.
 
-			@sa Clear().
+		@warning Stream must live longer than the Xml::Inspector
+			object that parses it. The source stream passed to the
+			constructor cannot be used by other code until this
+			stream is destroyed.
+	*/
+	class ParallelGzipStream : public std::istream
+	{
+	private:
+		std::ifstream file;
+		Details::ParallelGzipBuf buf;
+
+		// Copy constructor is inaccessible for this class.
+		ParallelGzipStream(const ParallelGzipStream&);
+
+		// Assignment operator is inaccessible for this class.
+		ParallelGzipStream& operator=(const ParallelGzipStream&);
+	public:
+		/**
+			@brief Initializes a new instance of the ParallelGzipStream class
+				and opens the specified compressed file.
+
+			@param filePath Path to the file.
+			@param threadsCount Number of worker threads. If 0, the number
+				of hardware threads is used.
+			@param queueDepth Number of members read ahead. If 0,
+				four times the number of threads is used.
+
+			@sa IsOpen().
 		*/
-		template <typename TInputIterator>
-		void Reset(TInputIterator first, TInputIterator last);
+		ParallelGzipStream(const char* filePath,
+			std::size_t threadsCount = 0, std::size_t queueDepth = 0);
 
 		/**
-			@brief Resets the state of Inspector object and assign
-				the source to the specified characters reader interface.
+			@brief Initializes a new instance of the ParallelGzipStream class
+				and opens the specified compressed file.
 
-			It doesn't clear the helpful containers to reduce the number of
-			string allocations in future reading nodes. To completely
-			clear those containers you can call the Clear method.
+			@param filePath Path to the file.
+			@param threadsCount Number of worker threads. If 0, the number
+				of hardware threads is used.
+			@param queueDepth Number of members read ahead. If 0,
+				four times the number of threads is used.
 
-			@sa Clear().
+			@sa IsOpen().
 		*/
-		void Reset(Encoding::CharactersReader* reader);
+		ParallelGzipStream(const std::string& filePath,
+			std::size_t threadsCount = 0, std::size_t queueDepth = 0);
 
 		/**
-			@brief Removes the association with the source, resets
-				the state of Inspector object and clears internal containers.
+			@brief Initializes a new instance of the ParallelGzipStream class
+				with the specified stream of compressed bytes.
+
+			@param compressedStream Source stream.
+			@param threadsCount Number of worker threads. If 0, the number
+				of hardware threads is used.
+			@param queueDepth Number of members read ahead. If 0,
+				four times the number of threads is used.
+		*/
+		ParallelGzipStream(std::istream* compressedStream,
+			std::size_t threadsCount = 0, std::size_t queueDepth = 0);
 
-			This method clears all the helpful containers in addition to
-			just reset the state. If you want to use Inspector object
-			to parse more XML documents you should consider Reset methods
-			instead. It would reduce the number of string allocations.
+		/**
+			@brief Destructor. Stops the worker threads.
+		*/
+		~ParallelGzipStream();
 
-			@sa Reset().
+		/**
+			@brief Gets a value indicating whether the source is opened.
 		*/
-		void Clear();
+		bool IsOpen() const;
+
+		/**
+			@brief Gets the number of worker threads.
+		*/
+		std::size_t GetThreadsCount() const;
 	};
+#endif
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWhiteSpace(char32_t codePoint)
-	{
-		return (codePoint == 0x20 || codePoint == 0x0A || codePoint == 0x09);
-	}
+	/**
+		@brief Position policy of Xml::Inspector which tracks the position
+			of every character.
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::LowerXml[3] =
+		Rows, columns and byte offsets of nodes and attributes are available
+		after each call of Xml::Inspector::Inspect method. It's the default policy.
+	*/
+	struct TrackedPositions
 	{
-		// "xml"
-		0x78, 0x6D, 0x6C
+		/**
+			@brief True if the positions are updated for every character.
+		*/
+		static const bool IsTracked = true;
 	};
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::UpperXml[3] =
-	{
-		// "XML"
-		0x58, 0x4D, 0x4C
-	};
+	/**
+		@brief Position policy of Xml::Inspector which doesn't track the positions
+			while parsing.
+
+		The parser doesn't count rows, columns and bytes of the characters. It saves
+		the start of the token as the index of the character in the characters buffer
+		and the checkpoint is the position before the start of the buffer. Saved positions
+		are resolved when the buffer is refilled, and Xml::Inspector::GetRow and
+		Xml::Inspector::GetColumn methods recompute the others on demand by rescanning
+		the decoded characters from the checkpoint. Rows and columns of nodes and errors
+		are the same as with Xml::TrackedPositions policy. Positions of attributes
+		and byte offsets are not available.
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::Xmlns[5] =
+		Example:
+		@code{.cpp}
+		Xml::Inspector<Xml::Encoding::Utf8Writer,
+			Xml::Encoding::CharactersReader, Xml::LazyPositions> inspector(&file);
+		@endcode
+	*/
+	struct LazyPositions
 	{
-		// "xmlns"
-		0x78, 0x6D, 0x6C, 0x6E, 0x73
+		/**
+			@brief True if the positions are updated for every character.
+		*/
+		static const bool IsTracked = false;
 	};
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::XmlUri[36] =
-	{
-		// "http://www.w3.org/XML/1998/namespace"
-		0x68, 0x74, 0x74, 0x70, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E, 0x77,
-		0x33, 0x2E, 0x6F, 0x72, 0x67, 0x2F, 0x58, 0x4D, 0x4C, 0x2F, 0x31, 0x39,
-		0x39, 0x38, 0x2F, 0x6E, 0x61, 0x6D, 0x65, 0x73, 0x70, 0x61, 0x63, 0x65
-	};
+	/**
+		@brief Streaming XML parser class.
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::XmlnsUri[29] =
-	{
-		// "http://www.w3.org/2000/xmlns/"
-		0x68, 0x74, 0x74, 0x70, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E, 0x77, 0x33, 0x2E, 0x6F,
-		0x72, 0x67, 0x2F, 0x32, 0x30, 0x30, 0x30, 0x2F, 0x78, 0x6D, 0x6C, 0x6E, 0x73, 0x2F
-	};
+		Example:
+		@code{.cpp}
+        #include "XmlInspector.hpp"
+        #include &lt;iostream&gt;
+        #include &lt;cstdlib&gt
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::XmlDeclarationVersion[7] =
-	{
-		// "version"
-		0x76, 0x65, 0x72, 0x73, 0x69, 0x6F, 0x6E
-	};
+        int main()
+        {
+            Xml::Inspector<Xml::Encoding::Utf8Writer> inspector("test.xml");
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::XmlDeclarationEncoding[8] =
-	{
-		// "encoding"
-		0x65, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67
-	};
+            while (inspector.Inspect())
+            {
+                switch (inspector.GetInspected())
+                {
+                    case Xml::Inspected::StartTag:
+                        std::cout << "[StartTag] name(" << inspector.GetName() <<
+                            "), value(" << inspector.GetValue() << ").\n";
+                        break;
+                    case Xml::Inspected::EndTag:
+                        std::cout << "[EndTag] name(" << inspector.GetName() <<
+                            "), value(" << inspector.GetValue() << ").\n";
+                        break;
+                    case Xml::Inspected::EmptyElementTag:
+                        std::cout << "[EmptyElementTag] name(" << inspector.GetName() <<
+                            "), value(" << inspector.GetValue() << ").\n";
+                        break;
+                    case Xml::Inspected::Text:
+                        std::cout << "[Text] value(" << inspector.GetValue() << ").";
+                        break;
+                    case Xml::Inspected::Whitespace:
+                        // Ignore white spaces between markup.
+                        break;
+                    default:
+                        std::cout << "[...] name(" << inspector.GetName() <<
+                            "), value(" << inspector.GetValue() << ").\n";
+                        break;
+                }
+            }
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::XmlDeclarationStandalone[10] =
-	{
-		// "standalone"
-		0x73, 0x74, 0x61, 0x6E, 0x64, 0x61, 0x6C, 0x6F, 0x6E, 0x65
-	};
+            if (inspector.GetErrorCode() != Xml::ErrorCode::None)
+            {
+                std::cout << "Error: " << inspector.GetErrorMessage() <<
+                " At row: " << inspector.GetRow() <<
+				", column: " << inspector.GetColumn() << "\n";
+            }
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::Yes[3] =
-	{
-		// "yes"
-		0x79, 0x65, 0x73
-	};
+            return EXIT_SUCCESS;
+        }
+		@endcode
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::No[2] =
+		@tparam TCharactersWriter Writer with a specified encoding. You don't need to care how the XML file is encoded.
+			You can choose how you want to store the strings between Xml::Encoding::Utf8Writer, Xml::Encoding::Utf16Writer
+			and Xml::Encoding::Utf32Writer class from CharactersWriter.hpp file. They respectively store the strings in
+			@c std::string, @c std::u16string and @c std::u32string. You can also write your own fancy way of
+			storing strings. For example you may want to use @c std::wstring and even other than Unicode encoding.
+		@tparam TCharactersReader Type of the characters reader passed to the constructor or Reset method.
+			By default it's Xml::Encoding::CharactersReader interface. If you always use the same
+			reader class, like Xml::Encoding::Utf8IteratorsReader, you can choose it here,
+			so the characters are decoded without any virtual call. Other sources work the same way
+			regardless of this type.
+		@tparam TPositionPolicy Xml::TrackedPositions (default) to know the position of every node,
+			or Xml::LazyPositions to recompute the position only when it's requested.
+	*/
+	template <typename TCharactersWriter,
+		typename TCharactersReader = Encoding::CharactersReader,
+		typename TPositionPolicy = TrackedPositions>
+	class Inspector
 	{
-		// "no"
-		0x6E, 0x6F
-	};
+	public:
+		/**
+			@brief Alias of the characters writer type that is used to write strings.
+		*/
+		typedef TCharactersWriter CharactersWriterType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::CDATA[5] =
-	{
-		// "CDATA"
-		0x43, 0x44, 0x41, 0x54, 0x41
-	};
+		/**
+			@brief Alias of the characters reader type that could be passed as a source.
+		*/
+		typedef TCharactersReader CharactersReaderType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::DOCTYPE[7] =
-	{
-		// "DOCTYPE"
-		0x44, 0x4F, 0x43, 0x54, 0x59, 0x50, 0x45
-	};
+		/**
+			@brief Alias of the position policy.
+		*/
+		typedef TPositionPolicy PositionPolicyType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::LtEntityName[2] =
-	{
-		// "lt"
-		0x6C, 0x74
-	};
+		/**
+			@brief String type provided by the CharactersWriterType.
+		*/
+		typedef typename TCharactersWriter::StringType StringType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::GtEntityName[2] =
-	{
-		// "gt"
-		0x67, 0x74
-	};
+		/**
+			@brief Attribute type.
+		*/
+		typedef InspectedAttribute<StringType> AttributeType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::AmpEntityName[3] =
-	{
-		// "amp"
-		0x61, 0x6D, 0x70
-	};
+		/**
+			@brief Alias to the view of the strings.
+		*/
+		typedef StringView<typename StringType::value_type> StringViewType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::AposEntityName[4] =
-	{
-		// "apos"
-		0x61, 0x70, 0x6F, 0x73
-	};
+		/**
+			@brief Unsigned integer type definition for determining location in the XML document.
+				This type should be enough to store any file size or memory buffer size.
+		*/
+		typedef std::uint_least64_t SizeType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::QuotEntityName[4] =
-	{
-		// "quot"
-		0x71, 0x75, 0x6F, 0x74
-	};
+		/**
+			@brief Default size of the buffer of the file descriptor source.
+		*/
+		static const std::size_t DefaultFdBufferSize = 256 * 1024;
+	private:
+		typedef typename StringType::size_type StringSizeType;
+		typedef Details::UnclosedTag<StringType> UnclosedTagType;
+		typedef Details::NamespaceDeclaration<StringType> NamespaceDeclarationType;
+		typedef typename std::deque<AttributeType>::size_type AttributesSizeType;
+		typedef typename std::deque<UnclosedTagType>::size_type UnclosedTagsSizeType;
+		typedef typename std::deque<NamespaceDeclarationType>::size_type NamespacesSizeType;
 
-	template <typename TCharactersWriter>
-	const unsigned char Inspector<TCharactersWriter>::ToLower[256] =
-	{
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0A, 0x00, 0x00, 0x0D, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
-		0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
-		0x40, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
-		0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
-		0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
-		0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
-		0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
-		0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
-		0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
-		0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
-		0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
-		0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
-		0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
-		0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
-	};
+		static const unsigned char Space = 0x20;                  // ' '
+		static const unsigned char LineFeed = 0x0A;               // '\n'
+		static const unsigned char CarriageReturn = 0x0D;         // '\r'
+		static const unsigned char LessThan = 0x3C;               // '<'
+		static const unsigned char GreaterThan = 0x3E;            // '>'
+		static const unsigned char Equals = 0x3D;                 // '='
+		static const unsigned char SingleQuote = 0x27;            // '\''
+		static const unsigned char DoubleQuote = 0x22;            // '\"'
+		static const unsigned char Slash = 0x2F;                  // '/'
+		static const unsigned char Question = 0x3F;               // '?'
+		static const unsigned char Exclamation = 0x21;            // '!'
+		static const unsigned char Minus = 0x2D;                  // '-'
+		static const unsigned char Ampersand = 0x26;              // '&'
+		static const unsigned char Hash = 0x23;                   // '#'
+		static const unsigned char X = 0x78;                      // 'x'
+		static const unsigned char Colon = 0x3A;                  // ':'
+		static const unsigned char Semicolon = 0x3B;              // ';'
+		static const unsigned char LeftSquareBracket = 0x5B;      // '['
+		static const unsigned char RightSquareBracket = 0x5D;     // ']'
+		static const unsigned char Dot = 0x2E;                    // '.'
+		static const unsigned char LowerXml[3];                   // "xml"
+		static const unsigned char UpperXml[3];                   // "XML"
+		static const unsigned char Xmlns[5];                      // "xmlns"
+		static const unsigned char XmlUri[36];                    // "http://www.w3.org/XML/1998/namespace"
+		static const unsigned char XmlnsUri[29];                  // "http://www.w3.org/2000/xmlns/"
+		static const unsigned char XmlDeclarationVersion[7];      // "version"
+		static const unsigned char XmlDeclarationEncoding[8];     // "encoding"
+		static const unsigned char XmlDeclarationStandalone[10];  // "standalone"
+		static const unsigned char Yes[3];                        // "yes"
+		static const unsigned char No[2];                         // "no"
+		static const unsigned char CDATA[5];                      // "CDATA"
+		static const unsigned char DOCTYPE[7];                    // "DOCTYPE"
+		static const unsigned char LtEntityName[2];               // "lt"
+		static const unsigned char GtEntityName[2];               // "gt"
+		static const unsigned char AmpEntityName[3];              // "amp"
+		static const unsigned char AposEntityName[4];             // "apos"
+		static const unsigned char QuotEntityName[4];             // "quot"
 
-	template <typename TCharactersWriter>
-	inline Inspector<TCharactersWriter>::Inspector()
-		: row(0),
-		column(0),
-		currentRow(0),
-		currentColumn(0),
-		node(Inspected::None),
-		err(ErrorCode::None),
-		errMsg(nullptr),
-		fPath(),
-		fileStream(),
-		inputStreamPtr(nullptr),
-		reader(nullptr),
-		sourceType(SourceNone),
-		afterBom(false),
-		bom(Details::Bom::None),
-		name(),
-		value(),
-		localName(),
-		prefix(),
-		namespaceUri(),
-		entityName(),
-		comparingName(),
-		entityNameCharCount(0),
-		currentCharacter(0),
-		bufferedCharacter(0),
-		foundElement(false),
-		foundDOCTYPE(false),
-		eof(false),
-		lowerXmlString(),
-		xmlnsString(),
-		xmlUriString(),
-		xmlnsUriString(),
-		attributes(),
-		attributesSize(0),
-		unclosedTags(),
-		unclosedTagsSize(0),
-		namespaces(),
-		namespacesSize(0)
-	{
-		InitStrings();
-	}
+		// Types of the ASCII characters runs (see TakeRun method).
+		static const unsigned char TextRun = 0x01; // Text characters except CR, '<', '&' and ']'.
+		static const unsigned char AttributeValueRun = 0x02; // Attribute value characters except quotes, '<', '&', tab and LF.
+		static const unsigned char NameRun = 0x04; // Name characters except ':'.
+		static const unsigned char CommentRun = 0x08; // Comment characters except CR and '-'.
+		static const unsigned char CDataRun = 0x10; // CDATA characters except CR and ']'.
+		static const unsigned char ProcessingInstructionRun = 0x20; // Processing instruction characters except CR and '?'.
 
-	template <typename TCharactersWriter>
-	inline Inspector<TCharactersWriter>::Inspector(const char* filePath)
-		: row(0),
-		column(0),
-		currentRow(0),
-		currentColumn(0),
-		node(Inspected::None),
-		err(ErrorCode::None),
-		errMsg(nullptr),
-		fPath(),
-		fileStream(),
-		inputStreamPtr(nullptr),
-		reader(nullptr),
-		sourceType(SourceNone),
-		afterBom(false),
-		bom(Details::Bom::None),
-		name(),
-		value(),
-		localName(),
-		prefix(),
-		namespaceUri(),
-		entityName(),
-		comparingName(),
-		entityNameCharCount(0),
+		// Run types of every ASCII character except CR.
+		static const unsigned char AsciiRuns[128];
+
+		// Source types.
+		static const int SourceNone = 0; // Inspector() constructor.
+		static const int SourcePath = 1; // Inspector(const char*) or Inspector(const std::string&) constructor.
+		static const int SourceStream = 2; // Inspector(std::istream*) constructor.
+		static const int SourceIterators = 3; // Inspector(InputIterator first, InputIterator last) constructor.
+		static const int SourceReader = 4; // Inspector(Encoding::CharactersReader*) constructor.
+		static const int SourceMemory = 5; // Inspector(const MappedFile*) or Inspector(InputIterator first, InputIterator last) with contiguous bytes.
+		static const int SourceFeed = 6; // Feed method.
+		static const int SourceFd = 7; // Inspector(FileDescriptor fd) constructor.
+		
+		static const StringSizeType NameReserve = 31;
+		static const StringSizeType ValueReserve = 63;
+		static const StringSizeType LocalNameReserve = 15;
+		static const StringSizeType PrefixReserve = 15;
+		static const StringSizeType NamespaceUriReserve = 63;
+
+		// Number of characters decoded by one call of the reader.
+		static const std::size_t CharactersBufferSize = 1024;
+
+		SizeType row;
+		SizeType column;
+		SizeType currentRow;
+		SizeType currentColumn;
+		SizeType byteOffset;
+		// Offset of the current character and the number of its bytes
+		// (both bytes of CR LF line end).
+		SizeType currentByteOffset;
+		std::size_t currentCharacterBytes;
+		// Bytes of the code unit: 1, 2 or 4, or 0 if UTF-8.
+		std::size_t codeUnitSize;
+		// Offset of '&' of the unknown entity reference.
+		SizeType entityByteOffset;
+		// Position of '&' of the parsed reference.
+		SizeType referenceRow;
+		SizeType referenceColumn;
+		// LazyPositions: position before the first character of the characters buffer.
+		// Positions saved since then are pending: the row is 0 and the column
+		// is the number of characters of the buffer up to the saved one.
+		Details::PositionCheckpoint checkpoint;
+		// LazyPositions: the parser stopped at the character of the buffer
+		// before stopIndex or, if stopAfter, at the next one.
+		Details::PositionCheckpoint stopCheckpoint;
+		std::size_t stopIndex;
+		bool stopAfter;
+		bool stopped;
+		// LazyPositions: the last NextCharBad call didn't read a character.
+		bool readFailed;
+		Inspected node;
+		ErrorCode err;
+		const char* errMsg;
+		std::string fPath;
+		std::ifstream fileStream;
+#if defined(XML_INSPECTOR_ZLIB)
+		Details::GzipBuf gzipBuf;
+#endif
+		std::istream* inputStreamPtr;
+		const char* memoryFirst;
+		const char* memoryLast;
+		Details::MemoryBuf memoryBuf;
+		std::istream memoryStream;
+		Encoding::Utf8IteratorsReader<const char*> memoryReader;
+		Details::FeedBuffer feedBuffer;
+		Details::FdBuf fdBuf;
+		std::istream fdStream;
+		Details::Utf8FdReader fdReader;
+		Encoding::SingleByteStreamReader singleByteReader;
+		Encoding::CharactersReader* reader;
+		int sourceType;
+		bool afterBom;
+		// Reader can't be replaced by the XML declaration anymore.
+		bool encodingResolved;
+		Details::Bom bom;
+		StringType name;
+		// It's empty until GetValue method is called if the value is the view of
+		// the document (see AppendBytes method), so it could be written there.
+		mutable StringType value;
+		StringType localName;
+		StringType prefix;
+		StringType namespaceUri;
+		StringType entityName;
+		std::u32string comparingName;
+		SizeType entityNameCharCount;
+		char32_t currentCharacter;
+		char32_t bufferedCharacter;
+		// Characters decoded ahead by the reader.
+		char32_t charactersBuffer[CharactersBufferSize];
+		std::size_t charactersPosition;
+		std::size_t charactersCount;
+		int charactersResult;
+		// UTF-8 bytes of the characters buffer decoded by memoryReader
+		// or nullptr for other readers (see TakeBytesRun method). Bytes of
+		// charactersBuffer[charactersBytesPosition] start at charactersBytes.
+		const char* charactersBytes;
+		std::size_t charactersBytesPosition;
+		// Bytes of the document which are the whole content of viewString,
+		// but are not written there yet (see AppendBytes method).
+		StringType* viewString;
+		const typename StringType::value_type* viewFirst;
+		const typename StringType::value_type* viewLast;
+		bool foundElement;
+		bool foundDOCTYPE;
+		bool eof;
+		StringType lowerXmlString;
+		StringType xmlnsString;
+		StringType xmlUriString;
+		StringType xmlnsUriString;
+		// Instead of removing objects from collection I decrement size.
+		// It's a fake size, but I don't want to
+		// allocate strings in objects after each element node and each XML document.
+		// To clear these collections you can call Inspector::Clear method.
+		std::deque<AttributeType> attributes;
+		AttributesSizeType attributesSize;
+		std::deque<UnclosedTagType> unclosedTags;
+		UnclosedTagsSizeType unclosedTagsSize;
+		std::deque<NamespaceDeclarationType> namespaces;
+		NamespacesSizeType namespacesSize;
+
+		// We don't need to check carriage return
+		// while NextCharBad method removes them for us.
+		// That's why I use this method instead of
+		// Xml::Encoding::CharactersReader::IsWhiteSpace.
+		static bool IsWhiteSpace(char32_t codePoint);
+
+		void SetError(ErrorCode errorCode);
+
+		void SavePosition();
+
+		void SavePosition(AttributeType& attribute);
+
+		// Saves the position of the character, which is the given number
+		// of characters before the current one in the same row.
+		void SavePosition(SizeType& resultRow, SizeType& resultColumn, SizeType before);
+
+		// LazyPositions: resolves the pending position by advancing the given position,
+		// which is after the given number of characters of the buffer.
+		void ResolvePosition(Details::PositionCheckpoint& position, std::size_t& index,
+			SizeType& resultRow, SizeType& resultColumn) const;
+
+		// LazyPositions: resolves the pending positions before the buffer is refilled.
+		void ResolvePositions();
+
+		// Resets the state like Reset method after an error or the end of the document,
+		// but LazyPositions remember where the parser stopped.
+		void Stop();
+
+		// LazyPositions: computes the position at which the parser stopped.
+		Details::PositionCheckpoint StopPosition() const;
+
+		// LazyPositions: computes the position of the row and column members.
+		Details::PositionCheckpoint LazyPosition() const;
+
+		// Takes the next character from the characters buffer
+		// and refills it from the reader if necessary.
+		// Returns the same values as Encoding::CharactersReader::ReadCharacter.
+		int ReadCharacter(char32_t& result);
+
+		// Refills the characters buffer from the reader passed as a source.
+		std::size_t ReadCharacters(std::size_t capacity, std::true_type);
+
+		std::size_t ReadCharacters(std::size_t capacity, std::false_type);
+
+		// Gets the number of bytes of the character in the source encoding.
+		std::size_t CharacterBytes(char32_t codePoint) const;
+
+		// Extracts the next character and sets the error flag
+		// if eof (only if insideTag flag), invalid character or stream error.
+		// Returns true if error or eof (insideTag == false) happened.
+		bool NextCharBad(bool insideTag);
+
+		// Takes the run of buffered ASCII characters of the specified type
+		// which follow the current character. They don't need any further
+		// check, so the last of them becomes the current character.
+		// Returns the number of taken characters.
+		std::size_t TakeRun(unsigned char runType, const char32_t*& run);
+
+		// Takes the run of any type except NameRun like TakeRun method
+		// and appends it to the destination string. Returns the number
+		// of taken characters.
+		std::size_t AppendRun(unsigned char runType,
+			StringType& destination, const char32_t*& run);
+
+		// UTF-8 input and output: takes the run of buffered characters,
+		// including non-ASCII characters, and appends its bytes directly
+		// from the memory. Returns false if the bytes are not available.
+		bool TakeBytesRun(unsigned char runType,
+			StringType& destination, std::size_t& length, std::true_type);
+
+		bool TakeBytesRun(unsigned char runType,
+			StringType& destination, std::size_t& length, std::false_type);
+
+		// Moves charactersBytes to the bytes of charactersBuffer[charactersPosition].
+		void SyncCharactersBytes();
+
+		// Writes the current character to the value of the node or attribute.
+		// Its bytes are written from the document if they are available.
+		void WriteCurrentCharacter(StringType& destination);
+
+		void WriteCurrentCharacter(StringType& destination, std::true_type);
+
+		void WriteCurrentCharacter(StringType& destination, std::false_type);
+
+		// Writes the character, which is not the current character (or it
+		// was changed by the normalization), to the value of the node or attribute.
+		void WriteValueCharacter(StringType& destination, char32_t codePoint);
+
+		// Appends the bytes of the document to the value of the node or attribute.
+		// If they are the whole value so far, they become the view of the document
+		// instead of being copied. Following bytes extend the view.
+		void AppendBytes(StringType& destination,
+			const typename StringType::value_type* first,
+			const typename StringType::value_type* last);
+
+		// Writes the view of the document to its string.
+		void FlushView();
+
+		// Writes the current character and the following run
+		// of ASCII name characters into both strings.
+		void WriteNameCharacters(StringType& qualifiedName, StringType& localPart);
+
+		void ParseBom();
+
+		bool ParseElement();
+
+		bool ParseAttributes();
+
+		bool ParseEndTag();
+
+		bool ParseText();
+
+		bool ParseQuestion();
+
+		bool ParseXmlDeclaration();
+
+		bool ParseProcessingInstruction();
+
+		bool ParseExclamation();
+
+		bool ParseComment();
+
+		bool ParseCDATA();
+
+		bool ParseDOCTYPE();
+
+		void PrepareNode();
+
+		bool NamespacesStuff();
+
+		// Returns false if error.
+		bool ParseCharacterReference(char32_t& result, bool insideTag);
+
+		// Returns 1 if predefined entity, 0 if unknown entity, -1 if error.
+		int ParseEntityReference(bool insideTag);
+
+		bool AttributeUniqueness();
+
+		// Returns the stream for the reader of the encoding from XML declaration.
+		std::istream* EncodingStream();
+
+		// Deletes the current reader unless it is owned by the Inspector.
+		void ReplaceReader(Encoding::CharactersReader* newReader);
+
+		// Chooses the final reader from the first bytes of a document
+		// without the byte order mark, before any character is decoded.
+		// Stream must read the same bytes.
+		void SniffEncoding(const char* first, const char* last, std::istream* stream);
+
+		// Gets the position of the reader in the fed bytes.
+		const char* GetFeedPosition() const;
+
+		// Returns true if the parser has taken all the fed bytes
+		// of complete tokens, so the next token needs more bytes.
+		bool IsFeedConsumed() const;
+
+		// Points the memory source and the reader to the fed bytes,
+		// which could be moved. Position is an offset of the reader.
+		void UpdateFeed(std::size_t position);
+
+		template <typename TInputIterator>
+		void ResetIterators(TInputIterator first, TInputIterator last, std::true_type);
+
+		template <typename TInputIterator>
+		void ResetIterators(TInputIterator first, TInputIterator last, std::false_type);
+
+		bool ResolveEncoding(const AttributeType& encoding);
+
+		AttributeType& NewAttribute();
+
+		UnclosedTagType& NewUnclosedTag();
+
+		NamespaceDeclarationType& NewNamespace();
+
+		void InitStrings();
+
+		// Copy constructor is inaccessible for this class.
+		Inspector(const Inspector&) { };
+
+		// Assignment operator is inaccessible for this class.
+		Inspector& operator=(const Inspector&) { return *this; };
+	public:
+		/**
+			@brief Initializes a new instance of the Inspector class.
+		*/
+		Inspector();
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified file path.
+		*/
+		Inspector(const char* filePath);
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified file path.
+		*/
+		Inspector(const std::string& filePath);
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified stream.
+		*/
+		Inspector(std::istream* inputStream);
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified iterators.
+
+			@param first,last Input iterators to the initial
+				and final positions in a sequence of bytes. The range used
+				is [first,last), which contains all the bytes
+				between first and last, including the byte pointed
+				by first but not the byte pointed by last.
+
+			Pointers to bytes and iterators of std::string or std::vector
+			of bytes are detected at compile time and the bytes are
+			decoded directly from the memory.
+		*/
+		template <typename TInputIterator, typename = typename std::enable_if<
+			!std::is_integral<TInputIterator>::value>::type>
+		Inspector(TInputIterator first, TInputIterator last);
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified characters reader interface.
+		*/
+		Inspector(CharactersReaderType* reader);
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified memory mapped file.
+
+			Bytes are decoded directly from the mapped memory.
+			Mapped file must live longer than the Inspector object
+			or until the source is changed.
+		*/
+		Inspector(const MappedFile* mappedFile);
+
+		/**
+			@brief Initializes a new instance of the Inspector class
+				with the specified file descriptor.
+
+			@param fd Descriptor of the file, pipe or socket opened for reading.
+				It must be in blocking mode. The descriptor isn't closed
+				by the Inspector.
+			@param bufferSize Size of the buffer into which the bytes are read.
+
+			Bytes are read by the system calls directly into the buffer
+			of the Inspector and UTF-8 is decoded from the buffer,
+			so the iostream library isn't involved. Interrupted reads
+			(@c EINTR) are restarted.
+		*/
+		Inspector(FileDescriptor fd, std::size_t bufferSize = DefaultFdBufferSize);
+
+		/**
+			@brief Destructor.
+		*/
+		~Inspector();
+
+		/**
+			@brief Inspects the next node from the stream.
+
+			@return True if the next node was inspected successfully.
+				False if there are no more nodes to inspect.
+		*/
+		bool Inspect();
+
+		/**
+			@brief Gets the last inspected node.
+		*/
+		Inspected GetInspected() const;
+
+		/**
+			@brief Gets the qualified name of the last inspected node.
+		*/
+		const StringType& GetName() const;
+
+		/**
+			@brief Gets the value of the last inspected node.
+
+			If the value is viewed in the document (see GetValueView()),
+			the first call copies it, so this method must not be called
+			from different threads at the same time without synchronization.
+		*/
+		const StringType& GetValue() const;
+
+		/**
+			@brief Gets the view of the value of the last inspected node.
+
+			For UTF-8 documents in memory (contiguous bytes or Xml::MappedFile)
+			inspected with Xml::Encoding::Utf8Writer, the value is not copied
+			if the document contains the same bytes, that is when there are no
+			references and no carriage returns. The view points to these bytes
+			and it's valid as long as the document. Otherwise (or if the value
+			was changed by the normalization) it points to the characters of
+			GetValue(), which are valid until the next inspection.
+
+			Values of the attributes are always copied to
+			InspectedAttribute::Value.
+		*/
+		StringViewType GetValueView() const;
+
+		/**
+			@brief Gets the local name of the last inspected node.
+		*/
+		const StringType& GetLocalName() const;
+
+		/**
+			@brief Gets the namespace prefix of the last inspected node.
+		*/
+		const StringType& GetPrefix() const;
+
+		/**
+			@brief Gets the namespace URI of the last inspected node.
+		*/
+		const StringType& GetNamespaceUri() const;
+
+		/**
+			@brief Gets a value indicating whether the last inspected node has any attributes.
+		*/
+		bool HasAttributes() const;
+
+		/**
+			@brief Gets the number of attributes on the last inspected node.
+		*/
+		SizeType GetAttributesCount() const;
+
+		/**
+			@brief Returns attribute at the specified index on the last inspected node.
+
+			@param index Index of the attribute.
+			@return Constant reference to the chosen attribute.
+			@exception std::out_of_range Index starting value is 0,
+				and GetAttributesCount() result should be greater than index.
+		*/
+		const AttributeType& GetAttributeAt(SizeType index) const;
+
+		/**
+			@brief Gets the last error message.
+		*/
+		const char* GetErrorMessage() const;
+
+		/**
+			@brief Gets the last error code.
+		*/
+		ErrorCode GetErrorCode() const;
+
+		/**
+			@brief Gets the current row number.
+
+			Starting value is 1. For example:
+			@verbatim
+			<root>
+			   <a>aaa</a>
+			   <b>
+				   bbb
+			   </b>
+			</root>
+			@endverbatim
+			Row number of @c bbb is 4.
+
+			With Xml::LazyPositions policy the row is recomputed by rescanning
+			the characters buffer, so it's slower than with Xml::TrackedPositions.
+
+			@sa GetColumn() and GetDepth().
+		*/
+		SizeType GetRow() const;
+
+		/**
+			@brief Gets the current column number.
+
+			Starting value is 1. For example:
+			@verbatim
+			<root>
+			abcdef<mytag />
+			</root>
+			@endverbatim
+			Column number of <tt>&lt;mytag /&gt;</tt> is 7.
+
+			With Xml::LazyPositions policy the column is recomputed by rescanning
+			the characters buffer, so it's slower than with Xml::TrackedPositions.
+
+			@sa GetRow() and GetDepth().
+		*/
+		SizeType GetColumn() const;
+
+		/**
+			@brief Gets the offset of the first byte of the last inspected node
+				from the beginning of the source.
+
+			Byte order mark is counted, so the offset could be used to seek
+			in the file or to slice the mapped memory. For the characters reader
+			source the bytes are counted as if the document was encoded in UTF-8.
+			Value is meaningful only after Inspect method returned true.
+			It's always 0 with Xml::LazyPositions policy.
+
+			@sa GetEndByteOffset() and GetRow().
+		*/
+		SizeType GetByteOffset() const;
+
+		/**
+			@brief Gets the offset of the byte following the last inspected node.
+
+			Bytes from GetByteOffset() to GetEndByteOffset() are the whole node,
+			for example the whole tag with its attributes or the text until the next
+			markup. Value is meaningful only after Inspect method returned true.
+			It's always 0 with Xml::LazyPositions policy.
+
+			@sa GetByteOffset().
+		*/
+		SizeType GetEndByteOffset() const;
+
+		/**
+			@brief Gets the depth of the last inspected node in the XML document.
+
+			Example:
+			@verbatim
+			<root>
+			   <a>aaa</a>
+			   <b>
+				   bbb
+			   </b>
+			</root>
+			@endverbatim
+			Depth of @c aaa is 2, the same as depth of @c bbb.
+			Depht of &lt;@c a&gt; tag, the same as closing tag &lt;/@c a&gt; is 1.
+
+			@sa GetRow() and GetColumn().
+		*/
+		SizeType GetDepth() const;
+
+		/**
+			@brief Removes the association with the source and resets
+				the state of Inspector object.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you should call the Clear method instead.
+
+			@sa Clear().
+		*/
+		void Reset();
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified file path.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Clear().
+		*/
+		void Reset(const char* filePath);
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified file path.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Clear().
+		*/
+		void Reset(const std::string& filePath);
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified stream.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Clear().
+		*/
+		void Reset(std::istream* inputStream);
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified byte sequence.
+
+			@param first,last Input iterators to the initial
+				and final positions in a sequence of bytes. The range used
+				is [first,last), which contains all the bytes
+				between first and last, including the element pointed
+				by first but not the element pointed by last.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Clear().
+		*/
+		template <typename TInputIterator, typename = typename std::enable_if<
+			!std::is_integral<TInputIterator>::value>::type>
+		void Reset(TInputIterator first, TInputIterator last);
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified characters reader interface.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Clear().
+		*/
+		void Reset(CharactersReaderType* reader);
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified memory mapped file.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Clear().
+		*/
+		void Reset(const MappedFile* mappedFile);
+
+		/**
+			@brief Resets the state of Inspector object and assign
+				the source to the specified file descriptor.
+
+			@param fd Descriptor of the file, pipe or socket opened for reading.
+				It must be in blocking mode. The descriptor isn't closed
+				by the Inspector.
+			@param bufferSize Size of the buffer into which the bytes are read.
+
+			It doesn't clear the helpful containers to reduce the number of
+			string allocations in future reading nodes. To completely
+			clear those containers you can call the Clear method.
+
+			@sa Inspector(FileDescriptor, std::size_t), Clear().
+		*/
+		void Reset(FileDescriptor fd, std::size_t bufferSize = DefaultFdBufferSize);
+
+		/**
+			@brief Appends the bytes of the document parsed in the push mode.
+
+			@param data Pointer to the next bytes of the document.
+			@param size Number of bytes.
+
+			Bytes are copied, so the caller can reuse its buffer. Instead of reaching
+			the end of fed bytes in the middle of a token, Xml::Inspector::Inspect
+			method returns false with ErrorCode::NeedMoreData error code. Nodes
+			which are fed completely are inspected as usual. If the source of the
+			Inspector isn't fed bytes (for example after the end of the previous
+			document or after an error), this method resets the state of
+			Inspector object and starts a new document.
+
+			Example:
+			@code{.cpp}
+			// When the chunk of the document arrives.
+			inspector.Feed(chunk, chunkSize);
+			while (inspector.Inspect())
+			{
+				// ...
+			}
+			if (inspector.GetErrorCode() == Xml::ErrorCode::NeedMoreData)
+			{
+				// Wait for the next chunk or call FinishFeed at the end of input.
+			}
+			@endcode
+
+			@sa FinishFeed().
+		*/
+		void Feed(const char* data, std::size_t size);
+
+		/**
+			@brief Marks the end of the document parsed in the push mode.
+
+			After this call the rest of fed bytes is inspected as the end
+			of the document, so unclosed tokens are reported as errors.
+			Called without any fed bytes, it starts an empty document.
+
+			@sa Feed().
+		*/
+		void FinishFeed();
+
+		/**
+			@brief Removes the association with the source, resets
+				the state of Inspector object and clears internal containers.
+
+			This method clears all the helpful containers in addition to
+			just reset the state. If you want to use Inspector object
+			to parse more XML documents you should consider Reset methods
+			instead. It would reduce the number of string allocations.
+
+			@sa Reset().
+		*/
+		void Clear();
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::IsWhiteSpace(char32_t codePoint)
+	{
+		return (codePoint == 0x20 || codePoint == 0x0A || codePoint == 0x09);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::LowerXml[3] =
+	{
+		// "xml"
+		0x78, 0x6D, 0x6C
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::UpperXml[3] =
+	{
+		// "XML"
+		0x58, 0x4D, 0x4C
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Xmlns[5] =
+	{
+		// "xmlns"
+		0x78, 0x6D, 0x6C, 0x6E, 0x73
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::XmlUri[36] =
+	{
+		// "http://www.w3.org/XML/1998/namespace"
+		0x68, 0x74, 0x74, 0x70, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E, 0x77,
+		0x33, 0x2E, 0x6F, 0x72, 0x67, 0x2F, 0x58, 0x4D, 0x4C, 0x2F, 0x31, 0x39,
+		0x39, 0x38, 0x2F, 0x6E, 0x61, 0x6D, 0x65, 0x73, 0x70, 0x61, 0x63, 0x65
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::XmlnsUri[29] =
+	{
+		// "http://www.w3.org/2000/xmlns/"
+		0x68, 0x74, 0x74, 0x70, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E, 0x77, 0x33, 0x2E, 0x6F,
+		0x72, 0x67, 0x2F, 0x32, 0x30, 0x30, 0x30, 0x2F, 0x78, 0x6D, 0x6C, 0x6E, 0x73, 0x2F
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::XmlDeclarationVersion[7] =
+	{
+		// "version"
+		0x76, 0x65, 0x72, 0x73, 0x69, 0x6F, 0x6E
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::XmlDeclarationEncoding[8] =
+	{
+		// "encoding"
+		0x65, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::XmlDeclarationStandalone[10] =
+	{
+		// "standalone"
+		0x73, 0x74, 0x61, 0x6E, 0x64, 0x61, 0x6C, 0x6F, 0x6E, 0x65
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Yes[3] =
+	{
+		// "yes"
+		0x79, 0x65, 0x73
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::No[2] =
+	{
+		// "no"
+		0x6E, 0x6F
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::CDATA[5] =
+	{
+		// "CDATA"
+		0x43, 0x44, 0x41, 0x54, 0x41
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::DOCTYPE[7] =
+	{
+		// "DOCTYPE"
+		0x44, 0x4F, 0x43, 0x54, 0x59, 0x50, 0x45
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::LtEntityName[2] =
+	{
+		// "lt"
+		0x6C, 0x74
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GtEntityName[2] =
+	{
+		// "gt"
+		0x67, 0x74
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AmpEntityName[3] =
+	{
+		// "amp"
+		0x61, 0x6D, 0x70
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AposEntityName[4] =
+	{
+		// "apos"
+		0x61, 0x70, 0x6F, 0x73
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::QuotEntityName[4] =
+	{
+		// "quot"
+		0x71, 0x75, 0x6F, 0x74
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	const unsigned char Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AsciiRuns[128] =
+	{
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3B, 0x3B, 0x39, 0x3B, 0x3B, 0x3B, 0x38, 0x39, 0x3B, 0x3B, 0x3B, 0x3B, 0x3B, 0x37, 0x3F, 0x3B,
+		0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3B, 0x3B, 0x38, 0x3B, 0x3B, 0x1B,
+		0x3B, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F,
+		0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3B, 0x3B, 0x2A, 0x3B, 0x3F,
+		0x3B, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F,
+		0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3B, 0x3B, 0x3B, 0x3B, 0x3B
+	};
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector()
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(const char* filePath)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+		Reset(filePath);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(const std::string& filePath)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+		Reset(filePath);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(std::istream* inputStream)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+		Reset(inputStream);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	template <typename TInputIterator, typename>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(
+		TInputIterator first, TInputIterator last)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+		Reset(first, last);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(CharactersReaderType* reader)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+		Reset(reader);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(const MappedFile* mappedFile)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
+		currentCharacter(0),
+		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
+		foundElement(false),
+		foundDOCTYPE(false),
+		eof(false),
+		lowerXmlString(),
+		xmlnsString(),
+		xmlUriString(),
+		xmlnsUriString(),
+		attributes(),
+		attributesSize(0),
+		unclosedTags(),
+		unclosedTagsSize(0),
+		namespaces(),
+		namespacesSize(0)
+	{
+		InitStrings();
+		Reset(mappedFile);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspector(FileDescriptor fd, std::size_t bufferSize)
+		: row(0),
+		column(0),
+		currentRow(0),
+		currentColumn(0),
+		byteOffset(0),
+		currentByteOffset(0),
+		currentCharacterBytes(0),
+		codeUnitSize(0),
+		entityByteOffset(0),
+		referenceRow(0),
+		referenceColumn(0),
+		checkpoint(),
+		stopCheckpoint(),
+		stopIndex(0),
+		stopAfter(false),
+		stopped(false),
+		readFailed(false),
+		node(Inspected::None),
+		err(ErrorCode::None),
+		errMsg(nullptr),
+		fPath(),
+		fileStream(),
+#if defined(XML_INSPECTOR_ZLIB)
+		gzipBuf(),
+#endif
+		inputStreamPtr(nullptr),
+		memoryFirst(nullptr),
+		memoryLast(nullptr),
+		memoryBuf(),
+		memoryStream(&memoryBuf),
+		memoryReader(nullptr, nullptr),
+		feedBuffer(),
+		fdBuf(),
+		fdStream(&fdBuf),
+		fdReader(&fdBuf),
+		singleByteReader(nullptr, Encoding::ISO_8859_1_StreamReader::GetCharacterMap()),
+		reader(nullptr),
+		sourceType(SourceNone),
+		afterBom(false),
+		encodingResolved(false),
+		bom(Details::Bom::None),
+		name(),
+		value(),
+		localName(),
+		prefix(),
+		namespaceUri(),
+		entityName(),
+		comparingName(),
+		entityNameCharCount(0),
 		currentCharacter(0),
 		bufferedCharacter(0),
+		charactersPosition(0),
+		charactersCount(0),
+		charactersResult(1),
+		charactersBytes(nullptr),
+		charactersBytesPosition(0),
+		viewString(nullptr),
+		viewFirst(nullptr),
+		viewLast(nullptr),
 		foundElement(false),
 		foundDOCTYPE(false),
 		eof(false),
@@ -1262,1076 +3760,2474 @@ namespace Xml
 		namespaces(),
 		namespacesSize(0)
 	{
-		InitStrings();
-		Reset(filePath);
+		InitStrings();
+		Reset(fd, bufferSize);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::~Inspector()
+	{
+		Reset();
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SetError(ErrorCode errorCode)
+	{
+		err = errorCode;
+		if (errorCode != ErrorCode::None)
+		{
+			switch (errorCode)
+			{
+				case ErrorCode::StreamError:
+					errMsg = "Stream error has occurred.";
+					return;
+				case ErrorCode::InvalidByteSequence:
+					errMsg = "Invalid byte sequence.";
+					return;
+				case ErrorCode::UnknownEncoding:
+					errMsg = "Unknown encoding.";
+					return;
+				case ErrorCode::EncodingConfusion:
+					errMsg = "Encoding confusion.";
+					return;
+				case ErrorCode::EncodingDeclarationRequired:
+					errMsg = "Encoding declaration must precede content that is not "
+						"a legal UTF-8 or UTF-16.";
+					return;
+				case ErrorCode::InvalidSyntax:
+					errMsg = "Invalid syntax.";
+					return;
+				case ErrorCode::InvalidXmlDeclarationLocation:
+					errMsg = "Invalid location of XML declaration.";
+					return;
+				case ErrorCode::CDataSectionOutside:
+					errMsg = "CDATA section is outside a root element.";
+					return;
+				case ErrorCode::ElementOutside:
+					errMsg = "Element is outside a root element.";
+					return;
+				case ErrorCode::InvalidDocumentTypeDeclarationLocation:
+					errMsg = "Invalid location of document type declaration.";
+					return;
+				case ErrorCode::DoubleDocumentTypeDeclaration:
+					errMsg = "There should be exactly one document type declaration.";
+					return;
+				case ErrorCode::InvalidTagName:
+					errMsg = "Invalid tag name.";
+					return;
+				case ErrorCode::InvalidAttributeName:
+					errMsg = "Invalid attribute name.";
+					return;
+				case ErrorCode::UnclosedToken:
+					errMsg = "Unclosed token.";
+					return;
+				case ErrorCode::InvalidReferenceSyntax:
+					errMsg = "Invalid syntax of reference.";
+					return;
+				case ErrorCode::InvalidCharacterReference:
+					errMsg = "Code point in character reference doesn\'t match "
+						"the valid character in ISO/IEC 10646 character set.";
+					return;
+				case ErrorCode::UnexpectedEndTag:
+					errMsg = "Unexpected end tag.";
+					return;
+				case ErrorCode::UnclosedTag:
+					errMsg = "Unclosed tag.";
+					return;
+				case ErrorCode::NoElement:
+					errMsg = "Cannot find an element.";
+					return;
+				case ErrorCode::DoubleAttributeName:
+					errMsg = "An attribute name must not appear more than "
+						"once in the same start-tag or empty-element tag.";
+					return;
+				case ErrorCode::PrefixWithoutAssignedNamespace:
+					errMsg = "Name prefix must bound to the namespace URI.";
+					return;
+				case ErrorCode::PrefixWithEmptyNamespace:
+					errMsg = "Namespace declaration with prefix cannot have an empty value.";
+					return;
+				case ErrorCode::XmlnsDeclared:
+					errMsg = "Reserved xmlns prefix cannot be declared or set to an empty value.";
+					return;
+				case ErrorCode::PrefixBoundToReservedNamespace:
+					errMsg = "Prefix is bound to reserved namespace.";
+					return;
+				case ErrorCode::ReservedNamespaceAsDefault:
+					errMsg = "Reserved namespace cannot be declared as a default namespace.";
+					return;
+				case ErrorCode::InvalidXmlPrefixDeclaration:
+					errMsg = "Prefix \'xml\' is reserved for use by XML and has a fixed "
+						"namespace URI http://www.w3.org/XML/1998/namespace.";
+					return;
+				case ErrorCode::NeedMoreData:
+					errMsg = "More data needs to be fed.";
+					return;
+				default:
+					errMsg = "XML error has occurred.";
+					return;
+			}
+		}
+		errMsg = nullptr;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseBom()
+	{
+		if (sourceType == SourcePath)
+		{
+			fileStream.open(fPath.c_str(), std::ifstream::binary);
+			if (!fileStream.is_open())
+			{
+				fileStream.clear();
+				SetError(ErrorCode::StreamError);
+				return;
+			}
+
+#if defined(XML_INSPECTOR_ZLIB)
+			fileStream.std::ios::rdbuf(fileStream.rdbuf());
+			if (fileStream.rdbuf()->sgetc() == 0x1F)
+			{
+				// Gzip or zlib header. XML document cannot start with
+				// this byte, so all the bytes are decompressed on the fly.
+				if (!gzipBuf.Open(fileStream.rdbuf()))
+				{
+					fileStream.close();
+					fileStream.clear();
+					SetError(ErrorCode::StreamError);
+					return;
+				}
+				fileStream.std::ios::rdbuf(&gzipBuf);
+			}
+#endif
+
+			Details::Bom tempBom = Details::ReadBom(&fileStream);
+			if (tempBom == Details::Bom::None || tempBom == Details::Bom::Utf8)
+			{
+				try
+				{
+					reader = new Encoding::Utf8StreamReader(&fileStream);
+				}
+				catch (...)
+				{
+					fileStream.close();
+					fileStream.clear();
+					throw;
+				}
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+				eof = ((fileStream.rdstate() & std::istream::eofbit) != 0);
+				return;
+			}
+
+			if (tempBom == Details::Bom::StreamError)
+			{
+				fileStream.close();
+				fileStream.clear();
+				SetError(ErrorCode::StreamError);
+				return;
+			}
+
+			if (tempBom == Details::Bom::Invalid)
+			{
+				fileStream.close();
+				fileStream.clear();
+				SetError(ErrorCode::InvalidByteSequence);
+				eof = ((fileStream.rdstate() & std::istream::eofbit) != 0);
+				return;
+			}
+
+			if (tempBom == Details::Bom::Utf16BE)
+			{
+				try
+				{
+					reader = new Encoding::Utf16BEStreamReader(&fileStream);
+				}
+				catch (...)
+				{
+					fileStream.close();
+					fileStream.clear();
+					throw;
+				}
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+			else if (tempBom == Details::Bom::Utf16LE)
+			{
+				try
+				{
+					reader = new Encoding::Utf16LEStreamReader(&fileStream);
+				}
+				catch (...)
+				{
+					fileStream.close();
+					fileStream.clear();
+					throw;
+				}
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+			else if (tempBom == Details::Bom::Utf32BE)
+			{
+				try
+				{
+					reader = new Encoding::Utf32BEStreamReader(&fileStream);
+				}
+				catch (...)
+				{
+					fileStream.close();
+					fileStream.clear();
+					throw;
+				}
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+			else if (tempBom == Details::Bom::Utf32LE)
+			{
+				try
+				{
+					reader = new Encoding::Utf32LEStreamReader(&fileStream);
+				}
+				catch (...)
+				{
+					fileStream.close();
+					fileStream.clear();
+					throw;
+				}
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+		}
+		else if (sourceType == SourceStream || sourceType == SourceIterators)
+		{
+			Details::Bom tempBom = Details::ReadBom(inputStreamPtr);
+			if (tempBom == Details::Bom::None || tempBom == Details::Bom::Utf8)
+			{
+				reader = new Encoding::Utf8StreamReader(inputStreamPtr);
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+				eof = ((inputStreamPtr->rdstate() & std::istream::eofbit) != 0);
+				return;
+			}
+
+			if (tempBom == Details::Bom::StreamError)
+			{
+				SetError(ErrorCode::StreamError);
+				return;
+			}
+
+			if (tempBom == Details::Bom::Invalid)
+			{
+				SetError(ErrorCode::InvalidByteSequence);
+				eof = ((inputStreamPtr->rdstate() & std::istream::eofbit) != 0);
+				return;
+			}
+
+			if (tempBom == Details::Bom::Utf16BE)
+			{
+				reader = new Encoding::Utf16BEStreamReader(inputStreamPtr);
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+			else if (tempBom == Details::Bom::Utf16LE)
+			{
+				reader = new Encoding::Utf16LEStreamReader(inputStreamPtr);
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+			else if (tempBom == Details::Bom::Utf32BE)
+			{
+				reader = new Encoding::Utf32BEStreamReader(inputStreamPtr);
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+			else if (tempBom == Details::Bom::Utf32LE)
+			{
+				reader = new Encoding::Utf32LEStreamReader(inputStreamPtr);
+				err = ErrorCode::None;
+				afterBom = true;
+				bom = tempBom;
+			}
+		}
+		else if (sourceType == SourceMemory || sourceType == SourceFeed)
+		{
+			const char* first = memoryFirst;
+			Details::Bom tempBom = Details::ReadBom(first, memoryLast);
+			if (tempBom == Details::Bom::Invalid)
+			{
+				SetError(ErrorCode::InvalidByteSequence);
+				eof = (first == memoryLast);
+				return;
+			}
+
+			if (tempBom == Details::Bom::None || tempBom == Details::Bom::Utf8)
+			{
+				// The most common case. Decode directly from the memory.
+				memoryReader.ResetIterators(first, memoryLast);
+				reader = &memoryReader;
+				eof = (first == memoryLast);
+				if (tempBom == Details::Bom::None)
+				{
+					memoryBuf.Reset(first, memoryLast);
+					memoryStream.clear();
+					SniffEncoding(first, memoryLast, &memoryStream);
+				}
+			}
+			else
+			{
+				memoryBuf.Reset(first, memoryLast);
+				memoryStream.clear();
+				if (tempBom == Details::Bom::Utf16BE)
+					reader = new Encoding::Utf16BEStreamReader(&memoryStream);
+				else if (tempBom == Details::Bom::Utf16LE)
+					reader = new Encoding::Utf16LEStreamReader(&memoryStream);
+				else if (tempBom == Details::Bom::Utf32BE)
+					reader = new Encoding::Utf32BEStreamReader(&memoryStream);
+				else // tempBom == Details::Bom::Utf32LE
+					reader = new Encoding::Utf32LEStreamReader(&memoryStream);
+			}
+			err = ErrorCode::None;
+			afterBom = true;
+			bom = tempBom;
+		}
+		else if (sourceType == SourceFd)
+		{
+			Details::Bom tempBom = Details::ReadBom(&fdStream);
+			if (tempBom == Details::Bom::StreamError)
+			{
+				SetError(ErrorCode::StreamError);
+				return;
+			}
+
+			if (tempBom == Details::Bom::Invalid)
+			{
+				SetError(ErrorCode::InvalidByteSequence);
+				eof = ((fdStream.rdstate() & std::istream::eofbit) != 0);
+				return;
+			}
+
+			if (tempBom == Details::Bom::None || tempBom == Details::Bom::Utf8)
+			{
+				// The most common case. Decode directly from the buffer.
+				reader = &fdReader;
+				eof = ((fdStream.rdstate() & std::istream::eofbit) != 0);
+				if (tempBom == Details::Bom::None)
+					SniffEncoding(fdBuf.GetFirst(), fdBuf.GetLast(), &fdStream);
+			}
+			else if (tempBom == Details::Bom::Utf16BE)
+				reader = new Encoding::Utf16BEStreamReader(&fdStream);
+			else if (tempBom == Details::Bom::Utf16LE)
+				reader = new Encoding::Utf16LEStreamReader(&fdStream);
+			else if (tempBom == Details::Bom::Utf32BE)
+				reader = new Encoding::Utf32BEStreamReader(&fdStream);
+			else // tempBom == Details::Bom::Utf32LE
+				reader = new Encoding::Utf32LEStreamReader(&fdStream);
+			err = ErrorCode::None;
+			afterBom = true;
+			bom = tempBom;
+		}
+		else if (sourceType == SourceReader)
+		{
+			err = ErrorCode::None;
+			afterBom = true;
+		}
+		else
+		{
+			SetError(ErrorCode::StreamError);
+		}
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseElement()
+	{
+		// currentCharacter == name start character.
+		// and
+		// currentCharacter != Colon.
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		if (unclosedTagsSize == 0 && foundElement)
+		{
+			tempRow = row;
+			tempColumn = column;
+			Stop();
+			SetError(ErrorCode::ElementOutside);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		PrepareNode();
+
+		// Element name.
+		do
+		{
+			WriteNameCharacters(name, localName);
+
+			if (NextCharBad(true))
+				return false;
+
+			if (currentCharacter == Colon)
+			{
+				// Prefixed name.
+				prefix = name;
+				localName.clear();
+				CharactersWriterType::WriteCharacter(name, currentCharacter);
+
+				if (NextCharBad(true))
+					return false;
+
+				if (currentCharacter == Colon ||
+					!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+				{
+					// row and column => '<'
+					tempRow = row;
+					tempColumn = column + 1;
+					Stop();
+					SetError(ErrorCode::InvalidTagName);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+
+				do
+				{
+					WriteNameCharacters(name, localName);
+
+					if (NextCharBad(true))
+						return false;
+
+					if (currentCharacter == Colon)
+					{
+						tempRow = row;
+						tempColumn = column + 1;
+						Stop();
+						SetError(ErrorCode::InvalidTagName);
+						row = tempRow;
+						column = tempColumn;
+						return false;
+					}
+				}
+				while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+				break;
+			}
+		}
+		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+
+		if (currentCharacter == GreaterThan)
+		{
+			node = Inspected::StartTag;
+			bool noErrors = NamespacesStuff();
+			if (noErrors)
+			{
+				UnclosedTagType& ref = NewUnclosedTag();
+				ref.Name = name;
+				ref.LocalName = localName;
+				ref.Prefix = prefix;
+				ref.NamespaceUri = namespaceUri;
+				ref.Row = row;
+				ref.Column = column;
+				foundElement = true;
+				return true;
+			}
+			return false;
+		}
+
+		if (currentCharacter == Slash)
+		{
+			// <tagName/
+			if (NextCharBad(true))
+				return false;
+			if (currentCharacter != GreaterThan)
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			node = Inspected::EmptyElementTag;
+			bool noErrors = NamespacesStuff();
+			if (noErrors)
+			{
+				foundElement = true;
+				return true;
+			}
+			return false;
+		}
+
+		if (IsWhiteSpace(currentCharacter))
+		{
+			// Ignore white spaces.
+			do
+			{
+				if (NextCharBad(true))
+					return false;
+			}
+			while (IsWhiteSpace(currentCharacter));
+
+			if (currentCharacter != Colon &&
+				Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+			{
+				// Attributes.
+				return ParseAttributes();
+			}
+
+			if (currentCharacter == Slash)
+			{
+				// <tagName /
+				if (NextCharBad(true))
+					return false;
+				if (currentCharacter != GreaterThan)
+				{
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+
+				node = Inspected::EmptyElementTag;
+				bool noErrors = NamespacesStuff();
+				if (noErrors)
+				{
+					foundElement = true;
+					return true;
+				}
+				return false;
+			}
+
+			if (currentCharacter == GreaterThan)
+			{
+				// <tagName >
+				node = Inspected::StartTag;
+				bool noErrors = NamespacesStuff();
+				if (noErrors)
+				{
+					UnclosedTagType& ref = NewUnclosedTag();
+					ref.Name = name;
+					ref.LocalName = localName;
+					ref.Prefix = prefix;
+					ref.NamespaceUri = namespaceUri;
+					ref.Row = row;
+					ref.Column = column;
+					foundElement = true;
+					return true;
+				}
+				return false;
+			}
+
+			if (Encoding::CharactersReader::IsNameChar(currentCharacter))
+			{
+				// For example <tagName 123attr="value">
+				// 1 is not allowed as a first character name.
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidAttributeName);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			// Invalid syntax.
+			// For example <tagName !abc...
+			// ! is not allowed as a part of the name.
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		// Invalid tag name.
+		tempRow = row;
+		tempColumn = column + 1;
+		Stop();
+		SetError(ErrorCode::InvalidTagName);
+		row = tempRow;
+		column = tempColumn;
+		return false;
+	}
+
+	
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseAttributes()
+	{
+		// IsNameStartChar(currentCharacter) == true
+		// and
+		// currentCharacter != Colon
+
+		SizeType tempRow;
+		SizeType tempColumn;
+		bool white = true;
+
+		do // {...} while (Encoding::CharactersReader::IsNameStartChar(currentCharacter));
+		{
+			AttributeType& attr = NewAttribute();
+			SavePosition(attr);
+
+			// attribute.Name, attribute.LocalName, attribute.Prefix.
+			do // {...} while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+			{
+				WriteNameCharacters(attr.Name, attr.LocalName);
+
+				if (NextCharBad(true))
+					return false;
+
+				if (currentCharacter == Colon)
+				{
+					// Prefixed name.
+					attr.Prefix = attr.Name;
+					attr.LocalName.clear();
+					CharactersWriterType::WriteCharacter(attr.Name, currentCharacter);
+
+					if (NextCharBad(true))
+						return false;
+
+					if (currentCharacter == Colon ||
+						!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+					{
+						Stop();
+						SetError(ErrorCode::InvalidAttributeName);
+						row = attr.Row;
+						column = attr.Column;
+						return false;
+					}
+
+					do // {...} while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+					{
+						WriteNameCharacters(attr.Name, attr.LocalName);
+
+						if (NextCharBad(true))
+							return false;
+
+						if (currentCharacter == Colon)
+						{
+							Stop();
+							SetError(ErrorCode::InvalidAttributeName);
+							row = attr.Row;
+							column = attr.Column;
+							return false;
+						}
+					}
+					while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+					break;
+				}
+			}
+			while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+
+			if (IsWhiteSpace(currentCharacter))
+			{
+				// Ignore white spaces.
+				do
+				{
+					if (NextCharBad(true))
+						return false;
+				}
+				while (IsWhiteSpace(currentCharacter));
+				white = true;
+			}
+			else
+			{
+				white = false;
+			}
+
+			if (currentCharacter != Equals)
+			{
+				if (white)
+				{
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+				Stop();
+				SetError(ErrorCode::InvalidAttributeName);
+				row = attr.Row;
+				column = attr.Column;
+				return false;
+			}
+
+			// attrname=
+			if (NextCharBad(true))
+				return false;
+
+			// Ignore white spaces.
+			while (IsWhiteSpace(currentCharacter))
+			{
+				if (NextCharBad(true))
+					return false;
+			}
+
+			char32_t quoteChar = currentCharacter;
+
+			if (quoteChar == DoubleQuote)
+			{
+				// attrname="
+				attr.Delimiter = QuotationMark::DoubleQuote;
+			}
+			else if (quoteChar == SingleQuote)
+			{
+				// attrname='
+				attr.Delimiter = QuotationMark::SingleQuote;
+			}
+			else
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			if (NextCharBad(true))
+				return false;
+
+			// attr.Value
+			while (currentCharacter != quoteChar)
+			{
+				if (currentCharacter == LessThan)
+				{
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+
+				if (currentCharacter == Ampersand)
+				{
+					if (NextCharBad(true))
+						return false;
+
+					if (currentCharacter == Hash)
+					{
+						// "&#"
+
+						char32_t codePoint;
+
+						if (!ParseCharacterReference(codePoint, true))
+							return false;
+
+						// currentCharacter == Semicolon.
+
+						WriteValueCharacter(attr.Value, codePoint);
+						if (NextCharBad(true))
+							return false;
+						continue; // while (currentCharacter != quoteChar) {...}
+					}
+					else if (currentCharacter != Colon &&
+						Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+					{
+						int resultParsing = ParseEntityReference(true);
+						if (resultParsing == -1)
+						{
+							// Error.
+							return false;
+						}
+						else if (resultParsing == 0)
+						{
+							// Unknown entity reference.
+							WriteValueCharacter(attr.Value, Ampersand);
+							attr.Value.append(entityName);
+							// Flushed by writing the ampersand.
+							entityName.clear();
+							WriteValueCharacter(attr.Value, Semicolon);
+							if (NextCharBad(true))
+								return false;
+							continue; // while (currentCharacter != quoteChar) {...}
+						}
+						else // resultParsing == 1.
+						{
+							// Predefined entity reference.
+							WriteValueCharacter(attr.Value, currentCharacter);
+							if (NextCharBad(true))
+								return false;
+							continue; // while (currentCharacter != quoteChar) {...}
+						}
+					}
+					else
+					{
+						SavePosition(tempRow, tempColumn, 1);
+						Stop();
+						SetError(ErrorCode::InvalidReferenceSyntax);
+						row = tempRow;
+						column = tempColumn;
+						return false;
+					}
+				}
+
+				if (!IsWhiteSpace(currentCharacter))
+					WriteCurrentCharacter(attr.Value);
+				else
+					WriteValueCharacter(attr.Value, Space);
+
+				const char32_t* run;
+				AppendRun(AttributeValueRun, attr.Value, run);
+
+				if (NextCharBad(true))
+					return false;
+			} // while (currentCharacter != quoteChar) {...}
+
+			// Attribute values are always copied to the public Value field.
+			FlushView();
+
+			// attrname="value"
+
+			if (!AttributeUniqueness())
+				return false;
+
+			if (NextCharBad(true))
+				return false;
+
+			if (IsWhiteSpace(currentCharacter))
+			{
+				// Ignore white spaces.
+				do
+				{
+					if (NextCharBad(true))
+						return false;
+				}
+				while (IsWhiteSpace(currentCharacter));
+				white = true;
+
+				if (currentCharacter == Colon)
+				{
+					Stop();
+					SetError(ErrorCode::InvalidAttributeName);
+					row = attr.Row;
+					column = attr.Column;
+					return false;
+				}
+			}
+			else
+			{
+				white = false;
+				break;
+			}
+		}
+		while (Encoding::CharactersReader::IsNameStartChar(currentCharacter));
+
+		if (currentCharacter == GreaterThan)
+		{
+			// attrname="value">
+			node = Inspected::StartTag;
+			bool noErrors = NamespacesStuff();
+			if (noErrors)
+			{
+				UnclosedTagType& ref = NewUnclosedTag();
+				ref.Name = name;
+				ref.LocalName = localName;
+				ref.Prefix = prefix;
+				ref.NamespaceUri = namespaceUri;
+				ref.Row = row;
+				ref.Column = column;
+				foundElement = true;
+				return true;
+			}
+			return false;
+		}
+		else if (currentCharacter == Slash)
+		{
+			// attrname="value"/
+			if (NextCharBad(true))
+				return false;
+			if (currentCharacter != GreaterThan)
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			node = Inspected::EmptyElementTag;
+			bool noErrors = NamespacesStuff();
+			if (noErrors)
+			{
+				// Namespaces associated with this tag are no longer needed.
+				SizeType indicesToRemove = static_cast<SizeType>(unclosedTagsSize);
+				NamespacesSizeType newNamespacesSize = 0;
+				while (newNamespacesSize < namespacesSize)
+				{
+					if (namespaces[newNamespacesSize].TagIndex == indicesToRemove)
+						break;
+					++newNamespacesSize;
+				}
+				namespacesSize = newNamespacesSize;
+				foundElement = true;
+				return true;
+			}
+			return false;
+		}
+		else // Some error.
+		{
+			if (white && Encoding::CharactersReader::IsNameChar(currentCharacter))
+			{
+				// After white space, cannot be a start character of attribute name,
+				// but can be a part of this name. Something like:
+				// <tag 123attrName="value">. "1" is not allowed as the start character.
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidAttributeName);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseEndTag()
+	{
+		// currentCharacter == Slash.
+		if (NextCharBad(true))
+			return false;
+
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		if (currentCharacter == Colon)
+		{
+			// row and column => '<'
+			tempRow = row;
+			tempColumn = column + 2;
+			Stop();
+			SetError(ErrorCode::InvalidTagName);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+		else if (!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+		{
+			tempRow = row;
+			tempColumn = column + 2;
+			if (Encoding::CharactersReader::IsNameChar(currentCharacter))
+			{
+				// Not allowed as start character of the name,
+				// but allowed as a part of this name.
+				Stop();
+				SetError(ErrorCode::InvalidTagName);
+			}
+			else
+			{
+				// Some weird character.
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+			}
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		PrepareNode();
+
+		// End element name.
+		do
+		{
+			WriteNameCharacters(name, localName);
+
+			if (NextCharBad(true))
+				return false;
+
+			if (currentCharacter == Colon)
+			{
+				// Prefixed name.
+				prefix = name;
+				localName.clear();
+				CharactersWriterType::WriteCharacter(name, currentCharacter);
+
+				if (NextCharBad(true))
+					return false;
+
+				if (currentCharacter == Colon ||
+					!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+				{
+					tempRow = row;
+					tempColumn = column + 2;
+					Stop();
+					SetError(ErrorCode::InvalidTagName);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+
+				do
+				{
+					WriteNameCharacters(name, localName);
+
+					if (NextCharBad(true))
+						return false;
+
+					if (currentCharacter == Colon)
+					{
+						tempRow = row;
+						tempColumn = column + 2;
+						Stop();
+						SetError(ErrorCode::InvalidTagName);
+						row = tempRow;
+						column = tempColumn;
+						return false;
+					}
+				}
+				while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+				break;
+			}
+		}
+		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+
+		if (IsWhiteSpace(currentCharacter))
+		{
+			// Ignore white spaces.
+			do
+			{
+				if (NextCharBad(true))
+					return false;
+			}
+			while (IsWhiteSpace(currentCharacter));
+
+			if (currentCharacter != GreaterThan)
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+		}
+		else if (currentCharacter != GreaterThan)
+		{
+			tempRow = row;
+			tempColumn = column + 2;
+			Stop();
+			SetError(ErrorCode::InvalidTagName);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		if (unclosedTagsSize == 0 ||
+			unclosedTags[unclosedTagsSize - 1].Name != name)
+		{
+			tempRow = row;
+			tempColumn = column;
+			Stop();
+			SetError(ErrorCode::UnexpectedEndTag);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+		namespaceUri = unclosedTags[unclosedTagsSize - 1].NamespaceUri;
+
+		// Tag is closed.
+		--unclosedTagsSize;
+
+		// Namespaces associated with this tag are no longer needed.
+		SizeType indicesToRemove = static_cast<SizeType>(unclosedTagsSize);
+		NamespacesSizeType newNamespacesSize = 0;
+		while (newNamespacesSize < namespacesSize)
+		{
+			if (namespaces[newNamespacesSize].TagIndex == indicesToRemove)
+				break;
+			++newNamespacesSize;
+		}
+		namespacesSize = newNamespacesSize;
+		node = Inspected::EndTag;
+		return true;
 	}
 
-	template <typename TCharactersWriter>
-	inline Inspector<TCharactersWriter>::Inspector(const std::string& filePath)
-		: row(0),
-		column(0),
-		currentRow(0),
-		currentColumn(0),
-		node(Inspected::None),
-		err(ErrorCode::None),
-		errMsg(nullptr),
-		fPath(),
-		fileStream(),
-		inputStreamPtr(nullptr),
-		reader(nullptr),
-		sourceType(SourceNone),
-		afterBom(false),
-		bom(Details::Bom::None),
-		name(),
-		value(),
-		localName(),
-		prefix(),
-		namespaceUri(),
-		entityName(),
-		comparingName(),
-		entityNameCharCount(0),
-		currentCharacter(0),
-		bufferedCharacter(0),
-		foundElement(false),
-		foundDOCTYPE(false),
-		eof(false),
-		lowerXmlString(),
-		xmlnsString(),
-		xmlUriString(),
-		xmlnsUriString(),
-		attributes(),
-		attributesSize(0),
-		unclosedTags(),
-		unclosedTagsSize(0),
-		namespaces(),
-		namespacesSize(0)
-	{
-		InitStrings();
-		Reset(filePath);
-	}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseText()
+	{
+		// currentCharacter == first character of text.
+
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		PrepareNode();
+
+		if (IsWhiteSpace(currentCharacter))
+		{
+			do
+			{
+				WriteCurrentCharacter(value);
+				
+				if (NextCharBad(false))
+				{
+					if (eof)
+					{
+						if (unclosedTagsSize != 0)
+						{
+							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+							Stop();
+							SetError(ErrorCode::UnclosedTag);
+							row = ref.Row;
+							column = ref.Column;
+							eof = true;
+							return false;
+						}
+
+						node = Inspected::Whitespace;
+						return true;
+					}
+					return false;
+				}
+			}
+			while (IsWhiteSpace(currentCharacter));
+
+			if (currentCharacter == LessThan)
+			{
+				node = Inspected::Whitespace;
+				return true;
+			}
+		}
+
+		if (unclosedTagsSize == 0)
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		bool onlyWhite = true;
+		do
+		{
+			if (currentCharacter == Ampersand)
+			{
+				entityByteOffset = currentByteOffset;
+				if (NextCharBad(false))
+				{
+					if (eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return false;
+				}
+
+				if (currentCharacter == Hash)
+				{
+					// "&#"
+
+					char32_t codePoint;
+
+					if (!ParseCharacterReference(codePoint, false))
+						return false;
+
+					// currentCharacter == Semicolon.
+
+					if (!Encoding::CharactersReader::IsWhiteSpace(codePoint))
+						onlyWhite = false;
+					WriteValueCharacter(value, codePoint);
+					if (NextCharBad(false))
+					{
+						if (eof)
+						{
+							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+							Stop();
+							SetError(ErrorCode::UnclosedTag);
+							row = ref.Row;
+							column = ref.Column;
+							eof = true;
+						}
+						return false;
+					}
+					continue;
+				}
+				else if (currentCharacter != Colon &&
+					Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+				{
+					int resultParsing = ParseEntityReference(false);
+					if (resultParsing == -1)
+					{
+						// Error.
+						return false;
+					}
+					else if (resultParsing == 0)
+					{
+						// Unknown entity reference.
+						if (value.empty() && viewString != &value)
+						{
+							name = entityName;
+							localName = entityName;
+							entityName.clear();
+							node = Inspected::EntityReference;
+							return true;
+						}
+						else
+						{
+							// entityName field is set,
+							// but first I must return some text.
+							if (onlyWhite)
+								node = Inspected::Whitespace;
+							else
+								node = Inspected::Text;
+							return true;
+						}
+					}
+					else // resultParsing == 1.
+					{
+						// Predefined entity reference.
+						onlyWhite = false;
+						WriteValueCharacter(value, currentCharacter);
+						if (NextCharBad(false))
+						{
+							if (eof)
+							{
+								UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+								Stop();
+								SetError(ErrorCode::UnclosedTag);
+								row = ref.Row;
+								column = ref.Column;
+								eof = true;
+							}
+							return false;
+						}
+						continue;
+					}
+				}
+				else
+				{
+					SavePosition(tempRow, tempColumn, 1);
+					Stop();
+					SetError(ErrorCode::InvalidReferenceSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+			}
+
+			if (currentCharacter == RightSquareBracket)
+			{
+				// "]]>" is not allowed here.
+				SizeType bracketCount = 0;
+				onlyWhite = false;
+				do
+				{
+					++bracketCount;
+					WriteCurrentCharacter(value);
+
+					if (NextCharBad(false))
+					{
+						if (eof)
+						{
+							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+							Stop();
+							SetError(ErrorCode::UnclosedTag);
+							row = ref.Row;
+							column = ref.Column;
+							eof = true;
+						}
+						return false;
+					}
+				}
+				while (currentCharacter == RightSquareBracket);
 
-	template <typename TCharactersWriter>
-	inline Inspector<TCharactersWriter>::Inspector(std::istream* inputStream)
-		: row(0),
-		column(0),
-		currentRow(0),
-		currentColumn(0),
-		node(Inspected::None),
-		err(ErrorCode::None),
-		errMsg(nullptr),
-		fPath(),
-		fileStream(),
-		inputStreamPtr(nullptr),
-		reader(nullptr),
-		sourceType(SourceNone),
-		afterBom(false),
-		bom(Details::Bom::None),
-		name(),
-		value(),
-		localName(),
-		prefix(),
-		namespaceUri(),
-		entityName(),
-		comparingName(),
-		entityNameCharCount(0),
-		currentCharacter(0),
-		bufferedCharacter(0),
-		foundElement(false),
-		foundDOCTYPE(false),
-		eof(false),
-		lowerXmlString(),
-		xmlnsString(),
-		xmlUriString(),
-		xmlnsUriString(),
-		attributes(),
-		attributesSize(0),
-		unclosedTags(),
-		unclosedTagsSize(0),
-		namespaces(),
-		namespacesSize(0)
-	{
-		InitStrings();
-		Reset(inputStream);
+				if (currentCharacter == GreaterThan && bracketCount > 1)
+				{
+					SavePosition(tempRow, tempColumn, 2);
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
+				}
+				continue;
+			}
+
+			if (!IsWhiteSpace(currentCharacter))
+				onlyWhite = false;
+			WriteCurrentCharacter(value);
+
+			const char32_t* run;
+			std::size_t runLength = AppendRun(TextRun, value, run);
+			for (std::size_t i = 0; onlyWhite && i < runLength; ++i)
+			{
+				if (!IsWhiteSpace(run[i]))
+					onlyWhite = false;
+			}
+
+			if (NextCharBad(false))
+			{
+				if (eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
+				return false;
+			}
+		}
+		while (currentCharacter != LessThan);
+
+		if (!onlyWhite)
+			node = Inspected::Text;
+		else
+			node = Inspected::Whitespace;
+
+		return true;
 	}
 
-	template <typename TCharactersWriter>
-	template <typename TInputIterator>
-	inline Inspector<TCharactersWriter>::Inspector(
-		TInputIterator first, TInputIterator last)
-		: row(0),
-		column(0),
-		currentRow(0),
-		currentColumn(0),
-		node(Inspected::None),
-		err(ErrorCode::None),
-		errMsg(nullptr),
-		fPath(),
-		fileStream(),
-		inputStreamPtr(nullptr),
-		reader(nullptr),
-		sourceType(SourceNone),
-		afterBom(false),
-		bom(Details::Bom::None),
-		name(),
-		value(),
-		localName(),
-		prefix(),
-		namespaceUri(),
-		entityName(),
-		comparingName(),
-		entityNameCharCount(0),
-		currentCharacter(0),
-		bufferedCharacter(0),
-		foundElement(false),
-		foundDOCTYPE(false),
-		eof(false),
-		lowerXmlString(),
-		xmlnsString(),
-		xmlUriString(),
-		xmlnsUriString(),
-		attributes(),
-		attributesSize(0),
-		unclosedTags(),
-		unclosedTagsSize(0),
-		namespaces(),
-		namespacesSize(0)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseQuestion()
 	{
-		InitStrings();
-		Reset(first, last);
-	}
+		// currentCharacter == Question.
+		// XmlDeclaration or ProcessingInstruction.
+
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		PrepareNode();
+
+		// '<?'
+		if (NextCharBad(true))
+			return false;
+		if (currentCharacter == LowerXml[0] ||
+			currentCharacter == UpperXml[0])
+		{
+			// '<?' ('X' | 'x')
+			CharactersWriterType::WriteCharacter(name, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+			if (currentCharacter == LowerXml[1] ||
+				currentCharacter == UpperXml[1])
+			{
+				// '<?' ('X' | 'x') ('M' | 'm')
+				CharactersWriterType::WriteCharacter(name, currentCharacter);
+				if (NextCharBad(true))
+					return false;
+				if (currentCharacter == LowerXml[2] ||
+					currentCharacter == UpperXml[2])
+				{
+					// '<?' ('X' | 'x') ('M' | 'm') ('L' | 'l')
+					CharactersWriterType::WriteCharacter(name, currentCharacter);
+					if (NextCharBad(true))
+						return false;
+
+					if (name == lowerXmlString)
+					{
+						// '<?xml' Char
+						if (IsWhiteSpace(currentCharacter))
+						{
+							// '<?xml '
+							localName = name;
+							return ParseXmlDeclaration();	
+						}
+					}
+
+					if (currentCharacter == Colon ||
+						!Encoding::CharactersReader::IsNameChar(currentCharacter))
+					{
+						tempRow = currentRow;
+						tempColumn = currentColumn;
+						Stop();
+						SetError(ErrorCode::InvalidSyntax);
+						row = tempRow;
+						column = tempColumn;
+						return false;
+					}
+				}
+			}
+		}
+		else if (currentCharacter == Colon ||
+			!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+		else
+		{
+			// '<?' (NameStartChar - ':')
+			CharactersWriterType::WriteCharacter(name, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+		}
+
+		while (currentCharacter != Colon &&
+			Encoding::CharactersReader::IsNameChar(currentCharacter))
+		{
+			CharactersWriterType::WriteCharacter(name, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+		}
 
-	template <typename TCharactersWriter>
-	inline Inspector<TCharactersWriter>::Inspector(Encoding::CharactersReader* reader)
-		: row(0),
-		column(0),
-		currentRow(0),
-		currentColumn(0),
-		node(Inspected::None),
-		err(ErrorCode::None),
-		errMsg(nullptr),
-		fPath(),
-		fileStream(),
-		inputStreamPtr(nullptr),
-		reader(nullptr),
-		sourceType(SourceNone),
-		afterBom(false),
-		bom(Details::Bom::None),
-		name(),
-		value(),
-		localName(),
-		prefix(),
-		namespaceUri(),
-		entityName(),
-		comparingName(),
-		entityNameCharCount(0),
-		currentCharacter(0),
-		bufferedCharacter(0),
-		foundElement(false),
-		foundDOCTYPE(false),
-		eof(false),
-		lowerXmlString(),
-		xmlnsString(),
-		xmlUriString(),
-		xmlnsUriString(),
-		attributes(),
-		attributesSize(0),
-		unclosedTags(),
-		unclosedTagsSize(0),
-		namespaces(),
-		namespacesSize(0)
-	{
-		InitStrings();
-		Reset(reader);
-	}
+		// '<?' PITarget (':' | (Char - NameChar))
 
-	template <typename TCharactersWriter>
-	inline Inspector<TCharactersWriter>::~Inspector()
-	{
-		Reset();
+		return ParseProcessingInstruction();
 	}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::SetError(ErrorCode errorCode)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseXmlDeclaration()
 	{
-		err = errorCode;
-		if (errorCode != ErrorCode::None)
+		// '<?xml '
+
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		if (GetRow() != 1 || GetColumn() != 1)
 		{
-			switch (errorCode)
+			tempRow = row;
+			tempColumn = column;
+			Stop();
+			SetError(ErrorCode::InvalidXmlDeclarationLocation);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		// Ignore white spaces.
+		do
+		{
+			if (NextCharBad(true))
+				return false;
+		}
+		while (IsWhiteSpace(currentCharacter));
+
+		AttributeType& versionAttr = NewAttribute();
+		SavePosition(versionAttr);
+
+		for (std::size_t i = 0; i < 7; ++i)
+		{
+			if (currentCharacter != XmlDeclarationVersion[i])
 			{
-				case ErrorCode::StreamError:
-					errMsg = "Stream error has occurred.";
-					return;
-				case ErrorCode::InvalidByteSequence:
-					errMsg = "Invalid byte sequence.";
-					return;
-				case ErrorCode::UnknownEncoding:
-					errMsg = "Unknown encoding.";
-					return;
-				case ErrorCode::EncodingConfusion:
-					errMsg = "Encoding confusion.";
-					return;
-				case ErrorCode::EncodingDeclarationRequired:
-					errMsg = "Encoding declaration must precede content that is not "
-						"a legal UTF-8 or UTF-16.";
-					return;
-				case ErrorCode::InvalidSyntax:
-					errMsg = "Invalid syntax.";
-					return;
-				case ErrorCode::InvalidXmlDeclarationLocation:
-					errMsg = "Invalid location of XML declaration.";
-					return;
-				case ErrorCode::CDataSectionOutside:
-					errMsg = "CDATA section is outside a root element.";
-					return;
-				case ErrorCode::ElementOutside:
-					errMsg = "Element is outside a root element.";
-					return;
-				case ErrorCode::InvalidDocumentTypeDeclarationLocation:
-					errMsg = "Invalid location of document type declaration.";
-					return;
-				case ErrorCode::DoubleDocumentTypeDeclaration:
-					errMsg = "There should be exactly one document type declaration.";
-					return;
-				case ErrorCode::InvalidTagName:
-					errMsg = "Invalid tag name.";
-					return;
-				case ErrorCode::InvalidAttributeName:
-					errMsg = "Invalid attribute name.";
-					return;
-				case ErrorCode::UnclosedToken:
-					errMsg = "Unclosed token.";
-					return;
-				case ErrorCode::InvalidReferenceSyntax:
-					errMsg = "Invalid syntax of reference.";
-					return;
-				case ErrorCode::InvalidCharacterReference:
-					errMsg = "Code point in character reference doesn\'t match "
-						"the valid character in ISO/IEC 10646 character set.";
-					return;
-				case ErrorCode::UnexpectedEndTag:
-					errMsg = "Unexpected end tag.";
-					return;
-				case ErrorCode::UnclosedTag:
-					errMsg = "Unclosed tag.";
-					return;
-				case ErrorCode::NoElement:
-					errMsg = "Cannot find an element.";
-					return;
-				case ErrorCode::DoubleAttributeName:
-					errMsg = "An attribute name must not appear more than "
-						"once in the same start-tag or empty-element tag.";
-					return;
-				case ErrorCode::PrefixWithoutAssignedNamespace:
-					errMsg = "Name prefix must bound to the namespace URI.";
-					return;
-				case ErrorCode::PrefixWithEmptyNamespace:
-					errMsg = "Namespace declaration with prefix cannot have an empty value.";
-					return;
-				case ErrorCode::XmlnsDeclared:
-					errMsg = "Reserved xmlns prefix cannot be declared or set to an empty value.";
-					return;
-				case ErrorCode::PrefixBoundToReservedNamespace:
-					errMsg = "Prefix is bound to reserved namespace.";
-					return;
-				case ErrorCode::ReservedNamespaceAsDefault:
-					errMsg = "Reserved namespace cannot be declared as a default namespace.";
-					return;
-				case ErrorCode::InvalidXmlPrefixDeclaration:
-					errMsg = "Prefix \'xml\' is reserved for use by XML and has a fixed "
-						"namespace URI http://www.w3.org/XML/1998/namespace.";
-					return;
-				default:
-					errMsg = "XML error has occurred.";
-					return;
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
 			}
+			CharactersWriterType::WriteCharacter(versionAttr.Name, currentCharacter);
+			CharactersWriterType::WriteCharacter(versionAttr.LocalName, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+		}
+
+		// '<?xml version' Char
+		
+		while (IsWhiteSpace(currentCharacter))
+		{
+			if (NextCharBad(true))
+				return false;
+		}
+
+		if (currentCharacter != Equals)
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		// '<?xml version='
+
+		if (NextCharBad(true))
+			return false;
+
+		while (IsWhiteSpace(currentCharacter))
+		{
+			if (NextCharBad(true))
+				return false;
+		}
+
+		char32_t quoteChar = currentCharacter;
+
+		if (quoteChar == DoubleQuote)
+		{
+			// <?xml version="
+			versionAttr.Delimiter = QuotationMark::DoubleQuote;
+		}
+		else if (quoteChar == SingleQuote)
+		{
+			// <?xml version='
+			versionAttr.Delimiter = QuotationMark::SingleQuote;
+		}
+		else
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		if (NextCharBad(true))
+			return false;
+
+		// Now should be:
+		// '1.' [0-9]+
+
+		if (Encoding::CharactersReader::GetHexDigitValue(currentCharacter) != 1)
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		// <?xml version="1
+		CharactersWriterType::WriteCharacter(versionAttr.Value, currentCharacter);
+
+		if (NextCharBad(true))
+			return false;
+
+		if (currentCharacter != Dot)
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
 		}
-		errMsg = nullptr;
-	}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::ParseBom()
-	{
-		if (sourceType == SourcePath)
+		// <?xml version="1.
+		CharactersWriterType::WriteCharacter(versionAttr.Value, currentCharacter);
+
+		if (NextCharBad(true))
+			return false;
+
+		int digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
+
+		if (digit < 0 || digit > 9)
 		{
-			fileStream.open(fPath.c_str(), std::ifstream::binary);
-			if (!fileStream.is_open())
+			// After a dot should be at least one digit.
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		do
+		{
+			CharactersWriterType::WriteCharacter(versionAttr.Value, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+			digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
+		}
+		while (digit >= 0 && digit <= 9);
+
+		if (currentCharacter != quoteChar)
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		// <?xml version="1.x"
+
+		if (NextCharBad(true))
+			return false;
+
+		if (IsWhiteSpace(currentCharacter))
+		{
+			do
 			{
-				fileStream.clear();
-				SetError(ErrorCode::StreamError);
-				return;
+				if (NextCharBad(true))
+					return false;
 			}
+			while (IsWhiteSpace(currentCharacter));
 
-			Details::Bom tempBom = Details::ReadBom(&fileStream);
-			if (tempBom == Details::Bom::None || tempBom == Details::Bom::Utf8)
+			if (currentCharacter == Question)
 			{
-				try
+				// <?xml version="1.x"   ?
+				if (NextCharBad(true))
+					return false;
+
+				if (currentCharacter != GreaterThan)
 				{
-					reader = new Encoding::Utf8StreamReader(&fileStream);
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
 				}
-				catch (...)
+
+				// <?xml version="1.x"   ?>
+				if (sourceType != SourceReader &&
+					bom != Details::Bom::None &&
+					bom != Details::Bom::Utf8 &&
+					bom != Details::Bom::Utf16BE &&
+					bom != Details::Bom::Utf16LE)
 				{
-					fileStream.close();
-					fileStream.clear();
-					throw;
+					Stop();
+					SetError(ErrorCode::EncodingDeclarationRequired);
+					row = 1;
+					column = 1;
+					return false;
 				}
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
-				eof = ((fileStream.rdstate() & std::istream::eofbit) != 0);
-				return;
+
+				node = Inspected::XmlDeclaration;
+				return true;
+			}
+		}
+		else // IsWhiteSpace(currentCharacter) == false
+		{
+			if (currentCharacter != Question)
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
 			}
 
-			if (tempBom == Details::Bom::StreamError)
+			// <?xml version="1.x"?
+			if (NextCharBad(true))
+				return false;
+
+			if (currentCharacter != GreaterThan)
 			{
-				fileStream.close();
-				fileStream.clear();
-				SetError(ErrorCode::StreamError);
-				return;
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
 			}
 
-			if (tempBom == Details::Bom::Invalid)
+			// <?xml version="1.x"?>
+			if (sourceType != SourceReader &&
+				bom != Details::Bom::None &&
+				bom != Details::Bom::Utf8 &&
+				bom != Details::Bom::Utf16BE &&
+				bom != Details::Bom::Utf16LE)
 			{
-				fileStream.close();
-				fileStream.clear();
-				SetError(ErrorCode::InvalidByteSequence);
-				eof = ((fileStream.rdstate() & std::istream::eofbit) != 0);
-				return;
+				Stop();
+				SetError(ErrorCode::EncodingDeclarationRequired);
+				row = 1;
+				column = 1;
+				return false;
 			}
 
-			if (tempBom == Details::Bom::Utf16BE)
+			node = Inspected::XmlDeclaration;
+			return true;
+		}
+
+		// Now should be an encoding or standalone attribute.
+		if (currentCharacter == XmlDeclarationEncoding[0])
+		{
+			// encoding
+			AttributeType& encodingAttr = NewAttribute();
+			SavePosition(encodingAttr);
+			comparingName.clear(); // Could be not empty after call of Reset method.
+			comparingName.reserve(NameReserve);
+
+			for (std::size_t i = 0; i < 8; ++i)
 			{
-				try
-				{
-					reader = new Encoding::Utf16BEStreamReader(&fileStream);
-				}
-				catch (...)
+				if (currentCharacter != XmlDeclarationEncoding[i])
 				{
-					fileStream.close();
-					fileStream.clear();
-					throw;
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
 				}
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
+				CharactersWriterType::WriteCharacter(encodingAttr.Name, currentCharacter);
+				CharactersWriterType::WriteCharacter(encodingAttr.LocalName, currentCharacter);
+				if (NextCharBad(true))
+					return false;
 			}
-			else if (tempBom == Details::Bom::Utf16LE)
+
+			// '<?xml version="1.x" encoding' Char
+			
+			while (IsWhiteSpace(currentCharacter))
 			{
-				try
-				{
-					reader = new Encoding::Utf16LEStreamReader(&fileStream);
-				}
-				catch (...)
-				{
-					fileStream.close();
-					fileStream.clear();
-					throw;
-				}
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
+				if (NextCharBad(true))
+					return false;
+			}
+
+			if (currentCharacter != Equals)
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			// '<?xml version="1.x" encoding='
+
+			if (NextCharBad(true))
+				return false;
+
+			while (IsWhiteSpace(currentCharacter))
+			{
+				if (NextCharBad(true))
+					return false;
+			}
+
+			quoteChar = currentCharacter;
+
+			if (quoteChar == DoubleQuote)
+			{
+				// <?xml version="1.x" encoding="
+				encodingAttr.Delimiter = QuotationMark::DoubleQuote;
+			}
+			else if (quoteChar == SingleQuote)
+			{
+				// <?xml version="1.x" encoding='
+				encodingAttr.Delimiter = QuotationMark::SingleQuote;
+			}
+			else
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			if (NextCharBad(true))
+				return false;
+
+			if (!Encoding::CharactersReader::IsEncNameStartChar(currentCharacter))
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			do
+			{
+				CharactersWriterType::WriteCharacter(encodingAttr.Value, currentCharacter);
+				comparingName.push_back(currentCharacter);
+				if (NextCharBad(true))
+					return false;
 			}
-			else if (tempBom == Details::Bom::Utf32BE)
+			while (Encoding::CharactersReader::IsEncNameChar(currentCharacter));
+
+			if (currentCharacter != quoteChar)
 			{
-				try
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			// '<?xml' VersionInfo EncodingDecl
+			if (sourceType != SourceReader && !ResolveEncoding(encodingAttr))
+				return false;
+			if (NextCharBad(true))
+				return false;
+			
+			if (IsWhiteSpace(currentCharacter))
+			{
+				do
 				{
-					reader = new Encoding::Utf32BEStreamReader(&fileStream);
+					if (NextCharBad(true))
+						return false;
 				}
-				catch (...)
+				while (IsWhiteSpace(currentCharacter));
+
+				if (currentCharacter == Question)
 				{
-					fileStream.close();
-					fileStream.clear();
-					throw;
+					// '<?xml' VersionInfo EncodingDecl S '?'
+					if (NextCharBad(true))
+						return false;
+
+					if (currentCharacter != GreaterThan)
+					{
+						tempRow = currentRow;
+						tempColumn = currentColumn;
+						Stop();
+						SetError(ErrorCode::InvalidSyntax);
+						row = tempRow;
+						column = tempColumn;
+						return false;
+					}
+
+					// '<?xml' VersionInfo EncodingDecl S '?>'
+					node = Inspected::XmlDeclaration;
+					return true;
 				}
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
 			}
-			else if (tempBom == Details::Bom::Utf32LE)
+			else // IsWhiteSpace(currentCharacter) == false
 			{
-				try
+				if (currentCharacter != Question)
 				{
-					reader = new Encoding::Utf32LEStreamReader(&fileStream);
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
 				}
-				catch (...)
+
+				if (NextCharBad(true))
+					return false;
+
+				if (currentCharacter != GreaterThan)
 				{
-					fileStream.close();
-					fileStream.clear();
-					throw;
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
+					row = tempRow;
+					column = tempColumn;
+					return false;
 				}
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
+
+				// '<?xml' VersionInfo EncodingDecl '?>'
+				node = Inspected::XmlDeclaration;
+				return true;
 			}
 		}
-		else if (sourceType == SourceStream || sourceType == SourceIterators)
+		else
 		{
-			Details::Bom tempBom = Details::ReadBom(inputStreamPtr);
-			if (tempBom == Details::Bom::None || tempBom == Details::Bom::Utf8)
+			if (sourceType != SourceReader &&
+				bom != Details::Bom::None &&
+				bom != Details::Bom::Utf8 &&
+				bom != Details::Bom::Utf16BE &&
+				bom != Details::Bom::Utf16LE)
 			{
-				reader = new Encoding::Utf8StreamReader(inputStreamPtr);
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
-				eof = ((inputStreamPtr->rdstate() & std::istream::eofbit) != 0);
-				return;
+				Stop();
+				SetError(ErrorCode::EncodingDeclarationRequired);
+				row = 1;
+				column = 1;
+				return false;
 			}
+		}
 
-			if (tempBom == Details::Bom::StreamError)
-			{
-				SetError(ErrorCode::StreamError);
-				return;
-			}
+		// Now should be a standalone attribute.
+		AttributeType& standaloneAttr = NewAttribute();
+		SavePosition(standaloneAttr);
 
-			if (tempBom == Details::Bom::Invalid)
+		for (std::size_t i = 0; i < 10; ++i)
+		{
+			if (currentCharacter != XmlDeclarationStandalone[i])
 			{
-				SetError(ErrorCode::InvalidByteSequence);
-				eof = ((inputStreamPtr->rdstate() & std::istream::eofbit) != 0);
-				return;
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
 			}
+			CharactersWriterType::WriteCharacter(standaloneAttr.Name, currentCharacter);
+			CharactersWriterType::WriteCharacter(standaloneAttr.LocalName, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+		}
 
-			if (tempBom == Details::Bom::Utf16BE)
-			{
-				reader = new Encoding::Utf16BEStreamReader(inputStreamPtr);
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
-			}
-			else if (tempBom == Details::Bom::Utf16LE)
-			{
-				reader = new Encoding::Utf16LEStreamReader(inputStreamPtr);
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
-			}
-			else if (tempBom == Details::Bom::Utf32BE)
-			{
-				reader = new Encoding::Utf32BEStreamReader(inputStreamPtr);
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
-			}
-			else if (tempBom == Details::Bom::Utf32LE)
-			{
-				reader = new Encoding::Utf32LEStreamReader(inputStreamPtr);
-				err = ErrorCode::None;
-				afterBom = true;
-				bom = tempBom;
-			}
+		// '<?xml' VersionInfo EncodingDecl S 'standalone' Char
+		
+		while (IsWhiteSpace(currentCharacter))
+		{
+			if (NextCharBad(true))
+				return false;
 		}
-		else if (sourceType == SourceReader)
+
+		if (currentCharacter != Equals)
 		{
-			err = ErrorCode::None;
-			afterBom = true;
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
 		}
-		else
+
+		// '<?xml' VersionInfo EncodingDecl S 'standalone' S? '='
+
+		if (NextCharBad(true))
+			return false;
+
+		while (IsWhiteSpace(currentCharacter))
 		{
-			SetError(ErrorCode::StreamError);
+			if (NextCharBad(true))
+				return false;
 		}
-	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseElement()
-	{
-		// currentCharacter == name start character.
-		// and
-		// currentCharacter != Colon.
-		SizeType tempRow = currentRow;
-		SizeType tempColumn = currentColumn;
+		quoteChar = currentCharacter;
 
-		if (unclosedTagsSize == 0 && foundElement)
+		if (quoteChar == DoubleQuote)
 		{
-			tempRow = row;
-			tempColumn = column;
-			Reset();
-			SetError(ErrorCode::ElementOutside);
+			// '<?xml' VersionInfo EncodingDecl S 'standalone' Eq '"'
+			standaloneAttr.Delimiter = QuotationMark::DoubleQuote;
+		}
+		else if (quoteChar == SingleQuote)
+		{
+			// '<?xml' VersionInfo EncodingDecl S 'standalone' Eq "'"
+			standaloneAttr.Delimiter = QuotationMark::SingleQuote;
+		}
+		else
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
 
-		PrepareNode();
+		if (NextCharBad(true))
+			return false;
+
+		if (currentCharacter == Yes[0])
+		{
+			CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+			if (currentCharacter == Yes[1])
+			{
+				CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
+				if (NextCharBad(true))
+					return false;
+				if (currentCharacter == Yes[2])
+				{
+					CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
+					if (NextCharBad(true))
+						return false;
+					if (currentCharacter == quoteChar)
+					{
+						// '<?xml' VersionInfo EncodingDecl SDDecl
+						if (NextCharBad(true))
+							return false;
+						while (IsWhiteSpace(currentCharacter))
+						{
+							if (NextCharBad(true))
+								return false;
+						}
+						if (currentCharacter != Question)
+						{
+							tempRow = currentRow;
+							tempColumn = currentColumn;
+							Stop();
+							SetError(ErrorCode::InvalidSyntax);
+							row = tempRow;
+							column = tempColumn;
+							return false;
+						}
+						if (NextCharBad(true))
+							return false;
+						if (currentCharacter != GreaterThan)
+						{
+							tempRow = currentRow;
+							tempColumn = currentColumn;
+							Stop();
+							SetError(ErrorCode::InvalidSyntax);
+							row = tempRow;
+							column = tempColumn;
+							return false;
+						}
 
-		// Element name.
-		do
+						// '<?xml' VersionInfo EncodingDecl SDDecl '?>'
+						node = Inspected::XmlDeclaration;
+						return true;
+					}
+				}
+			}
+		}
+		else if (currentCharacter == No[0])
 		{
-			CharactersWriterType::WriteCharacter(name, currentCharacter);
-			CharactersWriterType::WriteCharacter(localName, currentCharacter);
-
+			CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
 			if (NextCharBad(true))
 				return false;
-
-			if (currentCharacter == Colon)
+			if (currentCharacter == No[1])
 			{
-				// Prefixed name.
-				prefix = name;
-				localName.clear();
-				CharactersWriterType::WriteCharacter(name, currentCharacter);
-
+				CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
 				if (NextCharBad(true))
 					return false;
-
-				if (currentCharacter == Colon ||
-					!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
-				{
-					Reset();
-					SetError(ErrorCode::InvalidTagName);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
-
-				do
+				if (currentCharacter == quoteChar)
 				{
-					CharactersWriterType::WriteCharacter(name, currentCharacter);
-					CharactersWriterType::WriteCharacter(localName, currentCharacter);
-
+					// '<?xml' VersionInfo EncodingDecl SDDecl
 					if (NextCharBad(true))
 						return false;
-
-					if (currentCharacter == Colon)
+					while (IsWhiteSpace(currentCharacter))
 					{
-						Reset();
-						SetError(ErrorCode::InvalidTagName);
+						if (NextCharBad(true))
+							return false;
+					}
+					if (currentCharacter != Question)
+					{
+						tempRow = currentRow;
+						tempColumn = currentColumn;
+						Stop();
+						SetError(ErrorCode::InvalidSyntax);
+						row = tempRow;
+						column = tempColumn;
+						return false;
+					}
+					if (NextCharBad(true))
+						return false;
+					if (currentCharacter != GreaterThan)
+					{
+						tempRow = currentRow;
+						tempColumn = currentColumn;
+						Stop();
+						SetError(ErrorCode::InvalidSyntax);
 						row = tempRow;
 						column = tempColumn;
 						return false;
 					}
+
+					// '<?xml' VersionInfo EncodingDecl SDDecl '?>'
+					node = Inspected::XmlDeclaration;
+					return true;
 				}
-				while (Encoding::CharactersReader::IsNameChar(currentCharacter));
-				break;
 			}
 		}
-		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
 
-		if (currentCharacter == GreaterThan)
-		{
-			node = Inspected::StartTag;
-			bool noErrors = NamespacesStuff();
-			if (noErrors)
-			{
-				UnclosedTagType& ref = NewUnclosedTag();
-				ref.Name = name;
-				ref.LocalName = localName;
-				ref.Prefix = prefix;
-				ref.NamespaceUri = namespaceUri;
-				ref.Row = row;
-				ref.Column = column;
-				foundElement = true;
-				return true;
-			}
-			return false;
-		}
+		tempRow = currentRow;
+		tempColumn = currentColumn;
+		Stop();
+		SetError(ErrorCode::InvalidSyntax);
+		row = tempRow;
+		column = tempColumn;
+		return false;
+	}
 
-		if (currentCharacter == Slash)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseProcessingInstruction()
+	{
+		// '<?' PITarget (':' | (Char - NameChar))
+		// name == PITarget
+		// localName.empty() == true
+
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		if (currentCharacter == Question)
 		{
-			// <tagName/
+			// '<?' PITarget '?'
 			if (NextCharBad(true))
 				return false;
 			if (currentCharacter != GreaterThan)
 			{
 				tempRow = currentRow;
 				tempColumn = currentColumn;
-				Reset();
+				Stop();
 				SetError(ErrorCode::InvalidSyntax);
 				row = tempRow;
 				column = tempColumn;
 				return false;
 			}
 
-			node = Inspected::EmptyElementTag;
-			bool noErrors = NamespacesStuff();
-			if (noErrors)
-			{
-				foundElement = true;
-				return true;
-			}
-			return false;
+			// '<?' PITarget '?>'
+			localName = name;
+			node = Inspected::ProcessingInstruction;
+			return true;
 		}
 
-		if (IsWhiteSpace(currentCharacter))
+		if (!IsWhiteSpace(currentCharacter))
 		{
-			// Ignore white spaces.
-			do
-			{
-				if (NextCharBad(true))
-					return false;
-			}
-			while (IsWhiteSpace(currentCharacter));
-
-			if (currentCharacter != Colon &&
-				Encoding::CharactersReader::IsNameStartChar(currentCharacter))
-			{
-				// Attributes.
-				return ParseAttributes();
-			}
-
-			if (currentCharacter == Slash)
-			{
-				// <tagName /
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter != GreaterThan)
-				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
-
-				node = Inspected::EmptyElementTag;
-				bool noErrors = NamespacesStuff();
-				if (noErrors)
-				{
-					foundElement = true;
-					return true;
-				}
-				return false;
-			}
-
-			if (currentCharacter == GreaterThan)
-			{
-				// <tagName >
-				node = Inspected::StartTag;
-				bool noErrors = NamespacesStuff();
-				if (noErrors)
-				{
-					UnclosedTagType& ref = NewUnclosedTag();
-					ref.Name = name;
-					ref.LocalName = localName;
-					ref.Prefix = prefix;
-					ref.NamespaceUri = namespaceUri;
-					ref.Row = row;
-					ref.Column = column;
-					foundElement = true;
-					return true;
-				}
-				return false;
-			}
-
-			if (Encoding::CharactersReader::IsNameChar(currentCharacter))
-			{
-				// For example <tagName 123attr="value">
-				// 1 is not allowed as a first character name.
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidAttributeName);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
-
-			// Invalid syntax.
-			// For example <tagName !abc...
-			// ! is not allowed as a part of the name.
 			tempRow = currentRow;
 			tempColumn = currentColumn;
-			Reset();
+			Stop();
 			SetError(ErrorCode::InvalidSyntax);
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
 
-		// Invalid tag name.
-		Reset();
-		SetError(ErrorCode::InvalidTagName);
-		row = tempRow;
-		column = tempColumn;
-		return false;
-	}
-
-	
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseAttributes()
-	{
-		// IsNameStartChar(currentCharacter) == true
-		// and
-		// currentCharacter != Colon
-
-		SizeType tempRow;
-		SizeType tempColumn;
-		bool white = true;
-
-		do // {...} while (Encoding::CharactersReader::IsNameStartChar(currentCharacter));
-		{
-			AttributeType& attr = NewAttribute();
-			attr.Row = currentRow;
-			attr.Column = currentColumn;
-
-			// attribute.Name, attribute.LocalName, attribute.Prefix.
-			do // {...} while (Encoding::CharactersReader::IsNameChar(currentCharacter));
-			{
-				CharactersWriterType::WriteCharacter(attr.Name, currentCharacter);
-				CharactersWriterType::WriteCharacter(attr.LocalName, currentCharacter);
-
-				if (NextCharBad(true))
-					return false;
-
-				if (currentCharacter == Colon)
-				{
-					// Prefixed name.
-					attr.Prefix = attr.Name;
-					attr.LocalName.clear();
-					CharactersWriterType::WriteCharacter(attr.Name, currentCharacter);
-
-					if (NextCharBad(true))
-						return false;
-
-					if (currentCharacter == Colon ||
-						!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
-					{
-						Reset();
-						SetError(ErrorCode::InvalidAttributeName);
-						row = attr.Row;
-						column = attr.Column;
-						return false;
-					}
-
-					do // {...} while (Encoding::CharactersReader::IsNameChar(currentCharacter));
-					{
-						CharactersWriterType::WriteCharacter(attr.Name, currentCharacter);
-						CharactersWriterType::WriteCharacter(attr.LocalName, currentCharacter);
-
-						if (NextCharBad(true))
-							return false;
+		localName = name;
 
-						if (currentCharacter == Colon)
-						{
-							Reset();
-							SetError(ErrorCode::InvalidAttributeName);
-							row = attr.Row;
-							column = attr.Column;
-							return false;
-						}
-					}
-					while (Encoding::CharactersReader::IsNameChar(currentCharacter));
-					break;
-				}
-			}
-			while (Encoding::CharactersReader::IsNameChar(currentCharacter));
+		// Ignore white spaces.
+		do
+		{
+			if (NextCharBad(true))
+				return false;
+		}
+		while (IsWhiteSpace(currentCharacter));
 
-			if (IsWhiteSpace(currentCharacter))
+		do // {...} while (true);
+		{
+			if (currentCharacter == Question)
 			{
-				// Ignore white spaces.
-				do
+				if (NextCharBad(true))
+					return false;
+				if (currentCharacter == GreaterThan)
 				{
-					if (NextCharBad(true))
-						return false;
+					node = Inspected::ProcessingInstruction;
+					return true;
 				}
-				while (IsWhiteSpace(currentCharacter));
-				white = true;
+				WriteValueCharacter(value, Question);
 			}
 			else
 			{
-				white = false;
+				WriteCurrentCharacter(value);
+				const char32_t* run;
+				AppendRun(ProcessingInstructionRun, value, run);
+				if (NextCharBad(true))
+					return false;
 			}
+		}
+		while (true);
 
-			if (currentCharacter != Equals)
+		// Should never happen.
+		return false;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseExclamation()
+	{
+		// currentCharacter == Exclamation.
+		// Comment, CDATA or DocumentType.
+
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		if (NextCharBad(true))
+			return false;
+
+		if (currentCharacter == Minus)
+		{
+			// <!-
+			// Looks like a comment.
+			if (NextCharBad(true))
+				return false;
+			if (currentCharacter != Minus)
 			{
-				if (white)
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+
+			return ParseComment();
+		}
+
+		if (currentCharacter == LeftSquareBracket)
+		{
+			// <![
+			// Looks like CDATA section.
+			for (std::size_t i = 0; i < 5; ++i)
+			{
+				if (NextCharBad(true))
+					return false;
+				if (currentCharacter != CDATA[i])
 				{
 					tempRow = currentRow;
 					tempColumn = currentColumn;
-					Reset();
+					Stop();
 					SetError(ErrorCode::InvalidSyntax);
 					row = tempRow;
 					column = tempColumn;
 					return false;
 				}
-				Reset();
-				SetError(ErrorCode::InvalidAttributeName);
-				row = attr.Row;
-				column = attr.Column;
-				return false;
 			}
-
-			// attrname=
+			// <![CDATA
 			if (NextCharBad(true))
 				return false;
-
-			// Ignore white spaces.
-			while (IsWhiteSpace(currentCharacter))
+			if (currentCharacter != LeftSquareBracket)
 			{
-				if (NextCharBad(true))
-					return false;
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
+				return false;
 			}
 
-			char32_t quoteChar = currentCharacter;
+			return ParseCDATA();
+		}
 
-			if (quoteChar == DoubleQuote)
-			{
-				// attrname="
-				attr.Delimiter = QuotationMark::DoubleQuote;
-			}
-			else if (quoteChar == SingleQuote)
-			{
-				// attrname='
-				attr.Delimiter = QuotationMark::SingleQuote;
-			}
-			else
+		// <!currentCharacter
+		// Should be DOCTYPE declaration.
+		for (std::size_t i = 0; i < 7; ++i)
+		{
+			if (currentCharacter != DOCTYPE[i])
 			{
 				tempRow = currentRow;
 				tempColumn = currentColumn;
-				Reset();
+				Stop();
 				SetError(ErrorCode::InvalidSyntax);
 				row = tempRow;
 				column = tempColumn;
 				return false;
 			}
-
 			if (NextCharBad(true))
 				return false;
+		}
+		return ParseDOCTYPE();
+	}
 
-			// attr.Value
-			while (currentCharacter != quoteChar)
-			{
-				if (currentCharacter == LessThan)
-				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
-
-				if (currentCharacter == Ampersand)
-				{
-					if (NextCharBad(true))
-						return false;
-
-					if (currentCharacter == Hash)
-					{
-						// "&#"
-
-						char32_t codePoint;
-
-						if (!ParseCharacterReference(codePoint, true))
-							return false;
-
-						// currentCharacter == Semicolon.
-
-						CharactersWriterType::WriteCharacter(attr.Value, codePoint);
-						if (NextCharBad(true))
-							return false;
-						continue; // while (currentCharacter != quoteChar) {...}
-					}
-					else if (currentCharacter != Colon &&
-						Encoding::CharactersReader::IsNameStartChar(currentCharacter))
-					{
-						int resultParsing = ParseEntityReference(true);
-						if (resultParsing == -1)
-						{
-							// Error.
-							return false;
-						}
-						else if (resultParsing == 0)
-						{
-							// Unknown entity reference.
-							CharactersWriterType::WriteCharacter(attr.Value, Ampersand);
-							attr.Value.append(entityName);
-							entityName.clear();
-							CharactersWriterType::WriteCharacter(attr.Value, Semicolon);
-							if (NextCharBad(true))
-								return false;
-							continue; // while (currentCharacter != quoteChar) {...}
-						}
-						else // resultParsing == 1.
-						{
-							// Predefined entity reference.
-							CharactersWriterType::WriteCharacter(attr.Value, currentCharacter);
-							if (NextCharBad(true))
-								return false;
-							continue; // while (currentCharacter != quoteChar) {...}
-						}
-					}
-					else
-					{
-						tempRow = currentRow;
-						tempColumn = currentColumn - 1;
-						Reset();
-						SetError(ErrorCode::InvalidReferenceSyntax);
-						row = tempRow;
-						column = tempColumn;
-						return false;
-					}
-				}
-
-				if (!IsWhiteSpace(currentCharacter))
-					CharactersWriterType::WriteCharacter(attr.Value, currentCharacter);
-				else
-					CharactersWriterType::WriteCharacter(attr.Value, Space);
-
-				if (NextCharBad(true))
-					return false;
-			} // while (currentCharacter != quoteChar) {...}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseComment()
+	{
+		// currentCharacter == Minus.
 
-			// attrname="value"
+		SizeType tempRow;
+		SizeType tempColumn;
 
-			if (!AttributeUniqueness())
-				return false;
+		PrepareNode();
 
+		bool doubleMinus = false;
+		do
+		{
 			if (NextCharBad(true))
 				return false;
-
-			if (IsWhiteSpace(currentCharacter))
+			if (currentCharacter == Minus)
 			{
-				// Ignore white spaces.
-				do
+				// <!-- -
+				if (NextCharBad(true))
+					return false;
+				if (currentCharacter == Minus)
 				{
+					// <!-- --
 					if (NextCharBad(true))
 						return false;
+					doubleMinus = true;
 				}
-				while (IsWhiteSpace(currentCharacter));
-				white = true;
-
-				if (currentCharacter == Colon)
+				else
 				{
-					Reset();
-					SetError(ErrorCode::InvalidAttributeName);
-					row = attr.Row;
-					column = attr.Column;
-					return false;
+					WriteValueCharacter(value, Minus);
+					WriteCurrentCharacter(value);
 				}
 			}
-			else
+			else // Not minus.
 			{
-				white = false;
-				break;
+				WriteCurrentCharacter(value);
+				const char32_t* run;
+				AppendRun(CommentRun, value, run);
 			}
 		}
-		while (Encoding::CharactersReader::IsNameStartChar(currentCharacter));
+		while (!doubleMinus);
 
-		if (currentCharacter == GreaterThan)
+		if (currentCharacter != GreaterThan)
+		{
+			SavePosition(tempRow, tempColumn, 2);
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		node = Inspected::Comment;
+		return true;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseCDATA()
+	{
+		// currentCharacter == LeftSquareBracket.
+		// <![CDATA[
+
+		if (unclosedTagsSize == 0)
 		{
-			// attrname="value">
-			node = Inspected::StartTag;
-			bool noErrors = NamespacesStuff();
-			if (noErrors)
-			{
-				UnclosedTagType& ref = NewUnclosedTag();
-				ref.Name = name;
-				ref.LocalName = localName;
-				ref.Prefix = prefix;
-				ref.NamespaceUri = namespaceUri;
-				ref.Row = row;
-				ref.Column = column;
-				foundElement = true;
-				return true;
-			}
+			SizeType tempRow = row;
+			SizeType tempColumn = column;
+			Stop();
+			SetError(ErrorCode::CDataSectionOutside);
+			row = tempRow;
+			column = tempColumn;
 			return false;
 		}
-		else if (currentCharacter == Slash)
+
+		PrepareNode();
+
+		do
 		{
-			// attrname="value"/
 			if (NextCharBad(true))
 				return false;
-			if (currentCharacter != GreaterThan)
+			if (currentCharacter == RightSquareBracket)
 			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
+				// <![CDATA[ text ]
+				SizeType bracketCount = 0;
+				do
+				{
+					++bracketCount;
+					if (NextCharBad(true))
+						return false;
+				}
+				while (currentCharacter == RightSquareBracket);
 
-			node = Inspected::EmptyElementTag;
-			bool noErrors = NamespacesStuff();
-			if (noErrors)
-			{
-				// Namespaces associated with this tag are no longer needed.
-				SizeType indicesToRemove = static_cast<SizeType>(unclosedTagsSize);
-				NamespacesSizeType newNamespacesSize = 0;
-				while (newNamespacesSize < namespacesSize)
+				if (currentCharacter == GreaterThan && bracketCount >= 2)
 				{
-					if (namespaces[newNamespacesSize].TagIndex == indicesToRemove)
-						break;
-					++newNamespacesSize;
+					// <![CDATA[ text ]]>
+					bracketCount -= 2;
+					for (SizeType i = 0; i < bracketCount; ++i)
+						WriteValueCharacter(value, RightSquareBracket);
+					node = Inspected::CDATA;
+					return true;
+				}
+				else
+				{
+					for (SizeType i = 0; i < bracketCount; ++i)
+						WriteValueCharacter(value, RightSquareBracket);
+					WriteCurrentCharacter(value);
 				}
-				namespacesSize = newNamespacesSize;
-				foundElement = true;
-				return true;
 			}
-			return false;
-		}
-		else // Some error.
-		{
-			if (white && Encoding::CharactersReader::IsNameChar(currentCharacter))
+			else
 			{
-				// After white space, cannot be a start character of attribute name,
-				// but can be a part of this name. Something like:
-				// <tag 123attrName="value">. "1" is not allowed as the start character.
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidAttributeName);
-				row = tempRow;
-				column = tempColumn;
-				return false;
+				WriteCurrentCharacter(value);
+				const char32_t* run;
+				AppendRun(CDataRun, value, run);
 			}
+		}
+		while (true);
+
+		// Should never happen.
+		return false;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseDOCTYPE()
+	{
+		// <!DOCTYPEcurrentCharacter
 
+		SizeType tempRow;
+		SizeType tempColumn;
+
+		if (!IsWhiteSpace(currentCharacter))
+		{
 			tempRow = currentRow;
 			tempColumn = currentColumn;
-			Reset();
+			Stop();
 			SetError(ErrorCode::InvalidSyntax);
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseEndTag()
-	{
-		// currentCharacter == Slash.
-		if (NextCharBad(true))
-			return false;
 
-		SizeType tempRow = currentRow;
-		SizeType tempColumn = currentColumn;
-
-		if (currentCharacter == Colon)
+		if (foundElement)
 		{
-			Reset();
-			SetError(ErrorCode::InvalidTagName);
+			tempRow = row;
+			tempColumn = column;
+			Stop();
+			SetError(ErrorCode::InvalidDocumentTypeDeclarationLocation);
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
-		else if (!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+
+		if (foundDOCTYPE)
 		{
-			if (Encoding::CharactersReader::IsNameChar(currentCharacter))
-			{
-				// Not allowed as start character of the name,
-				// but allowed as a part of this name.
-				Reset();
-				SetError(ErrorCode::InvalidTagName);
-			}
-			else
-			{
-				// Some weird character.
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-			}
+			tempRow = row;
+			tempColumn = column;
+			Stop();
+			SetError(ErrorCode::DoubleDocumentTypeDeclaration);
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
+		foundDOCTYPE = true;
 
 		PrepareNode();
 
-		// End element name.
+		// Ignore white spaces.
 		do
 		{
-			CharactersWriterType::WriteCharacter(name, currentCharacter);
-			CharactersWriterType::WriteCharacter(localName, currentCharacter);
+			if (NextCharBad(true))
+				return false;
+		}
+		while (IsWhiteSpace(currentCharacter));
+
+		// <!DOCTYPE   currentCharacter
+		if (currentCharacter == Colon ||
+			!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+		{
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
+			SetError(ErrorCode::InvalidSyntax);
+			row = tempRow;
+			column = tempColumn;
+			return false;
+		}
+
+		// QName
+		do
+		{
+			WriteNameCharacters(name, localName);
 
 			if (NextCharBad(true))
 				return false;
@@ -2349,8 +6245,10 @@ namespace Xml
 				if (currentCharacter == Colon ||
 					!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
 				{
-					Reset();
-					SetError(ErrorCode::InvalidTagName);
+					tempRow = currentRow;
+					tempColumn = currentColumn;
+					Stop();
+					SetError(ErrorCode::InvalidSyntax);
 					row = tempRow;
 					column = tempColumn;
 					return false;
@@ -2358,16 +6256,17 @@ namespace Xml
 
 				do
 				{
-					CharactersWriterType::WriteCharacter(name, currentCharacter);
-					CharactersWriterType::WriteCharacter(localName, currentCharacter);
+					WriteNameCharacters(name, localName);
 
 					if (NextCharBad(true))
 						return false;
 
 					if (currentCharacter == Colon)
 					{
-						Reset();
-						SetError(ErrorCode::InvalidTagName);
+						tempRow = currentRow;
+						tempColumn = currentColumn;
+						Stop();
+						SetError(ErrorCode::InvalidSyntax);
 						row = tempRow;
 						column = tempColumn;
 						return false;
@@ -2379,4745 +6278,5461 @@ namespace Xml
 		}
 		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
 
-		if (IsWhiteSpace(currentCharacter))
-		{
-			// Ignore white spaces.
-			do
-			{
-				if (NextCharBad(true))
-					return false;
-			}
-			while (IsWhiteSpace(currentCharacter));
-
-			if (currentCharacter != GreaterThan)
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
-		}
-		else if (currentCharacter != GreaterThan)
-		{
-			Reset();
-			SetError(ErrorCode::InvalidTagName);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-
-		if (unclosedTagsSize == 0 ||
-			unclosedTags[unclosedTagsSize - 1].Name != name)
-		{
-			tempRow = row;
-			tempColumn = column;
-			Reset();
-			SetError(ErrorCode::UnexpectedEndTag);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-		namespaceUri = unclosedTags[unclosedTagsSize - 1].NamespaceUri;
-
-		// Tag is closed.
-		--unclosedTagsSize;
+		// <!DOCTYPE QNAMEcurrentCharacter
 
-		// Namespaces associated with this tag are no longer needed.
-		SizeType indicesToRemove = static_cast<SizeType>(unclosedTagsSize);
-		NamespacesSizeType newNamespacesSize = 0;
-		while (newNamespacesSize < namespacesSize)
+		if (currentCharacter == GreaterThan)
 		{
-			if (namespaces[newNamespacesSize].TagIndex == indicesToRemove)
-				break;
-			++newNamespacesSize;
+			// <!DOCTYPE QName>
+			node = Inspected::DocumentType;
+			return true;
 		}
-		namespacesSize = newNamespacesSize;
-		node = Inspected::EndTag;
-		return true;
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseText()
-	{
-		// currentCharacter == first character of text.
-
-		SizeType tempRow;
-		SizeType tempColumn;
-
-		PrepareNode();
-
-		if (IsWhiteSpace(currentCharacter))
+		else if (IsWhiteSpace(currentCharacter))
 		{
+			// Ignore white spaces.
 			do
 			{
-				CharactersWriterType::WriteCharacter(value, currentCharacter);
-				
-				if (NextCharBad(false))
-				{
-					if (eof)
-					{
-						if (unclosedTagsSize != 0)
-						{
-							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-							Reset();
-							SetError(ErrorCode::UnclosedTag);
-							row = ref.Row;
-							column = ref.Column;
-							eof = true;
-							return false;
-						}
-
-						node = Inspected::Whitespace;
-						return true;
-					}
+				if (NextCharBad(true))
 					return false;
-				}
 			}
 			while (IsWhiteSpace(currentCharacter));
 
-			if (currentCharacter == LessThan)
+			if (currentCharacter == GreaterThan)
 			{
-				node = Inspected::Whitespace;
+				// <!DOCTYPE QName  >
+				node = Inspected::DocumentType;
 				return true;
 			}
 		}
-
-		if (unclosedTagsSize == 0)
+		else if (currentCharacter != LeftSquareBracket)
 		{
 			tempRow = currentRow;
 			tempColumn = currentColumn;
-			Reset();
+			Stop();
 			SetError(ErrorCode::InvalidSyntax);
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
 
-		bool onlyWhite = true;
 		do
 		{
-			if (currentCharacter == Ampersand)
+			WriteCurrentCharacter(value);
+			if (currentCharacter == LeftSquareBracket)
 			{
-				if (NextCharBad(false))
+				// <!DOCTYPE QName [
+				do
 				{
-					if (eof)
+					if (NextCharBad(true))
+						return false;
+					while (currentCharacter == RightSquareBracket)
 					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
+						WriteCurrentCharacter(value);
+						if (NextCharBad(true))
+							return false;
+						while (IsWhiteSpace(currentCharacter))
+						{
+							WriteCurrentCharacter(value);
+							if (NextCharBad(true))
+								return false;
+						}
+						if (currentCharacter == GreaterThan)
+						{
+							// <!DOCTYPE QName [...] >
+							node = Inspected::DocumentType;
+							return true;
+						}
 					}
-					return false;
+					WriteCurrentCharacter(value);
 				}
+				while (true);
+			}
 
-				if (currentCharacter == Hash)
-				{
-					// "&#"
-
-					char32_t codePoint;
+			if (NextCharBad(true))
+				return false;
+		}
+		while (currentCharacter != GreaterThan);
 
-					if (!ParseCharacterReference(codePoint, false))
-						return false;
+		node = Inspected::DocumentType;
+		return true;
+	}
 
-					// currentCharacter == Semicolon.
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::PrepareNode()
+	{
+		name.clear();
+		value.clear();
+		viewString = nullptr;
+		localName.clear();
+		prefix.clear();
+		namespaceUri.clear();
+		attributesSize = 0;
+	}
 
-					if (!Encoding::CharactersReader::IsWhiteSpace(codePoint))
-						onlyWhite = false;
-					CharactersWriterType::WriteCharacter(value, codePoint);
-					if (NextCharBad(false))
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::NamespacesStuff()
+	{
+		// Collect namespaces from attributes.
+		typedef typename std::deque<AttributeType>::iterator AttrIter;
+		AttrIter attrEnd = attributes.begin() + attributesSize;
+		for (AttrIter attr = attributes.begin(); attr != attrEnd; ++attr)
+		{
+			if (attr->Prefix.empty())
+			{
+				if (attr->LocalName == xmlnsString)
+				{
+					// Default namespace.
+					// <mytag xmlns=...
+					if (attr->Value == xmlUriString ||
+						attr->Value == xmlnsUriString)
 					{
-						if (eof)
-						{
-							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-							Reset();
-							SetError(ErrorCode::UnclosedTag);
-							row = ref.Row;
-							column = ref.Column;
-							eof = true;
-						}
+						// <mytag xmlns="http://www.w3.org/XML/1998/namespace"...
+						// or
+						// <mytag xmlns="http://www.w3.org/2000/xmlns/"...
+						Stop();
+						SetError(ErrorCode::ReservedNamespaceAsDefault);
+						row = attr->Row;
+						column = attr->Column;
 						return false;
 					}
-					continue;
+
+					NamespaceDeclarationType& ref = NewNamespace();
+					ref.Uri = attr->Value;
+					ref.TagIndex = static_cast<SizeType>(unclosedTagsSize);
 				}
-				else if (currentCharacter != Colon &&
-					Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+			}
+			else if (attr->Prefix == xmlnsString)
+			{
+				if (attr->LocalName == xmlnsString)
 				{
-					int resultParsing = ParseEntityReference(false);
-					if (resultParsing == -1)
+					// <mytag xmlns:xmlns=...
+					Stop();
+					SetError(ErrorCode::XmlnsDeclared);
+					row = attr->Row;
+					column = attr->Column;
+					return false;
+				}
+				else if (attr->LocalName == lowerXmlString)
+				{
+					// <mytag xmlns:xml=...
+
+					if (attr->Value != xmlUriString)
 					{
-						// Error.
+						Stop();
+						SetError(ErrorCode::InvalidXmlPrefixDeclaration);
+						row = attr->Row;
+						column = attr->Column;
 						return false;
 					}
-					else if (resultParsing == 0)
+				}
+				else if (attr->Value == xmlUriString ||
+					attr->Value == xmlnsUriString)
+				{
+					// <mytag xmlns:newprefix="http://www.w3.org/XML/1998/namespace"...
+					// or
+					// <mytag xmlns:newprefix="http://www.w3.org/2000/xmlns/"...
+					Stop();
+					SetError(ErrorCode::PrefixBoundToReservedNamespace);
+					row = attr->Row;
+					column = attr->Column;
+					return false;
+				}
+				else if (attr->Value.empty())
+				{
+					// <mytag xmlns:newprefix=""...
+					Stop();
+					SetError(ErrorCode::PrefixWithEmptyNamespace);
+					row = attr->Row;
+					column = attr->Column;
+					return false;
+				}
+				else
+				{
+					NamespaceDeclarationType& ref = NewNamespace();
+					ref.Prefix = attr->LocalName;
+					ref.Uri = attr->Value;
+					ref.TagIndex = static_cast<SizeType>(unclosedTagsSize);
+				}
+			}
+		}
+
+		// Assign URIs to attributes.
+		typedef typename std::deque<NamespaceDeclarationType>::const_iterator NamespaceIter;
+		NamespaceIter namespaceLast = namespaces.begin();
+		if (namespacesSize != 0)
+			namespaceLast += (namespacesSize - 1);
+		for (AttrIter attr = attributes.begin(); attr != attrEnd; ++attr)
+		{
+			if (!attr->Prefix.empty())
+			{
+				if (attr->Prefix == xmlnsString)
+				{
+					attr->NamespaceUri = xmlnsUriString;
+				}
+				else if (attr->Prefix == lowerXmlString)
+				{
+					attr->NamespaceUri = xmlUriString;
+				}
+				else
+				{
+					bool found = false;
+					NamespaceIter n = namespaceLast;
+					for ( ; n != namespaces.begin(); --n)
 					{
-						// Unknown entity reference.
-						if (value.empty())
-						{
-							name = entityName;
-							localName = entityName;
-							entityName.clear();
-							node = Inspected::EntityReference;
-							return true;
-						}
-						else
+						if (attr->Prefix == n->Prefix)
 						{
-							// entityName field is set,
-							// but first I must return some text.
-							if (onlyWhite)
-								node = Inspected::Whitespace;
-							else
-								node = Inspected::Text;
-							return true;
+							found = true;
+							break;
 						}
 					}
-					else // resultParsing == 1.
+					if (!found && (namespacesSize == 0 || attr->Prefix != n->Prefix))
 					{
-						// Predefined entity reference.
-						onlyWhite = false;
-						CharactersWriterType::WriteCharacter(value, currentCharacter);
-						if (NextCharBad(false))
-						{
-							if (eof)
-							{
-								UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-								Reset();
-								SetError(ErrorCode::UnclosedTag);
-								row = ref.Row;
-								column = ref.Column;
-								eof = true;
-							}
-							return false;
-						}
-						continue;
+						Stop();
+						SetError(ErrorCode::PrefixWithoutAssignedNamespace);
+						row = attr->Row;
+						column = attr->Column;
+						return false;
+					}
+					else
+					{
+						attr->NamespaceUri = n->Uri;
 					}
-				}
-				else
-				{
-					tempRow = currentRow;
-					tempColumn = currentColumn - 1;
-					Reset();
-					SetError(ErrorCode::InvalidReferenceSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
 				}
 			}
+		}
 
-			if (currentCharacter == RightSquareBracket)
+		// Assign URI to element.
+		if (!prefix.empty())
+		{
+			if (prefix == xmlnsString)
 			{
-				// "]]>" is not allowed here.
-				SizeType bracketCount = 0;
-				onlyWhite = false;
-				do
+				// row and column => '<'
+				SizeType tempRow = row;
+				SizeType tempColumn = column + 1;
+				Stop();
+				SetError(ErrorCode::PrefixWithoutAssignedNamespace);
+				row = tempRow;
+				column = tempColumn;
+				return false;
+			}
+			else if (prefix == lowerXmlString)
+			{
+				namespaceUri = xmlUriString;
+			}
+			else
+			{
+				bool found = false;
+				NamespaceIter n = namespaceLast;
+				for ( ; n != namespaces.begin(); --n)
 				{
-					++bracketCount;
-					CharactersWriterType::WriteCharacter(value, currentCharacter);
-
-					if (NextCharBad(false))
+					if (prefix == n->Prefix)
 					{
-						if (eof)
-						{
-							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-							Reset();
-							SetError(ErrorCode::UnclosedTag);
-							row = ref.Row;
-							column = ref.Column;
-							eof = true;
-						}
-						return false;
+						found = true;
+						break;
 					}
 				}
-				while (currentCharacter == RightSquareBracket);
-
-				if (currentCharacter == GreaterThan && bracketCount > 1)
+				if (!found && (namespacesSize == 0 || prefix != n->Prefix))
 				{
-					tempRow = currentRow;
-					tempColumn = currentColumn - 2;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
+					// row and column => '<'
+					SizeType tempRow = row;
+					SizeType tempColumn = column + 1;
+					Stop();
+					SetError(ErrorCode::PrefixWithoutAssignedNamespace);
 					row = tempRow;
 					column = tempColumn;
 					return false;
 				}
-				continue;
+				else
+				{
+					namespaceUri = n->Uri;
+				}
 			}
-
-			if (!IsWhiteSpace(currentCharacter))
-				onlyWhite = false;
-			CharactersWriterType::WriteCharacter(value, currentCharacter);
-			if (NextCharBad(false))
+		}
+		else // prefix.empty() == true.
+		{
+			// Find default namespace.
+			bool found = false;
+			NamespaceIter n = namespaceLast;
+			for ( ; n != namespaces.begin(); --n)
 			{
-				if (eof)
+				if (n->Prefix.empty())
 				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
+					found = true;
+					break;
 				}
-				return false;
 			}
+			if (found || (namespacesSize != 0 && n->Prefix.empty()))
+				namespaceUri = n->Uri;
 		}
-		while (currentCharacter != LessThan);
-
-		if (!onlyWhite)
-			node = Inspected::Text;
-		else
-			node = Inspected::Whitespace;
-
-		return true;
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseQuestion()
-	{
-		// currentCharacter == Question.
-		// XmlDeclaration or ProcessingInstruction.
-
-		SizeType tempRow;
-		SizeType tempColumn;
-
-		PrepareNode();
 
-		// '<?'
-		if (NextCharBad(true))
-			return false;
-		if (currentCharacter == LowerXml[0] ||
-			currentCharacter == UpperXml[0])
+		// Ensure no double attribute name like:
+		// <a x:local="first" y:local="second">
+		// where x and y prefixes are bound to the same namespace URI.
+		if (attributesSize > 1)
 		{
-			// '<?' ('X' | 'x')
-			CharactersWriterType::WriteCharacter(name, currentCharacter);
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter == LowerXml[1] ||
-				currentCharacter == UpperXml[1])
+			AttrIter attrEndMinus1 = attributes.begin() + (attributesSize - 1);
+			for (AttrIter attr = attributes.begin(); attr != attrEndMinus1; ++attr)
 			{
-				// '<?' ('X' | 'x') ('M' | 'm')
-				CharactersWriterType::WriteCharacter(name, currentCharacter);
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter == LowerXml[2] ||
-					currentCharacter == UpperXml[2])
+				if (!attr->Prefix.empty())
 				{
-					// '<?' ('X' | 'x') ('M' | 'm') ('L' | 'l')
-					CharactersWriterType::WriteCharacter(name, currentCharacter);
-					if (NextCharBad(true))
-						return false;
-
-					if (name == lowerXmlString)
+					for (AttrIter next = attr + 1; next != attrEnd; ++next)
 					{
-						// '<?xml' Char
-						if (IsWhiteSpace(currentCharacter))
+						if (attr->LocalName == next->LocalName &&
+							attr->NamespaceUri == next->NamespaceUri)
 						{
-							// '<?xml '
-							localName = name;
-							return ParseXmlDeclaration();	
+							Stop();
+							SetError(ErrorCode::DoubleAttributeName);
+							row = next->Row;
+							column = next->Column;
+							return false;
 						}
 					}
-
-					if (currentCharacter == Colon ||
-						!Encoding::CharactersReader::IsNameChar(currentCharacter))
-					{
-						tempRow = currentRow;
-						tempColumn = currentColumn;
-						Reset();
-						SetError(ErrorCode::InvalidSyntax);
-						row = tempRow;
-						column = tempColumn;
-						return false;
-					}
 				}
 			}
 		}
-		else if (currentCharacter == Colon ||
-			!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
-		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-		else
-		{
-			// '<?' (NameStartChar - ':')
-			CharactersWriterType::WriteCharacter(name, currentCharacter);
-			if (NextCharBad(true))
-				return false;
-		}
-
-		while (currentCharacter != Colon &&
-			Encoding::CharactersReader::IsNameChar(currentCharacter))
-		{
-			CharactersWriterType::WriteCharacter(name, currentCharacter);
-			if (NextCharBad(true))
-				return false;
-		}
-
-		// '<?' PITarget (':' | (Char - NameChar))
 
-		return ParseProcessingInstruction();
+		return true;
 	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseXmlDeclaration()
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseCharacterReference(char32_t& result, bool insideTag)
 	{
-		// '<?xml '
-
-		SizeType tempRow;
-		SizeType tempColumn;
+		// currentCharacter == Hash.
+		
+		SavePosition(referenceRow, referenceColumn, 1);
 
-		if (row != 1 || column != 1)
+		if (NextCharBad(insideTag))
 		{
-			tempRow = row;
-			tempColumn = column;
-			Reset();
-			SetError(ErrorCode::InvalidXmlDeclarationLocation);
-			row = tempRow;
-			column = tempColumn;
+			if (!insideTag && eof)
+			{
+				UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+				Stop();
+				SetError(ErrorCode::UnclosedTag);
+				row = ref.Row;
+				column = ref.Column;
+				eof = true;
+			}
 			return false;
 		}
 
-		// Ignore white spaces.
-		do
+		const int BufferSize = 7;
+		unsigned char buffer[BufferSize];
+		int digitCount = 0;
+		int digit = 0;
+		int radix = 10;
+
+		if (currentCharacter == X)
 		{
-			if (NextCharBad(true))
+			// Hexadecimal representation of the character's code point.
+			radix = 16;
+			if (NextCharBad(insideTag))
+			{
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
 				return false;
+			}
 		}
-		while (IsWhiteSpace(currentCharacter));
 
-		AttributeType& versionAttr = NewAttribute();
-		versionAttr.Row = currentRow;
-		versionAttr.Column = currentColumn;
+		digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
 
-		for (std::size_t i = 0; i < 7; ++i)
+		// Ignore leading zeros.
+		bool leadingZeros = false;
+		while (digit == 0)
 		{
-			if (currentCharacter != XmlDeclarationVersion[i])
+			leadingZeros = true;
+			if (NextCharBad(insideTag))
 			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
 				return false;
 			}
-			CharactersWriterType::WriteCharacter(versionAttr.Name, currentCharacter);
-			CharactersWriterType::WriteCharacter(versionAttr.LocalName, currentCharacter);
-			if (NextCharBad(true))
-				return false;
+			digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
 		}
 
-		// '<?xml version' Char
-		
-		while (IsWhiteSpace(currentCharacter))
+		while (digitCount < BufferSize && digit >= 0 && digit < radix)
 		{
-			if (NextCharBad(true))
+			buffer[digitCount++] = static_cast<unsigned char>(digit);
+			if (NextCharBad(insideTag))
+			{
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
 				return false;
-		}
-
-		if (currentCharacter != Equals)
-		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-
-		// '<?xml version='
-
-		if (NextCharBad(true))
-			return false;
+			}
+			digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
+		}
 
-		while (IsWhiteSpace(currentCharacter))
+		// Now should be a semicolon.
+		if (currentCharacter == Semicolon)
 		{
-			if (NextCharBad(true))
+			// &#x0; is invalid code point in character reference.
+			// &#x; is invalid syntax of reference.
+			if (digitCount == 0)
+			{
+				if (leadingZeros)
+				{
+					Stop();
+					SetError(ErrorCode::InvalidCharacterReference);
+					row = referenceRow;
+					column = referenceColumn;
+				}
+				else
+				{
+					Stop();
+					SetError(ErrorCode::InvalidReferenceSyntax);
+					row = referenceRow;
+					column = referenceColumn;
+				}
 				return false;
-		}
+			}
 
-		char32_t quoteChar = currentCharacter;
+			// We are sure that digitCount is 7 max.
+			result = 0;
+			for (int i = 0; i < digitCount; ++i)
+				result = result * radix + static_cast<char32_t>(buffer[i]);
 
-		if (quoteChar == DoubleQuote)
-		{
-			// <?xml version="
-			versionAttr.Delimiter = QuotationMark::DoubleQuote;
-		}
-		else if (quoteChar == SingleQuote)
-		{
-			// <?xml version='
-			versionAttr.Delimiter = QuotationMark::SingleQuote;
+			if (!Encoding::CharactersReader::IsChar(result))
+			{
+				Stop();
+				SetError(ErrorCode::InvalidCharacterReference);
+				row = referenceRow;
+				column = referenceColumn;
+				return false;
+			}
 		}
-		else
+		else if (digit >= 0 && digit < radix)
 		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-
-		if (NextCharBad(true))
-			return false;
+			// To many digits, but we must check the syntax to set appropriate error.
 
-		// Now should be:
-		// '1.' [0-9]+
+			do
+			{
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return false;
+				}
+				digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
+			}
+			while (digit >= 0 && digit < radix);
 
-		if (Encoding::CharactersReader::GetHexDigitValue(currentCharacter) != 1)
-		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
+			if (currentCharacter == Semicolon)
+			{
+				// just invalid code point.
+				Stop();
+				SetError(ErrorCode::InvalidCharacterReference);
+				row = referenceRow;
+				column = referenceColumn;
+			}
+			else
+			{
+				// Invalid syntax of character reference, not just invalid code point.
+				Stop();
+				SetError(ErrorCode::InvalidReferenceSyntax);
+				row = referenceRow;
+				column = referenceColumn;
+			}
 			return false;
 		}
-
-		// <?xml version="1
-		CharactersWriterType::WriteCharacter(versionAttr.Value, currentCharacter);
-
-		if (NextCharBad(true))
-			return false;
-
-		if (currentCharacter != Dot)
+		else
 		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
+			// Not allowed character.
+			Stop();
+			SetError(ErrorCode::InvalidReferenceSyntax);
+			row = referenceRow;
+			column = referenceColumn;
 			return false;
 		}
 
-		// <?xml version="1.
-		CharactersWriterType::WriteCharacter(versionAttr.Value, currentCharacter);
+		return true;
+	}
 
-		if (NextCharBad(true))
-			return false;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline int Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ParseEntityReference(bool insideTag)
+	{
+		// IsNameStartChar(currentCharacter) == true
+		// &&
+		// currentCharacter != colon.
+		
+		SavePosition(referenceRow, referenceColumn, 1);
 
-		int digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
+		entityName.reserve(NameReserve);
+		entityNameCharCount = 0;
 
-		if (digit < 0 || digit > 9)
+		if (currentCharacter == LtEntityName[0])
 		{
-			// After a dot should be at least one digit.
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
+			// "&l"
+			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+			++entityNameCharCount;
+			if (NextCharBad(insideTag))
+			{
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
+				return -1;
+			}
 
-		do
-		{
-			CharactersWriterType::WriteCharacter(versionAttr.Value, currentCharacter);
-			if (NextCharBad(true))
-				return false;
-			digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
-		}
-		while (digit >= 0 && digit <= 9);
+			if (currentCharacter == LtEntityName[1])
+			{
+				// "&lt"
+				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+				++entityNameCharCount;
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return -1;
+				}
 
-		if (currentCharacter != quoteChar)
-		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
+				if (currentCharacter == Semicolon)
+				{
+					// "&lt;"
+					currentCharacter = LessThan;
+					entityName.clear();
+					return 1;
+				}
+			}
+			
+			if (currentCharacter == Semicolon)
+			{
+				return 0;
+			}
+			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
+				currentCharacter == Colon)
+			{
+				Stop();
+				SetError(ErrorCode::InvalidReferenceSyntax);
+				row = referenceRow;
+				column = referenceColumn;
+				return -1;
+			}
 		}
+		else if (currentCharacter == GtEntityName[0])
+		{
+			// "&g"
+			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+			++entityNameCharCount;
+			if (NextCharBad(insideTag))
+			{
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
+				return -1;
+			}
 
-		// <?xml version="1.x"
-
-		if (NextCharBad(true))
-			return false;
+			if (currentCharacter == GtEntityName[1])
+			{
+				// "&gt"
+				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+				++entityNameCharCount;
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return -1;
+				}
 
-		if (IsWhiteSpace(currentCharacter))
+				if (currentCharacter == Semicolon)
+				{
+					// "&gt;"
+					currentCharacter = GreaterThan;
+					entityName.clear();
+					return 1;
+				}
+			}
+			
+			if (currentCharacter == Semicolon)
+			{
+				return 0;
+			}
+			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
+				currentCharacter == Colon)
+			{
+				Stop();
+				SetError(ErrorCode::InvalidReferenceSyntax);
+				row = referenceRow;
+				column = referenceColumn;
+				return -1;
+			}
+		}
+		else if (currentCharacter == AmpEntityName[0])
 		{
-			do
+			// "&a"
+			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+			++entityNameCharCount;
+			if (NextCharBad(insideTag))
 			{
-				if (NextCharBad(true))
-					return false;
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
+				return -1;
 			}
-			while (IsWhiteSpace(currentCharacter));
 
-			if (currentCharacter == Question)
+			if (currentCharacter == AmpEntityName[1])
 			{
-				// <?xml version="1.x"   ?
-				if (NextCharBad(true))
-					return false;
+				// "&am"
+				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+				++entityNameCharCount;
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return -1;
+				}
 
-				if (currentCharacter != GreaterThan)
+				if (currentCharacter == AmpEntityName[2])
 				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
+					// "&amp"
+					CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+					++entityNameCharCount;
+					if (NextCharBad(insideTag))
+					{
+						if (!insideTag && eof)
+						{
+							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+							Stop();
+							SetError(ErrorCode::UnclosedTag);
+							row = ref.Row;
+							column = ref.Column;
+							eof = true;
+						}
+						return -1;
+					}
+
+					if (currentCharacter == Semicolon)
+					{
+						// "&amp;"
+						currentCharacter = Ampersand;
+						entityName.clear();
+						return 1;
+					}
+				}
+			}
+			else if (currentCharacter == AposEntityName[1])
+			{
+				// "&ap"
+				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+				++entityNameCharCount;
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return -1;
 				}
 
-				// <?xml version="1.x"   ?>
-				if (sourceType != SourceReader &&
-					bom != Details::Bom::None &&
-					bom != Details::Bom::Utf8 &&
-					bom != Details::Bom::Utf16BE &&
-					bom != Details::Bom::Utf16LE)
+				if (currentCharacter == AposEntityName[2])
 				{
-					Reset();
-					SetError(ErrorCode::EncodingDeclarationRequired);
-					row = 1;
-					column = 1;
-					return false;
+					// "&apo"
+					CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+					++entityNameCharCount;
+					if (NextCharBad(insideTag))
+					{
+						if (!insideTag && eof)
+						{
+							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+							Stop();
+							SetError(ErrorCode::UnclosedTag);
+							row = ref.Row;
+							column = ref.Column;
+							eof = true;
+						}
+						return -1;
+					}
+
+					if (currentCharacter == AposEntityName[3])
+					{
+						// "&apos"
+						CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+						++entityNameCharCount;
+						if (NextCharBad(insideTag))
+						{
+							if (!insideTag && eof)
+							{
+								UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+								Stop();
+								SetError(ErrorCode::UnclosedTag);
+								row = ref.Row;
+								column = ref.Column;
+								eof = true;
+							}
+							return -1;
+						}
+
+						if (currentCharacter == Semicolon)
+						{
+							// "&apos;"
+							currentCharacter = SingleQuote;
+							entityName.clear();
+							return 1;
+						}
+					}
 				}
+			}
 
-				node = Inspected::XmlDeclaration;
-				return true;
+			if (currentCharacter == Semicolon)
+			{
+				return 0;
+			}
+			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
+				currentCharacter == Colon)
+			{
+				Stop();
+				SetError(ErrorCode::InvalidReferenceSyntax);
+				row = referenceRow;
+				column = referenceColumn;
+				return -1;
 			}
 		}
-		else // IsWhiteSpace(currentCharacter) == false
+		else if (currentCharacter == QuotEntityName[0])
 		{
-			if (currentCharacter != Question)
+			// "&q"
+			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+			++entityNameCharCount;
+			std::size_t i;
+			for (i = 1; i < 4; ++i)
 			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return -1;
+				}
+
+				if (currentCharacter != QuotEntityName[i])
+					break;
+
+				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+				++entityNameCharCount;
 			}
 
-			// <?xml version="1.x"?
-			if (NextCharBad(true))
-				return false;
+			if (i == 4)
+			{
+				if (NextCharBad(insideTag))
+				{
+					if (!insideTag && eof)
+					{
+						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+						Stop();
+						SetError(ErrorCode::UnclosedTag);
+						row = ref.Row;
+						column = ref.Column;
+						eof = true;
+					}
+					return -1;
+				}
+			}
 
-			if (currentCharacter != GreaterThan)
+			if (currentCharacter == Semicolon)
 			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
+				if (i == 4)
+				{
+					// "&quot;"
+					currentCharacter = DoubleQuote;
+					entityName.clear();
+					return 1;
+				}
+				else
+				{
+					return 0;
+				}
+			}
+			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
+				currentCharacter == Colon)
+			{
+				Stop();
+				SetError(ErrorCode::InvalidReferenceSyntax);
+				row = referenceRow;
+				column = referenceColumn;
+				return -1;
 			}
+		}
 
-			// <?xml version="1.x"?>
-			if (sourceType != SourceReader &&
-				bom != Details::Bom::None &&
-				bom != Details::Bom::Utf8 &&
-				bom != Details::Bom::Utf16BE &&
-				bom != Details::Bom::Utf16LE)
+		do
+		{
+			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
+			++entityNameCharCount;
+			if (NextCharBad(insideTag))
 			{
-				Reset();
-				SetError(ErrorCode::EncodingDeclarationRequired);
-				row = 1;
-				column = 1;
-				return false;
+				if (!insideTag && eof)
+				{
+					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+					Stop();
+					SetError(ErrorCode::UnclosedTag);
+					row = ref.Row;
+					column = ref.Column;
+					eof = true;
+				}
+				return -1;
 			}
 
-			node = Inspected::XmlDeclaration;
-			return true;
+			if (currentCharacter == Colon)
+			{
+				Stop();
+				SetError(ErrorCode::InvalidReferenceSyntax);
+				row = referenceRow;
+				column = referenceColumn;
+				return -1;
+			}
 		}
+		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
 
-		// Now should be an encoding or standalone attribute.
-		if (currentCharacter == XmlDeclarationEncoding[0])
+		if (currentCharacter != Semicolon)
 		{
-			// encoding
-			AttributeType& encodingAttr = NewAttribute();
-			encodingAttr.Row = currentRow;
-			encodingAttr.Column = currentColumn;
-			comparingName.clear(); // Could be not empty after call of Reset method.
-			comparingName.reserve(NameReserve);
+			Stop();
+			SetError(ErrorCode::InvalidReferenceSyntax);
+			row = referenceRow;
+			column = referenceColumn;
+			return -1;
+		}
 
-			for (std::size_t i = 0; i < 8; ++i)
+		return 0;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AttributeUniqueness()
+	{
+		if (attributesSize > 1)
+		{
+			const AttributesSizeType lastIndex = attributesSize - 1;
+			const AttributeType& last = attributes[lastIndex];
+			for (AttributesSizeType i = 0; i < lastIndex; ++i)
 			{
-				if (currentCharacter != XmlDeclarationEncoding[i])
+				if (last.Name == attributes[i].Name)
 				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
+					Stop();
+					SetError(ErrorCode::DoubleAttributeName);
+					row = last.Row;
+					column = last.Column;
 					return false;
 				}
-				CharactersWriterType::WriteCharacter(encodingAttr.Name, currentCharacter);
-				CharactersWriterType::WriteCharacter(encodingAttr.LocalName, currentCharacter);
-				if (NextCharBad(true))
-					return false;
-			}
-
-			// '<?xml version="1.x" encoding' Char
-			
-			while (IsWhiteSpace(currentCharacter))
-			{
-				if (NextCharBad(true))
-					return false;
 			}
+		}
 
-			if (currentCharacter != Equals)
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
+		return true;
+	}
 
-			// '<?xml version="1.x" encoding='
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline std::istream* Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::EncodingStream()
+	{
+		if (sourceType == SourcePath)
+			return &fileStream;
 
-			if (NextCharBad(true))
-				return false;
+		if (sourceType == SourceMemory || sourceType == SourceFeed)
+		{
+			// Current reader decodes UTF-8 directly from the memory.
+			// New reader continues from its position.
+			memoryBuf.Reset(memoryReader.GetFirstIterator(), memoryLast);
+			memoryStream.clear();
+			return &memoryStream;
+		}
 
-			while (IsWhiteSpace(currentCharacter))
-			{
-				if (NextCharBad(true))
-					return false;
-			}
+		if (sourceType == SourceFd)
+		{
+			// Buffer position is shared with the current reader.
+			fdStream.clear();
+			return &fdStream;
+		}
 
-			quoteChar = currentCharacter;
+		return inputStreamPtr;
+	}
 
-			if (quoteChar == DoubleQuote)
-			{
-				// <?xml version="1.x" encoding="
-				encodingAttr.Delimiter = QuotationMark::DoubleQuote;
-			}
-			else if (quoteChar == SingleQuote)
-			{
-				// <?xml version="1.x" encoding='
-				encodingAttr.Delimiter = QuotationMark::SingleQuote;
-			}
-			else
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ReplaceReader(
+		Encoding::CharactersReader* newReader)
+	{
+		if (reader != &memoryReader && reader != &fdReader && reader != &singleByteReader)
+			delete reader;
+		reader = newReader;
+		// Only the single-byte readers replace the reader of the declaration.
+		if (newReader != nullptr)
+			codeUnitSize = 1;
+	}
 
-			if (NextCharBad(true))
-				return false;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SniffEncoding(
+		const char* first, const char* last, std::istream* stream)
+	{
+		const char* encodingFirst;
+		const char* encodingLast;
+		Details::Declaration declaration = Details::SniffDeclaration(
+			first, last, encodingFirst, encodingLast);
+		if (declaration == Details::Declaration::Unknown)
+			return; // The reader is chosen by ResolveEncoding method.
+
+		encodingResolved = true;
+		if (declaration == Details::Declaration::NoEncoding)
+			return;
+
+		const char16_t* characterMap = Details::CharacterMap(
+			Details::FindCharset(encodingFirst, encodingLast));
+		if (characterMap != nullptr)
+		{
+			// The declaration itself is decoded by the final reader.
+			// ResolveEncoding method will only check it.
+			singleByteReader.ResetInputStream(stream);
+			singleByteReader.ResetCharacterMap(characterMap);
+			ReplaceReader(&singleByteReader);
+		}
+	}
 
-			if (!Encoding::CharactersReader::IsEncNameStartChar(currentCharacter))
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ResolveEncoding(const AttributeType& encoding)
+	{
+		// comparingName is already set.
 
-			do
-			{
-				CharactersWriterType::WriteCharacter(encodingAttr.Value, currentCharacter);
-				comparingName.push_back(currentCharacter);
-				if (NextCharBad(true))
-					return false;
-			}
-			while (Encoding::CharactersReader::IsEncNameChar(currentCharacter));
+		SizeType tempRow;
+		SizeType tempColumn;
 
-			if (currentCharacter != quoteChar)
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
+		Details::Charset charset = Details::FindCharset(
+			comparingName.data(), comparingName.data() + comparingName.size());
+		switch (charset)
+		{
+			case Details::Charset::Unknown:
+				tempRow = encoding.Row;
+				tempColumn = encoding.Column;
+				Stop();
+				SetError(ErrorCode::UnknownEncoding);
 				row = tempRow;
 				column = tempColumn;
 				return false;
-			}
-
-			// '<?xml' VersionInfo EncodingDecl
-			if (sourceType != SourceReader && !ResolveEncoding(encodingAttr))
-				return false;
-			if (NextCharBad(true))
-				return false;
-			
-			if (IsWhiteSpace(currentCharacter))
-			{
-				do
+			case Details::Charset::Utf8:
+				if (bom == Details::Bom::Utf8 ||
+					bom == Details::Bom::None)
+					return true;
+				break;
+			case Details::Charset::Utf16:
+				if (bom == Details::Bom::Utf16BE ||
+					bom == Details::Bom::Utf16LE)
+					return true;
+				break;
+			case Details::Charset::Utf32:
+				if (bom == Details::Bom::Utf32BE ||
+					bom == Details::Bom::Utf32LE)
+					return true;
+				break;
+			case Details::Charset::Utf16BE:
+				if (bom == Details::Bom::Utf16BE)
+					return true;
+				break;
+			case Details::Charset::Utf16LE:
+				if (bom == Details::Bom::Utf16LE)
+					return true;
+				break;
+			case Details::Charset::Utf32BE:
+				if (bom == Details::Bom::Utf32BE)
+					return true;
+				break;
+			case Details::Charset::Utf32LE:
+				if (bom == Details::Bom::Utf32LE)
+					return true;
+				break;
+			default:
+				// Single byte encoding.
+				if (bom == Details::Bom::None)
 				{
-					if (NextCharBad(true))
-						return false;
+					// The reader could be chosen already by SniffEncoding method.
+					if (reader != &singleByteReader)
+					{
+						singleByteReader.ResetInputStream(EncodingStream());
+						singleByteReader.ResetCharacterMap(Details::CharacterMap(charset));
+						ReplaceReader(&singleByteReader);
+					}
+					encodingResolved = true;
+					return true;
 				}
-				while (IsWhiteSpace(currentCharacter));
+				break;
+		}
+
+		tempRow = encoding.Row;
+		tempColumn = encoding.Column;
+		Stop();
+		SetError(ErrorCode::EncodingConfusion);
+		row = tempRow;
+		column = tempColumn;
+		return false;
+	}
+
+	
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AttributeType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::NewAttribute()
+	{
+		AttributesSizeType fakeSize = static_cast<AttributesSizeType>(attributesSize);
+		if (fakeSize < attributes.size())
+		{
+			++attributesSize;
+			AttributeType& ref = attributes[fakeSize];
+			ref.Name.clear();
+			ref.Value.clear();
+			ref.LocalName.clear();
+			ref.Prefix.clear();
+			ref.NamespaceUri.clear();
+			return ref;
+		}
+
+		// fakeSize == attributes.size().
+		attributes.push_back(AttributeType());
+		++attributesSize;
+		AttributeType& ref = attributes.back();
+		ref.Name.reserve(NameReserve);
+		ref.Value.reserve(ValueReserve);
+		ref.LocalName.reserve(LocalNameReserve);
+		ref.Prefix.reserve(PrefixReserve);
+		ref.NamespaceUri.reserve(NamespaceUriReserve);
+		return ref;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::UnclosedTagType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::NewUnclosedTag()
+	{
+		UnclosedTagsSizeType fakeSize = static_cast<UnclosedTagsSizeType>(unclosedTagsSize);
+		if (fakeSize < unclosedTags.size())
+		{
+			++unclosedTagsSize;
+			UnclosedTagType& ref = unclosedTags[fakeSize];
+			ref.Name.clear();
+			ref.LocalName.clear();
+			ref.Prefix.clear();
+			ref.NamespaceUri.clear();
+			return ref;
+		}
+
+		// fakeSize == unclosedTags.size().
+		unclosedTags.push_back(UnclosedTagType());
+		++unclosedTagsSize;
+		UnclosedTagType& ref = unclosedTags.back();
+		ref.Name.reserve(NameReserve);
+		ref.LocalName.reserve(LocalNameReserve);
+		ref.Prefix.reserve(PrefixReserve);
+		ref.NamespaceUri.reserve(NamespaceUriReserve);
+		return ref;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::NamespaceDeclarationType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::NewNamespace()
+	{
+		NamespacesSizeType fakeSize = static_cast<NamespacesSizeType>(namespacesSize);
+		if (fakeSize < namespaces.size())
+		{
+			++namespacesSize;
+			NamespaceDeclarationType& ref = namespaces[fakeSize];
+			ref.Prefix.clear();
+			ref.Uri.clear();
+			ref.TagIndex = 0;
+			return ref;
+		}
+
+		// fakeSize == namespaces.size().
+		namespaces.push_back(NamespaceDeclarationType());
+		++namespacesSize;
+		NamespaceDeclarationType& ref = namespaces.back();
+		ref.Prefix.reserve(PrefixReserve);
+		ref.Uri.reserve(NamespaceUriReserve);
+		return ref;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::InitStrings()
+	{
+		name.reserve(NameReserve);
+		value.reserve(ValueReserve);
+		localName.reserve(LocalNameReserve);
+		prefix.reserve(PrefixReserve);
+		namespaceUri.reserve(NamespaceUriReserve);
+
+		lowerXmlString.reserve(3);
+		xmlnsString.reserve(5);
+		xmlUriString.reserve(36);
+		xmlnsUriString.reserve(29);
 
-				if (currentCharacter == Question)
-				{
-					// '<?xml' VersionInfo EncodingDecl S '?'
-					if (NextCharBad(true))
-						return false;
+		for (std::size_t i = 0; i < 3; ++i)
+			CharactersWriterType::WriteCharacter(lowerXmlString, LowerXml[i]);
 
-					if (currentCharacter != GreaterThan)
-					{
-						tempRow = currentRow;
-						tempColumn = currentColumn;
-						Reset();
-						SetError(ErrorCode::InvalidSyntax);
-						row = tempRow;
-						column = tempColumn;
-						return false;
-					}
+		for (std::size_t i = 0; i < 5; ++i)
+			CharactersWriterType::WriteCharacter(xmlnsString, Xmlns[i]);
 
-					// '<?xml' VersionInfo EncodingDecl S '?>'
-					node = Inspected::XmlDeclaration;
-					return true;
-				}
-			}
-			else // IsWhiteSpace(currentCharacter) == false
-			{
-				if (currentCharacter != Question)
-				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
+		for (std::size_t i = 0; i < 36; ++i)
+			CharactersWriterType::WriteCharacter(xmlUriString, XmlUri[i]);
 
-				if (NextCharBad(true))
-					return false;
+		for (std::size_t i = 0; i < 29; ++i)
+			CharactersWriterType::WriteCharacter(xmlnsUriString, XmlnsUri[i]);
+	}
 
-				if (currentCharacter != GreaterThan)
-				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SavePosition()
+	{
+		SavePosition(row, column, 0);
+		if (PositionPolicyType::IsTracked)
+			byteOffset = currentByteOffset;
+	}
 
-				// '<?xml' VersionInfo EncodingDecl '?>'
-				node = Inspected::XmlDeclaration;
-				return true;
-			}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SavePosition(
+		AttributeType& attribute)
+	{
+		SavePosition(attribute.Row, attribute.Column, 0);
+		if (PositionPolicyType::IsTracked)
+			attribute.ByteOffset = currentByteOffset;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SavePosition(
+		SizeType& resultRow, SizeType& resultColumn, SizeType before)
+	{
+		if (PositionPolicyType::IsTracked)
+		{
+			resultRow = currentRow;
+			resultColumn = currentColumn - before;
+			return;
+		}
+
+		// Number of characters of the buffer up to the current one. It's 0 if the current
+		// character is CR at the end of the previous buffer (see NextCharBad method).
+		const std::size_t index = charactersPosition - (bufferedCharacter > 3 ? 1 : 0);
+		if (index > before)
+		{
+			resultRow = 0;
+			resultColumn = static_cast<SizeType>(index - before);
 		}
 		else
 		{
-			if (sourceType != SourceReader &&
-				bom != Details::Bom::None &&
-				bom != Details::Bom::Utf8 &&
-				bom != Details::Bom::Utf16BE &&
-				bom != Details::Bom::Utf16LE)
-			{
-				Reset();
-				SetError(ErrorCode::EncodingDeclarationRequired);
-				row = 1;
-				column = 1;
-				return false;
-			}
+			// The saved character isn't in the buffer.
+			Details::PositionCheckpoint position = checkpoint;
+			position.Advance(charactersBuffer, charactersBuffer + index);
+			resultRow = position.Row;
+			resultColumn = position.Column - before;
 		}
+	}
 
-		// Now should be a standalone attribute.
-		AttributeType& standaloneAttr = NewAttribute();
-		standaloneAttr.Row = currentRow;
-		standaloneAttr.Column = currentColumn;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ResolvePosition(
+		Details::PositionCheckpoint& position, std::size_t& index,
+		SizeType& resultRow, SizeType& resultColumn) const
+	{
+		if (resultRow != 0 || resultColumn == 0)
+			return;
 
-		for (std::size_t i = 0; i < 10; ++i)
+		const std::size_t last = static_cast<std::size_t>(resultColumn);
+		if (last < index)
 		{
-			if (currentCharacter != XmlDeclarationStandalone[i])
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
-			CharactersWriterType::WriteCharacter(standaloneAttr.Name, currentCharacter);
-			CharactersWriterType::WriteCharacter(standaloneAttr.LocalName, currentCharacter);
-			if (NextCharBad(true))
-				return false;
+			position = checkpoint;
+			index = 0;
 		}
+		position.Advance(charactersBuffer + index, charactersBuffer + last);
+		index = last;
+		resultRow = position.Row;
+		resultColumn = position.Column;
+	}
 
-		// '<?xml' VersionInfo EncodingDecl S 'standalone' Char
-		
-		while (IsWhiteSpace(currentCharacter))
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ResolvePositions()
+	{
+		// One pass over the buffer if the positions are in order.
+		Details::PositionCheckpoint position = checkpoint;
+		std::size_t index = 0;
+
+		// Tags are opened in order, so only the last ones can be pending.
+		UnclosedTagsSizeType i = unclosedTagsSize;
+		while (i != 0 && unclosedTags[i - 1].Row == 0)
+			--i;
+		for ( ; i < unclosedTagsSize; ++i)
+			ResolvePosition(position, index, unclosedTags[i].Row, unclosedTags[i].Column);
+
+		ResolvePosition(position, index, row, column);
+		for (AttributesSizeType j = 0; j < attributesSize; ++j)
+			ResolvePosition(position, index, attributes[j].Row, attributes[j].Column);
+		ResolvePosition(position, index, referenceRow, referenceColumn);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Details::PositionCheckpoint
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StopPosition() const
+	{
+		// Characters of the buffer stay untouched until the next source is read.
+		Details::PositionCheckpoint position = stopCheckpoint;
+		position.Advance(charactersBuffer, charactersBuffer + stopIndex);
+		if (stopAfter)
 		{
-			if (NextCharBad(true))
-				return false;
+			const char32_t next = 0;
+			position.Advance(&next, &next + 1);
 		}
+		return position;
+	}
 
-		if (currentCharacter != Equals)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Details::PositionCheckpoint
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::LazyPosition() const
+	{
+		Details::PositionCheckpoint position;
+		if (row != 0)
 		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
+			position.Row = row;
+			position.Column = column;
 		}
+		else if (column != 0)
+		{
+			// Pending position of the node or the start of the erroneous token.
+			position = stopped ? stopCheckpoint : checkpoint;
+			position.Advance(charactersBuffer,
+				charactersBuffer + static_cast<std::size_t>(column));
+		}
+		else if (stopped)
+		{
+			// Error at the character at which it was detected.
+			position = StopPosition();
+		}
+		else
+		{
+			position.Row = 0;
+		}
+		return position;
+	}
 
-		// '<?xml' VersionInfo EncodingDecl S 'standalone' S? '='
-
-		if (NextCharBad(true))
-			return false;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline int Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ReadCharacter(char32_t& result)
+	{
+		if (charactersPosition < charactersCount)
+		{
+			result = charactersBuffer[charactersPosition++];
+			return 1;
+		}
 
-		while (IsWhiteSpace(currentCharacter))
+		if (charactersResult != 1)
 		{
-			if (NextCharBad(true))
-				return false;
+			// End of the source or error after the last buffered character.
+			return charactersResult;
 		}
 
-		quoteChar = currentCharacter;
+		// Until the first node is inspected, the XML declaration could
+		// replace the reader (see ResolveEncoding method), so we can't
+		// decode more than one character in advance.
+		std::size_t capacity = CharactersBufferSize;
+		if (node == Inspected::None &&
+			sourceType != SourceReader &&
+			bom == Details::Bom::None &&
+			!encodingResolved)
+			capacity = 1;
 
-		if (quoteChar == DoubleQuote)
+		if (!PositionPolicyType::IsTracked)
 		{
-			// '<?xml' VersionInfo EncodingDecl S 'standalone' Eq '"'
-			standaloneAttr.Delimiter = QuotationMark::DoubleQuote;
+			ResolvePositions();
+			checkpoint.Advance(charactersBuffer, charactersBuffer + charactersCount);
 		}
-		else if (quoteChar == SingleQuote)
+		charactersPosition = 0;
+		charactersBytes = nullptr;
+		charactersBytesPosition = 0;
+		if (reader == &memoryReader)
 		{
-			// '<?xml' VersionInfo EncodingDecl S 'standalone' Eq "'"
-			standaloneAttr.Delimiter = QuotationMark::SingleQuote;
+			// Reader owned by the Inspector, so its type is known.
+			charactersBytes = memoryReader.GetFirstIterator();
+			charactersCount = memoryReader.Encoding::Utf8IteratorsReader<const char*>::ReadCharacters(
+				charactersBuffer, capacity, charactersResult);
+		}
+		else if (reader == &fdReader)
+		{
+			charactersCount = fdReader.Details::Utf8FdReader::ReadCharacters(
+				charactersBuffer, capacity, charactersResult);
+		}
+		else if (reader == &singleByteReader)
+		{
+			charactersCount = singleByteReader.Encoding::SingleByteStreamReader::ReadCharacters(
+				charactersBuffer, capacity, charactersResult);
+		}
+		else if (sourceType == SourceReader)
+		{
+			charactersCount = ReadCharacters(capacity, std::integral_constant<bool,
+				!std::is_same<CharactersReaderType, Encoding::CharactersReader>::value>());
 		}
 		else
 		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
+			charactersCount = reader->ReadCharacters(charactersBuffer, capacity, charactersResult);
 		}
+		if (charactersCount == 0)
+			return charactersResult;
 
-		if (NextCharBad(true))
-			return false;
+		// Some characters were read, so the result is
+		// reported after the last of them.
+		result = charactersBuffer[charactersPosition++];
+		return 1;
+	}
 
-		if (currentCharacter == Yes[0])
-		{
-			CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter == Yes[1])
-			{
-				CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter == Yes[2])
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline std::size_t Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::TakeRun(
+		unsigned char runType, const char32_t*& run)
+	{
+		// Next character could be buffered by the line ends normalization.
+		if (bufferedCharacter != 0)
+			return 0;
+
+		run = charactersBuffer + charactersPosition;
+		const char32_t* last = charactersBuffer + charactersCount;
+		const char32_t* i = run;
+		// Skip the long runs up to the first character of the terminator,
+		// the rest of the terminator is verified by the caller.
+		if (runType == TextRun)
+			i = Details::SkipRunCharacters(i, last, LessThan, Ampersand, RightSquareBracket);
+		else if (runType == CommentRun)
+			i = Details::SkipRunCharacters(i, last, Minus, Minus, Minus);
+		else if (runType == CDataRun)
+			i = Details::SkipRunCharacters(i, last, RightSquareBracket, RightSquareBracket, RightSquareBracket);
+		else if (runType == ProcessingInstructionRun)
+			i = Details::SkipRunCharacters(i, last, Question, Question, Question);
+		else if (runType == AttributeValueRun)
+			i = Details::SkipAttributeValueCharacters(i, last);
+		while (i != last && *i < 0x80 && (AsciiRuns[*i] & runType) != 0)
+			++i;
+
+		std::size_t length = static_cast<std::size_t>(i - run);
+		if (length != 0)
+		{
+			charactersPosition += length;
+			if (PositionPolicyType::IsTracked)
+			{
+				// Name and attribute value runs don't contain line feeds.
+				// Every character after a line feed starts the next row.
+				SizeType rows = 0;
+				const char32_t* rowFirst = run;
+				if (currentCharacter == LineFeed)
+					rows = 1;
+				if ((AsciiRuns[LineFeed] & runType) != 0)
 				{
-					CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
-					if (NextCharBad(true))
-						return false;
-					if (currentCharacter == quoteChar)
+					for (const char32_t* j = run; j != i - 1; ++j)
 					{
-						// '<?xml' VersionInfo EncodingDecl SDDecl
-						if (NextCharBad(true))
-							return false;
-						while (IsWhiteSpace(currentCharacter))
-						{
-							if (NextCharBad(true))
-								return false;
-						}
-						if (currentCharacter != Question)
-						{
-							tempRow = currentRow;
-							tempColumn = currentColumn;
-							Reset();
-							SetError(ErrorCode::InvalidSyntax);
-							row = tempRow;
-							column = tempColumn;
-							return false;
-						}
-						if (NextCharBad(true))
-							return false;
-						if (currentCharacter != GreaterThan)
+						if (*j == LineFeed)
 						{
-							tempRow = currentRow;
-							tempColumn = currentColumn;
-							Reset();
-							SetError(ErrorCode::InvalidSyntax);
-							row = tempRow;
-							column = tempColumn;
-							return false;
+							++rows;
+							rowFirst = j + 1;
 						}
-
-						// '<?xml' VersionInfo EncodingDecl SDDecl '?>'
-						node = Inspected::XmlDeclaration;
-						return true;
 					}
 				}
-			}
-		}
-		else if (currentCharacter == No[0])
-		{
-			CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter == No[1])
-			{
-				CharactersWriterType::WriteCharacter(standaloneAttr.Value, currentCharacter);
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter == quoteChar)
+				if (rows != 0)
 				{
-					// '<?xml' VersionInfo EncodingDecl SDDecl
-					if (NextCharBad(true))
-						return false;
-					while (IsWhiteSpace(currentCharacter))
-					{
-						if (NextCharBad(true))
-							return false;
-					}
-					if (currentCharacter != Question)
-					{
-						tempRow = currentRow;
-						tempColumn = currentColumn;
-						Reset();
-						SetError(ErrorCode::InvalidSyntax);
-						row = tempRow;
-						column = tempColumn;
-						return false;
-					}
-					if (NextCharBad(true))
-						return false;
-					if (currentCharacter != GreaterThan)
-					{
-						tempRow = currentRow;
-						tempColumn = currentColumn;
-						Reset();
-						SetError(ErrorCode::InvalidSyntax);
-						row = tempRow;
-						column = tempColumn;
-						return false;
-					}
-
-					// '<?xml' VersionInfo EncodingDecl SDDecl '?>'
-					node = Inspected::XmlDeclaration;
-					return true;
+					currentRow += rows;
+					currentColumn = static_cast<SizeType>(i - rowFirst);
 				}
+				else
+				{
+					currentColumn += static_cast<SizeType>(length);
+				}
+				// ASCII characters take one code unit.
+				std::size_t unitSize = (codeUnitSize != 0) ? codeUnitSize : 1;
+				currentByteOffset += currentCharacterBytes + (length - 1) * unitSize;
+				currentCharacterBytes = unitSize;
 			}
+			currentCharacter = run[length - 1];
+		}
+		return length;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline std::size_t Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AppendRun(
+		unsigned char runType, StringType& destination, const char32_t*& run)
+	{
+		std::size_t length;
+		if (TakeBytesRun(runType, destination, length,
+			std::is_same<CharactersWriterType, Encoding::Utf8Writer>()))
+		{
+			run = charactersBuffer + charactersPosition - length;
+			return length;
 		}
 
-		tempRow = currentRow;
-		tempColumn = currentColumn;
-		Reset();
-		SetError(ErrorCode::InvalidSyntax);
-		row = tempRow;
-		column = tempColumn;
-		return false;
+		length = TakeRun(runType, run);
+		if (length != 0)
+		{
+			FlushView();
+			Details::WriteCharacters<CharactersWriterType>(destination, run, run + length);
+		}
+		return length;
 	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseProcessingInstruction()
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::TakeBytesRun(
+		unsigned char runType, StringType& destination, std::size_t& length, std::true_type)
 	{
-		// '<?' PITarget (':' | (Char - NameChar))
-		// name == PITarget
-		// localName.empty() == true
+		// Next character could be buffered by the line ends normalization.
+		if (charactersBytes == nullptr || bufferedCharacter != 0)
+			return false;
 
-		SizeType tempRow;
-		SizeType tempColumn;
+		SyncCharactersBytes();
 
-		if (currentCharacter == Question)
+		// Non-ASCII characters are allowed in all the runs except names.
+		const unsigned char* first = reinterpret_cast<const unsigned char*>(charactersBytes);
+		const unsigned char* last = reinterpret_cast<const unsigned char*>(memoryLast);
+		std::size_t available = charactersCount - charactersPosition;
+		std::size_t count = 0;
+		const unsigned char* i = Details::SkipRunBytes(first, last, available, count);
+		while (i != last)
 		{
-			// '<?' PITarget '?'
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter != GreaterThan)
+			if ((*i & 0xC0) == 0x80)
 			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
+				// Continuation byte of the taken character.
+				++i;
+				continue;
 			}
-
-			// '<?' PITarget '?>'
-			localName = name;
-			node = Inspected::ProcessingInstruction;
-			return true;
-		}
-
-		if (!IsWhiteSpace(currentCharacter))
-		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
+			if (count == available || (*i < 0x80 && (AsciiRuns[*i] & runType) == 0))
+				break;
+			++count;
+			++i;
 		}
 
-		localName = name;
+		length = count;
+		if (count == 0)
+			return true;
 
-		// Ignore white spaces.
-		do
+		if (PositionPolicyType::IsTracked)
 		{
-			if (NextCharBad(true))
-				return false;
-		}
-		while (IsWhiteSpace(currentCharacter));
+			const unsigned char* lastCharacter = i - 1;
+			while ((*lastCharacter & 0xC0) == 0x80)
+				--lastCharacter;
 
-		do // {...} while (true);
-		{
-			if (currentCharacter == Question)
+			// Every character after a line feed starts the next row.
+			SizeType rows = 0;
+			const unsigned char* rowFirst = first;
+			if (currentCharacter == LineFeed)
+				rows = 1;
+			for (const unsigned char* j = first; j != lastCharacter; ++j)
 			{
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter == GreaterThan)
+				if (*j == LineFeed)
 				{
-					node = Inspected::ProcessingInstruction;
-					return true;
+					++rows;
+					rowFirst = j + 1;
+				}
+			}
+			if (rows != 0)
+			{
+				SizeType columns = 0;
+				for (const unsigned char* j = rowFirst; j != i; ++j)
+				{
+					if ((*j & 0xC0) != 0x80)
+						++columns;
 				}
-				CharactersWriterType::WriteCharacter(value, Question);
+				currentRow += rows;
+				currentColumn = columns;
 			}
 			else
 			{
-				CharactersWriterType::WriteCharacter(value, currentCharacter);
-				if (NextCharBad(true))
-					return false;
+				currentColumn += static_cast<SizeType>(count);
 			}
+			currentByteOffset += currentCharacterBytes + static_cast<std::size_t>(lastCharacter - first);
+			currentCharacterBytes = static_cast<std::size_t>(i - lastCharacter);
 		}
-		while (true);
 
-		// Should never happen.
+		AppendBytes(destination, charactersBytes, reinterpret_cast<const char*>(i));
+		charactersPosition += count;
+		charactersBytesPosition = charactersPosition;
+		charactersBytes = reinterpret_cast<const char*>(i);
+		currentCharacter = charactersBuffer[charactersPosition - 1];
+		return true;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::TakeBytesRun(
+		unsigned char, StringType&, std::size_t&, std::false_type)
+	{
 		return false;
 	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseExclamation()
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SyncCharactersBytes()
 	{
-		// currentCharacter == Exclamation.
-		// Comment, CDATA or DocumentType.
+		// Characters are decoded from valid UTF-8 sequences, so their
+		// lengths are the lengths of the sequences.
+		for ( ; charactersBytesPosition != charactersPosition; ++charactersBytesPosition)
+		{
+			char32_t c = charactersBuffer[charactersBytesPosition];
+			charactersBytes += (c < 0x80) ? 1 : (c < 0x800) ? 2 : (c < 0x10000) ? 3 : 4;
+		}
+	}
 
-		SizeType tempRow;
-		SizeType tempColumn;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::WriteCurrentCharacter(
+		StringType& destination)
+	{
+		WriteCurrentCharacter(destination,
+			std::is_same<CharactersWriterType, Encoding::Utf8Writer>());
+	}
 
-		if (NextCharBad(true))
-			return false;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::WriteCurrentCharacter(
+		StringType& destination, std::true_type)
+	{
+		// Line feed normalized from CR, LF pair is the last of them,
+		// but line feed normalized from single CR is not in the document.
+		if (charactersBytes != nullptr && bufferedCharacter == 0 && charactersPosition != 0 &&
+			charactersBuffer[charactersPosition - 1] == currentCharacter)
+		{
+			SyncCharactersBytes();
+			char32_t c = currentCharacter;
+			std::size_t size = (c < 0x80) ? 1 : (c < 0x800) ? 2 : (c < 0x10000) ? 3 : 4;
+			AppendBytes(destination, charactersBytes - size, charactersBytes);
+			return;
+		}
+		WriteValueCharacter(destination, currentCharacter);
+	}
 
-		if (currentCharacter == Minus)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::WriteCurrentCharacter(
+		StringType& destination, std::false_type)
+	{
+		CharactersWriterType::WriteCharacter(destination, currentCharacter);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::WriteValueCharacter(
+		StringType& destination, char32_t codePoint)
+	{
+		FlushView();
+		CharactersWriterType::WriteCharacter(destination, codePoint);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AppendBytes(
+		StringType& destination,
+		const typename StringType::value_type* first,
+		const typename StringType::value_type* last)
+	{
+		if (viewString == &destination && viewLast == first)
 		{
-			// <!-
-			// Looks like a comment.
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter != Minus)
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
+			viewLast = last;
+			return;
+		}
 
-			return ParseComment();
+		// Fed bytes could be moved, so only the bytes of the whole
+		// document in memory could be viewed after the inspection.
+		if (viewString == nullptr && destination.empty() && sourceType == SourceMemory)
+		{
+			viewString = &destination;
+			viewFirst = first;
+			viewLast = last;
+			return;
 		}
 
-		if (currentCharacter == LeftSquareBracket)
+		FlushView();
+		destination.append(first, static_cast<std::size_t>(last - first));
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::FlushView()
+	{
+		if (viewString != nullptr)
 		{
-			// <![
-			// Looks like CDATA section.
-			for (std::size_t i = 0; i < 5; ++i)
-			{
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter != CDATA[i])
-				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
-			}
-			// <![CDATA
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter != LeftSquareBracket)
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
+			viewString->assign(viewFirst, static_cast<std::size_t>(viewLast - viewFirst));
+			viewString = nullptr;
+		}
+	}
 
-			return ParseCDATA();
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::WriteNameCharacters(
+		StringType& qualifiedName, StringType& localPart)
+	{
+		CharactersWriterType::WriteCharacter(qualifiedName, currentCharacter);
+		CharactersWriterType::WriteCharacter(localPart, currentCharacter);
+
+		const char32_t* run;
+		std::size_t runLength = TakeRun(NameRun, run);
+		if (runLength != 0)
+		{
+			Details::WriteCharacters<CharactersWriterType>(qualifiedName, run, run + runLength);
+			Details::WriteCharacters<CharactersWriterType>(localPart, run, run + runLength);
 		}
+	}
 
-		// <!currentCharacter
-		// Should be DOCTYPE declaration.
-		for (std::size_t i = 0; i < 7; ++i)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline std::size_t Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ReadCharacters(
+		std::size_t capacity, std::true_type)
+	{
+		// Reader type is known at compile time, so the call can be inlined.
+		return static_cast<CharactersReaderType*>(reader)->CharactersReaderType::ReadCharacters(
+			charactersBuffer, capacity, charactersResult);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline std::size_t Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ReadCharacters(
+		std::size_t capacity, std::false_type)
+	{
+		return reader->ReadCharacters(charactersBuffer, capacity, charactersResult);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline std::size_t Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::CharacterBytes(
+		char32_t codePoint) const
+	{
+		if (codeUnitSize == 0)
 		{
-			if (currentCharacter != DOCTYPE[i])
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
-			if (NextCharBad(true))
-				return false;
+			// Readers reject overlong UTF-8 sequences.
+			if (codePoint < 0x80)
+				return 1;
+			if (codePoint < 0x800)
+				return 2;
+			return (codePoint < 0x10000) ? 3 : 4;
 		}
-		return ParseDOCTYPE();
+
+		// Surrogate pair.
+		if (codeUnitSize == 2 && codePoint > 0xFFFF)
+			return 4;
+		return codeUnitSize;
 	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseComment()
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::NextCharBad(bool insideTag)
 	{
-		// currentCharacter == Minus.
+		// x, CR, LF, y => x, LF, y
+		// x, CR, y => x, LF, y
+		// x, LF, CR, y => x, LF, LF, y
+		// Check http://www.w3.org/TR/2008/REC-xml-20081126/#sec-line-ends.
 
 		SizeType tempRow;
 		SizeType tempColumn;
 
-		PrepareNode();
+		if (PositionPolicyType::IsTracked)
+		{
+			if (currentCharacter == LineFeed)
+			{
+				++currentRow;
+				currentColumn = 1;
+			}
+			else
+			{
+				++currentColumn;
+			}
+			currentByteOffset += currentCharacterBytes;
+			currentCharacterBytes = 0;
+		}
 
-		bool doubleMinus = false;
-		do
+		if (bufferedCharacter != 0)
 		{
-			if (NextCharBad(true))
+			if (bufferedCharacter > 3) // Allowed character.
+			{
+				currentCharacter = bufferedCharacter;
+				if (PositionPolicyType::IsTracked)
+					currentCharacterBytes = CharacterBytes(currentCharacter);
+				bufferedCharacter = 0;
 				return false;
-			if (currentCharacter == Minus)
+			}
+
+			// Error position is after the current character.
+			readFailed = true;
+
+			if (bufferedCharacter == 1) // No more characters to read.
 			{
-				// <!-- -
-				if (NextCharBad(true))
-					return false;
-				if (currentCharacter == Minus)
+				if (insideTag)
 				{
-					// <!-- --
-					if (NextCharBad(true))
-						return false;
-					doubleMinus = true;
+					// Start token position.
+					tempRow = row;
+					tempColumn = column;
+					Stop();
+					row = tempRow;
+					column = tempColumn;
+					SetError(ErrorCode::UnclosedToken);
+					eof = true;
 				}
 				else
 				{
-					CharactersWriterType::WriteCharacter(value, Minus);
-					CharactersWriterType::WriteCharacter(value, currentCharacter);
+					eof = true;
+					bufferedCharacter = 0;
 				}
 			}
-			else // Not minus.
+			else if (bufferedCharacter == 2) // Character is not allowed in XML document.
 			{
-				CharactersWriterType::WriteCharacter(value, currentCharacter);
+				// Invalid character position.
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				row = tempRow;
+				column = tempColumn;
+				SetError(ErrorCode::InvalidByteSequence);
 			}
-		}
-		while (!doubleMinus);
-
-		if (currentCharacter != GreaterThan)
-		{
-			tempRow = currentRow;
-			tempColumn = currentColumn - 2;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-
-		node = Inspected::Comment;
-		return true;
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseCDATA()
-	{
-		// currentCharacter == LeftSquareBracket.
-		// <![CDATA[
-
-		if (unclosedTagsSize == 0)
-		{
-			SizeType tempRow = row;
-			SizeType tempColumn = column;
-			Reset();
-			SetError(ErrorCode::CDataSectionOutside);
-			row = tempRow;
-			column = tempColumn;
-			return false;
+			else // bufferedCharacter == 3 // Stream error.
+			{
+				// Character at stream error position.
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				row = tempRow;
+				column = tempColumn;
+				SetError(ErrorCode::StreamError);
+			}
+			afterBom = true;
+			return true;
 		}
 
-		PrepareNode();
+		int result = ReadCharacter(currentCharacter);
 
-		do
+		if (result == 1) // Character was read successfully.
 		{
-			if (NextCharBad(true))
-				return false;
-			if (currentCharacter == RightSquareBracket)
+			if (PositionPolicyType::IsTracked)
+				currentCharacterBytes = CharacterBytes(currentCharacter);
+			if (currentCharacter == CarriageReturn) // We don't like CR.
 			{
-				// <![CDATA[ text ]
-				SizeType bracketCount = 0;
-				do
+				result = ReadCharacter(currentCharacter);
+				if (result == 1) // Second character was read successfully.
 				{
-					++bracketCount;
-					if (NextCharBad(true))
-						return false;
+					if (currentCharacter != LineFeed)
+					{
+						// CR, x => LF, x
+						bufferedCharacter = currentCharacter;
+						currentCharacter = LineFeed;
+					}
+					else if (PositionPolicyType::IsTracked)
+					{
+						// CR, LF => LF
+						currentCharacterBytes += CharacterBytes(LineFeed);
+					}
 				}
-				while (currentCharacter == RightSquareBracket);
-
-				if (currentCharacter == GreaterThan && bracketCount >= 2)
+				else if (result == 0) // No more characters to read.
 				{
-					// <![CDATA[ text ]]>
-					bracketCount -= 2;
-					for (SizeType i = 0; i < bracketCount; ++i)
-						CharactersWriterType::WriteCharacter(value, RightSquareBracket);
-					node = Inspected::CDATA;
-					return true;
+					// CR, [end of document] => LF, [end of document]
+					bufferedCharacter = 1;
+					currentCharacter = LineFeed;
 				}
-				else
+				else if (result == -1) // Character is not allowed in XML document.
 				{
-					for (SizeType i = 0; i < bracketCount; ++i)
-						CharactersWriterType::WriteCharacter(value, RightSquareBracket);
-					CharactersWriterType::WriteCharacter(value, currentCharacter);
+					// CR, [not allowed character] => LF, [not allowed character]
+					bufferedCharacter = 2;
+					currentCharacter = LineFeed;
 				}
+				else // result == -2 // Stream error.
+				{
+					// CR, [stream error] => LF, [stream error]
+					bufferedCharacter = 3;
+					currentCharacter = LineFeed;
+				}
+			}
+			return false;
+		}
+
+		// Error position is after the current character.
+		readFailed = true;
+
+		if (result == 0) // No more characters to read.
+		{
+			if (insideTag)
+			{
+				// Start token position.
+				tempRow = row;
+				tempColumn = column;
+				Stop();
+				row = tempRow;
+				column = tempColumn;
+				SetError(ErrorCode::UnclosedToken);
+				eof = true;
 			}
 			else
 			{
-				CharactersWriterType::WriteCharacter(value, currentCharacter);
+				eof = true;
 			}
 		}
-		while (true);
-
-		// Should never happen.
-		return false;
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseDOCTYPE()
-	{
-		// <!DOCTYPEcurrentCharacter
-
-		SizeType tempRow;
-		SizeType tempColumn;
-
-		if (!IsWhiteSpace(currentCharacter))
+		else if (result == -1) // Character is not allowed in XML document.
 		{
+			// Invalid character position.
 			tempRow = currentRow;
 			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
-
-		if (foundElement)
-		{
-			tempRow = row;
-			tempColumn = column;
-			Reset();
-			SetError(ErrorCode::InvalidDocumentTypeDeclarationLocation);
+			Stop();
 			row = tempRow;
 			column = tempColumn;
-			return false;
+			SetError(ErrorCode::InvalidByteSequence);
 		}
-
-		if (foundDOCTYPE)
+		else // result == -2 // Stream error.
 		{
-			tempRow = row;
-			tempColumn = column;
-			Reset();
-			SetError(ErrorCode::DoubleDocumentTypeDeclaration);
+			// Character at stream error position.
+			tempRow = currentRow;
+			tempColumn = currentColumn;
+			Stop();
 			row = tempRow;
 			column = tempColumn;
-			return false;
+			SetError(ErrorCode::StreamError);
 		}
-		foundDOCTYPE = true;
-
-		PrepareNode();
+		afterBom = true;
+		return true;
+	}
 
-		// Ignore white spaces.
-		do
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Inspect()
+	{
+		SizeType tempRow;
+		SizeType tempColumn;
+		if (sourceType == SourceFeed)
 		{
-			if (NextCharBad(true))
+			// Push mode. Inspect the next token only if it's fed completely.
+			if (!feedBuffer.IsFinished() && IsFeedConsumed())
+			{
+				SetError(ErrorCode::NeedMoreData);
 				return false;
+			}
+			if (err == ErrorCode::NeedMoreData)
+				SetError(ErrorCode::None);
 		}
-		while (IsWhiteSpace(currentCharacter));
 
-		// <!DOCTYPE   currentCharacter
-		if (currentCharacter == Colon ||
-			!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+		if (!afterBom && (err == ErrorCode::None || err == ErrorCode::StreamError))
 		{
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
+			// First call of Inspect method or after stream error while BOM parsing.
+			ParseBom();
+			if (err != ErrorCode::None)
+				return false;
+			row = 1;
+			column = 1;
+			if (eof)
+			{
+				SetError(ErrorCode::NoElement);
+				return false;
+			}
+			if (PositionPolicyType::IsTracked)
+			{
+				currentRow = 1;
+				currentColumn = 0; // Don't worry,
+				// it will be 1 after first call of NextCharBad method.
+			}
+			checkpoint = Details::PositionCheckpoint();
+			stopped = false;
 
-		// QName
-		do
-		{
-			CharactersWriterType::WriteCharacter(name, currentCharacter);
-			CharactersWriterType::WriteCharacter(localName, currentCharacter);
+			// Byte offsets count the BOM.
+			if (bom == Details::Bom::Utf8)
+			{
+				currentByteOffset = 3;
+			}
+			else if (bom == Details::Bom::Utf16BE || bom == Details::Bom::Utf16LE)
+			{
+				currentByteOffset = 2;
+				codeUnitSize = 2;
+			}
+			else if (bom == Details::Bom::Utf32BE || bom == Details::Bom::Utf32LE)
+			{
+				currentByteOffset = 4;
+				codeUnitSize = 4;
+			}
+			byteOffset = currentByteOffset;
 
-			if (NextCharBad(true))
-				return false;
+			// First character.
+			if (NextCharBad(false))
+			{
+				if (eof)
+				{
+					SetError(ErrorCode::NoElement);
+					return false;
+				}
+			}
 
-			if (currentCharacter == Colon)
+			if (sourceType != SourceReader &&
+				bom != Details::Bom::None &&
+				bom != Details::Bom::Utf8 &&
+				bom != Details::Bom::Utf16BE &&
+				bom != Details::Bom::Utf16LE)
 			{
-				// Prefixed name.
-				prefix = name;
-				localName.clear();
-				CharactersWriterType::WriteCharacter(name, currentCharacter);
+				// Encoding declaration is required here.
+
+				if (currentCharacter != LessThan)
+				{
+					Stop();
+					SetError(ErrorCode::EncodingDeclarationRequired);
+					row = 1;
+					column = 1;
+					return false;
+				}
+
+				if (NextCharBad(true))
+					return false;
+
+				if (currentCharacter != Question)
+				{
+					Stop();
+					SetError(ErrorCode::EncodingDeclarationRequired);
+					row = 1;
+					column = 1;
+					return false;
+				}
+
+				for (std::size_t i = 0; i < 3; ++i)
+				{
+					if (NextCharBad(true))
+						return false;
+					if (currentCharacter != LowerXml[i])
+					{
+						Stop();
+						SetError(ErrorCode::EncodingDeclarationRequired);
+						row = 1;
+						column = 1;
+						return false;
+					}
+					CharactersWriterType::WriteCharacter(name, currentCharacter);
+					CharactersWriterType::WriteCharacter(localName, currentCharacter);
+				}
 
+				// '<?xml'
 				if (NextCharBad(true))
 					return false;
 
-				if (currentCharacter == Colon ||
-					!Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+				if (!IsWhiteSpace(currentCharacter))
+				{
+					Stop();
+					SetError(ErrorCode::EncodingDeclarationRequired);
+					row = 1;
+					column = 1;
+					return false;
+				}
+
+				return ParseXmlDeclaration();
+			}
+
+			if (IsWhiteSpace(currentCharacter))
+			{
+				do
+				{
+					WriteCurrentCharacter(value);
+					if (NextCharBad(false))
+					{
+						if (eof) // White spaces followed by end of file.
+						{
+							// In XML document at least one root element is required.
+							tempRow = currentRow;
+							tempColumn = currentColumn;
+							Stop();
+							SetError(ErrorCode::NoElement);
+							row = tempRow;
+							column = tempColumn;
+							return false;
+						}
+						else // White spaces followed by invalid character or stream error.
+						{
+							// Error is set already.
+							return false;
+						}
+					}
+				}
+				while (IsWhiteSpace(currentCharacter));
+
+				if (currentCharacter != LessThan)
 				{
 					tempRow = currentRow;
 					tempColumn = currentColumn;
-					Reset();
+					Stop();
 					SetError(ErrorCode::InvalidSyntax);
 					row = tempRow;
 					column = tempColumn;
 					return false;
 				}
+				
+				node = Inspected::Whitespace;
+				return true;
+			}
 
-				do
-				{
-					CharactersWriterType::WriteCharacter(name, currentCharacter);
-					CharactersWriterType::WriteCharacter(localName, currentCharacter);
-
-					if (NextCharBad(true))
-						return false;
-
-					if (currentCharacter == Colon)
-					{
-						tempRow = currentRow;
-						tempColumn = currentColumn;
-						Reset();
-						SetError(ErrorCode::InvalidSyntax);
-						row = tempRow;
-						column = tempColumn;
-						return false;
-					}
-				}
-				while (Encoding::CharactersReader::IsNameChar(currentCharacter));
-				break;
+			if (currentCharacter != LessThan)
+			{
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+				row = tempRow;
+				column = tempColumn;
 			}
 		}
-		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
 
-		// <!DOCTYPE QNAMEcurrentCharacter
+		if (err != ErrorCode::None)
+			return false;
 
-		if (currentCharacter == GreaterThan)
+		if (currentCharacter == GreaterThan) 
 		{
-			// <!DOCTYPE QName>
-			node = Inspected::DocumentType;
-			return true;
+			// End of token.
+			if (NextCharBad(false) && !eof)
+				return false;
 		}
-		else if (IsWhiteSpace(currentCharacter))
+		else if (currentCharacter == Semicolon)
 		{
-			// Ignore white spaces.
-			do
+			if (!entityName.empty())
 			{
-				if (NextCharBad(true))
+				PrepareNode();
+				name = entityName;
+				localName = entityName;
+				entityName.clear();
+				node = Inspected::EntityReference;
+				SavePosition(row, column, entityNameCharCount + 1);
+				byteOffset = entityByteOffset;
+				return true;
+			}
+			else
+			{
+				// End of reference.
+				if (NextCharBad(false) && !eof)
 					return false;
 			}
-			while (IsWhiteSpace(currentCharacter));
+		}
 
-			if (currentCharacter == GreaterThan)
+		if (eof)
+		{
+			if (!foundElement)
 			{
-				// <!DOCTYPE QName  >
-				node = Inspected::DocumentType;
-				return true;
+				// In XML document at least one root element is required.
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				SetError(ErrorCode::NoElement);
+				row = tempRow;
+				column = tempColumn;
+			}
+			else if (unclosedTagsSize != 0)
+			{
+				UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
+				Stop();
+				SetError(ErrorCode::UnclosedTag);
+				row = ref.Row;
+				column = ref.Column;
+				foundElement = true;
+			}
+			else
+			{
+				// XML document is fully parsed without any error.
+				tempRow = currentRow;
+				tempColumn = currentColumn;
+				Stop();
+				row = tempRow;
+				column = tempColumn;
+				currentRow = tempRow;
+				currentColumn = tempColumn;
+				foundElement = true;
+				afterBom = true;
 			}
+			currentCharacter = 0;
+			eof = true;
+			return false;
 		}
-		else if (currentCharacter != LeftSquareBracket)
+
+		if (currentCharacter == LessThan) // New tag to parse.
 		{
+			SavePosition();
+
+			// Go to the next character after '<'.
+			if (NextCharBad(true))
+				return false;
+
+			if (currentCharacter == Slash)
+			{
+				// EndTag.
+				return ParseEndTag();
+			}
+
+			if (currentCharacter != Colon &&
+				Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+			{
+				// StartTag or EmptyElementTag.
+				return ParseElement();
+			}
+
+			if (currentCharacter == Exclamation)
+			{
+				// Comment or DocumentType.
+				return ParseExclamation();
+			}
+
+			if (currentCharacter == Question)
+			{
+				// XmlDeclaration or ProcessingInstruction.
+				return ParseQuestion();
+			}
+
+			// currentCharacter is not allowed here.
 			tempRow = currentRow;
 			tempColumn = currentColumn;
-			Reset();
-			SetError(ErrorCode::InvalidSyntax);
+			if (Encoding::CharactersReader::IsNameChar(currentCharacter))
+			{
+				// Not allowed as start character of the name,
+				// but allowed as a part of this name.
+				Stop();
+				SetError(ErrorCode::InvalidTagName);
+			}
+			else
+			{
+				// Some weird character.
+				Stop();
+				SetError(ErrorCode::InvalidSyntax);
+			}
 			row = tempRow;
 			column = tempColumn;
 			return false;
 		}
 
-		do
-		{
-			CharactersWriterType::WriteCharacter(value, currentCharacter);
-			if (currentCharacter == LeftSquareBracket)
-			{
-				// <!DOCTYPE QName [
-				do
-				{
-					if (NextCharBad(true))
-						return false;
-					while (currentCharacter == RightSquareBracket)
-					{
-						CharactersWriterType::WriteCharacter(value, currentCharacter);
-						if (NextCharBad(true))
-							return false;
-						while (IsWhiteSpace(currentCharacter))
-						{
-							CharactersWriterType::WriteCharacter(value, currentCharacter);
-							if (NextCharBad(true))
-								return false;
-						}
-						if (currentCharacter == GreaterThan)
-						{
-							// <!DOCTYPE QName [...] >
-							node = Inspected::DocumentType;
-							return true;
-						}
-					}
-					CharactersWriterType::WriteCharacter(value, currentCharacter);
-				}
-				while (true);
-			}
+		// currentCharacter == first character of text.
+		SavePosition();
+		return ParseText();
+	}
 
-			if (NextCharBad(true))
-				return false;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline Inspected Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetInspected() const
+	{
+		return node;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StringType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetName() const
+	{
+		return name;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StringType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetValue() const
+	{
+		// Copy the view of the document only if it's needed.
+		if (viewString == &value && value.empty())
+			value.assign(viewFirst, static_cast<std::size_t>(viewLast - viewFirst));
+		return value;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StringViewType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetValueView() const
+	{
+		if (viewString == &value)
+			return StringViewType(viewFirst, static_cast<std::size_t>(viewLast - viewFirst));
+		return StringViewType(value.data(), value.size());
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StringType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetLocalName() const
+	{
+		return localName;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StringType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetPrefix() const
+	{
+		return prefix;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::StringType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetNamespaceUri() const
+	{
+		return namespaceUri;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::HasAttributes() const
+	{
+		return (attributesSize != 0);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SizeType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetAttributesCount() const
+	{
+		return static_cast<SizeType>(attributesSize);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::AttributeType&
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetAttributeAt(SizeType index) const
+	{
+		if (index >= attributesSize)
+			throw std::out_of_range("Attempt to access out of range element.");
+		return attributes[static_cast<AttributesSizeType>(index)];
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const char* Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetErrorMessage() const
+	{
+		return errMsg;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline ErrorCode Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetErrorCode() const
+	{
+		return err;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SizeType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetRow() const
+	{
+		if (!PositionPolicyType::IsTracked)
+			return LazyPosition().Row;
+		return row;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SizeType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetColumn() const
+	{
+		if (!PositionPolicyType::IsTracked)
+			return LazyPosition().Column;
+		return column;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SizeType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetDepth() const
+	{
+		if (node == Inspected::StartTag)
+			return static_cast<SizeType>(unclosedTagsSize - 1);
+		else
+			return static_cast<SizeType>(unclosedTagsSize);
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SizeType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetByteOffset() const
+	{
+		if (!PositionPolicyType::IsTracked)
+			return 0;
+		return byteOffset;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline typename Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::SizeType
+		Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetEndByteOffset() const
+	{
+		if (!PositionPolicyType::IsTracked)
+			return 0;
+
+		if (node == Inspected::Text || node == Inspected::Whitespace)
+		{
+			// Text ends before the markup or the unknown entity reference.
+			if (!entityName.empty())
+				return entityByteOffset;
+			return currentByteOffset;
 		}
-		while (currentCharacter != GreaterThan);
 
-		node = Inspected::DocumentType;
-		return true;
+		if (node == Inspected::None)
+			return byteOffset;
+
+		// Other nodes end with the current character ('>' or ';').
+		return currentByteOffset + currentCharacterBytes;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset()
+	{
+		Stop();
+		if (!PositionPolicyType::IsTracked)
+		{
+			// Positions of the previous source are forgotten.
+			checkpoint = Details::PositionCheckpoint();
+			stopCheckpoint = Details::PositionCheckpoint();
+			stopIndex = 0;
+			stopAfter = false;
+			stopped = false;
+		}
 	}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::PrepareNode()
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Stop()
 	{
+		if (!PositionPolicyType::IsTracked)
+		{
+			// Remember where the parser stopped. The position
+			// is computed only if it's requested.
+			stopped = (afterBom && sourceType != SourceNone);
+			if (stopped)
+			{
+				stopCheckpoint = checkpoint;
+				stopIndex = charactersPosition - (bufferedCharacter > 3 ? 1 : 0);
+				stopAfter = readFailed;
+			}
+			readFailed = false;
+		}
+		row = 0;
+		column = 0;
+		currentRow = 0;
+		currentColumn = 0;
+		byteOffset = 0;
+		currentByteOffset = 0;
+		currentCharacterBytes = 0;
+		codeUnitSize = 0;
+		entityByteOffset = 0;
+		node = Inspected::None;
+		err = ErrorCode::None;
+		errMsg = nullptr;
+		afterBom = false;
+		encodingResolved = false;
+		bom = Details::Bom::None;
 		name.clear();
 		value.clear();
 		localName.clear();
 		prefix.clear();
 		namespaceUri.clear();
+		entityName.clear();
+		entityNameCharCount = 0;
+		currentCharacter = 0;
+		bufferedCharacter = 0;
+		charactersPosition = 0;
+		charactersCount = 0;
+		charactersResult = 1;
+		charactersBytes = nullptr;
+		charactersBytesPosition = 0;
+		viewString = nullptr;
+		foundElement = false;
+		foundDOCTYPE = false;
+		eof = false;
 		attributesSize = 0;
+		unclosedTagsSize = 0;
+		namespacesSize = 0;
+		if (sourceType == SourcePath)
+		{
+			fPath.clear();
+#if defined(XML_INSPECTOR_ZLIB)
+			fileStream.std::ios::rdbuf(fileStream.rdbuf());
+			gzipBuf.Close();
+#endif
+			if (fileStream.is_open())
+				fileStream.close();
+			fileStream.clear();
+			ReplaceReader(nullptr);
+		}
+		else if (sourceType == SourceReader)
+		{
+			reader = nullptr;
+		}
+		else if (sourceType == SourceStream)
+		{
+			inputStreamPtr = nullptr;
+			ReplaceReader(nullptr);
+		}
+		else if (sourceType == SourceIterators)
+		{
+			delete inputStreamPtr->rdbuf();
+			delete inputStreamPtr;
+			inputStreamPtr = nullptr;
+			ReplaceReader(nullptr);
+		}
+		else if (sourceType == SourceMemory || sourceType == SourceFeed)
+		{
+			memoryFirst = nullptr;
+			memoryLast = nullptr;
+			memoryBuf.Reset(nullptr, nullptr);
+			memoryStream.clear();
+			memoryReader.ResetIterators(nullptr, nullptr);
+			ReplaceReader(nullptr);
+			feedBuffer.Clear();
+		}
+		else if (sourceType == SourceFd)
+		{
+			fdBuf.Close();
+			fdStream.clear();
+			ReplaceReader(nullptr);
+		}
+		sourceType = SourceNone;
 	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::NamespacesStuff()
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(const char* filePath)
 	{
-		// Collect namespaces from attributes.
-		typedef typename std::deque<AttributeType>::iterator AttrIter;
-		AttrIter attrEnd = attributes.begin() + attributesSize;
-		for (AttrIter attr = attributes.begin(); attr != attrEnd; ++attr)
-		{
-			if (attr->Prefix.empty())
-			{
-				if (attr->LocalName == xmlnsString)
-				{
-					// Default namespace.
-					// <mytag xmlns=...
-					if (attr->Value == xmlUriString ||
-						attr->Value == xmlnsUriString)
-					{
-						// <mytag xmlns="http://www.w3.org/XML/1998/namespace"...
-						// or
-						// <mytag xmlns="http://www.w3.org/2000/xmlns/"...
-						Reset();
-						SetError(ErrorCode::ReservedNamespaceAsDefault);
-						row = attr->Row;
-						column = attr->Column;
-						return false;
-					}
+		Reset();
+		fPath = filePath;
+		sourceType = SourcePath;
+	}
 
-					NamespaceDeclarationType& ref = NewNamespace();
-					ref.Uri = attr->Value;
-					ref.TagIndex = static_cast<SizeType>(unclosedTagsSize);
-				}
-			}
-			else if (attr->Prefix == xmlnsString)
-			{
-				if (attr->LocalName == xmlnsString)
-				{
-					// <mytag xmlns:xmlns=...
-					Reset();
-					SetError(ErrorCode::XmlnsDeclared);
-					row = attr->Row;
-					column = attr->Column;
-					return false;
-				}
-				else if (attr->LocalName == lowerXmlString)
-				{
-					// <mytag xmlns:xml=...
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(const std::string& filePath)
+	{
+		Reset();
+		fPath = filePath;
+		sourceType = SourcePath;
+	}
 
-					if (attr->Value != xmlUriString)
-					{
-						Reset();
-						SetError(ErrorCode::InvalidXmlPrefixDeclaration);
-						row = attr->Row;
-						column = attr->Column;
-						return false;
-					}
-				}
-				else if (attr->Value == xmlUriString ||
-					attr->Value == xmlnsUriString)
-				{
-					// <mytag xmlns:newprefix="http://www.w3.org/XML/1998/namespace"...
-					// or
-					// <mytag xmlns:newprefix="http://www.w3.org/2000/xmlns/"...
-					Reset();
-					SetError(ErrorCode::PrefixBoundToReservedNamespace);
-					row = attr->Row;
-					column = attr->Column;
-					return false;
-				}
-				else if (attr->Value.empty())
-				{
-					// <mytag xmlns:newprefix=""...
-					Reset();
-					SetError(ErrorCode::PrefixWithEmptyNamespace);
-					row = attr->Row;
-					column = attr->Column;
-					return false;
-				}
-				else
-				{
-					NamespaceDeclarationType& ref = NewNamespace();
-					ref.Prefix = attr->LocalName;
-					ref.Uri = attr->Value;
-					ref.TagIndex = static_cast<SizeType>(unclosedTagsSize);
-				}
-			}
-		}
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(std::istream* inputStream)
+	{
+		Reset();
+		inputStreamPtr = inputStream;
+		sourceType = SourceStream;
+	}
 
-		// Assign URIs to attributes.
-		typedef typename std::deque<NamespaceDeclarationType>::const_iterator NamespaceIter;
-		NamespaceIter namespaceLast = namespaces.begin();
-		if (namespacesSize != 0)
-			namespaceLast += (namespacesSize - 1);
-		for (AttrIter attr = attributes.begin(); attr != attrEnd; ++attr)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	template <typename TInputIterator, typename>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(
+		TInputIterator first, TInputIterator last)
+	{
+		Reset();
+		ResetIterators(first, last, std::integral_constant<bool,
+			Details::IsContiguousIterator<TInputIterator>::value>());
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	template <typename TInputIterator>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ResetIterators(
+		TInputIterator first, TInputIterator last, std::true_type)
+	{
+		// Bytes are stored contiguously, so parse them like the mapped file.
+		if (first != last)
 		{
-			if (!attr->Prefix.empty())
-			{
-				if (attr->Prefix == xmlnsString)
-				{
-					attr->NamespaceUri = xmlnsUriString;
-				}
-				else if (attr->Prefix == lowerXmlString)
-				{
-					attr->NamespaceUri = xmlUriString;
-				}
-				else
-				{
-					bool found = false;
-					NamespaceIter n = namespaceLast;
-					for ( ; n != namespaces.begin(); --n)
-					{
-						if (attr->Prefix == n->Prefix)
-						{
-							found = true;
-							break;
-						}
-					}
-					if (!found && (namespacesSize == 0 || attr->Prefix != n->Prefix))
-					{
-						Reset();
-						SetError(ErrorCode::PrefixWithoutAssignedNamespace);
-						row = attr->Row;
-						column = attr->Column;
-						return false;
-					}
-					else
-					{
-						attr->NamespaceUri = n->Uri;
-					}
-				}
-			}
+			memoryFirst = reinterpret_cast<const char*>(&*first);
+			memoryLast = memoryFirst + (last - first);
 		}
+		sourceType = SourceMemory;
+	}
 
-		// Assign URI to element.
-		if (!prefix.empty())
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	template <typename TInputIterator>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::ResetIterators(
+		TInputIterator first, TInputIterator last, std::false_type)
+	{
+		std::unique_ptr<Details::BasicIteratorsBuf<TInputIterator, char> > buf(
+			new Details::BasicIteratorsBuf<TInputIterator, char>(first, last));
+		inputStreamPtr = new std::istream(buf.get());
+		buf.release();
+		sourceType = SourceIterators;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(CharactersReaderType* r)
+	{
+		Reset();
+		if (r != nullptr)
 		{
-			if (prefix == xmlnsString)
-			{
-				// row and column => '<'
-				SizeType tempRow = row;
-				SizeType tempColumn = column + 1;
-				Reset();
-				SetError(ErrorCode::PrefixWithoutAssignedNamespace);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
-			else if (prefix == lowerXmlString)
-			{
-				namespaceUri = xmlUriString;
-			}
-			else
-			{
-				bool found = false;
-				NamespaceIter n = namespaceLast;
-				for ( ; n != namespaces.begin(); --n)
-				{
-					if (prefix == n->Prefix)
-					{
-						found = true;
-						break;
-					}
-				}
-				if (!found && (namespacesSize == 0 || prefix != n->Prefix))
-				{
-					// row and column => '<'
-					SizeType tempRow = row;
-					SizeType tempColumn = column + 1;
-					Reset();
-					SetError(ErrorCode::PrefixWithoutAssignedNamespace);
-					row = tempRow;
-					column = tempColumn;
-					return false;
-				}
-				else
-				{
-					namespaceUri = n->Uri;
-				}
-			}
+			reader = r;
+			sourceType = SourceReader;
+		}
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(const MappedFile* mappedFile)
+	{
+		Reset();
+		if (mappedFile != nullptr && mappedFile->IsOpen())
+		{
+			memoryFirst = mappedFile->GetData();
+			memoryLast = memoryFirst + mappedFile->GetSize();
+			sourceType = SourceMemory;
 		}
-		else // prefix.empty() == true.
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Reset(FileDescriptor fd, std::size_t bufferSize)
+	{
+		Reset();
+		if (fd.Get() >= 0)
 		{
-			// Find default namespace.
-			bool found = false;
-			NamespaceIter n = namespaceLast;
-			for ( ; n != namespaces.begin(); --n)
-			{
-				if (n->Prefix.empty())
-				{
-					found = true;
-					break;
-				}
-			}
-			if (found || (namespacesSize != 0 && n->Prefix.empty()))
-				namespaceUri = n->Uri;
+			fdBuf.Open(fd.Get(), bufferSize);
+			sourceType = SourceFd;
 		}
+	}
 
-		// Ensure no double attribute name like:
-		// <a x:local="first" y:local="second">
-		// where x and y prefixes are bound to the same namespace URI.
-		if (attributesSize > 1)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Feed(
+		const char* data, std::size_t size)
+	{
+		if (sourceType != SourceFeed)
 		{
-			AttrIter attrEndMinus1 = attributes.begin() + (attributesSize - 1);
-			for (AttrIter attr = attributes.begin(); attr != attrEndMinus1; ++attr)
+			Reset();
+			sourceType = SourceFeed;
+		}
+
+		std::size_t position = 0;
+		if (afterBom)
+		{
+			position = static_cast<std::size_t>(GetFeedPosition() - memoryFirst);
+			// Remove the decoded bytes if they take at least half of the buffer,
+			// so every byte is moved a constant number of times on average.
+			if (position != 0 && position >= feedBuffer.GetSize() - position)
 			{
-				if (!attr->Prefix.empty())
-				{
-					for (AttrIter next = attr + 1; next != attrEnd; ++next)
-					{
-						if (attr->LocalName == next->LocalName &&
-							attr->NamespaceUri == next->NamespaceUri)
-						{
-							Reset();
-							SetError(ErrorCode::DoubleAttributeName);
-							row = next->Row;
-							column = next->Column;
-							return false;
-						}
-					}
-				}
+				feedBuffer.Erase(position);
+				position = 0;
 			}
 		}
+		feedBuffer.Append(data, size);
+		UpdateFeed(position);
+	}
 
-		return true;
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::FinishFeed()
+	{
+		// Empty document could be finished without any fed bytes,
+		// but the error of the fed document is kept.
+		if (sourceType != SourceFeed)
+		{
+			if (err != ErrorCode::None)
+				return;
+			Reset();
+			sourceType = SourceFeed;
+		}
+
+		std::size_t position = 0;
+		if (afterBom)
+			position = static_cast<std::size_t>(GetFeedPosition() - memoryFirst);
+		feedBuffer.Finish();
+		UpdateFeed(position);
 	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ParseCharacterReference(char32_t& result, bool insideTag)
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline const char* Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::GetFeedPosition() const
 	{
-		// currentCharacter == Hash.
-		
-		SizeType tempRow = currentRow;
-		SizeType tempColumn = currentColumn - 1;
+		if (reader == &memoryReader)
+			return memoryReader.GetFirstIterator();
+		return memoryBuf.GetPosition();
+	}
 
-		if (NextCharBad(insideTag))
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline bool Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::IsFeedConsumed() const
+	{
+		if (!afterBom)
+			return feedBuffer.GetLimit() == feedBuffer.GetStart();
+
+		if (bufferedCharacter != 0)
+			return false;
+
+		std::size_t characters = charactersCount - charactersPosition;
+		std::size_t bytes = static_cast<std::size_t>(memoryLast - GetFeedPosition());
+		if (characters == 0 && bytes == 0)
+			return true;
+
+		// '<' which ends the text is fed before the rest of its token,
+		// but it's left unparsed after the entity reference.
+		if (!feedBuffer.IsTagOpened())
+			return false;
+		if (characters == 1 && bytes == 0)
+			return charactersBuffer[charactersPosition] == LessThan;
+		return characters == 0 && bytes == feedBuffer.GetUnitSize();
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::UpdateFeed(std::size_t position)
+	{
+		memoryFirst = feedBuffer.GetData();
+		memoryLast = memoryFirst + feedBuffer.GetLimit();
+		// Bytes could be moved, so the buffered characters are written
+		// by the characters writer until the next refill.
+		charactersBytes = nullptr;
+		if (!afterBom)
+			return;
+
+		if (reader == &memoryReader)
 		{
-			if (!insideTag && eof)
-			{
-				UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-				Reset();
-				SetError(ErrorCode::UnclosedTag);
-				row = ref.Row;
-				column = ref.Column;
-				eof = true;
-			}
+			memoryReader.ResetIterators(memoryFirst + position, memoryLast);
+		}
+		else
+		{
+			memoryBuf.Reset(memoryFirst + position, memoryLast);
+			memoryStream.clear();
+		}
+
+		// The reader could reach the end of previously fed bytes.
+		if (charactersResult == 0)
+			charactersResult = 1;
+	}
+
+	template <typename TCharactersWriter, typename TCharactersReader, typename TPositionPolicy>
+	inline void Inspector<TCharactersWriter, TCharactersReader, TPositionPolicy>::Clear()
+	{
+		Reset();
+		attributes.clear();
+		unclosedTags.clear();
+		namespaces.clear();
+	}
+
+	template <typename TCharacter>
+	inline StringView<TCharacter>::StringView()
+		: data(nullptr),
+		size(0)
+	{
+
+	}
+
+	template <typename TCharacter>
+	inline StringView<TCharacter>::StringView(const TCharacter* first, std::size_t count)
+		: data(first),
+		size(count)
+	{
+
+	}
+
+	template <typename TCharacter>
+	inline const TCharacter* StringView<TCharacter>::GetData() const
+	{
+		return data;
+	}
+
+	template <typename TCharacter>
+	inline std::size_t StringView<TCharacter>::GetSize() const
+	{
+		return size;
+	}
+
+	template <typename TCharacter>
+	inline bool StringView<TCharacter>::IsEmpty() const
+	{
+		return size == 0;
+	}
+
+	template <typename TCharacter>
+	inline const TCharacter* StringView<TCharacter>::begin() const
+	{
+		return data;
+	}
+
+	template <typename TCharacter>
+	inline const TCharacter* StringView<TCharacter>::end() const
+	{
+		return data + size;
+	}
+
+	template <typename TCharacter>
+	inline std::basic_string<TCharacter> StringView<TCharacter>::ToString() const
+	{
+		return std::basic_string<TCharacter>(data, size);
+	}
+
+	inline FileDescriptor::FileDescriptor(int fd)
+		: descriptor(fd)
+	{
+
+	}
+
+	inline int FileDescriptor::Get() const
+	{
+		return descriptor;
+	}
+
+	inline MappedFile::MappedFile()
+		: data(nullptr),
+		size(0),
+		opened(false)
+#if defined(_WIN32)
+		, fileHandle(INVALID_HANDLE_VALUE),
+		mappingHandle(NULL)
+#endif
+	{
+
+	}
+
+	inline MappedFile::MappedFile(const char* filePath)
+		: data(nullptr),
+		size(0),
+		opened(false)
+#if defined(_WIN32)
+		, fileHandle(INVALID_HANDLE_VALUE),
+		mappingHandle(NULL)
+#endif
+	{
+		Open(filePath);
+	}
+
+	inline MappedFile::MappedFile(const std::string& filePath)
+		: data(nullptr),
+		size(0),
+		opened(false)
+#if defined(_WIN32)
+		, fileHandle(INVALID_HANDLE_VALUE),
+		mappingHandle(NULL)
+#endif
+	{
+		Open(filePath.c_str());
+	}
+
+	inline MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	inline bool MappedFile::Open(const char* filePath)
+	{
+		Close();
+
+#if defined(_WIN32)
+		fileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) ||
+			static_cast<unsigned long long>(fileSize.QuadPart) >
+				static_cast<unsigned long long>(static_cast<std::size_t>(-1)))
+		{
+			Close();
 			return false;
 		}
 
-		const int BufferSize = 7;
-		unsigned char buffer[BufferSize];
-		int digitCount = 0;
-		int digit = 0;
-		int radix = 10;
+		if (fileSize.QuadPart == 0)
+		{
+			// Empty file cannot be mapped.
+			opened = true;
+			return true;
+		}
 
-		if (currentCharacter == X)
+		mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mappingHandle == NULL)
 		{
-			// Hexadecimal representation of the character's code point.
-			radix = 16;
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
-				}
-				return false;
-			}
+			Close();
+			return false;
+		}
+
+		void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (view == NULL)
+		{
+			Close();
+			return false;
+		}
+
+		data = static_cast<const char*>(view);
+		size = static_cast<std::size_t>(fileSize.QuadPart);
+		opened = true;
+		return true;
+#else
+		int fd = ::open(filePath, O_RDONLY);
+		if (fd == -1)
+			return false;
+
+		struct stat fileStat;
+		if (::fstat(fd, &fileStat) != 0 ||
+			static_cast<unsigned long long>(fileStat.st_size) >
+				static_cast<unsigned long long>(static_cast<std::size_t>(-1)))
+		{
+			::close(fd);
+			return false;
+		}
+
+		if (fileStat.st_size == 0)
+		{
+			// Empty file cannot be mapped.
+			::close(fd);
+			opened = true;
+			return true;
 		}
 
-		digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
+		std::size_t fileSize = static_cast<std::size_t>(fileStat.st_size);
+		void* view = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		// Mapping is still valid after closing the file descriptor.
+		::close(fd);
+
+		if (view == MAP_FAILED)
+			return false;
+
+		// Only a hint, so the result doesn't matter.
+		::posix_madvise(view, fileSize, POSIX_MADV_SEQUENTIAL);
+
+		data = static_cast<const char*>(view);
+		size = fileSize;
+		opened = true;
+		return true;
+#endif
+	}
+
+	inline bool MappedFile::Open(const std::string& filePath)
+	{
+		return Open(filePath.c_str());
+	}
+
+	inline void MappedFile::Close()
+	{
+#if defined(_WIN32)
+		if (data != nullptr)
+			UnmapViewOfFile(data);
+		if (mappingHandle != NULL)
+			CloseHandle(mappingHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(fileHandle);
+		mappingHandle = NULL;
+		fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (data != nullptr)
+			::munmap(const_cast<char*>(data), size);
+#endif
+		data = nullptr;
+		size = 0;
+		opened = false;
+	}
+
+	inline bool MappedFile::IsOpen() const
+	{
+		return opened;
+	}
+
+	inline const char* MappedFile::GetData() const
+	{
+		return data;
+	}
+
+	inline std::size_t MappedFile::GetSize() const
+	{
+		return size;
+	}
+
+	inline ReadAheadStream::ReadAheadStream(const char* filePath,
+		std::size_t blockSize, std::size_t ringDepth)
+		: std::istream(nullptr),
+		buf(blockSize, ringDepth)
+	{
+		rdbuf(&buf);
+		if (filePath == nullptr || !buf.Open(filePath))
+			setstate(std::istream::failbit);
+	}
+
+	inline ReadAheadStream::ReadAheadStream(const std::string& filePath,
+		std::size_t blockSize, std::size_t ringDepth)
+		: std::istream(nullptr),
+		buf(blockSize, ringDepth)
+	{
+		rdbuf(&buf);
+		if (!buf.Open(filePath.c_str()))
+			setstate(std::istream::failbit);
+	}
+
+	inline ReadAheadStream::ReadAheadStream(std::istream* inputStream,
+		std::size_t blockSize, std::size_t ringDepth)
+		: std::istream(nullptr),
+		buf(blockSize, ringDepth)
+	{
+		rdbuf(&buf);
+		if (inputStream != nullptr)
+			buf.Start(inputStream);
+		else
+			setstate(std::istream::failbit);
+	}
+
+	inline ReadAheadStream::~ReadAheadStream()
+	{
+
+	}
+
+	inline bool ReadAheadStream::IsOpen() const
+	{
+		return buf.IsOpen();
+	}
+
+	inline std::size_t ReadAheadStream::GetBlockSize() const
+	{
+		return buf.GetBlockSize();
+	}
+
+	inline std::size_t ReadAheadStream::GetRingDepth() const
+	{
+		return buf.GetRingDepth();
+	}
+
+	inline std::chrono::nanoseconds ReadAheadStream::GetReadTime() const
+	{
+		return buf.GetReadTime();
+	}
+
+	inline std::chrono::nanoseconds ReadAheadStream::GetWaitTime() const
+	{
+		return buf.GetWaitTime();
+	}
+
+#if !defined(_WIN32)
+	inline UringFileStream::UringFileStream(const char* filePath,
+		std::size_t blockSize, std::size_t queueDepth, bool useUring)
+		: std::istream(nullptr),
+		buf(blockSize, queueDepth)
+	{
+		rdbuf(&buf);
+		if (filePath == nullptr || !buf.Open(filePath, useUring))
+			setstate(std::istream::failbit);
+	}
+
+	inline UringFileStream::UringFileStream(const std::string& filePath,
+		std::size_t blockSize, std::size_t queueDepth, bool useUring)
+		: std::istream(nullptr),
+		buf(blockSize, queueDepth)
+	{
+		rdbuf(&buf);
+		if (!buf.Open(filePath.c_str(), useUring))
+			setstate(std::istream::failbit);
+	}
+
+	inline UringFileStream::~UringFileStream()
+	{
+
+	}
+
+	inline bool UringFileStream::IsOpen() const
+	{
+		return buf.IsOpen();
+	}
+
+	inline bool UringFileStream::IsUringUsed() const
+	{
+		return buf.IsUringUsed();
+	}
+
+	inline std::size_t UringFileStream::GetBlockSize() const
+	{
+		return buf.GetBlockSize();
+	}
 
-		// Ignore leading zeros.
-		bool leadingZeros = false;
-		while (digit == 0)
-		{
-			leadingZeros = true;
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
-				}
-				return false;
-			}
-			digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
-		}
+	inline std::size_t UringFileStream::GetQueueDepth() const
+	{
+		return buf.GetQueueDepth();
+	}
 
-		while (digitCount < BufferSize && digit >= 0 && digit < radix)
-		{
-			buffer[digitCount++] = static_cast<unsigned char>(digit);
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
-				}
-				return false;
-			}
-			digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
-		}
+	inline DirectFileStream::DirectFileStream(const char* filePath,
+		std::size_t blockSize, bool useDirect)
+		: std::istream(nullptr),
+		buf(blockSize)
+	{
+		rdbuf(&buf);
+		if (filePath == nullptr || !buf.Open(filePath, useDirect))
+			setstate(std::istream::failbit);
+	}
 
-		// Now should be a semicolon.
-		if (currentCharacter == Semicolon)
-		{
-			// &#x0; is invalid code point in character reference.
-			// &#x; is invalid syntax of reference.
-			if (digitCount == 0)
-			{
-				if (leadingZeros)
-				{
-					Reset();
-					SetError(ErrorCode::InvalidCharacterReference);
-					row = tempRow;
-					column = tempColumn;
-				}
-				else
-				{
-					Reset();
-					SetError(ErrorCode::InvalidReferenceSyntax);
-					row = tempRow;
-					column = tempColumn;
-				}
-				return false;
-			}
+	inline DirectFileStream::DirectFileStream(const std::string& filePath,
+		std::size_t blockSize, bool useDirect)
+		: std::istream(nullptr),
+		buf(blockSize)
+	{
+		rdbuf(&buf);
+		if (!buf.Open(filePath.c_str(), useDirect))
+			setstate(std::istream::failbit);
+	}
 
-			// We are sure that digitCount is 7 max.
-			result = 0;
-			for (int i = 0; i < digitCount; ++i)
-				result = result * radix + static_cast<char32_t>(buffer[i]);
+	inline DirectFileStream::~DirectFileStream()
+	{
 
-			if (!Encoding::CharactersReader::IsChar(result))
-			{
-				Reset();
-				SetError(ErrorCode::InvalidCharacterReference);
-				row = tempRow;
-				column = tempColumn;
-				return false;
-			}
-		}
-		else if (digit >= 0 && digit < radix)
-		{
-			// To many digits, but we must check the syntax to set appropriate error.
+	}
 
-			do
-			{
-				if (NextCharBad(insideTag))
-				{
-					if (!insideTag && eof)
-					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
-					}
-					return false;
-				}
-				digit = Encoding::CharactersReader::GetHexDigitValue(currentCharacter);
-			}
-			while (digit >= 0 && digit < radix);
+	inline bool DirectFileStream::IsOpen() const
+	{
+		return buf.IsOpen();
+	}
 
-			if (currentCharacter == Semicolon)
-			{
-				// just invalid code point.
-				Reset();
-				SetError(ErrorCode::InvalidCharacterReference);
-				row = tempRow;
-				column = tempColumn;
-			}
-			else
-			{
-				// Invalid syntax of character reference, not just invalid code point.
-				Reset();
-				SetError(ErrorCode::InvalidReferenceSyntax);
-				row = tempRow;
-				column = tempColumn;
-			}
-			return false;
-		}
-		else
-		{
-			// Not allowed character.
-			Reset();
-			SetError(ErrorCode::InvalidReferenceSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return false;
-		}
+	inline bool DirectFileStream::IsDirect() const
+	{
+		return buf.IsDirect();
+	}
 
-		return true;
+	inline std::size_t DirectFileStream::GetBlockSize() const
+	{
+		return buf.GetBlockSize();
 	}
+#endif
 
-	template <typename TCharactersWriter>
-	inline int Inspector<TCharactersWriter>::ParseEntityReference(bool insideTag)
+#if defined(XML_INSPECTOR_ZLIB)
+	inline GzipStream::GzipStream(const char* filePath)
+		: std::istream(nullptr),
+		file(),
+		buf()
 	{
-		// IsNameStartChar(currentCharacter) == true
-		// &&
-		// currentCharacter != colon.
-		
-		SizeType tempRow = currentRow;
-		SizeType tempColumn = currentColumn - 1;
+		rdbuf(&buf);
+		if (filePath != nullptr)
+			file.open(filePath, std::ifstream::binary);
+		if (!file.is_open() || !buf.Open(file.rdbuf()))
+			setstate(std::istream::failbit);
+	}
 
-		entityName.reserve(NameReserve);
-		entityNameCharCount = 0;
+	inline GzipStream::GzipStream(const std::string& filePath)
+		: std::istream(nullptr),
+		file(filePath.c_str(), std::ifstream::binary),
+		buf()
+	{
+		rdbuf(&buf);
+		if (!file.is_open() || !buf.Open(file.rdbuf()))
+			setstate(std::istream::failbit);
+	}
 
-		if (currentCharacter == LtEntityName[0])
-		{
-			// "&l"
-			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-			++entityNameCharCount;
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
-				}
-				return -1;
-			}
+	inline GzipStream::GzipStream(std::istream* compressedStream)
+		: std::istream(nullptr),
+		file(),
+		buf()
+	{
+		rdbuf(&buf);
+		if (compressedStream == nullptr ||
+			compressedStream->rdbuf() == nullptr ||
+			!buf.Open(compressedStream->rdbuf()))
+			setstate(std::istream::failbit);
+	}
 
-			if (currentCharacter == LtEntityName[1])
-			{
-				// "&lt"
-				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-				++entityNameCharCount;
-				if (NextCharBad(insideTag))
-				{
-					if (!insideTag && eof)
-					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
-					}
-					return -1;
-				}
+	inline GzipStream::~GzipStream()
+	{
 
-				if (currentCharacter == Semicolon)
-				{
-					// "&lt;"
-					currentCharacter = LessThan;
-					entityName.clear();
-					return 1;
-				}
-			}
-			
-			if (currentCharacter == Semicolon)
-			{
-				return 0;
-			}
-			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
-				currentCharacter == Colon)
-			{
-				Reset();
-				SetError(ErrorCode::InvalidReferenceSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return -1;
-			}
-		}
-		else if (currentCharacter == GtEntityName[0])
-		{
-			// "&g"
-			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-			++entityNameCharCount;
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
-				}
-				return -1;
-			}
+	}
 
-			if (currentCharacter == GtEntityName[1])
-			{
-				// "&gt"
-				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-				++entityNameCharCount;
-				if (NextCharBad(insideTag))
-				{
-					if (!insideTag && eof)
-					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
-					}
-					return -1;
-				}
+	inline bool GzipStream::IsOpen() const
+	{
+		return buf.IsOpen();
+	}
+
+	inline ParallelGzipStream::ParallelGzipStream(const char* filePath,
+		std::size_t threadsCount, std::size_t queueDepth)
+		: std::istream(nullptr),
+		file(),
+		buf(threadsCount, queueDepth)
+	{
+		rdbuf(&buf);
+		if (filePath != nullptr)
+			file.open(filePath, std::ifstream::binary);
+		if (file.is_open())
+			buf.Open(file.rdbuf());
+		else
+			setstate(std::istream::failbit);
+	}
+
+	inline ParallelGzipStream::ParallelGzipStream(const std::string& filePath,
+		std::size_t threadsCount, std::size_t queueDepth)
+		: std::istream(nullptr),
+		file(filePath.c_str(), std::ifstream::binary),
+		buf(threadsCount, queueDepth)
+	{
+		rdbuf(&buf);
+		if (file.is_open())
+			buf.Open(file.rdbuf());
+		else
+			setstate(std::istream::failbit);
+	}
+
+	inline ParallelGzipStream::ParallelGzipStream(std::istream* compressedStream,
+		std::size_t threadsCount, std::size_t queueDepth)
+		: std::istream(nullptr),
+		file(),
+		buf(threadsCount, queueDepth)
+	{
+		rdbuf(&buf);
+		if (compressedStream != nullptr && compressedStream->rdbuf() != nullptr)
+			buf.Open(compressedStream->rdbuf());
+		else
+			setstate(std::istream::failbit);
+	}
+
+	inline ParallelGzipStream::~ParallelGzipStream()
+	{
+
+	}
+
+	inline bool ParallelGzipStream::IsOpen() const
+	{
+		return buf.IsOpen();
+	}
 
-				if (currentCharacter == Semicolon)
-				{
-					// "&gt;"
-					currentCharacter = GreaterThan;
-					entityName.clear();
-					return 1;
-				}
-			}
-			
-			if (currentCharacter == Semicolon)
-			{
-				return 0;
-			}
-			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
-				currentCharacter == Colon)
-			{
-				Reset();
-				SetError(ErrorCode::InvalidReferenceSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return -1;
-			}
-		}
-		else if (currentCharacter == AmpEntityName[0])
+	inline std::size_t ParallelGzipStream::GetThreadsCount() const
+	{
+		return buf.GetThreadsCount();
+	}
+#endif
+
+	/// @cond DETAILS
+	namespace Details
+	{
+		inline Bom ReadBom(std::istream* inputStream)
 		{
-			// "&a"
-			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-			++entityNameCharCount;
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
-				}
-				return -1;
-			}
+			// UTF-8          EF BB BF
+			// UTF-16 (BE)    FE FF
+			// UTF-16 (LE)    FF FE
+			// UTF-32 (BE)    00 00 FE FF
+			// UTF-32 (LE)    FF FE 00 00
 
-			if (currentCharacter == AmpEntityName[1])
+			if (inputStream != nullptr)
 			{
-				// "&am"
-				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-				++entityNameCharCount;
-				if (NextCharBad(insideTag))
+				// Check first byte.
+				int oneByte = inputStream->peek();
+
+				if (oneByte == std::char_traits<char>::eof())
 				{
-					if (!insideTag && eof)
-					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
-					}
-					return -1;
+					if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+						return Bom::None; // End of the stream.
+					return Bom::StreamError;
 				}
 
-				if (currentCharacter == AmpEntityName[2])
+				if (oneByte == 0xEF) // Should be UTF-8
 				{
-					// "&amp"
-					CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-					++entityNameCharCount;
-					if (NextCharBad(insideTag))
+					// Extract first byte.
+					inputStream->get();
+
+					// Extract second byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						if (!insideTag && eof)
-						{
-							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-							Reset();
-							SetError(ErrorCode::UnclosedTag);
-							row = ref.Row;
-							column = ref.Column;
-							eof = true;
-						}
-						return -1;
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
+					if (oneByte != 0xBB)
+						return Bom::Invalid;
 
-					if (currentCharacter == Semicolon)
+					// Extract third byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						// "&amp;"
-						currentCharacter = Ampersand;
-						entityName.clear();
-						return 1;
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
+					if (oneByte != 0xBF)
+						return Bom::Invalid;
+
+					return Bom::Utf8;
 				}
-			}
-			else if (currentCharacter == AposEntityName[1])
-			{
-				// "&ap"
-				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-				++entityNameCharCount;
-				if (NextCharBad(insideTag))
+				else if (oneByte == 0xFE) // Should be UTF-16 (BE)
 				{
-					if (!insideTag && eof)
+					// Extract first byte.
+					inputStream->get();
+
+					// Extract second byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
-					return -1;
-				}
+					if (oneByte != 0xFF)
+						return Bom::Invalid;
 
-				if (currentCharacter == AposEntityName[2])
+					return Bom::Utf16BE;
+				}
+				else if (oneByte == 0xFF) // Should be UTF-16 (LE) of UTF-32 (LE)
 				{
-					// "&apo"
-					CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-					++entityNameCharCount;
-					if (NextCharBad(insideTag))
+					// Extract first byte.
+					inputStream->get();
+
+					// Extract second byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						if (!insideTag && eof)
-						{
-							UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-							Reset();
-							SetError(ErrorCode::UnclosedTag);
-							row = ref.Row;
-							column = ref.Column;
-							eof = true;
-						}
-						return -1;
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
+					if (oneByte != 0xFE)
+						return Bom::Invalid;
 
-					if (currentCharacter == AposEntityName[3])
+					// Check third byte.
+					oneByte = inputStream->peek();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						// "&apos"
-						CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-						++entityNameCharCount;
-						if (NextCharBad(insideTag))
-						{
-							if (!insideTag && eof)
-							{
-								UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-								Reset();
-								SetError(ErrorCode::UnclosedTag);
-								row = ref.Row;
-								column = ref.Column;
-								eof = true;
-							}
-							return -1;
-						}
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Utf16LE;
+						return Bom::StreamError;
+					}
+					if (oneByte != 0x00)
+						return Bom::Utf16LE;
 
-						if (currentCharacter == Semicolon)
-						{
-							// "&apos;"
-							currentCharacter = SingleQuote;
-							entityName.clear();
-							return 1;
-						}
+					// Should be UTF-32 (LE)
+					// Extract third byte.
+					inputStream->get();
+
+					// Extract fourth byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
+					{
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
-				}
-			}
+					if (oneByte != 0x00)
+						return Bom::Invalid;
 
-			if (currentCharacter == Semicolon)
-			{
-				return 0;
-			}
-			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
-				currentCharacter == Colon)
-			{
-				Reset();
-				SetError(ErrorCode::InvalidReferenceSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return -1;
-			}
-		}
-		else if (currentCharacter == QuotEntityName[0])
-		{
-			// "&q"
-			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-			++entityNameCharCount;
-			std::size_t i;
-			for (i = 1; i < 4; ++i)
-			{
-				if (NextCharBad(insideTag))
+					return Bom::Utf32LE;
+				}
+				else if (oneByte == 0x00) // Should be UTF-32 (BE)
 				{
-					if (!insideTag && eof)
+					// Extract first byte.
+					inputStream->get();
+
+					// Extract second byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
-					return -1;
-				}
-
-				if (currentCharacter != QuotEntityName[i])
-					break;
+					if (oneByte != 0x00)
+						return Bom::Invalid;
 
-				CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-				++entityNameCharCount;
-			}
+					// Extract third byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
+					{
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
+					}
+					if (oneByte != 0xFE)
+						return Bom::Invalid;
 
-			if (i == 4)
-			{
-				if (NextCharBad(insideTag))
-				{
-					if (!insideTag && eof)
+					// Extract fourth byte.
+					oneByte = inputStream->get();
+					if (oneByte == std::char_traits<char>::eof())
 					{
-						UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-						Reset();
-						SetError(ErrorCode::UnclosedTag);
-						row = ref.Row;
-						column = ref.Column;
-						eof = true;
+						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
+							return Bom::Invalid;
+						return Bom::StreamError;
 					}
-					return -1;
-				}
-			}
+					if (oneByte != 0xFF)
+						return Bom::Invalid;
 
-			if (currentCharacter == Semicolon)
-			{
-				if (i == 4)
-				{
-					// "&quot;"
-					currentCharacter = DoubleQuote;
-					entityName.clear();
-					return 1;
+					return Bom::Utf32BE;
 				}
 				else
 				{
-					return 0;
-				}
-			}
-			else if (!Encoding::CharactersReader::IsNameChar(currentCharacter) ||
-				currentCharacter == Colon)
-			{
-				Reset();
-				SetError(ErrorCode::InvalidReferenceSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return -1;
-			}
-		}
-
-		do
-		{
-			CharactersWriterType::WriteCharacter(entityName, currentCharacter);
-			++entityNameCharCount;
-			if (NextCharBad(insideTag))
-			{
-				if (!insideTag && eof)
-				{
-					UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-					Reset();
-					SetError(ErrorCode::UnclosedTag);
-					row = ref.Row;
-					column = ref.Column;
-					eof = true;
+					return Bom::None;
 				}
-				return -1;
-			}
-
-			if (currentCharacter == Colon)
-			{
-				Reset();
-				SetError(ErrorCode::InvalidReferenceSyntax);
-				row = tempRow;
-				column = tempColumn;
-				return -1;
 			}
+			return Bom::StreamError;
 		}
-		while (Encoding::CharactersReader::IsNameChar(currentCharacter));
-
-		if (currentCharacter != Semicolon)
+		
+		template <typename TInputIterator>
+		inline Bom ReadBom(TInputIterator& first, TInputIterator& last)
 		{
-			Reset();
-			SetError(ErrorCode::InvalidReferenceSyntax);
-			row = tempRow;
-			column = tempColumn;
-			return -1;
-		}
+			// UTF-8          EF BB BF
+			// UTF-16 (BE)    FE FF
+			// UTF-16 (LE)    FF FE
+			// UTF-32 (BE)    00 00 FE FF
+			// UTF-32 (LE)    FF FE 00 00
 
-		return 0;
-	}
+			if (first == last)
+				return Bom::None;
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::AttributeUniqueness()
-	{
-		if (attributesSize > 1)
-		{
-			const AttributesSizeType lastIndex = attributesSize - 1;
-			const AttributeType& last = attributes[lastIndex];
-			for (AttributesSizeType i = 0; i < lastIndex; ++i)
+			if (static_cast<unsigned char>(*first) == 0xEF) // Should be UTF-8
 			{
-				if (last.Name == attributes[i].Name)
-				{
-					Reset();
-					SetError(ErrorCode::DoubleAttributeName);
-					row = last.Row;
-					column = last.Column;
-					return false;
-				}
-			}
-		}
-
-		return true;
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::ResolveEncoding(const AttributeType& encoding)
-	{
-		// comparingName is already set.
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0xBB)
+					return Bom::Invalid;
 
-		SizeType tempRow;
-		SizeType tempColumn;
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0xBF)
+					return Bom::Invalid;
 
-		if (IsUtf8Charset())
-		{
-			if (bom == Details::Bom::Utf8 ||
-				bom == Details::Bom::None)
-				return true;
-		}
-		else if (IsUtf16Charset())
-		{
-			if (bom == Details::Bom::Utf16BE ||
-				bom == Details::Bom::Utf16LE)
-				return true;
-		}
-		else if (IsUtf32Charset())
-		{
-			if (bom == Details::Bom::Utf32BE ||
-				bom == Details::Bom::Utf32LE)
-				return true;
-		}
-		else if (IsUtf16BECharset())
-		{
-			if (bom == Details::Bom::Utf16BE)
-				return true;
-		}
-		else if (IsUtf16LECharset())
-		{
-			if (bom == Details::Bom::Utf16LE)
-				return true;
-		}
-		else if (IsUtf32BECharset())
-		{
-			if (bom == Details::Bom::Utf32BE)
-				return true;
-		}
-		else if (IsUtf32LECharset())
-		{
-			if (bom == Details::Bom::Utf32LE)
-				return true;
-		}
-		else if (IsISO_8859_1_Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_1_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_1_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
-		}
-		else if (IsISO_8859_2_Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_2_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_2_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
-		}
-		else if (IsWindows874Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows874StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows874StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
-		}
-		else if (IsWindows1250Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1250StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1250StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
-		}
-		else if (IsWindows1251Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1251StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1251StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
-		}
-		else if (IsWindows1252Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1252StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1252StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
-		}
-		else if (IsWindows1253Charset())
-		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1253StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1253StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
+				++first;
+				return Bom::Utf8;
 			}
-		}
-		else if (IsWindows1254Charset())
-		{
-			if (bom == Details::Bom::None)
+			else if (static_cast<unsigned char>(*first) == 0xFE) // Should be UTF-16 (BE)
 			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1254StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1254StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0xFF)
+					return Bom::Invalid;
+
+				++first;
+				return Bom::Utf16BE;
 			}
-		}
-		else if (IsWindows1255Charset())
-		{
-			if (bom == Details::Bom::None)
+			else if (static_cast<unsigned char>(*first) == 0xFF) // Should be UTF-16 (LE) of UTF-32 (LE)
 			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1255StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1255StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0xFE)
+					return Bom::Invalid;
+
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0x00)
+					return Bom::Utf16LE;
+
+				// Should be UTF-32 (LE)
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0x00)
+					return Bom::Invalid;
+
+				++first;
+				return Bom::Utf32LE;
 			}
-		}
-		else if (IsWindows1256Charset())
-		{
-			if (bom == Details::Bom::None)
+			else if (static_cast<unsigned char>(*first) == 0x00) // Should be UTF-32 (BE)
 			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1256StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1256StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0x00)
+					return Bom::Invalid;
+
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0xFE)
+					return Bom::Invalid;
+
+				++first;
+				if (first == last || static_cast<unsigned char>(*first) != 0xFF)
+					return Bom::Invalid;
+
+				++first;
+				return Bom::Utf32BE;
 			}
-		}
-		else if (IsWindows1257Charset())
-		{
-			if (bom == Details::Bom::None)
+			else
 			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1257StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1257StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
+				return Bom::None;
 			}
 		}
-		else if (IsWindows1258Charset())
+
+		// Skips white spaces. Returns false if there are no more bytes.
+		inline bool SkipWhiteSpaces(const char*& first, const char* last)
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::Windows1258StreamReader(&fileStream);
-				else
-					newReader = new Encoding::Windows1258StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			while (first != last &&
+				(*first == ' ' || *first == '\t' || *first == '\r' || *first == '\n'))
+				++first;
+			return first != last;
 		}
-		else if (IsISO_8859_3_Charset())
+
+		// Skips Eq and the opening quotation mark.
+		inline bool SkipEq(const char*& first, const char* last, char& quote)
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_3_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_3_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			if (!SkipWhiteSpaces(first, last) || *first != '=')
+				return false;
+			++first;
+			if (!SkipWhiteSpaces(first, last) || (*first != '"' && *first != '\''))
+				return false;
+			quote = *first++;
+			return true;
 		}
-		else if (IsISO_8859_4_Charset())
+
+		inline Declaration SniffDeclaration(const char* first, const char* last,
+			const char*& encodingFirst, const char*& encodingLast)
 		{
-			if (bom == Details::Bom::None)
+			// '<?xml' S 'version' Eq ('"' VersionNum '"' | "'" VersionNum "'")
+			// S 'encoding' Eq ('"' EncName '"' | "'" EncName "'")
+			// Syntax errors are reported as Declaration::Unknown,
+			// so they are found by the parser.
+			static const char xml[5] = { '<', '?', 'x', 'm', 'l' };
+			static const char version[7] = { 'v', 'e', 'r', 's', 'i', 'o', 'n' };
+			static const char encoding[8] = { 'e', 'n', 'c', 'o', 'd', 'i', 'n', 'g' };
+
+			const char* i = first;
+			for (std::size_t j = 0; j < 5; ++j, ++i)
 			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_4_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_4_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
+				if (i == last)
+					return Declaration::Unknown;
+				if (*i != xml[j])
+					return Declaration::NoEncoding;
+			}
+
+			// Processing instruction like <?xml-stylesheet?> isn't the XML declaration.
+			if (i == last)
+				return Declaration::Unknown;
+			if (*i != ' ' && *i != '\t' && *i != '\r' && *i != '\n')
+				return Declaration::NoEncoding;
+
+			if (!SkipWhiteSpaces(i, last))
+				return Declaration::Unknown;
+			for (std::size_t j = 0; j < 7; ++j, ++i)
+			{
+				if (i == last || *i != version[j])
+					return Declaration::Unknown;
+			}
+
+			char quote;
+			if (!SkipEq(i, last, quote))
+				return Declaration::Unknown;
+			while (i != last && *i != quote && *i != '<' && *i != '>')
+				++i;
+			if (i == last || *i != quote)
+				return Declaration::Unknown;
+			++i;
+
+			if (i == last)
+				return Declaration::Unknown;
+			if (*i != ' ' && *i != '\t' && *i != '\r' && *i != '\n')
+				return Declaration::NoEncoding;
+			if (!SkipWhiteSpaces(i, last))
+				return Declaration::Unknown;
+			if (*i != 'e')
+				return Declaration::NoEncoding; // Standalone declaration or the end.
+			for (std::size_t j = 0; j < 8; ++j, ++i)
+			{
+				if (i == last || *i != encoding[j])
+					return Declaration::Unknown;
+			}
+
+			if (!SkipEq(i, last, quote))
+				return Declaration::Unknown;
+			encodingFirst = i;
+			// EncName ::= [A-Za-z] ([A-Za-z0-9._] | '-')*
+			while (i != last &&
+				((*i >= 'A' && *i <= 'Z') || (*i >= 'a' && *i <= 'z') ||
+				(i != encodingFirst &&
+					((*i >= '0' && *i <= '9') || *i == '.' || *i == '_' || *i == '-'))))
+				++i;
+			if (i == last || i == encodingFirst || *i != quote)
+				return Declaration::Unknown;
+			encodingLast = i;
+			return Declaration::Encoding;
+		}
+
+		constexpr std::uint_least32_t CharsetHash(const char* name, std::uint_least32_t hash)
+		{
+			return (*name == 0) ? hash : CharsetHash(name + 1,
+				((hash ^ (static_cast<unsigned char>(*name) | 0x20u)) * 16777619u) & 0xFFFFFFFFu);
+		}
+
+		constexpr bool IsSortedByHash(const CharsetName* first, const CharsetName* last)
+		{
+			return (last - first < 2) ? true :
+				(first[0].Hash < first[1].Hash && IsSortedByHash(first + 1, last));
+		}
+
+		inline bool operator<(const CharsetName& name, std::uint_least32_t hash)
+		{
+			return name.Hash < hash;
+		}
+
+		template <typename TCharacter>
+		inline Charset FindCharset(const TCharacter* first, const TCharacter* last)
+		{
+			typedef typename std::make_unsigned<TCharacter>::type UnsignedType;
+
+			// Lowercase names of the character sets registered by IANA sorted by
+			// their hashes, which are computed by the compiler. A new name must be
+			// inserted before the first name with greater hash, and the names
+			// with the same hash are rejected by the static assertion too.
+			static constexpr CharsetName names[118] =
+			{
+				{ "windows-1255", Charset::Windows1255 },
+				{ "windows-1254", Charset::Windows1254 },
+				{ "windows-1257", Charset::Windows1257 },
+				{ "windows-1256", Charset::Windows1256 },
+				{ "windows-1251", Charset::Windows1251 },
+				{ "windows-1250", Charset::Windows1250 },
+				{ "utf-8", Charset::Utf8 },
+				{ "csutf32", Charset::Utf32 },
+				{ "windows-1253", Charset::Windows1253 },
+				{ "utf-32le", Charset::Utf32LE },
+				{ "windows-1252", Charset::Windows1252 },
+				{ "l8", Charset::ISO_8859_14 },
+				{ "l3", Charset::ISO_8859_3 },
+				{ "l2", Charset::ISO_8859_2 },
+				{ "l1", Charset::ISO_8859_1 },
+				{ "cswindows874", Charset::Windows874 },
+				{ "l6", Charset::ISO_8859_10 },
+				{ "l5", Charset::ISO_8859_9 },
+				{ "l4", Charset::ISO_8859_4 },
+				{ "iso-celtic", Charset::ISO_8859_14 },
+				{ "utf-16le", Charset::Utf16LE },
+				{ "csisolatinhebrew", Charset::ISO_8859_8 },
+				{ "windows-874", Charset::Windows874 },
+				{ "asmo-708", Charset::ISO_8859_6 },
+				{ "iso_8859-16", Charset::ISO_8859_16 },
+				{ "iso_8859-15", Charset::ISO_8859_15 },
+				{ "iso_8859-14", Charset::ISO_8859_14 },
+				{ "latin-9", Charset::ISO_8859_15 },
+				{ "iso-8859-6", Charset::ISO_8859_6 },
+				{ "iso-8859-7", Charset::ISO_8859_7 },
+				{ "iso-8859-4", Charset::ISO_8859_4 },
+				{ "iso_8859-10", Charset::ISO_8859_10 },
+				{ "iso-8859-5", Charset::ISO_8859_5 },
+				{ "iso-8859-2", Charset::ISO_8859_2 },
+				{ "cstis620", Charset::TIS620 },
+				{ "iso-8859-3", Charset::ISO_8859_3 },
+				{ "utf-16be", Charset::Utf16BE },
+				{ "iso-8859-1", Charset::ISO_8859_1 },
+				{ "iso-8859-8", Charset::ISO_8859_8 },
+				{ "iso-8859-9", Charset::ISO_8859_9 },
+				{ "greek8", Charset::ISO_8859_7 },
+				{ "csisolatinarabic", Charset::ISO_8859_6 },
+				{ "iso-ir-138", Charset::ISO_8859_8 },
+				{ "arabic", Charset::ISO_8859_6 },
+				{ "iso-ir-148", Charset::ISO_8859_9 },
+				{ "utf-16", Charset::Utf16 },
+				{ "iso-ir-144", Charset::ISO_8859_5 },
+				{ "utf-32", Charset::Utf32 },
+				{ "iso-ir-157", Charset::ISO_8859_10 },
+				{ "csutf16", Charset::Utf16 },
+				{ "iso_8859-8", Charset::ISO_8859_8 },
+				{ "iso_8859-9", Charset::ISO_8859_9 },
+				{ "iso_8859-4", Charset::ISO_8859_4 },
+				{ "iso_8859-5", Charset::ISO_8859_5 },
+				{ "iso_8859-6", Charset::ISO_8859_6 },
+				{ "iso_8859-7", Charset::ISO_8859_7 },
+				{ "iso_8859-1", Charset::ISO_8859_1 },
+				{ "iso_8859-2", Charset::ISO_8859_2 },
+				{ "iso_8859-3", Charset::ISO_8859_3 },
+				{ "csisolatincyrillic", Charset::ISO_8859_5 },
+				{ "csiso885913", Charset::ISO_8859_13 },
+				{ "csiso885915", Charset::ISO_8859_15 },
+				{ "csiso885914", Charset::ISO_8859_14 },
+				{ "csiso885916", Charset::ISO_8859_16 },
+				{ "csisolatin2", Charset::ISO_8859_2 },
+				{ "csisolatin3", Charset::ISO_8859_3 },
+				{ "cswindows1258", Charset::Windows1258 },
+				{ "tis-620", Charset::TIS620 },
+				{ "cyrillic", Charset::ISO_8859_5 },
+				{ "csisolatin1", Charset::ISO_8859_1 },
+				{ "csutf8", Charset::Utf8 },
+				{ "csisolatin6", Charset::ISO_8859_10 },
+				{ "l10", Charset::ISO_8859_16 },
+				{ "csisolatin4", Charset::ISO_8859_4 },
+				{ "csisolatin5", Charset::ISO_8859_9 },
+				{ "cswindows1252", Charset::Windows1252 },
+				{ "cswindows1253", Charset::Windows1253 },
+				{ "ecma-114", Charset::ISO_8859_6 },
+				{ "cswindows1250", Charset::Windows1250 },
+				{ "cswindows1251", Charset::Windows1251 },
+				{ "cswindows1256", Charset::Windows1256 },
+				{ "cp819", Charset::ISO_8859_1 },
+				{ "cswindows1257", Charset::Windows1257 },
+				{ "cswindows1254", Charset::Windows1254 },
+				{ "latin10", Charset::ISO_8859_16 },
+				{ "cswindows1255", Charset::Windows1255 },
+				{ "ecma-118", Charset::ISO_8859_7 },
+				{ "iso-8859-15", Charset::ISO_8859_15 },
+				{ "iso-8859-14", Charset::ISO_8859_14 },
+				{ "iso-ir-226", Charset::ISO_8859_16 },
+				{ "iso-8859-16", Charset::ISO_8859_16 },
+				{ "iso-8859-10", Charset::ISO_8859_10 },
+				{ "iso-8859-13", Charset::ISO_8859_13 },
+				{ "ibm819", Charset::ISO_8859_1 },
+				{ "latin1", Charset::ISO_8859_1 },
+				{ "latin3", Charset::ISO_8859_3 },
+				{ "latin2", Charset::ISO_8859_2 },
+				{ "latin5", Charset::ISO_8859_9 },
+				{ "latin4", Charset::ISO_8859_4 },
+				{ "latin6", Charset::ISO_8859_10 },
+				{ "csutf16be", Charset::Utf16BE },
+				{ "latin8", Charset::ISO_8859_14 },
+				{ "iso-ir-100", Charset::ISO_8859_1 },
+				{ "iso-ir-101", Charset::ISO_8859_2 },
+				{ "csutf16le", Charset::Utf16LE },
+				{ "iso-ir-110", Charset::ISO_8859_4 },
+				{ "iso-ir-126", Charset::ISO_8859_7 },
+				{ "elot_928", Charset::ISO_8859_7 },
+				{ "iso-ir-127", Charset::ISO_8859_6 },
+				{ "iso-ir-109", Charset::ISO_8859_3 },
+				{ "csutf32le", Charset::Utf32LE },
+				{ "iso-ir-199", Charset::ISO_8859_14 },
+				{ "csutf32be", Charset::Utf32BE },
+				{ "utf-32be", Charset::Utf32BE },
+				{ "csisolatingreek", Charset::ISO_8859_7 },
+				{ "hebrew", Charset::ISO_8859_8 },
+				{ "windows-1258", Charset::Windows1258 },
+				{ "greek", Charset::ISO_8859_7 }
+			};
+			static_assert(IsSortedByHash(names, names + 118),
+				"Charset names must be sorted by their different hashes.");
+
+			std::uint_least32_t hash = 2166136261u;
+			for (const TCharacter* i = first; i != last; ++i)
+			{
+				std::uint_least32_t c = static_cast<UnsignedType>(*i);
+				if (c > 0x7F)
+					return Charset::Unknown;
+				hash = ((hash ^ (c | 0x20u)) * 16777619u) & 0xFFFFFFFFu;
+			}
+
+			const CharsetName* name = std::lower_bound(names, names + 118, hash);
+			if (name == names + 118 || name->Hash != hash)
+				return Charset::Unknown;
+
+			// Different names could have the same hash.
+			const char* c = name->Name;
+			for (const TCharacter* i = first; i != last; ++i, ++c)
+			{
+				std::uint_least32_t lower = static_cast<UnsignedType>(*i);
+				if (lower >= 0x41 && lower <= 0x5A)
+					lower += 0x20;
+				if (*c == 0 || lower != static_cast<unsigned char>(*c))
+					return Charset::Unknown;
+			}
+			if (*c != 0)
+				return Charset::Unknown;
+			return name->Value;
+		}
+
+		inline const char16_t* CharacterMap(Charset charset)
+		{
+			switch (charset)
+			{
+			case Charset::ISO_8859_1:
+				return Encoding::ISO_8859_1_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_2:
+				return Encoding::ISO_8859_2_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_3:
+				return Encoding::ISO_8859_3_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_4:
+				return Encoding::ISO_8859_4_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_5:
+				return Encoding::ISO_8859_5_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_6:
+				return Encoding::ISO_8859_6_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_7:
+				return Encoding::ISO_8859_7_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_8:
+				return Encoding::ISO_8859_8_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_9:
+				return Encoding::ISO_8859_9_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_10:
+				return Encoding::ISO_8859_10_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_13:
+				return Encoding::ISO_8859_13_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_14:
+				return Encoding::ISO_8859_14_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_15:
+				return Encoding::ISO_8859_15_StreamReader::GetCharacterMap();
+			case Charset::ISO_8859_16:
+				return Encoding::ISO_8859_16_StreamReader::GetCharacterMap();
+			case Charset::TIS620:
+				return Encoding::TIS620StreamReader::GetCharacterMap();
+			case Charset::Windows874:
+				return Encoding::Windows874StreamReader::GetCharacterMap();
+			case Charset::Windows1250:
+				return Encoding::Windows1250StreamReader::GetCharacterMap();
+			case Charset::Windows1251:
+				return Encoding::Windows1251StreamReader::GetCharacterMap();
+			case Charset::Windows1252:
+				return Encoding::Windows1252StreamReader::GetCharacterMap();
+			case Charset::Windows1253:
+				return Encoding::Windows1253StreamReader::GetCharacterMap();
+			case Charset::Windows1254:
+				return Encoding::Windows1254StreamReader::GetCharacterMap();
+			case Charset::Windows1255:
+				return Encoding::Windows1255StreamReader::GetCharacterMap();
+			case Charset::Windows1256:
+				return Encoding::Windows1256StreamReader::GetCharacterMap();
+			case Charset::Windows1257:
+				return Encoding::Windows1257StreamReader::GetCharacterMap();
+			case Charset::Windows1258:
+				return Encoding::Windows1258StreamReader::GetCharacterMap();
+				default:
+					return nullptr;
 			}
 		}
-		else if (IsISO_8859_5_Charset())
+
+		template <
+			typename TInputIterator,
+			typename TCharacterType,
+			typename TTraits>
+		inline typename BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::int_type
+			BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::underflow()
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_5_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_5_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			if (curIter == endIter)
+				return traits_type::eof();
+
+			return traits_type::to_int_type(*curIter);
 		}
-		else if (IsISO_8859_6_Charset())
+
+		template <
+			typename TInputIterator,
+			typename TCharacterType,
+			typename TTraits>
+		inline typename BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::int_type
+			BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::uflow()
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_6_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_6_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			if (curIter == endIter)
+				return traits_type::eof();
+
+			return traits_type::to_int_type(*curIter++);
 		}
-		else if (IsISO_8859_7_Charset())
+
+		template <
+			typename TInputIterator,
+			typename TCharacterType,
+			typename TTraits>
+		inline std::streamsize
+			BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::showmanyc()
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_7_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_7_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			return (curIter != endIter)
+				? 1
+				: 0;
 		}
-		else if (IsISO_8859_8_Charset())
+
+		inline FeedBuffer::FeedBuffer()
+			: bytes(),
+			start(0),
+			scanned(0),
+			limit(0),
+			unitSize(0),
+			bigEndian(false),
+			state(ScanContent),
+			matched(0),
+			quote(0),
+			text(false),
+			tagOpened(false),
+			finished(false)
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_8_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_8_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+
 		}
-		else if (IsISO_8859_9_Charset())
+
+		inline void FeedBuffer::Clear()
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_9_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_9_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			bytes.clear();
+			start = 0;
+			scanned = 0;
+			limit = 0;
+			unitSize = 0;
+			bigEndian = false;
+			state = ScanContent;
+			matched = 0;
+			quote = 0;
+			text = false;
+			tagOpened = false;
+			finished = false;
 		}
-		else if (IsISO_8859_10_Charset())
+
+		inline void FeedBuffer::Append(const char* data, std::size_t size)
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_10_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_10_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			bytes.append(data, size);
+			Scan();
 		}
-		else if (IsISO_8859_13_Charset())
+
+		inline void FeedBuffer::Finish()
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_13_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_13_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			finished = true;
+			Scan();
 		}
-		else if (IsISO_8859_14_Charset())
+
+		inline void FeedBuffer::Erase(std::size_t count)
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_14_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_14_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			bytes.erase(0, count);
+			start = (start > count) ? start - count : 0;
+			scanned -= count;
+			limit -= count;
 		}
-		else if (IsISO_8859_15_Charset())
+
+		inline bool FeedBuffer::IsFinished() const
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_15_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_15_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			return finished;
 		}
-		else if (IsISO_8859_16_Charset())
+
+		inline const char* FeedBuffer::GetData() const
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::ISO_8859_16_StreamReader(&fileStream);
-				else
-					newReader = new Encoding::ISO_8859_16_StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			return bytes.data();
 		}
-		else if (IsTIS620Charset())
+
+		inline std::size_t FeedBuffer::GetSize() const
 		{
-			if (bom == Details::Bom::None)
-			{
-				Encoding::CharactersReader* newReader;
-				if (sourceType == SourcePath)
-					newReader = new Encoding::TIS620StreamReader(&fileStream);
-				else
-					newReader = new Encoding::TIS620StreamReader(inputStreamPtr);
-				delete reader;
-				reader = newReader;
-				return true;
-			}
+			return bytes.size();
 		}
-		else
+
+		inline std::size_t FeedBuffer::GetStart() const
 		{
-			tempRow = encoding.Row;
-			tempColumn = encoding.Column;
-			Reset();
-			SetError(ErrorCode::UnknownEncoding);
-			row = tempRow;
-			column = tempColumn;
-			return false;
+			return start;
 		}
-		
-		tempRow = encoding.Row;
-		tempColumn = encoding.Column;
-		Reset();
-		SetError(ErrorCode::EncodingConfusion);
-		row = tempRow;
-		column = tempColumn;
-		return false;
-	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf8Charset()
-	{
-		// UTF-8
-		static const unsigned char c1[5] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x38 };
-		// csUTF8
-		static const unsigned char c2[6] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x38 };
-		return (
-			CharsetEqual(c1, 5) ||
-			CharsetEqual(c2, 6));
-		/*
-		return (
-			CharsetEqual(U"UTF-8") ||
-			CharsetEqual(U"csUTF8"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf16Charset()
-	{
-		// UTF-16
-		static const unsigned char c1[6] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x31, 0x36 };
-		// csUTF16
-		static const unsigned char c2[7] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x31, 0x36 };
-		return (
-			CharsetEqual(c1, 6) ||
-			CharsetEqual(c2, 7));
-		/*
-		return (
-			CharsetEqual(U"UTF-16") ||
-			CharsetEqual(U"csUTF16"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf16BECharset()
-	{
-		// UTF-16BE
-		static const unsigned char c1[8] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x31, 0x36, 0x42, 0x45 };
-		// csUTF16BE
-		static const unsigned char c2[9] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x31, 0x36, 0x42, 0x45 };
-		return (
-			CharsetEqual(c1, 8) ||
-			CharsetEqual(c2, 9));
-		/*
-		return (
-			CharsetEqual(U"UTF-16BE") ||
-			CharsetEqual(U"csUTF16BE"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf16LECharset()
-	{
-		// UTF-16LE
-		static const unsigned char c1[8] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x31, 0x36, 0x4C, 0x45 };
-		// csUTF16LE
-		static const unsigned char c2[9] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x31, 0x36, 0x4C, 0x45 };
-		return (
-			CharsetEqual(c1, 8) ||
-			CharsetEqual(c2, 9));
-		/*
-		return (
-			CharsetEqual(U"UTF-16LE") ||
-			CharsetEqual(U"csUTF16LE"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf32Charset()
-	{
-		// UTF-32
-		static const unsigned char c1[6] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x33, 0x32 };
-		// csUTF32
-		static const unsigned char c2[7] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x33, 0x32 };
-		return (
-			CharsetEqual(c1, 6) ||
-			CharsetEqual(c2, 7));
-		/*
-		return (
-			CharsetEqual(U"UTF-32") ||
-			CharsetEqual(U"csUTF32"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf32BECharset()
-	{
-		// UTF-32BE
-		static const unsigned char c1[8] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x33, 0x32, 0x42, 0x45 };
-		// csUTF32BE
-		static const unsigned char c2[9] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x33, 0x32, 0x42, 0x45 };
-		return (
-			CharsetEqual(c1, 8) ||
-			CharsetEqual(c2, 9));
-		/*
-		return (
-			CharsetEqual(U"UTF-32BE") ||
-			CharsetEqual(U"csUTF32BE"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsUtf32LECharset()
-	{
-		// UTF-32LE
-		static const unsigned char c1[8] =
-			{ 0x55, 0x54, 0x46, 0x2D, 0x33, 0x32, 0x4C, 0x45 };
-		// csUTF32LE
-		static const unsigned char c2[9] =
-			{ 0x63, 0x73, 0x55, 0x54, 0x46, 0x33, 0x32, 0x4C, 0x45 };
-		return (
-			CharsetEqual(c1, 8) ||
-			CharsetEqual(c2, 9));
-		/*
-		return (
-			CharsetEqual(U"UTF-32LE") ||
-			CharsetEqual(U"csUTF32LE"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_1_Charset()
-	{
-		// ISO-8859-1
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31 };
-		// iso-ir-100
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x30, 0x30 };
-		// ISO_8859-1
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31 };
-		// latin1
-		static const unsigned char c4[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x31 };
-		// l1
-		static const unsigned char c5[2] =
-			{ 0x6C, 0x31 };
-		// IBM819
-		static const unsigned char c6[6] =
-			{ 0x49, 0x42, 0x4D, 0x38, 0x31, 0x39 };
-		// CP819
-		static const unsigned char c7[5] =
-			{ 0x43, 0x50, 0x38, 0x31, 0x39 };
-		// csISOLatin1
-		static const unsigned char c8[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x31 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 2) ||
-			CharsetEqual(c6, 6) ||
-			CharsetEqual(c7, 5) ||
-			CharsetEqual(c8, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-1") ||
-			CharsetEqual(U"iso-ir-100") ||
-			CharsetEqual(U"ISO_8859-1") ||
-			CharsetEqual(U"latin1") ||
-			CharsetEqual(U"l1") ||
-			CharsetEqual(U"IBM819") ||
-			CharsetEqual(U"CP819") ||
-			CharsetEqual(U"csISOLatin1"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_2_Charset()
-	{
-		// ISO-8859-2
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x32 };
-		// iso-ir-101
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x30, 0x31 };
-		// ISO_8859-2
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x32 };
-		// latin2
-		static const unsigned char c4[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x32 };
-		// l2
-		static const unsigned char c5[2] =
-			{ 0x6C, 0x32 };
-		// csISOLatin2
-		static const unsigned char c6[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x32 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 2) ||
-			CharsetEqual(c6, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-2") ||
-			CharsetEqual(U"iso-ir-101") ||
-			CharsetEqual(U"ISO_8859-2") ||
-			CharsetEqual(U"latin2") ||
-			CharsetEqual(U"l2") ||
-			CharsetEqual(U"csISOLatin2"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_3_Charset()
-	{
-		// ISO-8859-3
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x33 };
-		// iso-ir-109
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x30, 0x39 };
-		// ISO_8859-3
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x33 };
-		// latin3
-		static const unsigned char c4[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x33 };
-		// l3
-		static const unsigned char c5[2] =
-			{ 0x6C, 0x33 };
-		// csISOLatin3
-		static const unsigned char c6[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x33 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 2) ||
-			CharsetEqual(c6, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-3") ||
-			CharsetEqual(U"iso-ir-109") ||
-			CharsetEqual(U"ISO_8859-3") ||
-			CharsetEqual(U"latin3") ||
-			CharsetEqual(U"l3") ||
-			CharsetEqual(U"csISOLatin3"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_4_Charset()
-	{
-		// ISO-8859-4
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x34 };
-		// iso-ir-110
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x31, 0x30 };
-		// ISO_8859-4
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x34 };
-		// latin4
-		static const unsigned char c4[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x34 };
-		// l4
-		static const unsigned char c5[2] =
-			{ 0x6C, 0x34 };
-		// csISOLatin4
-		static const unsigned char c6[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x34 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 2) ||
-			CharsetEqual(c6, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-4") ||
-			CharsetEqual(U"iso-ir-110") ||
-			CharsetEqual(U"ISO_8859-4") ||
-			CharsetEqual(U"latin4") ||
-			CharsetEqual(U"l4") ||
-			CharsetEqual(U"csISOLatin4"));
-		*/
-	}
-	
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_5_Charset()
-	{
-		// ISO-8859-5
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x35 };
-		// iso-ir-144
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x34, 0x34 };
-		// ISO_8859-5
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x35 };
-		// cyrillic
-		static const unsigned char c4[8] =
-			{ 0x63, 0x79, 0x72, 0x69, 0x6C, 0x6C, 0x69, 0x63 };
-		// csISOLatinCyrillic
-		static const unsigned char c5[18] =
-		{
-			0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69,
-			0x6E, 0x43, 0x79, 0x72, 0x69, 0x6C, 0x6C, 0x69, 0x63
-		};
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 8) ||
-			CharsetEqual(c5, 18));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-5") ||
-			CharsetEqual(U"iso-ir-144") ||
-			CharsetEqual(U"ISO_8859-5") ||
-			CharsetEqual(U"cyrillic") ||
-			CharsetEqual(U"csISOLatinCyrillic"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_6_Charset()
-	{
-		// ISO-8859-6
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x36 };
-		// iso-ir-127
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x32, 0x37 };
-		// ISO_8859-6
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x36 };
-		// ECMA-114
-		static const unsigned char c4[8] =
-			{ 0x45, 0x43, 0x4D, 0x41, 0x2D, 0x31, 0x31, 0x34 };
-		// ASMO-708
-		static const unsigned char c5[8] =
-			{ 0x41, 0x53, 0x4D, 0x4F, 0x2D, 0x37, 0x30, 0x38 };
-		// arabic
-		static const unsigned char c6[6] =
-			{ 0x61, 0x72, 0x61, 0x62, 0x69, 0x63 };
-		// csISOLatinArabic
-		static const unsigned char c7[16] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x41, 0x72, 0x61, 0x62, 0x69, 0x63 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 8) ||
-			CharsetEqual(c5, 8) ||
-			CharsetEqual(c6, 6) ||
-			CharsetEqual(c7, 16));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-6") ||
-			CharsetEqual(U"iso-ir-127") ||
-			CharsetEqual(U"ISO_8859-6") ||
-			CharsetEqual(U"ECMA-114") ||
-			CharsetEqual(U"ASMO-708") ||
-			CharsetEqual(U"arabic") ||
-			CharsetEqual(U"csISOLatinArabic"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_7_Charset()
-	{
-		// ISO-8859-7
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x37 };
-		// iso-ir-126
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x32, 0x36 };
-		// ISO_8859-7
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x37 };
-		// ELOT_928
-		static const unsigned char c4[8] =
-			{ 0x45, 0x4C, 0x4F, 0x54, 0x5F, 0x39, 0x32, 0x38 };
-		// ECMA-118
-		static const unsigned char c5[8] =
-			{ 0x45, 0x43, 0x4D, 0x41, 0x2D, 0x31, 0x31, 0x38 };
-		// greek
-		static const unsigned char c6[5] =
-			{ 0x67, 0x72, 0x65, 0x65, 0x6B };
-		// greek8
-		static const unsigned char c7[6] =
-			{ 0x67, 0x72, 0x65, 0x65, 0x6B, 0x38 };
-		// csISOLatinGreek
-		static const unsigned char c8[15] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x47, 0x72, 0x65, 0x65, 0x6B };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 8) ||
-			CharsetEqual(c5, 8) ||
-			CharsetEqual(c6, 5) ||
-			CharsetEqual(c7, 6) ||
-			CharsetEqual(c8, 15));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-7") ||
-			CharsetEqual(U"iso-ir-126") ||
-			CharsetEqual(U"ISO_8859-7") ||
-			CharsetEqual(U"ELOT_928") ||
-			CharsetEqual(U"ECMA-118") ||
-			CharsetEqual(U"greek") ||
-			CharsetEqual(U"greek8") ||
-			CharsetEqual(U"csISOLatinGreek"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_8_Charset()
-	{
-		// ISO-8859-8
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x38 };
-		// iso-ir-138
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x33, 0x38 };
-		// ISO_8859-8
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x38 };
-		// hebrew
-		static const unsigned char c4[6] =
-			{ 0x68, 0x65, 0x62, 0x72, 0x65, 0x77 };
-		// csISOLatinHebrew
-		static const unsigned char c5[16] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x48, 0x65, 0x62, 0x72, 0x65, 0x77 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 16));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-8") ||
-			CharsetEqual(U"iso-ir-138") ||
-			CharsetEqual(U"ISO_8859-8") ||
-			CharsetEqual(U"hebrew") ||
-			CharsetEqual(U"csISOLatinHebrew"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_9_Charset()
-	{
-		// ISO-8859-9
-		static const unsigned char c1[10] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x39 };
-		// iso-ir-148
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x34, 0x38 };
-		// ISO_8859-9
-		static const unsigned char c3[10] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x39 };
-		// latin5
-		static const unsigned char c4[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x35 };
-		// l5
-		static const unsigned char c5[2] =
-			{ 0x6C, 0x35 };
-		// csISOLatin5
-		static const unsigned char c6[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x35 };
-		return (
-			CharsetEqual(c1, 10) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 10) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 2) ||
-			CharsetEqual(c6, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-9") ||
-			CharsetEqual(U"iso-ir-148") ||
-			CharsetEqual(U"ISO_8859-9") ||
-			CharsetEqual(U"latin5") ||
-			CharsetEqual(U"l5") ||
-			CharsetEqual(U"csISOLatin5"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_10_Charset()
-	{
-		// ISO-8859-10
-		static const unsigned char c1[11] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x30 };
-		// iso-ir-157
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x35, 0x37 };
-		// l6
-		static const unsigned char c3[2] =
-			{ 0x6C, 0x36 };
-		// ISO_8859-10
-		static const unsigned char c4[11] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x30 };
-		// csISOLatin6
-		static const unsigned char c5[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x36 };
-		// latin6
-		static const unsigned char c6[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x36 };
-		return (
-			CharsetEqual(c1, 11) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 2) ||
-			CharsetEqual(c4, 11) ||
-			CharsetEqual(c5, 11) ||
-			CharsetEqual(c6, 6));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-10") ||
-			CharsetEqual(U"iso-ir-157") ||
-			CharsetEqual(U"l6") ||
-			CharsetEqual(U"ISO_8859-10") ||
-			CharsetEqual(U"csISOLatin6") ||
-			CharsetEqual(U"latin6"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_13_Charset()
-	{
-		// ISO-8859-13
-		static const unsigned char c1[11] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x33 };
-		// csISO885913
-		static const unsigned char c2[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x38, 0x38, 0x35, 0x39, 0x31, 0x33 };
-		return (
-			CharsetEqual(c1, 11) ||
-			CharsetEqual(c2, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-13") ||
-			CharsetEqual(U"csISO885913"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_14_Charset()
-	{
-		// ISO-8859-14
-		static const unsigned char c1[11] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x34 };
-		// iso-ir-199
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x31, 0x39, 0x39 };
-		// ISO_8859-14
-		static const unsigned char c3[11] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x34 };
-		// latin8
-		static const unsigned char c4[6] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x38 };
-		// iso-celtic
-		static const unsigned char c5[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x63, 0x65, 0x6C, 0x74, 0x69, 0x63 };
-		// l8
-		static const unsigned char c6[2] =
-			{ 0x6C, 0x38 };
-		// csISO885914
-		static const unsigned char c7[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x38, 0x38, 0x35, 0x39, 0x31, 0x34 };
-		return (
-			CharsetEqual(c1, 11) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 11) ||
-			CharsetEqual(c4, 6) ||
-			CharsetEqual(c5, 10) ||
-			CharsetEqual(c6, 2) ||
-			CharsetEqual(c7, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-14") ||
-			CharsetEqual(U"iso-ir-199") ||
-			CharsetEqual(U"ISO_8859-14") ||
-			CharsetEqual(U"latin8") ||
-			CharsetEqual(U"iso-celtic") ||
-			CharsetEqual(U"l8") ||
-			CharsetEqual(U"csISO885914"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_15_Charset()
-	{
-		// ISO-8859-15
-		static const unsigned char c1[11] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x35 };
-		// ISO_8859-15
-		static const unsigned char c2[11] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x35 };
-		// Latin-9
-		static const unsigned char c3[7] =
-			{ 0x4C, 0x61, 0x74, 0x69, 0x6E, 0x2D, 0x39 };
-		// csISO885915
-		static const unsigned char c4[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x38, 0x38, 0x35, 0x39, 0x31, 0x35 };
-		return (
-			CharsetEqual(c1, 11) ||
-			CharsetEqual(c2, 11) ||
-			CharsetEqual(c3, 7) ||
-			CharsetEqual(c4, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-15") ||
-			CharsetEqual(U"ISO_8859-15") ||
-			CharsetEqual(U"Latin-9") ||
-			CharsetEqual(U"csISO885915"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsISO_8859_16_Charset()
-	{
-		// ISO-8859-16
-		static const unsigned char c1[11] =
-			{ 0x49, 0x53, 0x4F, 0x2D, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x36 };
-		// iso-ir-226
-		static const unsigned char c2[10] =
-			{ 0x69, 0x73, 0x6F, 0x2D, 0x69, 0x72, 0x2D, 0x32, 0x32, 0x36 };
-		// ISO_8859-16
-		static const unsigned char c3[11] =
-			{ 0x49, 0x53, 0x4F, 0x5F, 0x38, 0x38, 0x35, 0x39, 0x2D, 0x31, 0x36 };
-		// latin10
-		static const unsigned char c4[7] =
-			{ 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x31, 0x30 };
-		// l10
-		static const unsigned char c5[3] =
-			{ 0x6C, 0x31, 0x30 };
-		// csISO885916
-		static const unsigned char c6[11] =
-			{ 0x63, 0x73, 0x49, 0x53, 0x4F, 0x38, 0x38, 0x35, 0x39, 0x31, 0x36 };
-		return (
-			CharsetEqual(c1, 11) ||
-			CharsetEqual(c2, 10) ||
-			CharsetEqual(c3, 11) ||
-			CharsetEqual(c4, 7) ||
-			CharsetEqual(c5, 3) ||
-			CharsetEqual(c6, 11));
-		/*
-		return (
-			CharsetEqual(U"ISO-8859-16") ||
-			CharsetEqual(U"iso-ir-226") ||
-			CharsetEqual(U"ISO_8859-16") ||
-			CharsetEqual(U"latin10") ||
-			CharsetEqual(U"l10") ||
-			CharsetEqual(U"csISO885916"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsTIS620Charset()
-	{
-		// TIS-620
-		static const unsigned char c1[7] =
-			{ 0x54, 0x49, 0x53, 0x2D, 0x36, 0x32, 0x30 };
-		// csTIS620
-		static const unsigned char c2[8] =
-			{ 0x63, 0x73, 0x54, 0x49, 0x53, 0x36, 0x32, 0x30 };
-		return (
-			CharsetEqual(c1, 7) ||
-			CharsetEqual(c2, 8));
-		/*
-		return (
-			CharsetEqual(U"TIS-620") ||
-			CharsetEqual(U"csTIS620"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows874Charset()
-	{
-		// windows-874
-		static const unsigned char c1[11] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x38, 0x37, 0x34 };
-		// cswindows874
-		static const unsigned char c2[12] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x38, 0x37, 0x34 };
-		return (
-			CharsetEqual(c1, 11) ||
-			CharsetEqual(c2, 12));
-		/*
-		return (
-			CharsetEqual(U"windows-874") ||
-			CharsetEqual(U"cswindows874"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1250Charset()
-	{
-		// windows-1250
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x30 };
-		// cswindows1250
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x30 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1250") ||
-			CharsetEqual(U"cswindows1250"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1251Charset()
-	{
-		// windows-1251
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x31 };
-		// cswindows1251
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x31 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1251") ||
-			CharsetEqual(U"cswindows1251"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1252Charset()
-	{
-		// windows-1252
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x32 };
-		// cswindows1252
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x32 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1252") ||
-			CharsetEqual(U"cswindows1252"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1253Charset()
-	{
-		// windows-1253
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x33 };
-		// cswindows1253
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x33 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1253") ||
-			CharsetEqual(U"cswindows1253"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1254Charset()
-	{
-		// windows-1254
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x34 };
-		// cswindows1254
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x34 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1254") ||
-			CharsetEqual(U"cswindows1254"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1255Charset()
-	{
-		// windows-1255
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x35 };
-		// cswindows1255
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x35 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1255") ||
-			CharsetEqual(U"cswindows1255"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1256Charset()
-	{
-		// windows-1256
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x36 };
-		// cswindows1256
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x36 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1256") ||
-			CharsetEqual(U"cswindows1256"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1257Charset()
-	{
-		// windows-1257
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x37 };
-		// cswindows1257
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x37 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1257") ||
-			CharsetEqual(U"cswindows1257"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::IsWindows1258Charset()
-	{
-		// windows-1258
-		static const unsigned char c1[12] =
-			{ 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x2D, 0x31, 0x32, 0x35, 0x38 };
-		// cswindows1258
-		static const unsigned char c2[13] =
-			{ 0x63, 0x73, 0x77, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x31, 0x32, 0x35, 0x38 };
-		return (
-			CharsetEqual(c1, 12) ||
-			CharsetEqual(c2, 13));
-		/*
-		return (
-			CharsetEqual(U"windows-1258") ||
-			CharsetEqual(U"cswindows1258"));
-		*/
-	}
-
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::AttributeType&
-		Inspector<TCharactersWriter>::NewAttribute()
-	{
-		AttributesSizeType fakeSize = static_cast<AttributesSizeType>(attributesSize);
-		if (fakeSize < attributes.size())
+		inline std::size_t FeedBuffer::GetLimit() const
 		{
-			++attributesSize;
-			AttributeType& ref = attributes[fakeSize];
-			ref.Name.clear();
-			ref.Value.clear();
-			ref.LocalName.clear();
-			ref.Prefix.clear();
-			ref.NamespaceUri.clear();
-			return ref;
+			return limit;
 		}
 
-		// fakeSize == attributes.size().
-		attributes.push_back(AttributeType());
-		++attributesSize;
-		AttributeType& ref = attributes.back();
-		ref.Name.reserve(NameReserve);
-		ref.Value.reserve(ValueReserve);
-		ref.LocalName.reserve(LocalNameReserve);
-		ref.Prefix.reserve(PrefixReserve);
-		ref.NamespaceUri.reserve(NamespaceUriReserve);
-		return ref;
-	}
-
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::UnclosedTagType&
-		Inspector<TCharactersWriter>::NewUnclosedTag()
-	{
-		UnclosedTagsSizeType fakeSize = static_cast<UnclosedTagsSizeType>(unclosedTagsSize);
-		if (fakeSize < unclosedTags.size())
+		inline std::size_t FeedBuffer::GetUnitSize() const
 		{
-			++unclosedTagsSize;
-			UnclosedTagType& ref = unclosedTags[fakeSize];
-			ref.Name.clear();
-			ref.LocalName.clear();
-			ref.Prefix.clear();
-			ref.NamespaceUri.clear();
-			return ref;
+			return unitSize;
 		}
 
-		// fakeSize == unclosedTags.size().
-		unclosedTags.push_back(UnclosedTagType());
-		++unclosedTagsSize;
-		UnclosedTagType& ref = unclosedTags.back();
-		ref.Name.reserve(NameReserve);
-		ref.LocalName.reserve(LocalNameReserve);
-		ref.Prefix.reserve(PrefixReserve);
-		ref.NamespaceUri.reserve(NamespaceUriReserve);
-		return ref;
-	}
+		inline bool FeedBuffer::IsTagOpened() const
+		{
+			return tagOpened;
+		}
 
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::NamespaceDeclarationType&
-		Inspector<TCharactersWriter>::NewNamespace()
-	{
-		NamespacesSizeType fakeSize = static_cast<NamespacesSizeType>(namespacesSize);
-		if (fakeSize < namespaces.size())
+		inline char32_t FeedBuffer::GetUnit(std::size_t position) const
 		{
-			++namespacesSize;
-			NamespaceDeclarationType& ref = namespaces[fakeSize];
-			ref.Prefix.clear();
-			ref.Uri.clear();
-			ref.TagIndex = 0;
-			return ref;
+			const unsigned char* p =
+				reinterpret_cast<const unsigned char*>(bytes.data()) + position;
+			if (unitSize == 1)
+				return static_cast<char32_t>(p[0]);
+			if (unitSize == 2)
+			{
+				return bigEndian
+					? static_cast<char32_t>((p[0] << 8) | p[1])
+					: static_cast<char32_t>((p[1] << 8) | p[0]);
+			}
+			return bigEndian
+				? (static_cast<char32_t>(p[0]) << 24) | (static_cast<char32_t>(p[1]) << 16) |
+					(static_cast<char32_t>(p[2]) << 8) | static_cast<char32_t>(p[3])
+				: (static_cast<char32_t>(p[3]) << 24) | (static_cast<char32_t>(p[2]) << 16) |
+					(static_cast<char32_t>(p[1]) << 8) | static_cast<char32_t>(p[0]);
 		}
 
-		// fakeSize == namespaces.size().
-		namespaces.push_back(NamespaceDeclarationType());
-		++namespacesSize;
-		NamespaceDeclarationType& ref = namespaces.back();
-		ref.Prefix.reserve(PrefixReserve);
-		ref.Uri.reserve(NamespaceUriReserve);
-		return ref;
-	}
+		inline void FeedBuffer::Scan()
+		{
+			if (unitSize == 0)
+			{
+				// BOM needs up to 4 bytes to be recognized.
+				if (bytes.size() < 4 && !finished)
+					return;
+
+				const char* first = bytes.data();
+				const char* last = first + bytes.size();
+				Bom bom = ReadBom(first, last);
+				unitSize = 1;
+				if (bom == Bom::Utf16BE || bom == Bom::Utf16LE)
+					unitSize = 2;
+				else if (bom == Bom::Utf32BE || bom == Bom::Utf32LE)
+					unitSize = 4;
+				bigEndian = (bom == Bom::Utf16BE || bom == Bom::Utf32BE);
+				start = static_cast<std::size_t>(first - bytes.data());
+				scanned = start;
+				limit = start;
+				if (bom == Bom::Invalid)
+				{
+					// Parser reports the error at the beginning.
+					scanned = bytes.size();
+					limit = scanned;
+				}
+			}
+
+			if (finished)
+			{
+				scanned = bytes.size();
+				limit = scanned;
+				tagOpened = false;
+				return;
+			}
+
+			// Only ASCII characters matter, so every code unit
+			// is compared without decoding the characters.
+			while (bytes.size() - scanned >= unitSize)
+			{
+				if (state == ScanContent && unitSize == 1)
+				{
+					// Skip the text up to '<'.
+					const void* lessThan = std::memchr(
+						bytes.data() + scanned, 0x3C, bytes.size() - scanned);
+					std::size_t textEnd = (lessThan != nullptr)
+						? static_cast<std::size_t>(static_cast<const char*>(lessThan) - bytes.data())
+						: bytes.size();
+					if (textEnd != scanned)
+						text = true;
+					scanned = textEnd;
+					if (lessThan == nullptr)
+						break;
+				}
+
+				char32_t c = GetUnit(scanned);
+				scanned += unitSize;
+				bool tokenEnd = false;
+				switch (state)
+				{
+					case ScanContent:
+						if (c == 0x3C) // '<'
+						{
+							// Text node ends with '<' character.
+							if (text)
+							{
+								limit = scanned;
+								tagOpened = true;
+							}
+							text = false;
+							state = ScanTagOpen;
+						}
+						else
+						{
+							text = true;
+						}
+						break;
+					case ScanTagOpen:
+						if (c == 0x21) // '!'
+						{
+							state = ScanExclamation;
+						}
+						else if (c == 0x3F) // '?'
+						{
+							state = ScanQuestion;
+							matched = 0;
+						}
+						else
+						{
+							state = ScanTag;
+							tokenEnd = (c == 0x3E); // '>'
+						}
+						break;
+					case ScanExclamation:
+						if (c == 0x2D) // '-'
+						{
+							state = ScanCommentOpen;
+						}
+						else if (c == 0x5B) // '['
+						{
+							state = ScanCDATA;
+							matched = 0;
+						}
+						else
+						{
+							state = ScanDOCTYPE;
+							tokenEnd = (c == 0x3E); // '>'
+						}
+						break;
+					case ScanCommentOpen:
+						if (c == 0x2D) // '-'
+						{
+							state = ScanComment;
+							matched = 0;
+						}
+						else
+						{
+							state = ScanTag;
+							tokenEnd = (c == 0x3E); // '>'
+						}
+						break;
+					case ScanComment:
+						// "-->"
+						if (c == 0x2D) // '-'
+						{
+							if (matched < 2)
+								++matched;
+						}
+						else
+						{
+							tokenEnd = (c == 0x3E && matched == 2);
+							matched = 0;
+						}
+						break;
+					case ScanCDATA:
+						// "]]>"
+						if (c == 0x5D) // ']'
+						{
+							if (matched < 2)
+								++matched;
+						}
+						else
+						{
+							tokenEnd = (c == 0x3E && matched == 2);
+							matched = 0;
+						}
+						break;
+					case ScanQuestion:
+						// "?>"
+						if (c == 0x3F) // '?'
+						{
+							matched = 1;
+						}
+						else
+						{
+							tokenEnd = (c == 0x3E && matched == 1);
+							matched = 0;
+						}
+						break;
+					case ScanTag:
+						if (c == 0x22 || c == 0x27) // '"' or '\''
+						{
+							quote = c;
+							state = ScanQuoted;
+						}
+						else
+						{
+							tokenEnd = (c == 0x3E); // '>'
+						}
+						break;
+					case ScanQuoted:
+						if (c == quote)
+							state = ScanTag;
+						break;
+					case ScanDOCTYPE:
+						if (c == 0x5B) // '['
+							state = ScanSubset;
+						else
+							tokenEnd = (c == 0x3E); // '>'
+						break;
+					case ScanSubset:
+						if (c == 0x5D) // ']'
+							state = ScanSubsetClose;
+						break;
+					default: // ScanSubsetClose
+						// Only white spaces or another ']' can precede '>'.
+						if (c == 0x3E) // '>'
+							tokenEnd = true;
+						else if (c != 0x5D && c != 0x20 && c != 0x09 && c != 0x0D && c != 0x0A)
+							state = ScanSubset;
+						break;
+				}
+
+				if (tokenEnd)
+				{
+					limit = scanned;
+					tagOpened = false;
+					state = ScanContent;
+				}
+			}
+		}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::CharsetEqual(const char32_t* charset)
-	{
-		std::size_t length = 0;
-		const char32_t* pt = charset;
-		while (*pt != 0)
+		inline FdBuf::FdBuf()
+			: std::streambuf(),
+			fd(-1),
+			buffer(),
+			bufferSize(0),
+			ended(false)
 		{
-			++length;
-			++pt;
-		}
 
-		// comparingName contains encoding name.
-		if (length != comparingName.size())
-			return false;
+		}
 
-		for (std::size_t i = 0; i < length; ++i)
+		inline void FdBuf::Open(int fileDescriptor, std::size_t size)
 		{
-			if (ToLower[static_cast<unsigned char>(comparingName[i])] !=
-				ToLower[static_cast<unsigned char>(charset[i])])
-				return false;
+			// At least one complete UTF-8 character.
+			if (size < 4)
+				size = 4;
+			if (!buffer || bufferSize != size)
+			{
+				buffer.reset(new char[size]);
+				bufferSize = size;
+			}
+			fd = fileDescriptor;
+			ended = false;
+			setg(buffer.get(), buffer.get(), buffer.get());
 		}
 
-		return true;
-	}
-
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::CharsetEqual(
-		const unsigned char* charset, std::size_t len)
-	{
-		// comparingName contains encoding name.
-		if (len != comparingName.size())
-			return false;
+		inline void FdBuf::Close()
+		{
+			fd = -1;
+			ended = false;
+			setg(nullptr, nullptr, nullptr);
+		}
 
-		for (std::size_t i = 0; i < len; ++i)
+		inline bool FdBuf::IsOpen() const
 		{
-			if (ToLower[static_cast<unsigned char>(comparingName[i])] !=
-				ToLower[charset[i]])
-				return false;
+			return (fd >= 0);
 		}
 
-		return true;
-	}
+		inline const char* FdBuf::GetFirst() const
+		{
+			return gptr();
+		}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::InitStrings()
-	{
-		name.reserve(NameReserve);
-		value.reserve(ValueReserve);
-		localName.reserve(LocalNameReserve);
-		prefix.reserve(PrefixReserve);
-		namespaceUri.reserve(NamespaceUriReserve);
+		inline const char* FdBuf::GetLast() const
+		{
+			return egptr();
+		}
 
-		lowerXmlString.reserve(3);
-		xmlnsString.reserve(5);
-		xmlUriString.reserve(36);
-		xmlnsUriString.reserve(29);
+		inline void FdBuf::Consume(std::size_t count)
+		{
+			setg(eback(), gptr() + count, egptr());
+		}
 
-		for (std::size_t i = 0; i < 3; ++i)
-			CharactersWriterType::WriteCharacter(lowerXmlString, LowerXml[i]);
+		inline bool FdBuf::Refill(std::size_t minimum)
+		{
+			std::size_t available = static_cast<std::size_t>(egptr() - gptr());
+			if (available >= minimum || ended || fd < 0)
+				return true;
 
-		for (std::size_t i = 0; i < 5; ++i)
-			CharactersWriterType::WriteCharacter(xmlnsString, Xmlns[i]);
+			// Keep the rest of the buffered bytes.
+			std::memmove(buffer.get(), gptr(), available);
+			bool success = true;
+			while (available < minimum && !ended)
+			{
+#if defined(_WIN32)
+				int count = _read(fd, buffer.get() + available,
+					static_cast<unsigned int>(bufferSize - available));
+#else
+				ssize_t count = read(fd, buffer.get() + available, bufferSize - available);
+#endif
+				if (count > 0)
+				{
+					available += static_cast<std::size_t>(count);
+				}
+				else if (count == 0)
+				{
+					ended = true;
+				}
+				else if (errno != EINTR)
+				{
+					success = false;
+					break;
+				}
+			}
+			setg(buffer.get(), buffer.get(), buffer.get() + available);
+			return success;
+		}
 
-		for (std::size_t i = 0; i < 36; ++i)
-			CharactersWriterType::WriteCharacter(xmlUriString, XmlUri[i]);
+		inline FdBuf::int_type FdBuf::underflow()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
 
-		for (std::size_t i = 0; i < 29; ++i)
-			CharactersWriterType::WriteCharacter(xmlnsUriString, XmlnsUri[i]);
-	}
+			if (!Refill(1))
+				throw std::ios_base::failure("Cannot read the file descriptor.");
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::SavePosition()
-	{
-		row = currentRow;
-		column = currentColumn;
-	}
+			if (gptr() == egptr())
+				return traits_type::eof();
+			return traits_type::to_int_type(*gptr());
+		}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::NextCharBad(bool insideTag)
-	{
-		// x, CR, LF, y => x, LF, y
-		// x, CR, y => x, LF, y
-		// x, LF, CR, y => x, LF, LF, y
-		// Check http://www.w3.org/TR/2008/REC-xml-20081126/#sec-line-ends.
+		inline Utf8FdReader::Utf8FdReader(FdBuf* fdBuf)
+			: buf(fdBuf)
+		{
 
-		SizeType tempRow;
-		SizeType tempColumn;
+		}
 
-		if (currentCharacter == LineFeed)
+		inline bool Utf8FdReader::Prepare()
 		{
-			++currentRow;
-			currentColumn = 1;
+			return buf->Refill(4);
 		}
-		else
+
+		inline int Utf8FdReader::ReadCharacter(char32_t& result)
 		{
-			++currentColumn;
+			if (!Prepare())
+				return -2; // Something terrible with the descriptor.
+
+			const unsigned char* first = reinterpret_cast<const unsigned char*>(buf->GetFirst());
+			const unsigned char* last = reinterpret_cast<const unsigned char*>(buf->GetLast());
+			Encoding::Utf8IteratorsReader<const unsigned char*> rest(first, last);
+			int r = rest.Encoding::Utf8IteratorsReader<const unsigned char*>::ReadCharacter(result);
+			buf->Consume(static_cast<std::size_t>(rest.GetFirstIterator() - first));
+			return r;
 		}
 
-		if (bufferedCharacter != 0)
+		inline std::size_t Utf8FdReader::ReadCharacters(char32_t* destination,
+			std::size_t capacity, int& result)
 		{
-			if (bufferedCharacter > 3) // Allowed character.
-			{
-				currentCharacter = bufferedCharacter;
-				bufferedCharacter = 0;
-				return false;
-			}
-
-			if (bufferedCharacter == 1) // No more characters to read.
+			std::size_t count = 0;
+			while (count < capacity)
 			{
-				if (insideTag)
+				if (!Prepare())
 				{
-					// Start token position.
-					tempRow = row;
-					tempColumn = column;
-					Reset();
-					row = tempRow;
-					column = tempColumn;
-					SetError(ErrorCode::UnclosedToken);
-					eof = true;
+					result = -2; // Something terrible with the descriptor.
+					return count;
 				}
-				else
+
+				const unsigned char* first = reinterpret_cast<const unsigned char*>(buf->GetFirst());
+				const unsigned char* last = reinterpret_cast<const unsigned char*>(buf->GetLast());
+				if (first == last)
 				{
-					eof = true;
-					bufferedCharacter = 0;
+					result = 0; // End of the data.
+					return count;
 				}
+
+				// Every character has at least 1 byte.
+				if (static_cast<std::size_t>(last - first) > capacity - count)
+					last = first + (capacity - count);
+				const unsigned char* position = first;
+				count += DecodeCharacters(position, last, destination + count);
+				buf->Consume(static_cast<std::size_t>(position - first));
+				if (position == last)
+					continue;
+
+				// The character at the position needs the detailed check.
+				result = ReadCharacter(destination[count]);
+				if (result != 1)
+					return count;
+				++count;
 			}
-			else if (bufferedCharacter == 2) // Character is not allowed in XML document.
-			{
-				// Invalid character position.
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				row = tempRow;
-				column = tempColumn;
-				SetError(ErrorCode::InvalidByteSequence);
-			}
-			else // bufferedCharacter == 3 // Stream error.
-			{
-				// Character at stream error position.
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				row = tempRow;
-				column = tempColumn;
-				SetError(ErrorCode::StreamError);
-			}
-			afterBom = true;
-			return true;
+			result = 1;
+			return count;
 		}
 
-		int result = reader->ReadCharacter(currentCharacter);
+		inline ReadAheadBuf::ReadAheadBuf(std::size_t blockSize, std::size_t ringDepth)
+			: std::streambuf(),
+			file(),
+			source(nullptr),
+			blockSize(blockSize != 0 ? blockSize : 1),
+			ringDepth(ringDepth >= 2 ? ringDepth : 2),
+			blocks(),
+			sizes(),
+			produced(0),
+			consumed(0),
+			finished(false),
+			failed(false),
+			stopping(false),
+			producerWaiting(false),
+			consumerWaiting(false),
+			mutex(),
+			dataReady(),
+			spaceReady(),
+			readNanoseconds(0),
+			waitNanoseconds(0),
+			holding(false),
+			producer()
+		{
 
-		if (result == 1) // Character was read successfully.
+		}
+
+		inline ReadAheadBuf::~ReadAheadBuf()
 		{
-			if (currentCharacter == CarriageReturn) // We don't like CR.
+			if (producer.joinable())
 			{
-				result = reader->ReadCharacter(currentCharacter);
-				if (result == 1) // Second character was read successfully.
-				{
-					if (currentCharacter != LineFeed)
-					{
-						// CR, x => LF, x
-						bufferedCharacter = currentCharacter;
-						currentCharacter = LineFeed;
-					}
-					// else CR, LF => LF
-				}
-				else if (result == 0) // No more characters to read.
-				{
-					// CR, [end of document] => LF, [end of document]
-					bufferedCharacter = 1;
-					currentCharacter = LineFeed;
-				}
-				else if (result == -1) // Character is not allowed in XML document.
-				{
-					// CR, [not allowed character] => LF, [not allowed character]
-					bufferedCharacter = 2;
-					currentCharacter = LineFeed;
-				}
-				else // result == -2 // Stream error.
 				{
-					// CR, [stream error] => LF, [stream error]
-					bufferedCharacter = 3;
-					currentCharacter = LineFeed;
+					std::lock_guard<std::mutex> lock(mutex);
+					stopping.store(true);
 				}
+				spaceReady.notify_one();
+				producer.join();
 			}
-			return false;
 		}
 
-		if (result == 0) // No more characters to read.
+		inline bool ReadAheadBuf::Open(const char* filePath)
 		{
-			if (insideTag)
+			file.open(filePath, std::ifstream::binary);
+			if (!file.is_open())
+				return false;
+			Start(&file);
+			return true;
+		}
+
+		inline void ReadAheadBuf::Start(std::istream* inputStream)
+		{
+			source = inputStream;
+			blocks.reset(new char[blockSize * ringDepth]);
+			sizes.reset(new std::size_t[ringDepth]);
+			try
 			{
-				// Start token position.
-				tempRow = row;
-				tempColumn = column;
-				Reset();
-				row = tempRow;
-				column = tempColumn;
-				SetError(ErrorCode::UnclosedToken);
-				eof = true;
+				producer = std::thread(&ReadAheadBuf::Produce, this);
 			}
-			else
+			catch (const std::system_error&)
 			{
-				eof = true;
+				// No more threads. The consumer reads the blocks by itself.
 			}
 		}
-		else if (result == -1) // Character is not allowed in XML document.
+
+		inline bool ReadAheadBuf::IsOpen() const
 		{
-			// Invalid character position.
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			row = tempRow;
-			column = tempColumn;
-			SetError(ErrorCode::InvalidByteSequence);
+			return (source != nullptr);
 		}
-		else // result == -2 // Stream error.
+
+		inline std::size_t ReadAheadBuf::GetBlockSize() const
 		{
-			// Character at stream error position.
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			Reset();
-			row = tempRow;
-			column = tempColumn;
-			SetError(ErrorCode::StreamError);
+			return blockSize;
 		}
-		afterBom = true;
-		return true;
-	}
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::Inspect()
-	{
-		SizeType tempRow;
-		SizeType tempColumn;
-		if (!afterBom && (err == ErrorCode::None || err == ErrorCode::StreamError))
+		inline std::size_t ReadAheadBuf::GetRingDepth() const
 		{
-			// First call of Inspect method or after stream error while BOM parsing.
-			ParseBom();
-			if (err != ErrorCode::None)
-				return false;
-			row = 1;
-			column = 1;
-			if (eof)
+			return ringDepth;
+		}
+
+		inline std::chrono::nanoseconds ReadAheadBuf::GetReadTime() const
+		{
+			return std::chrono::nanoseconds(readNanoseconds.load());
+		}
+
+		inline std::chrono::nanoseconds ReadAheadBuf::GetWaitTime() const
+		{
+			return std::chrono::nanoseconds(waitNanoseconds);
+		}
+
+		inline bool ReadAheadBuf::ReadBlock(std::size_t slot)
+		{
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			std::size_t count = 0;
+			try
 			{
-				SetError(ErrorCode::NoElement);
-				return false;
+				source->read(blocks.get() + slot * blockSize,
+					static_cast<std::streamsize>(blockSize));
+				count = static_cast<std::size_t>(source->gcount());
+				if (count != blockSize &&
+					(source->rdstate() & std::istream::eofbit) == 0)
+					failed.store(true);
 			}
-			currentRow = 1;
-			currentColumn = 0; // Don't worry,
-			// it will be 1 after first call of NextCharBad method.
-
-			// First character.
-			if (NextCharBad(false))
+			catch (...)
 			{
-				if (eof)
-				{
-					SetError(ErrorCode::NoElement);
-					return false;
-				}
+				// Source stream with enabled exceptions.
+				failed.store(true);
 			}
+			sizes[slot] = count;
+			readNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - startTime).count());
+			return (count == blockSize);
+		}
 
-			if (sourceType != SourceReader &&
-				bom != Details::Bom::None &&
-				bom != Details::Bom::Utf8 &&
-				bom != Details::Bom::Utf16BE &&
-				bom != Details::Bom::Utf16LE)
+		inline void ReadAheadBuf::Produce()
+		{
+			std::size_t index = 0;
+			bool more = true;
+			while (more)
 			{
-				// Encoding declaration is required here.
-
-				if (currentCharacter != LessThan)
-				{
-					Reset();
-					SetError(ErrorCode::EncodingDeclarationRequired);
-					row = 1;
-					column = 1;
-					return false;
-				}
-
-				if (NextCharBad(true))
-					return false;
-
-				if (currentCharacter != Question)
-				{
-					Reset();
-					SetError(ErrorCode::EncodingDeclarationRequired);
-					row = 1;
-					column = 1;
-					return false;
-				}
-
-				for (std::size_t i = 0; i < 3; ++i)
+				if (index - consumed.load() == ringDepth)
 				{
-					if (NextCharBad(true))
-						return false;
-					if (currentCharacter != LowerXml[i])
-					{
-						Reset();
-						SetError(ErrorCode::EncodingDeclarationRequired);
-						row = 1;
-						column = 1;
-						return false;
-					}
-					CharactersWriterType::WriteCharacter(name, currentCharacter);
-					CharactersWriterType::WriteCharacter(localName, currentCharacter);
+					// Ring is full.
+					std::unique_lock<std::mutex> lock(mutex);
+					producerWaiting.store(true);
+					while (index - consumed.load() == ringDepth && !stopping.load())
+						spaceReady.wait(lock);
+					producerWaiting.store(false);
 				}
+				if (stopping.load())
+					return;
 
-				// '<?xml'
-				if (NextCharBad(true))
-					return false;
+				std::size_t slot = index % ringDepth;
+				more = ReadBlock(slot);
+				if (sizes[slot] != 0)
+					produced.store(++index);
+				if (!more)
+					finished.store(true);
 
-				if (!IsWhiteSpace(currentCharacter))
+				// Consumer checks the indices after it marks itself as
+				// waiting, so either it sees the new block or we see the mark.
+				if (consumerWaiting.load())
 				{
-					Reset();
-					SetError(ErrorCode::EncodingDeclarationRequired);
-					row = 1;
-					column = 1;
-					return false;
+					std::lock_guard<std::mutex> lock(mutex);
+					dataReady.notify_one();
 				}
+			}
+		}
 
-				return ParseXmlDeclaration();
+		inline ReadAheadBuf::int_type ReadAheadBuf::underflow()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
+
+			if (source == nullptr)
+				return traits_type::eof();
+
+			std::size_t index = consumed.load();
+			if (holding)
+			{
+				// Release the block read by the consumer.
+				holding = false;
+				setg(nullptr, nullptr, nullptr);
+				consumed.store(++index);
+				if (producerWaiting.load())
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					spaceReady.notify_one();
+				}
 			}
 
-			if (IsWhiteSpace(currentCharacter))
+			if (produced.load() == index)
 			{
-				do
+				std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+				if (!producer.joinable())
 				{
-					CharactersWriterType::WriteCharacter(value, currentCharacter);
-					if (NextCharBad(false))
+					// There is no background thread.
+					if (!finished.load())
 					{
-						if (eof) // White spaces followed by end of file.
-						{
-							// In XML document at least one root element is required.
-							tempRow = currentRow;
-							tempColumn = currentColumn;
-							Reset();
-							SetError(ErrorCode::NoElement);
-							row = tempRow;
-							column = tempColumn;
-							return false;
-						}
-						else // White spaces followed by invalid character or stream error.
-						{
-							// Error is set already.
-							return false;
-						}
+						if (!ReadBlock(index % ringDepth))
+							finished.store(true);
+						if (sizes[index % ringDepth] != 0)
+							produced.store(index + 1);
 					}
 				}
-				while (IsWhiteSpace(currentCharacter));
+				else
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					consumerWaiting.store(true);
+					while (produced.load() == index && !finished.load())
+						dataReady.wait(lock);
+					consumerWaiting.store(false);
+				}
+				waitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - startTime).count();
 
-				if (currentCharacter != LessThan)
+				if (produced.load() == index)
 				{
-					tempRow = currentRow;
-					tempColumn = currentColumn;
-					Reset();
-					SetError(ErrorCode::InvalidSyntax);
-					row = tempRow;
-					column = tempColumn;
-					return false;
+					// End of the source.
+					if (failed.load())
+						throw std::ios_base::failure("Read-ahead source error.");
+					return traits_type::eof();
 				}
-				
-				node = Inspected::Whitespace;
-				return true;
 			}
 
-			if (currentCharacter != LessThan)
-			{
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
-				row = tempRow;
-				column = tempColumn;
-			}
+			char* block = blocks.get() + (index % ringDepth) * blockSize;
+			setg(block, block, block + sizes[index % ringDepth]);
+			holding = true;
+			return traits_type::to_int_type(*gptr());
 		}
 
-		if (err != ErrorCode::None)
-			return false;
+#if defined(XML_INSPECTOR_IO_URING)
+		inline IoUring::IoUring()
+			: ringDescriptor(-1),
+			submissionRing(nullptr),
+			submissionRingSize(0),
+			completionRing(nullptr),
+			completionRingSize(0),
+			entries(nullptr),
+			entriesSize(0),
+			submissionTail(nullptr),
+			submissionMask(nullptr),
+			submissionArray(nullptr),
+			completionHead(nullptr),
+			completionTail(nullptr),
+			completionMask(nullptr),
+			completions(nullptr),
+			toSubmit(0)
+		{
 
-		if (currentCharacter == GreaterThan) 
+		}
+
+		inline IoUring::~IoUring()
 		{
-			// End of token.
-			if (NextCharBad(false) && !eof)
-				return false;
+			Close();
 		}
-		else if (currentCharacter == Semicolon)
+
+		inline bool IoUring::Open(unsigned entriesCount)
 		{
-			if (!entityName.empty())
+			Close();
+
+			io_uring_params params;
+			std::memset(&params, 0, sizeof(params));
+			int descriptor = static_cast<int>(syscall(__NR_io_uring_setup, entriesCount, &params));
+			if (descriptor < 0)
+				return false;
+			ringDescriptor = descriptor;
+
+			submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool singleMap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+			if (singleMap)
 			{
-				PrepareNode();
-				name = entityName;
-				localName = entityName;
-				entityName.clear();
-				node = Inspected::EntityReference;
-				row = currentRow;
-				column = (currentColumn - entityNameCharCount - 1);
-				return true;
+				if (completionRingSize > submissionRingSize)
+					submissionRingSize = completionRingSize;
+				completionRingSize = submissionRingSize;
 			}
-			else
+
+			void* memory = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQ_RING);
+			if (memory == MAP_FAILED)
 			{
-				// End of reference.
-				if (NextCharBad(false) && !eof)
-					return false;
+				Close();
+				return false;
 			}
-		}
+			submissionRing = memory;
 
-		if (eof)
-		{
-			if (!foundElement)
+			if (singleMap)
 			{
-				// In XML document at least one root element is required.
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				SetError(ErrorCode::NoElement);
-				row = tempRow;
-				column = tempColumn;
+				completionRing = submissionRing;
 			}
-			else if (unclosedTagsSize != 0)
+			else
 			{
-				UnclosedTagType& ref = unclosedTags[unclosedTagsSize - 1];
-				Reset();
-				SetError(ErrorCode::UnclosedTag);
-				row = ref.Row;
-				column = ref.Column;
-				foundElement = true;
+				memory = mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_CQ_RING);
+				if (memory == MAP_FAILED)
+				{
+					Close();
+					return false;
+				}
+				completionRing = memory;
 			}
-			else
+
+			entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+			memory = mmap(nullptr, entriesSize, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQES);
+			if (memory == MAP_FAILED)
 			{
-				// XML document is fully parsed without any error.
-				tempRow = currentRow;
-				tempColumn = currentColumn;
-				Reset();
-				row = tempRow;
-				column = tempColumn;
-				currentRow = tempRow;
-				currentColumn = tempColumn;
-				foundElement = true;
-				afterBom = true;
+				entriesSize = 0;
+				Close();
+				return false;
 			}
-			currentCharacter = 0;
-			eof = true;
-			return false;
+			entries = static_cast<io_uring_sqe*>(memory);
+
+			char* sq = static_cast<char*>(submissionRing);
+			submissionTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+			submissionMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+			submissionArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+			char* cq = static_cast<char*>(completionRing);
+			completionHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+			completionTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+			completionMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+			completions = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+			toSubmit = 0;
+			return true;
 		}
 
-		if (currentCharacter == LessThan) // New tag to parse.
+		inline void IoUring::Close()
 		{
-			SavePosition();
+			if (entries != nullptr)
+				munmap(entries, entriesSize);
+			if (completionRing != nullptr && completionRing != submissionRing)
+				munmap(completionRing, completionRingSize);
+			if (submissionRing != nullptr)
+				munmap(submissionRing, submissionRingSize);
+			if (ringDescriptor >= 0)
+				close(ringDescriptor);
+			ringDescriptor = -1;
+			submissionRing = nullptr;
+			completionRing = nullptr;
+			entries = nullptr;
+			toSubmit = 0;
+		}
 
-			// Go to the next character after '<'.
-			if (NextCharBad(true))
-				return false;
+		inline bool IoUring::IsOpen() const
+		{
+			return (ringDescriptor >= 0);
+		}
 
-			if (currentCharacter == Slash)
-			{
-				// EndTag.
-				return ParseEndTag();
-			}
+		inline void IoUring::PrepareRead(int fileDescriptor, const iovec* vector,
+			std::uint_least64_t offset, std::uint_least64_t userData)
+		{
+			// Only this thread writes the tail.
+			unsigned tail = *submissionTail;
+			unsigned index = tail & *submissionMask;
+			io_uring_sqe& entry = entries[index];
+			std::memset(&entry, 0, sizeof(entry));
+			entry.opcode = IORING_OP_READV;
+			entry.fd = fileDescriptor;
+			entry.addr = static_cast<std::uint_least64_t>(reinterpret_cast<std::uintptr_t>(vector));
+			entry.len = 1;
+			entry.off = offset;
+			entry.user_data = userData;
+			submissionArray[index] = index;
+			__atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+			++toSubmit;
+		}
 
-			if (currentCharacter != Colon &&
-				Encoding::CharactersReader::IsNameStartChar(currentCharacter))
+		inline bool IoUring::Submit()
+		{
+			while (toSubmit != 0)
 			{
-				// StartTag or EmptyElementTag.
-				return ParseElement();
+				int result = static_cast<int>(syscall(__NR_io_uring_enter,
+					ringDescriptor, toSubmit, 0, 0, nullptr, 0));
+				if (result < 0)
+				{
+					if (errno == EINTR || errno == EAGAIN)
+						continue;
+					return false;
+				}
+				toSubmit -= static_cast<unsigned>(result);
 			}
+			return true;
+		}
 
-			if (currentCharacter == Exclamation)
+		inline bool IoUring::WaitCompletion(std::uint_least64_t& userData, int& result)
+		{
+			while (true)
 			{
-				// Comment or DocumentType.
-				return ParseExclamation();
+				unsigned head = *completionHead;
+				if (head != __atomic_load_n(completionTail, __ATOMIC_ACQUIRE))
+				{
+					const io_uring_cqe& completion = completions[head & *completionMask];
+					userData = completion.user_data;
+					result = completion.res;
+					__atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+					return true;
+				}
+
+				int entered = static_cast<int>(syscall(__NR_io_uring_enter,
+					ringDescriptor, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+				if (entered < 0)
+				{
+					if (errno == EINTR || errno == EAGAIN)
+						continue;
+					return false;
+				}
+				toSubmit -= static_cast<unsigned>(entered);
 			}
+		}
+#endif
 
-			if (currentCharacter == Question)
+#if !defined(_WIN32)
+		inline UringFileBuf::UringFileBuf(std::size_t blockSize, std::size_t queueDepth)
+			: std::streambuf(),
+			fileDescriptor(-1),
+			blocksCount(0),
+			fileSize(0),
+			blockSize(blockSize != 0 ? blockSize : 1),
+			queueDepth(queueDepth != 0 ? queueDepth : 1),
+			blocks(),
+			filled(),
+			current(0),
+			holding(false),
+			failed(false)
+#if defined(XML_INSPECTOR_IO_URING)
+			,
+			ring(),
+			vectors(),
+			done(),
+			inFlight(0)
+#endif
+		{
+
+		}
+
+		inline UringFileBuf::~UringFileBuf()
+		{
+#if defined(XML_INSPECTOR_IO_URING)
+			// Kernel could still write into the blocks.
+			while (inFlight != 0 && ring.IsOpen())
 			{
-				// XmlDeclaration or ProcessingInstruction.
-				return ParseQuestion();
+				std::uint_least64_t userData;
+				int result;
+				if (!ring.WaitCompletion(userData, result))
+					break;
+				--inFlight;
 			}
+			ring.Close();
+#endif
+			if (fileDescriptor >= 0)
+				close(fileDescriptor);
+		}
 
-			// currentCharacter is not allowed here.
-			tempRow = currentRow;
-			tempColumn = currentColumn;
-			if (Encoding::CharactersReader::IsNameChar(currentCharacter))
+		inline bool UringFileBuf::Open(const char* filePath, bool useUring)
+		{
+			int descriptor;
+			do
 			{
-				// Not allowed as start character of the name,
-				// but allowed as a part of this name.
-				Reset();
-				SetError(ErrorCode::InvalidTagName);
+				descriptor = open(filePath, O_RDONLY | O_CLOEXEC);
 			}
-			else
+			while (descriptor < 0 && errno == EINTR);
+			if (descriptor < 0)
+				return false;
+
+			struct stat fileStat;
+			if (fstat(descriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
 			{
-				// Some weird character.
-				Reset();
-				SetError(ErrorCode::InvalidSyntax);
+				close(descriptor);
+				return false;
 			}
-			row = tempRow;
-			column = tempColumn;
+			fileDescriptor = descriptor;
+			fileSize = static_cast<std::uint_least64_t>(fileStat.st_size);
+			blocksCount = (fileSize + blockSize - 1) / blockSize;
+
+			std::size_t slots = (blocksCount < queueDepth)
+				? static_cast<std::size_t>(blocksCount)
+				: queueDepth;
+			if (slots == 0)
+				return true;
+			queueDepth = slots;
+			blocks.reset(new char[slots * blockSize]);
+			filled.reset(new std::size_t[slots]);
+#if defined(XML_INSPECTOR_IO_URING)
+			if (useUring && slots > 1 && ring.Open(static_cast<unsigned>(slots)))
+			{
+				vectors.reset(new iovec[slots]);
+				done.reset(new bool[slots]);
+				for (std::size_t i = 0; i < slots; ++i)
+					SubmitBlock(i, true);
+				if (!ring.Submit())
+					failed = true;
+			}
+#else
+			(void)useUring;
+#endif
+			return true;
+		}
+
+		inline bool UringFileBuf::IsOpen() const
+		{
+			return (fileDescriptor >= 0);
+		}
+
+		inline bool UringFileBuf::IsUringUsed() const
+		{
+#if defined(XML_INSPECTOR_IO_URING)
+			return ring.IsOpen();
+#else
 			return false;
+#endif
 		}
 
-		// currentCharacter == first character of text.
-		SavePosition();
-		return ParseText();
-	}
+		inline std::size_t UringFileBuf::GetBlockSize() const
+		{
+			return blockSize;
+		}
 
-	template <typename TCharactersWriter>
-	inline Inspected Inspector<TCharactersWriter>::GetInspected() const
-	{
-		return node;
-	}
+		inline std::size_t UringFileBuf::GetQueueDepth() const
+		{
+			return queueDepth;
+		}
 
-	template <typename TCharactersWriter>
-	inline const typename Inspector<TCharactersWriter>::StringType&
-		Inspector<TCharactersWriter>::GetName() const
-	{
-		return name;
-	}
+		inline std::size_t UringFileBuf::GetBlockLength(std::uint_least64_t block) const
+		{
+			std::uint_least64_t rest = fileSize - block * blockSize;
+			return (rest < blockSize)
+				? static_cast<std::size_t>(rest)
+				: blockSize;
+		}
 
-	template <typename TCharactersWriter>
-	inline const typename Inspector<TCharactersWriter>::StringType&
-		Inspector<TCharactersWriter>::GetValue() const
-	{
-		return value;
-	}
+#if defined(XML_INSPECTOR_IO_URING)
+		inline void UringFileBuf::SubmitBlock(std::uint_least64_t block, bool first)
+		{
+			std::size_t slot = static_cast<std::size_t>(block % queueDepth);
+			if (first)
+			{
+				filled[slot] = 0;
+				done[slot] = false;
+			}
+			vectors[slot].iov_base = blocks.get() + slot * blockSize + filled[slot];
+			vectors[slot].iov_len = GetBlockLength(block) - filled[slot];
+			ring.PrepareRead(fileDescriptor, &vectors[slot],
+				block * blockSize + filled[slot], block);
+			++inFlight;
+		}
 
-	template <typename TCharactersWriter>
-	inline const typename Inspector<TCharactersWriter>::StringType&
-		Inspector<TCharactersWriter>::GetLocalName() const
-	{
-		return localName;
-	}
+		inline bool UringFileBuf::WaitBlock(std::uint_least64_t block)
+		{
+			std::size_t slot = static_cast<std::size_t>(block % queueDepth);
+			while (!done[slot])
+			{
+				std::uint_least64_t userData;
+				int result;
+				if (!ring.WaitCompletion(userData, result))
+					return false;
+				--inFlight;
+
+				std::size_t readSlot = static_cast<std::size_t>(userData % queueDepth);
+				if (result == -EINTR || result == -EAGAIN)
+				{
+					SubmitBlock(userData, false);
+				}
+				else if (result < 0)
+				{
+					return false;
+				}
+				else if (result == 0)
+				{
+					// File is shorter than it was.
+					done[readSlot] = true;
+					if (blocksCount > userData + 1)
+						blocksCount = userData + 1;
+				}
+				else
+				{
+					filled[readSlot] += static_cast<std::size_t>(result);
+					if (filled[readSlot] == GetBlockLength(userData))
+						done[readSlot] = true;
+					else
+						SubmitBlock(userData, false); // Short read.
+				}
+				if (!ring.Submit())
+					return false;
+			}
+			return true;
+		}
+#endif
+
+		inline bool UringFileBuf::ReadBlock(std::uint_least64_t block)
+		{
+			std::size_t slot = static_cast<std::size_t>(block % queueDepth);
+			std::size_t length = GetBlockLength(block);
+			char* first = blocks.get() + slot * blockSize;
+			filled[slot] = 0;
+			while (filled[slot] < length)
+			{
+				ssize_t result = pread(fileDescriptor, first + filled[slot], length - filled[slot],
+					static_cast<off_t>(block * blockSize + filled[slot]));
+				if (result < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return false;
+				}
+				if (result == 0)
+				{
+					// File is shorter than it was.
+					blocksCount = block + 1;
+					break;
+				}
+				filled[slot] += static_cast<std::size_t>(result);
+			}
+			return true;
+		}
 
-	template <typename TCharactersWriter>
-	inline const typename Inspector<TCharactersWriter>::StringType&
-		Inspector<TCharactersWriter>::GetPrefix() const
-	{
-		return prefix;
-	}
+		inline UringFileBuf::int_type UringFileBuf::underflow()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
 
-	template <typename TCharactersWriter>
-	inline const typename Inspector<TCharactersWriter>::StringType&
-		Inspector<TCharactersWriter>::GetNamespaceUri() const
-	{
-		return namespaceUri;
-	}
+			if (fileDescriptor < 0)
+				return traits_type::eof();
 
-	template <typename TCharactersWriter>
-	inline bool Inspector<TCharactersWriter>::HasAttributes() const
-	{
-		return (attributesSize != 0);
-	}
+			if (holding)
+			{
+				holding = false;
+				setg(nullptr, nullptr, nullptr);
+				++current;
+#if defined(XML_INSPECTOR_IO_URING)
+				// Request the next part of the file into the consumed block.
+				std::uint_least64_t next = current - 1 + queueDepth;
+				if (ring.IsOpen() && !failed && next < blocksCount)
+				{
+					SubmitBlock(next, true);
+					if (!ring.Submit())
+						failed = true;
+				}
+#endif
+			}
 
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::SizeType
-		Inspector<TCharactersWriter>::GetAttributesCount() const
-	{
-		return static_cast<SizeType>(attributesSize);
-	}
+			if (failed)
+				throw std::ios_base::failure("File read error.");
 
-	template <typename TCharactersWriter>
-	inline const typename Inspector<TCharactersWriter>::AttributeType&
-		Inspector<TCharactersWriter>::GetAttributeAt(SizeType index) const
-	{
-		if (index >= attributesSize)
-			throw std::out_of_range("Attempt to access out of range element.");
-		return attributes[static_cast<AttributesSizeType>(index)];
-	}
+			if (current >= blocksCount)
+				return traits_type::eof();
 
-	template <typename TCharactersWriter>
-	inline const char* Inspector<TCharactersWriter>::GetErrorMessage() const
-	{
-		return errMsg;
-	}
+			bool success;
+#if defined(XML_INSPECTOR_IO_URING)
+			if (ring.IsOpen())
+				success = WaitBlock(current);
+			else
+				success = ReadBlock(current);
+#else
+			success = ReadBlock(current);
+#endif
+			if (!success)
+			{
+				failed = true;
+				throw std::ios_base::failure("File read error.");
+			}
 
-	template <typename TCharactersWriter>
-	inline ErrorCode Inspector<TCharactersWriter>::GetErrorCode() const
-	{
-		return err;
-	}
+			std::size_t slot = static_cast<std::size_t>(current % queueDepth);
+			if (filled[slot] == 0)
+				return traits_type::eof();
 
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::SizeType
-		Inspector<TCharactersWriter>::GetRow() const
-	{
-		return row;
-	}
+			char* block = blocks.get() + slot * blockSize;
+			setg(block, block, block + filled[slot]);
+			holding = true;
+			return traits_type::to_int_type(*gptr());
+		}
 
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::SizeType
-		Inspector<TCharactersWriter>::GetColumn() const
-	{
-		return column;
-	}
+		inline DirectFileBuf::DirectFileBuf(std::size_t blockSize)
+			: std::streambuf(),
+			fileDescriptor(-1),
+			fileSize(0),
+			offset(0),
+			blockSize((blockSize + Alignment - 1) / Alignment * Alignment),
+			buffer(nullptr),
+			direct(false),
+			failed(false)
+		{
+			if (this->blockSize == 0)
+				this->blockSize = Alignment;
+		}
 
-	template <typename TCharactersWriter>
-	inline typename Inspector<TCharactersWriter>::SizeType
-		Inspector<TCharactersWriter>::GetDepth() const
-	{
-		if (node == Inspected::StartTag)
-			return static_cast<SizeType>(unclosedTagsSize - 1);
-		else
-			return static_cast<SizeType>(unclosedTagsSize);
-	}
+		inline DirectFileBuf::~DirectFileBuf()
+		{
+			if (fileDescriptor >= 0)
+				close(fileDescriptor);
+			std::free(buffer);
+		}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::Reset()
-	{
-		row = 0;
-		column = 0;
-		currentRow = 0;
-		currentColumn = 0;
-		node = Inspected::None;
-		err = ErrorCode::None;
-		errMsg = nullptr;
-		afterBom = false;
-		bom = Details::Bom::None;
-		name.clear();
-		value.clear();
-		localName.clear();
-		prefix.clear();
-		namespaceUri.clear();
-		entityName.clear();
-		entityNameCharCount = 0;
-		currentCharacter = 0;
-		bufferedCharacter = 0;
-		foundElement = false;
-		foundDOCTYPE = false;
-		eof = false;
-		attributesSize = 0;
-		unclosedTagsSize = 0;
-		namespacesSize = 0;
-		if (sourceType == SourcePath)
+		inline bool DirectFileBuf::Open(const char* filePath, bool useDirect)
 		{
-			fPath.clear();
-			if (fileStream.is_open())
-				fileStream.close();
-			fileStream.clear();
-			delete reader;
-			reader = nullptr;
+			int flags = O_RDONLY | O_CLOEXEC;
+#if defined(O_DIRECT)
+			if (useDirect)
+				flags |= O_DIRECT;
+#endif
+			int descriptor;
+			do
+			{
+				descriptor = open(filePath, flags);
+			}
+			while (descriptor < 0 && errno == EINTR);
+#if defined(O_DIRECT)
+			// File system doesn't support direct I/O.
+			if (descriptor < 0 && errno == EINVAL && useDirect)
+			{
+				do
+				{
+					descriptor = open(filePath, O_RDONLY | O_CLOEXEC);
+				}
+				while (descriptor < 0 && errno == EINTR);
+			}
+			else if (descriptor >= 0)
+			{
+				direct = useDirect;
+			}
+#endif
+			if (descriptor < 0)
+				return false;
+
+			struct stat fileStat;
+			void* memory = nullptr;
+			if (fstat(descriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) ||
+				posix_memalign(&memory, Alignment, blockSize) != 0)
+			{
+				close(descriptor);
+				direct = false;
+				return false;
+			}
+#if defined(F_NOCACHE)
+			if (useDirect && fcntl(descriptor, F_NOCACHE, 1) == 0)
+				direct = true;
+#endif
+			fileDescriptor = descriptor;
+			fileSize = static_cast<std::uint_least64_t>(fileStat.st_size);
+			buffer = static_cast<char*>(memory);
+			return true;
 		}
-		else if (sourceType == SourceReader)
+
+		inline bool DirectFileBuf::IsOpen() const
 		{
-			reader = nullptr;
+			return (fileDescriptor >= 0);
 		}
-		else if (sourceType == SourceStream)
+
+		inline bool DirectFileBuf::IsDirect() const
 		{
-			inputStreamPtr = nullptr;
-			delete reader;
-			reader = nullptr;
+			return direct;
 		}
-		else if (sourceType == SourceIterators)
+
+		inline std::size_t DirectFileBuf::GetBlockSize() const
 		{
-			delete inputStreamPtr->rdbuf();
-			delete inputStreamPtr;
-			inputStreamPtr = nullptr;
-			delete reader;
-			reader = nullptr;
+			return blockSize;
 		}
-		sourceType = SourceNone;
-	}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::Reset(const char* filePath)
-	{
-		Reset();
-		fPath = filePath;
-		sourceType = SourcePath;
-	}
+		inline bool DirectFileBuf::DisableDirect()
+		{
+#if defined(O_DIRECT)
+			int flags = fcntl(fileDescriptor, F_GETFL);
+			if (!direct || flags < 0 || fcntl(fileDescriptor, F_SETFL, flags & ~O_DIRECT) != 0)
+				return false;
+			direct = false;
+			return true;
+#else
+			return false;
+#endif
+		}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::Reset(const std::string& filePath)
-	{
-		Reset();
-		fPath = filePath;
-		sourceType = SourcePath;
-	}
+		inline std::ptrdiff_t DirectFileBuf::ReadBlock()
+		{
+			std::size_t length = blockSize;
+			if (fileSize - offset < length)
+			{
+				// Tail of the file. Size of the read stays aligned,
+				// the kernel stops at the end of the file.
+				length = static_cast<std::size_t>(fileSize - offset);
+				length = (length + Alignment - 1) / Alignment * Alignment;
+			}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::Reset(std::istream* inputStream)
-	{
-		Reset();
-		inputStreamPtr = inputStream;
-		sourceType = SourceStream;
-	}
+			std::size_t filled = 0;
+			while (filled < length)
+			{
+				// After a short read the next read starts at the aligned
+				// offset again, reading some bytes for the second time.
+				std::size_t start = direct ? filled / Alignment * Alignment : filled;
+				ssize_t result = pread(fileDescriptor, buffer + start, length - start,
+					static_cast<off_t>(offset + start));
+				if (result < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					// Some file systems refuse the direct read of the tail.
+					if (errno == EINVAL && DisableDirect())
+						continue;
+					return -1;
+				}
+				std::size_t end = start + static_cast<std::size_t>(result);
+				// No new bytes at the end of the file.
+				if (end <= filled)
+					break;
+				filled = end;
+			}
+			if (offset + filled > fileSize)
+				filled = static_cast<std::size_t>(fileSize - offset);
 
-	template <typename TCharactersWriter>
-	template <typename TInputIterator>
-	inline void Inspector<TCharactersWriter>::Reset(
-		TInputIterator first, TInputIterator last)
-	{
-		Reset();
-		std::unique_ptr<Details::BasicIteratorsBuf<TInputIterator, char> > buf(
-			new Details::BasicIteratorsBuf<TInputIterator, char>(first, last));
-		inputStreamPtr = new std::istream(buf.get());
-		buf.release();
-		sourceType = SourceIterators;
-	}
+#if defined(POSIX_FADV_DONTNEED)
+			if (!direct && filled != 0)
+			{
+				// Read pages aren't needed in the page cache anymore.
+				posix_fadvise(fileDescriptor, static_cast<off_t>(offset),
+					static_cast<off_t>(filled), POSIX_FADV_DONTNEED);
+			}
+#endif
+			return static_cast<std::ptrdiff_t>(filled);
+		}
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::Reset(Encoding::CharactersReader* r)
-	{
-		Reset();
-		if (r != nullptr)
+		inline DirectFileBuf::int_type DirectFileBuf::underflow()
 		{
-			reader = r;
-			sourceType = SourceReader;
-		}
-	}
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
 
-	template <typename TCharactersWriter>
-	inline void Inspector<TCharactersWriter>::Clear()
-	{
-		Reset();
-		attributes.clear();
-		unclosedTags.clear();
-		namespaces.clear();
-	}
+			if (fileDescriptor < 0 || offset >= fileSize)
+				return traits_type::eof();
 
-	/// @cond DETAILS
-	namespace Details
-	{
-		inline Bom ReadBom(std::istream* inputStream)
-		{
-			// UTF-8          EF BB BF
-			// UTF-16 (BE)    FE FF
-			// UTF-16 (LE)    FF FE
-			// UTF-32 (BE)    00 00 FE FF
-			// UTF-32 (LE)    FF FE 00 00
+			if (failed)
+				throw std::ios_base::failure("File read error.");
 
-			if (inputStream != nullptr)
+			std::ptrdiff_t count = ReadBlock();
+			if (count < 0)
 			{
-				// Check first byte.
-				int oneByte = inputStream->peek();
-
-				if (oneByte == std::char_traits<char>::eof())
-				{
-					if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-						return Bom::None; // End of the stream.
-					return Bom::StreamError;
-				}
+				failed = true;
+				throw std::ios_base::failure("File read error.");
+			}
+			if (count == 0)
+			{
+				// File is shorter than it was.
+				fileSize = offset;
+				return traits_type::eof();
+			}
 
-				if (oneByte == 0xEF) // Should be UTF-8
-				{
-					// Extract first byte.
-					inputStream->get();
+			offset += static_cast<std::uint_least64_t>(count);
+			setg(buffer, buffer, buffer + count);
+			return traits_type::to_int_type(*gptr());
+		}
+#endif
 
-					// Extract second byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0xBB)
-						return Bom::Invalid;
+#if defined(XML_INSPECTOR_ZLIB)
+		inline GzipBuf::GzipBuf()
+			: std::streambuf(),
+			source(nullptr),
+			inflater(),
+			initialized(false),
+			memberEnd(false),
+			failed(false),
+			input(),
+			output()
+		{
 
-					// Extract third byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0xBF)
-						return Bom::Invalid;
+		}
 
-					return Bom::Utf8;
-				}
-				else if (oneByte == 0xFE) // Should be UTF-16 (BE)
-				{
-					// Extract first byte.
-					inputStream->get();
+		inline GzipBuf::~GzipBuf()
+		{
+			Close();
+		}
 
-					// Extract second byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0xFF)
-						return Bom::Invalid;
+		inline bool GzipBuf::Open(std::streambuf* compressed)
+		{
+			Close();
+			std::memset(&inflater, 0, sizeof(inflater));
+			// 32 - detect gzip or zlib header, 15 - maximum window.
+			if (inflateInit2(&inflater, 15 + 32) != Z_OK)
+				return false;
+			initialized = true;
+			if (!input)
+				input.reset(new char[InputSize]);
+			if (!output)
+				output.reset(new char[OutputSize]);
+			source = compressed;
+			return true;
+		}
 
-					return Bom::Utf16BE;
-				}
-				else if (oneByte == 0xFF) // Should be UTF-16 (LE) of UTF-32 (LE)
-				{
-					// Extract first byte.
-					inputStream->get();
+		inline void GzipBuf::Close()
+		{
+			if (initialized)
+				inflateEnd(&inflater);
+			initialized = false;
+			memberEnd = false;
+			failed = false;
+			source = nullptr;
+			setg(nullptr, nullptr, nullptr);
+		}
 
-					// Extract second byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0xFE)
-						return Bom::Invalid;
+		inline bool GzipBuf::IsOpen() const
+		{
+			return initialized;
+		}
 
-					// Check third byte.
-					oneByte = inputStream->peek();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Utf16LE;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0x00)
-						return Bom::Utf16LE;
+		inline GzipBuf::int_type GzipBuf::underflow()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
 
-					// Should be UTF-32 (LE)
-					// Extract third byte.
-					inputStream->get();
+			if (!initialized)
+				return traits_type::eof();
 
-					// Extract fourth byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0x00)
-						return Bom::Invalid;
+			if (failed)
+				throw std::ios_base::failure("Invalid compressed data.");
 
-					return Bom::Utf32LE;
-				}
-				else if (oneByte == 0x00) // Should be UTF-32 (BE)
+			inflater.next_out = reinterpret_cast<Bytef*>(output.get());
+			inflater.avail_out = static_cast<uInt>(OutputSize);
+			while (inflater.avail_out == OutputSize)
+			{
+				if (inflater.avail_in == 0)
 				{
-					// Extract first byte.
-					inputStream->get();
-
-					// Extract second byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
+					std::streamsize count = source->sgetn(input.get(),
+						static_cast<std::streamsize>(InputSize));
+					if (count <= 0)
 					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0x00)
-						return Bom::Invalid;
+						if (memberEnd)
+							return traits_type::eof();
 
-					// Extract third byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
+						// Truncated data.
+						failed = true;
+						throw std::ios_base::failure("Invalid compressed data.");
 					}
-					if (oneByte != 0xFE)
-						return Bom::Invalid;
+					inflater.next_in = reinterpret_cast<Bytef*>(input.get());
+					inflater.avail_in = static_cast<uInt>(count);
+				}
 
-					// Extract fourth byte.
-					oneByte = inputStream->get();
-					if (oneByte == std::char_traits<char>::eof())
-					{
-						if ((inputStream->rdstate() & std::istream::eofbit) != 0)
-							return Bom::Invalid;
-						return Bom::StreamError;
-					}
-					if (oneByte != 0xFF)
-						return Bom::Invalid;
+				if (memberEnd)
+				{
+					// Next member of concatenated gzip data.
+					inflateReset(&inflater);
+					memberEnd = false;
+				}
 
-					return Bom::Utf32BE;
+				int result = inflate(&inflater, Z_NO_FLUSH);
+				if (result == Z_STREAM_END)
+				{
+					memberEnd = true;
 				}
-				else
+				else if (result != Z_OK && result != Z_BUF_ERROR)
 				{
-					return Bom::None;
+					failed = true;
+					throw std::ios_base::failure("Invalid compressed data.");
 				}
 			}
-			return Bom::StreamError;
+
+			setg(output.get(), output.get(),
+				output.get() + (OutputSize - inflater.avail_out));
+			return traits_type::to_int_type(*gptr());
 		}
-		
-		template <typename TInputIterator>
-		inline Bom ReadBom(TInputIterator& first, TInputIterator& last)
+
+		inline PrefixBuf::PrefixBuf()
+			: std::streambuf(),
+			source(nullptr),
+			prefix(),
+			buffer()
 		{
-			// UTF-8          EF BB BF
-			// UTF-16 (BE)    FE FF
-			// UTF-16 (LE)    FF FE
-			// UTF-32 (BE)    00 00 FE FF
-			// UTF-32 (LE)    FF FE 00 00
 
-			if (first == last)
-				return Bom::None;
+		}
 
-			if (*first == 0xEF) // Should be UTF-8
-			{
-				++first;
-				if (first == last || *first != 0xBB)
-					return Bom::Invalid;
+		inline void PrefixBuf::Reset(const char* first, const char* last, std::streambuf* next)
+		{
+			prefix.assign(first, last);
+			source = next;
+			if (prefix.empty())
+				setg(nullptr, nullptr, nullptr);
+			else
+				setg(&prefix[0], &prefix[0], &prefix[0] + prefix.size());
+		}
 
-				++first;
-				if (first == last || *first != 0xBF)
-					return Bom::Invalid;
+		inline PrefixBuf::int_type PrefixBuf::underflow()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
 
-				++first;
-				return Bom::Utf8;
-			}
-			else if (*first == 0xFE) // Should be UTF-16 (BE)
-			{
-				++first;
-				if (first == last || *first != 0xFF)
-					return Bom::Invalid;
+			if (source == nullptr)
+				return traits_type::eof();
 
-				++first;
-				return Bom::Utf16BE;
+			if (!buffer)
+				buffer.reset(new char[BufferSize]);
+			std::streamsize count = source->sgetn(buffer.get(),
+				static_cast<std::streamsize>(BufferSize));
+			if (count <= 0)
+				return traits_type::eof();
+			setg(buffer.get(), buffer.get(), buffer.get() + count);
+			return traits_type::to_int_type(*gptr());
+		}
+
+		inline ParallelGzipBuf::ParallelGzipBuf(std::size_t threadsCount, std::size_t queueDepth)
+			: std::streambuf(),
+			source(nullptr),
+			threadsCount(threadsCount),
+			queueDepth(queueDepth),
+			jobs(),
+			next(0),
+			queued(0),
+			sourceEnd(false),
+			sourceFailed(false),
+			failed(false),
+			holding(false),
+			sequentialPending(false),
+			sequential(false),
+			headerSize(0),
+			queue(),
+			mutex(),
+			jobReady(),
+			jobDone(),
+			stopping(false),
+			workers(),
+			inflater(),
+			inflaterInitialized(false),
+			prefix(),
+			gzip(),
+			sequentialBuffer()
+		{
+			if (this->threadsCount == 0)
+			{
+				this->threadsCount = std::thread::hardware_concurrency();
+				if (this->threadsCount == 0)
+					this->threadsCount = 2;
 			}
-			else if (*first == 0xFF) // Should be UTF-16 (LE) of UTF-32 (LE)
+			if (this->queueDepth == 0)
+				this->queueDepth = this->threadsCount * 4;
+			if (this->queueDepth < 2)
+				this->queueDepth = 2;
+		}
+
+		inline ParallelGzipBuf::~ParallelGzipBuf()
+		{
 			{
-				++first;
-				if (first == last || *first != 0xFE)
-					return Bom::Invalid;
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			jobReady.notify_all();
+			for (std::size_t i = 0; i < workers.size(); ++i)
+				workers[i].join();
+			if (inflaterInitialized)
+				inflateEnd(&inflater);
+		}
 
-				++first;
-				if (first == last || *first != 0x00)
-					return Bom::Utf16LE;
+		inline void ParallelGzipBuf::Open(std::streambuf* compressed)
+		{
+			source = compressed;
+			jobs.reset(new Job[queueDepth]);
+			for (std::size_t i = 0; i < queueDepth; ++i)
+				jobs[i].state = JobFree;
+		}
 
-				// Should be UTF-32 (LE)
-				++first;
-				if (first == last || *first != 0x00)
-					return Bom::Invalid;
+		inline bool ParallelGzipBuf::IsOpen() const
+		{
+			return (source != nullptr);
+		}
 
-				++first;
-				return Bom::Utf32LE;
-			}
-			else if (*first == 0x00) // Should be UTF-32 (BE)
-			{
-				++first;
-				if (first == last || *first != 0x00)
-					return Bom::Invalid;
+		inline std::size_t ParallelGzipBuf::GetThreadsCount() const
+		{
+			return threadsCount;
+		}
 
-				++first;
-				if (first == last || *first != 0xFE)
-					return Bom::Invalid;
+		inline int ParallelGzipBuf::ReadMember(Job& job)
+		{
+			headerSize = static_cast<std::size_t>(source->sgetn(header,
+				static_cast<std::streamsize>(HeaderSize)));
+			if (headerSize == 0)
+				return MemberEnd;
 
-				++first;
-				if (first == last || *first != 0xFF)
-					return Bom::Invalid;
+			// ID1 ID2 CM FLG MTIME(4) XFL OS XLEN(2) 'B' 'C' SLEN(2) BSIZE(2)
+			const unsigned char* h = reinterpret_cast<const unsigned char*>(header);
+			if (headerSize != HeaderSize ||
+				h[0] != 0x1F || h[1] != 0x8B || h[2] != 8 || (h[3] & 0x04) == 0 ||
+				(h[10] | (h[11] << 8)) < 6 ||
+				h[12] != 0x42 || h[13] != 0x43 || (h[14] | (h[15] << 8)) != 2)
+				return MemberOther;
 
-				++first;
-				return Bom::Utf32BE;
+			std::size_t memberSize = static_cast<std::size_t>(h[16] | (h[17] << 8)) + 1;
+			// Header, empty deflate block, CRC32 and ISIZE at least.
+			if (memberSize < HeaderSize + 10)
+				return MemberTruncated;
+
+			job.input.resize(memberSize);
+			std::memcpy(&job.input[0], header, HeaderSize);
+			std::streamsize rest = static_cast<std::streamsize>(memberSize - HeaderSize);
+			if (source->sgetn(&job.input[HeaderSize], rest) != rest)
+				return MemberTruncated;
+
+			const unsigned char* trailer =
+				reinterpret_cast<const unsigned char*>(&job.input[memberSize - 4]);
+			std::size_t outputSize = static_cast<std::size_t>(trailer[0]) |
+				(static_cast<std::size_t>(trailer[1]) << 8) |
+				(static_cast<std::size_t>(trailer[2]) << 16) |
+				(static_cast<std::size_t>(trailer[3]) << 24);
+			// BGZF member never inflates to more than 64 KiB.
+			if (outputSize > 65536)
+				return MemberTruncated;
+			job.output.resize(outputSize);
+			return MemberRead;
+		}
+
+		inline void ParallelGzipBuf::Fill()
+		{
+			while (!sourceEnd && !sourceFailed && !sequentialPending &&
+				queued - next < queueDepth)
+			{
+				Job& job = jobs[queued % queueDepth];
+				int result = ReadMember(job);
+				if (result == MemberEnd)
+				{
+					sourceEnd = true;
+				}
+				else if (result == MemberOther)
+				{
+					// Inflate the rest sequentially after the queued members.
+					sequentialPending = true;
+				}
+				else if (result == MemberTruncated)
+				{
+					sourceFailed = true;
+				}
+				else
+				{
+					if (workers.empty() && threadsCount > 1)
+						StartWorkers();
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						job.state = JobQueued;
+						queue.push_back(queued);
+						++queued;
+					}
+					jobReady.notify_one();
+				}
 			}
-			else
+		}
+
+		inline void ParallelGzipBuf::StartWorkers()
+		{
+			try
 			{
-				return Bom::None;
+				// The consumer inflates members too while it waits.
+				for (std::size_t i = 1; i < threadsCount; ++i)
+					workers.push_back(std::thread(&ParallelGzipBuf::Work, this));
+			}
+			catch (const std::system_error&)
+			{
+				// Fewer threads, the consumer still inflates queued members.
 			}
+			threadsCount = workers.size() + 1;
 		}
 
-		template <
-			typename TInputIterator,
-			typename TCharacterType,
-			typename TTraits>
-		inline typename BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::int_type
-			BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::underflow()
+		inline void ParallelGzipBuf::Work()
 		{
-			if (curIter == endIter)
-				return traits_type::eof();
+			z_stream stream;
+			std::memset(&stream, 0, sizeof(stream));
+			bool initialized = (inflateInit2(&stream, 15 + 16) == Z_OK);
 
-			return traits_type::to_int_type(*curIter);
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true)
+			{
+				while (queue.empty() && !stopping)
+					jobReady.wait(lock);
+				if (stopping)
+					break;
+
+				Job& job = jobs[queue.front() % queueDepth];
+				queue.pop_front();
+				job.state = JobRunning;
+				lock.unlock();
+				bool success = initialized && Inflate(stream, job);
+				lock.lock();
+				job.state = success ? JobDone : JobFailed;
+				jobDone.notify_all();
+			}
+
+			if (initialized)
+				inflateEnd(&stream);
 		}
 
-		template <
-			typename TInputIterator,
-			typename TCharacterType,
-			typename TTraits>
-		inline typename BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::int_type
-			BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::uflow()
+		inline bool ParallelGzipBuf::Inflate(z_stream& stream, Job& job)
 		{
-			if (curIter == endIter)
-				return traits_type::eof();
+			if (inflateReset(&stream) != Z_OK)
+				return false;
 
-			return traits_type::to_int_type(*curIter++);
+			char empty = 0;
+			stream.next_in = reinterpret_cast<Bytef*>(&job.input[0]);
+			stream.avail_in = static_cast<uInt>(job.input.size());
+			stream.next_out = reinterpret_cast<Bytef*>(job.output.empty() ? &empty : &job.output[0]);
+			stream.avail_out = static_cast<uInt>(job.output.size());
+			int result = inflate(&stream, Z_FINISH);
+			return (result == Z_STREAM_END &&
+				stream.avail_in == 0 &&
+				stream.total_out == job.output.size());
 		}
 
-		template <
-			typename TInputIterator,
-			typename TCharacterType,
-			typename TTraits>
-		inline std::streamsize
-			BasicIteratorsBuf<TInputIterator, TCharacterType, TTraits>::showmanyc()
+		inline ParallelGzipBuf::int_type ParallelGzipBuf::underflow()
 		{
-			return (curIter != endIter)
-				? 1
-				: 0;
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
+
+			if (source == nullptr)
+				return traits_type::eof();
+
+			if (sequential)
+			{
+				std::streamsize count = gzip.sgetn(sequentialBuffer.get(),
+					static_cast<std::streamsize>(SequentialSize));
+				if (count <= 0)
+					return traits_type::eof();
+				setg(sequentialBuffer.get(), sequentialBuffer.get(), sequentialBuffer.get() + count);
+				return traits_type::to_int_type(*gptr());
+			}
+
+			if (failed)
+				throw std::ios_base::failure("Invalid compressed data.");
+
+			while (true)
+			{
+				if (holding)
+				{
+					// Release the consumed job.
+					holding = false;
+					setg(nullptr, nullptr, nullptr);
+					std::lock_guard<std::mutex> lock(mutex);
+					jobs[next % queueDepth].state = JobFree;
+					++next;
+				}
+
+				Fill();
+
+				if (next == queued)
+				{
+					if (sourceFailed)
+					{
+						failed = true;
+						throw std::ios_base::failure("Invalid compressed data.");
+					}
+
+					if (!sequentialPending)
+						return traits_type::eof();
+
+					// Not BGZF member. Inflate the rest of the source sequentially.
+					sequential = true;
+					sequentialBuffer.reset(new char[SequentialSize]);
+					prefix.Reset(header, header + headerSize, source);
+					if (!gzip.Open(&prefix))
+					{
+						failed = true;
+						throw std::ios_base::failure("Invalid compressed data.");
+					}
+					return underflow();
+				}
+
+				Job& job = jobs[next % queueDepth];
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					while (job.state == JobQueued || job.state == JobRunning)
+					{
+						if (job.state == JobQueued)
+						{
+							// No worker took it yet, so inflate it here.
+							queue.erase(std::find(queue.begin(), queue.end(), next));
+							job.state = JobRunning;
+							lock.unlock();
+							if (!inflaterInitialized)
+							{
+								std::memset(&inflater, 0, sizeof(inflater));
+								inflaterInitialized = (inflateInit2(&inflater, 15 + 16) == Z_OK);
+							}
+							bool success = inflaterInitialized && Inflate(inflater, job);
+							lock.lock();
+							job.state = success ? JobDone : JobFailed;
+						}
+						else
+						{
+							jobDone.wait(lock);
+						}
+					}
+				}
+
+				if (job.state == JobFailed)
+				{
+					failed = true;
+					throw std::ios_base::failure("Invalid compressed data.");
+				}
+
+				holding = true;
+				if (!job.output.empty())
+				{
+					setg(&job.output[0], &job.output[0], &job.output[0] + job.output.size());
+					return traits_type::to_int_type(*gptr());
+				}
+				// Empty member (for example BGZF end-of-file marker).
+			}
 		}
+#endif
 	}
 	/// @endcond
 }
@@ -0,0 +1,136 @@
+#include "XmlInspector.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Range cascades used by IsNameStartChar and IsNameChar methods
+// before the BMP bitmaps (Latin-1 characters are checked by the same ranges).
+static bool CascadeIsNameStartChar(char32_t codePoint)
+{
+	if (codePoint <= 0xFF)
+	{
+		return (codePoint == 0x3A || (codePoint >= 0x41 && codePoint <= 0x5A) ||
+			codePoint == 0x5F || (codePoint >= 0x61 && codePoint <= 0x7A) ||
+			(codePoint >= 0xC0 && codePoint != 0xD7 && codePoint != 0xF7));
+	}
+
+	return (
+		(codePoint <= 0x2FF) ||
+		(codePoint >= 0x370 && codePoint <= 0x37D) ||
+		(codePoint >= 0x37F && codePoint <= 0x1FFF) ||
+		(codePoint >= 0x200C && codePoint <= 0x200D) ||
+		(codePoint >= 0x2070 && codePoint <= 0x218F) ||
+		(codePoint >= 0x2C00 && codePoint <= 0x2FEF) ||
+		(codePoint >= 0x3001 && codePoint <= 0xD7FF) ||
+		(codePoint >= 0xF900 && codePoint <= 0xFDCF) ||
+		(codePoint >= 0xFDF0 && codePoint <= 0xFFFD) ||
+		(codePoint >= 0x10000 && codePoint <= 0xEFFFF));
+}
+
+static bool CascadeIsNameChar(char32_t codePoint)
+{
+	if (codePoint <= 0xFF)
+	{
+		return (CascadeIsNameStartChar(codePoint) || codePoint == 0x2D || codePoint == 0x2E ||
+			(codePoint >= 0x30 && codePoint <= 0x39) || codePoint == 0xB7);
+	}
+
+	return (
+		(codePoint <= 0x2FF) ||
+		(codePoint >= 0x300 && codePoint <= 0x37D) ||
+		(codePoint >= 0x37F && codePoint <= 0x1FFF) ||
+		(codePoint >= 0x200C && codePoint <= 0x200D) ||
+		(codePoint >= 0x203F && codePoint <= 0x2040) ||
+		(codePoint >= 0x2070 && codePoint <= 0x218F) ||
+		(codePoint >= 0x2C00 && codePoint <= 0x2FEF) ||
+		(codePoint >= 0x3001 && codePoint <= 0xD7FF) ||
+		(codePoint >= 0xF900 && codePoint <= 0xFDCF) ||
+		(codePoint >= 0xFDF0 && codePoint <= 0xFFFD) ||
+		(codePoint >= 0x10000 && codePoint <= 0xEFFFF));
+}
+
+// Returns nanoseconds per character.
+template <typename TPredicate>
+static double Measure(TPredicate predicate, const std::vector<char32_t>& characters,
+	std::size_t repeats, std::size_t& matched)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (std::size_t r = 0; r < repeats; ++r)
+	{
+		for (std::size_t i = 0; i < characters.size(); ++i)
+		{
+			if (predicate(characters[i]))
+				++matched;
+		}
+	}
+	std::chrono::nanoseconds elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start);
+	return static_cast<double>(elapsed.count()) / (characters.size() * repeats);
+}
+
+static std::vector<char32_t> Range(char32_t first, char32_t last, std::size_t count)
+{
+	std::vector<char32_t> result;
+	std::uint_least32_t state = 12345;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		state = state * 1103515245u + 12345u;
+		result.push_back(first + static_cast<char32_t>((state >> 8) % (last - first + 1)));
+	}
+	return result;
+}
+
+static void Compare(const char* title, const std::vector<char32_t>& characters)
+{
+	const std::size_t repeats = 2000;
+	std::size_t matched = 0;
+	double cascadeStart = Measure(CascadeIsNameStartChar, characters, repeats, matched);
+	double bitmapStart = Measure(Xml::Encoding::CharactersReader::IsNameStartChar,
+		characters, repeats, matched);
+	double cascadeName = Measure(CascadeIsNameChar, characters, repeats, matched);
+	double bitmapName = Measure(Xml::Encoding::CharactersReader::IsNameChar,
+		characters, repeats, matched);
+	std::cout << title << " (ns per character, cascade / bitmap)\n" <<
+		"  IsNameStartChar: " << cascadeStart << " / " << bitmapStart << "\n" <<
+		"  IsNameChar:      " << cascadeName << " / " << bitmapName << "\n";
+	if (matched == 0)
+		std::cout << "  (nothing matched)\n";
+}
+
+static void ParseNames(const char* title, const std::string& name)
+{
+	std::string doc = "<root>";
+	for (int i = 0; i < 100000; ++i)
+		doc += "<" + name + " " + name + "=\"1\"></" + name + ">";
+	doc += "</root>";
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.data(), doc.data() + doc.size());
+	std::size_t count = 0;
+	while (inspector.Inspect())
+		++count;
+	std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - start);
+	std::cout << title << ": " << count << " nodes, " << doc.size() << " bytes in " <<
+		elapsed.count() << " ms\n";
+	if (inspector.GetErrorCode() != Xml::ErrorCode::None)
+		std::cout << "  error: " << inspector.GetErrorMessage() << "\n";
+}
+
+int main()
+{
+	const std::size_t count = 1 << 16;
+	Compare("ASCII letters", Range(0x61, 0x7A, count));
+	Compare("Cyrillic", Range(0x410, 0x44F, count));
+	Compare("CJK", Range(0x4E00, 0x9FFF, count));
+	Compare("Whole BMP", Range(0, 0xFFFF, count));
+
+	ParseNames("Parse ASCII names", "element");
+	ParseNames("Parse Cyrillic names", "\xD1\x8D\xD0\xBB\xD0\xB5\xD0\xBC\xD0\xB5\xD0\xBD\xD1\x82");
+	ParseNames("Parse CJK names", "\xE8\xA6\x81\xE7\xB4\xA0\xE5\x90\x8D");
+
+	return EXIT_SUCCESS;
+}
@@ -5,12 +5,16 @@
 #include <cstring>
 #include <string>
 #include <streambuf>
+#include <sstream>
 #include <fstream>
 #include <cstddef>
 #include <algorithm>
 #include <list>
+#include <vector>
 #include <cassert>
 #include <stdexcept>
+#include <cstdio>
+#include <cctype>
 
 class MemBuf : public std::streambuf
 {
@@ -22,6 +26,18 @@ public:
 	}
 };
 
+// Characters writer without the WriteCharacters method.
+class PlainUtf32Writer
+{
+public:
+	typedef std::u32string StringType;
+
+	static void WriteCharacter(StringType& stringDestination, char32_t codePoint)
+	{
+		stringDestination.push_back(codePoint);
+	}
+};
+
 static bool IsBigEndian()
 {
 	char32_t value = 0xAABBCCDD;
@@ -43,6 +59,9 @@ public:
 		Utf32BEStreamReaderTest();
 		Utf32LEStreamReaderTest();
 		Utf8IteratorsReaderTest();
+		ReadCharactersTest();
+		Utf8BlockDecodingTest();
+		Utf16BlockDecodingTest();
 		Utf8WriterTest();
 		Utf16WriterTest();
 		Utf32WriterTest();
@@ -166,7 +185,34 @@ public:
 		Windows1256Test();
 		Windows1257Test();
 		Windows1258Test();
+		SingleByteBlockDecodingTest();
 		TwoRootsTest();
+		MappedFileTest();
+		ContiguousIteratorsTest();
+		AsciiRunsTest();
+		BoundReaderTest();
+		FeedTest();
+		ReadAheadTest();
+#if !defined(_WIN32)
+		UringFileTest();
+#endif
+#if defined(XML_INSPECTOR_ZLIB)
+		GzipTest();
+		ParallelGzipTest();
+#endif
+#if !defined(_WIN32)
+		FdTest();
+		DirectFileTest();
+#endif
+		ByteOffsetTest();
+		LazyPositionsTest();
+		EncodingSniffTest();
+		CharsetNamesTest();
+		TextRunTest();
+		TerminatorRunTest();
+		AttributeValueRunTest();
+		BytesRunTest();
+		ValueViewTest();
 
 		std::cout << "--END TEST--\n";
 	}
@@ -339,6 +385,231 @@ public:
 		std::cout << "OK\n";
 	}
 
+	void ReadCharactersTest()
+	{
+		std::cout << "Read characters block test... ";
+
+		// Invalid byte (0xFF) after 4 characters.
+		char source[] = u8"ab\U000000A2\U00024B62\xFFgh";
+		MemBuf buf(source, sizeof(source) - 1);
+		std::istream is(&buf);
+
+		Xml::Encoding::Utf8StreamReader reader(&is);
+		char32_t block[8];
+		int result;
+		std::size_t count = reader.ReadCharacters(block, 3, result);
+
+		assert(count == 3);
+		assert(result == 1);
+		assert(block[0] == U'a' && block[1] == U'b' && block[2] == 0xA2);
+
+		count = reader.ReadCharacters(block, 8, result);
+
+		assert(count == 1);
+		assert(result == -1);
+		assert(block[0] == 0x24B62);
+
+		std::string source2 = u8"abc";
+		Xml::Encoding::Utf8IteratorsReader<std::string::const_iterator> reader2(
+			source2.cbegin(), source2.cend());
+		count = reader2.ReadCharacters(block, 8, result);
+
+		assert(count == 3);
+		assert(result == 0);
+		assert(block[0] == U'a' && block[1] == U'b' && block[2] == U'c');
+
+		// Document longer than the Inspector buffer,
+		// with CR LF pairs on the buffer boundaries.
+		std::string docString = u8"<root>";
+		std::string text;
+		for (int i = 0; i < 1500; ++i)
+			text += u8"ab\r\n";
+		docString += text;
+		docString += u8"</root>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(
+			docString.begin(), docString.end());
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue().size() == 1500 * 3);
+		for (std::string::size_type i = 0; i < inspector.GetValue().size(); i += 3)
+			assert(inspector.GetValue().compare(i, 3, u8"ab\n") == 0);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(inspector.GetRow() == 1501);
+		assert(inspector.GetColumn() == 1);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		std::cout << "OK\n";
+	}
+
+	void Utf8BlockDecodingTest()
+	{
+		std::cout << "UTF-8 block decoding test... ";
+
+		// Valid, invalid and incomplete sequences mixed together.
+		const char* fragments[] =
+		{
+			"abcdefghijklmnopqrstuvwxyz", "<root attr=\"value\">", " ", "\t", "\n", "\r\n",
+			"\xC2\xA2", "\xE2\x82\xAC", "\xF0\xA4\xAD\xA2", "\xEF\xBF\xBD",
+			"\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xEF\xBF\xBE", "\xF4\x90\x80\x80",
+			"\xC2", "\xE2\x82", "\xF0\xA4\xAD", "\x80", "\xFF", "\x01", "\x7F",
+			"0123456789012345678901234567890123456789"
+		};
+		const std::size_t fragmentsCount = sizeof(fragments) / sizeof(fragments[0]);
+		const std::size_t capacities[] = { 1, 3, 16, 17, 1000 };
+
+		unsigned int seed = 12345;
+		for (int test = 0; test < 500; ++test)
+		{
+			std::string doc;
+			seed = seed * 1103515245 + 12345;
+			unsigned int fragmentsInDoc = 1 + (seed >> 16) % 80;
+			for (unsigned int i = 0; i < fragmentsInDoc; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				// Prefer the valid fragments.
+				std::size_t index = (seed >> 16) % (fragmentsCount * 4);
+				doc += fragments[index < fragmentsCount ? index : index % 10];
+			}
+
+			std::u32string expected;
+			int expectedResult;
+			char32_t c;
+			Xml::Encoding::Utf8IteratorsReader<std::string::const_iterator> reference(
+				doc.cbegin(), doc.cend());
+			while ((expectedResult = reference.ReadCharacter(c)) == 1)
+				expected.push_back(c);
+
+			for (std::size_t capacity : capacities)
+			{
+				char32_t block[1000];
+				int result;
+
+				std::u32string decoded;
+				Xml::Encoding::Utf8IteratorsReader<const char*> reader(
+					doc.data(), doc.data() + doc.size());
+				do
+				{
+					std::size_t count = reader.ReadCharacters(block, capacity, result);
+					decoded.append(block, count);
+				} while (result == 1);
+
+				assert(decoded == expected);
+				assert(result == expectedResult);
+
+				decoded.clear();
+				MemBuf buf(&doc[0], doc.size());
+				std::istream is(&buf);
+				Xml::Encoding::Utf8StreamReader streamReader(&is);
+				do
+				{
+					std::size_t count = streamReader.ReadCharacters(block, capacity, result);
+					decoded.append(block, count);
+				} while (result == 1);
+
+				assert(decoded == expected);
+				assert(result == expectedResult);
+			}
+		}
+
+		std::cout << "OK\n";
+	}
+
+	void Utf16BlockDecodingTest()
+	{
+		std::cout << "UTF-16 block decoding test... ";
+
+		// Valid, invalid and incomplete code units sequences mixed together.
+		const std::u16string fragments[] =
+		{
+			u"abcdefghijklmnopqrstuvwxyz", u"<root attr=\"value\">", u" ", u"\t", u"\n", u"\r\n",
+			u"\U000000A2\U000020AC\U00000416", u"\U0000FFFD\U0000E000", u"\U00024B62", u"\U0010FFFF",
+			std::u16string(1, 0xD800), std::u16string(1, 0xDC00), std::u16string(2, 0xDC00),
+			std::u16string(1, 0xFFFE), std::u16string(1, 0x0001), std::u16string(1, 0xD7FF),
+			u"0123456789012345678901234567890123456789"
+		};
+		const std::size_t fragmentsCount = sizeof(fragments) / sizeof(fragments[0]);
+		const std::size_t capacities[] = { 1, 3, 8, 9, 1000 };
+
+		unsigned int seed = 54321;
+		for (int test = 0; test < 500; ++test)
+		{
+			std::u16string units;
+			seed = seed * 1103515245 + 12345;
+			unsigned int fragmentsInDoc = 1 + (seed >> 16) % 80;
+			for (unsigned int i = 0; i < fragmentsInDoc; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				// Prefer the valid fragments.
+				std::size_t index = (seed >> 16) % (fragmentsCount * 4);
+				units += fragments[index < fragmentsCount ? index : index % 10];
+			}
+
+			for (int bigEndian = 0; bigEndian < 2; ++bigEndian)
+			{
+				std::string doc;
+				for (char16_t unit : units)
+				{
+					char high = static_cast<char>(unit >> 8);
+					char low = static_cast<char>(unit & 0xFF);
+					doc += bigEndian ? high : low;
+					doc += bigEndian ? low : high;
+				}
+				// Sometimes odd number of bytes.
+				if (test % 3 == 0)
+					doc += 'a';
+
+				std::u32string expected;
+				int expectedResult;
+				char32_t c;
+				{
+					MemBuf buf(&doc[0], doc.size());
+					std::istream is(&buf);
+					if (bigEndian)
+					{
+						Xml::Encoding::Utf16BEStreamReader reference(&is);
+						while ((expectedResult = reference.ReadCharacter(c)) == 1)
+							expected.push_back(c);
+					}
+					else
+					{
+						Xml::Encoding::Utf16LEStreamReader reference(&is);
+						while ((expectedResult = reference.ReadCharacter(c)) == 1)
+							expected.push_back(c);
+					}
+				}
+
+				for (std::size_t capacity : capacities)
+				{
+					char32_t block[1000];
+					int result;
+					std::u32string decoded;
+					MemBuf buf(&doc[0], doc.size());
+					std::istream is(&buf);
+					Xml::Encoding::Utf16BEStreamReader readerBE(&is);
+					Xml::Encoding::Utf16LEStreamReader readerLE(&is);
+					Xml::Encoding::CharactersReader& reader = bigEndian ?
+						static_cast<Xml::Encoding::CharactersReader&>(readerBE) :
+						static_cast<Xml::Encoding::CharactersReader&>(readerLE);
+					do
+					{
+						std::size_t count = reader.ReadCharacters(block, capacity, result);
+						decoded.append(block, count);
+					} while (result == 1);
+
+					assert(decoded == expected);
+					assert(result == expectedResult);
+				}
+			}
+		}
+
+		std::cout << "OK\n";
+	}
+
 	void Utf8WriterTest()
 	{
 		std::cout << "UTF-8 final encoding test... ";
@@ -997,9 +1268,30 @@ public:
 		for (std::size_t i = 0; i < sizeof(notAllowed) / sizeof(char32_t); ++i)
 			assert(!Xml::Encoding::CharactersReader::IsNameStartChar(notAllowed[i]));
 
+		// Every character, so the bitmaps match the production.
+		for (char32_t c = 0; c <= 0x110000; ++c)
+			assert(Xml::Encoding::CharactersReader::IsNameStartChar(c) == NameStartCharProduction(c));
+
 		std::cout << "OK\n";
 	}
 
+	// NameStartChar production of the XML recommendation.
+	static bool NameStartCharProduction(char32_t c)
+	{
+		return (c == 0x3A || (c >= 0x41 && c <= 0x5A) || c == 0x5F || (c >= 0x61 && c <= 0x7A) ||
+			(c >= 0xC0 && c <= 0xD6) || (c >= 0xD8 && c <= 0xF6) || (c >= 0xF8 && c <= 0x2FF) ||
+			(c >= 0x370 && c <= 0x37D) || (c >= 0x37F && c <= 0x1FFF) || (c >= 0x200C && c <= 0x200D) ||
+			(c >= 0x2070 && c <= 0x218F) || (c >= 0x2C00 && c <= 0x2FEF) || (c >= 0x3001 && c <= 0xD7FF) ||
+			(c >= 0xF900 && c <= 0xFDCF) || (c >= 0xFDF0 && c <= 0xFFFD) || (c >= 0x10000 && c <= 0xEFFFF));
+	}
+
+	// NameChar production of the XML recommendation.
+	static bool NameCharProduction(char32_t c)
+	{
+		return (NameStartCharProduction(c) || c == 0x2D || c == 0x2E || (c >= 0x30 && c <= 0x39) ||
+			c == 0xB7 || (c >= 0x300 && c <= 0x36F) || (c >= 0x203F && c <= 0x2040));
+	}
+
 	void IsNameCharTest()
 	{
 		std::cout << "Is name char test... ";
@@ -1029,6 +1321,10 @@ public:
 			assert(!Xml::Encoding::CharactersReader::IsNameChar(notAllowed[i]));
 		}
 
+		// Every character, so the bitmaps match the production.
+		for (char32_t c = 0; c <= 0x110000; ++c)
+			assert(Xml::Encoding::CharactersReader::IsNameChar(c) == NameCharProduction(c));
+
 		std::cout << "OK\n";
 	}
 
@@ -6371,6 +6667,93 @@ public:
 		std::cout << "OK\n";
 	}
 
+	void SingleByteBlockDecodingTest()
+	{
+		std::cout << "Single byte block decoding test... ";
+
+		const char16_t* maps[] =
+		{
+			Xml::Encoding::ISO_8859_1_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_2_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_3_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_4_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_5_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_6_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_7_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_8_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_9_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_10_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_13_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_14_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_15_StreamReader::GetCharacterMap(),
+			Xml::Encoding::ISO_8859_16_StreamReader::GetCharacterMap(),
+			Xml::Encoding::TIS620StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows874StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1250StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1251StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1252StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1253StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1254StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1255StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1256StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1257StreamReader::GetCharacterMap(),
+			Xml::Encoding::Windows1258StreamReader::GetCharacterMap()
+		};
+		const std::size_t capacities[] = { 1, 7, 16, 1000 };
+
+		unsigned int seed = 98765;
+		for (const char16_t* map : maps)
+		{
+			for (int test = 0; test < 20; ++test)
+			{
+				// Mostly ASCII with some other bytes, sometimes not allowed ones.
+				std::string doc;
+				seed = seed * 1103515245 + 12345;
+				unsigned int length = (seed >> 16) % 2000;
+				for (unsigned int i = 0; i < length; ++i)
+				{
+					seed = seed * 1103515245 + 12345;
+					unsigned int value = (seed >> 16) % 4096;
+					if (value < 256 && (test % 2 == 0 || map[value] != 0))
+						doc += static_cast<char>(value);
+					else
+						doc += static_cast<char>(0x20 + value % 0x60);
+				}
+
+				std::u32string expected;
+				int expectedResult;
+				char32_t c;
+				{
+					MemBuf buf(&doc[0], doc.size());
+					std::istream is(&buf);
+					Xml::Encoding::SingleByteStreamReader reference(&is, map);
+					while ((expectedResult = reference.ReadCharacter(c)) == 1)
+						expected.push_back(c);
+				}
+
+				for (std::size_t capacity : capacities)
+				{
+					char32_t block[1000];
+					int result;
+					std::u32string decoded;
+					MemBuf buf(&doc[0], doc.size());
+					std::istream is(&buf);
+					Xml::Encoding::SingleByteStreamReader reader(&is, map);
+					do
+					{
+						std::size_t count = reader.ReadCharacters(block, capacity, result);
+						decoded.append(block, count);
+					} while (result == 1);
+
+					assert(decoded == expected);
+					assert(result == expectedResult);
+				}
+			}
+		}
+
+		std::cout << "OK\n";
+	}
+
 	void TwoRootsTest()
 	{
 		std::cout << "Two roots test... ";
@@ -6435,6 +6818,1992 @@ public:
 
 		std::cout << "OK\n";
 	}
+
+	void MappedFileTest()
+	{
+		std::cout << "Mapped file test... ";
+
+		const char* path = "mapped_test.xml";
+
+		// windows-1251 declared in XML declaration.
+		unsigned char source[] =
+			"<?xml version=\"1.0\" encoding=\"windows-1251\"?>\r\n<root a=\"\xC6\">\x88</root>";
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(reinterpret_cast<const char*>(source), sizeof(source) - 1);
+		}
+
+		Xml::MappedFile file(path);
+		assert(file.IsOpen());
+		assert(file.GetSize() == sizeof(source) - 1);
+
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&file);
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Whitespace);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetRow() == 2);
+		assert(inspector.GetAttributeAt(0).Value == u8"\U00000416");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == u8"\U000020AC");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// UTF-16 (little endian) with BOM.
+		unsigned char source2[] =
+		{
+			0xFF, 0xFE, 0x3C, 0x00, 0x61, 0x00, 0x3E, 0x00, 0xAC, 0x20,
+			0x3C, 0x00, 0x2F, 0x00, 0x61, 0x00, 0x3E, 0x00
+		};
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(reinterpret_cast<const char*>(source2), sizeof(source2));
+		}
+
+		assert(file.Open(path));
+		inspector.Reset(&file);
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetName() == u8"a");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == u8"\U000020AC");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Empty file.
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+		}
+
+		assert(file.Open(path));
+		assert(file.GetSize() == 0);
+		inspector.Reset(&file);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::NoElement);
+
+		inspector.Reset();
+		file.Close();
+		std::remove(path);
+
+		// File doesn't exist.
+		assert(!file.Open(path));
+		inspector.Reset(&file);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		std::cout << "OK\n";
+	}
+	void ContiguousIteratorsTest()
+	{
+		std::cout << "Contiguous iterators test... ";
+
+		static_assert(Xml::Details::IsContiguousIterator<const char*>::value, "");
+		static_assert(Xml::Details::IsContiguousIterator<unsigned char*>::value, "");
+		static_assert(Xml::Details::IsContiguousIterator<std::string::const_iterator>::value, "");
+		static_assert(Xml::Details::IsContiguousIterator<std::vector<char>::iterator>::value, "");
+		static_assert(!Xml::Details::IsContiguousIterator<std::list<char>::iterator>::value, "");
+		static_assert(!Xml::Details::IsContiguousIterator<const char16_t*>::value, "");
+
+		// windows-1251 declared in XML declaration.
+		std::string doc =
+			"<?xml version=\"1.0\" encoding=\"windows-1251\"?>\r\n<root a=\"\xC6\">\x88</root>";
+
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.cbegin(), doc.cend());
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Whitespace);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetRow() == 2);
+		assert(inspector.GetAttributeAt(0).Value == u8"\U00000416");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == u8"\U000020AC");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// UTF-16 (little endian) with BOM.
+		std::vector<unsigned char> doc2 =
+		{
+			0xFF, 0xFE, 0x3C, 0x00, 0x61, 0x00, 0x3E, 0x00, 0xAC, 0x20,
+			0x3C, 0x00, 0x2F, 0x00, 0x61, 0x00, 0x3E, 0x00
+		};
+		inspector.Reset(doc2.begin(), doc2.end());
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetName() == u8"a");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == u8"\U000020AC");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// UTF-8 with BOM.
+		std::vector<char> doc3 = { '\xEF', '\xBB', '\xBF', '<', 'a', '/', '>' };
+		inspector.Reset(doc3.begin(), doc3.end());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EmptyElementTag);
+		assert(inspector.GetName() == u8"a");
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Empty range.
+		std::string empty;
+		inspector.Reset(empty.begin(), empty.end());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::NoElement);
+
+		// Not contiguous iterators.
+		std::list<char> doc4(doc.begin(), doc.end());
+		inspector.Reset(doc4.begin(), doc4.end());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetAttributeAt(0).Value == u8"\U00000416");
+
+		std::cout << "OK\n";
+	}
+
+	template <typename TCharactersWriter>
+	void AsciiRunsTest(const std::string& doc, int count)
+	{
+		typedef typename TCharactersWriter::StringType StringType;
+
+		Xml::Inspector<TCharactersWriter> inspector(doc.begin(), doc.end());
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		for (int i = 0; i < count; ++i)
+		{
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::Whitespace);
+			assert(inspector.GetValue().size() == 2);
+
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+			assert(inspector.GetRow() == static_cast<std::size_t>(2 + 3 * i));
+			assert(inspector.GetColumn() == 2);
+			assert(inspector.GetLocalName().size() == 11);
+			assert(inspector.GetPrefix().size() == 2);
+			assert(inspector.GetAttributesCount() == 2);
+			assert(inspector.GetAttributeAt(0).Row == static_cast<std::size_t>(2 + 3 * i));
+			assert(inspector.GetAttributeAt(0).Column == 18);
+			StringType attrValue = inspector.GetAttributeAt(0).Value;
+			assert(attrValue.size() == 10);
+			assert(attrValue[5] == ' ' && attrValue[6] == '\'' && attrValue[9] == '>');
+			assert(inspector.GetAttributeAt(1).Column == 40);
+			assert(inspector.GetAttributeAt(1).Value.size() == 4);
+			assert(inspector.GetAttributeAt(1).Value[1] == '"');
+
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::Text);
+			StringType text = inspector.GetValue();
+			assert(text.size() == 30 + (sizeof(typename StringType::value_type) == 1 ? 1 : 0));
+			assert(text[10] == '&' && text[11] == ']' && text[12] == '>');
+			assert(text[20] == '\n' && text[21] == '\t' && text[22] == 'a');
+
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+			assert(inspector.GetRow() == static_cast<std::size_t>(4 + 3 * i));
+			assert(inspector.GetColumn() == 1);
+		}
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Whitespace);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+	}
+
+	void AsciiRunsTest()
+	{
+		std::cout << "ASCII runs test... ";
+
+		// Many elements, so the runs cross the characters buffer boundaries.
+		const int count = 400;
+		std::string doc = "<root xmlns:ns=\"http://example.com/\">";
+		for (int i = 0; i < count; ++i)
+		{
+			doc += "\r\n <ns:element_1.a attr=\"value\t'&amp;x>\" b='x\"yz'>";
+			doc += "some text &amp;]> simple\r\n\tabcdef\xC2\xA2\r\n</ns:element_1.a>";
+		}
+		doc += "\n</root>";
+
+		AsciiRunsTest<Xml::Encoding::Utf8Writer>(doc, count);
+		AsciiRunsTest<Xml::Encoding::Utf16Writer>(doc, count);
+		AsciiRunsTest<PlainUtf32Writer>(doc, count);
+
+		std::cout << "OK\n";
+	}
+	void BoundReaderTest()
+	{
+		std::cout << "Bound reader test... ";
+
+		std::string doc = "<root a=\"1\">text &amp; \xE2\x82\xAC</root>";
+
+		typedef Xml::Encoding::Utf8IteratorsReader<const char*> ReaderType;
+		ReaderType reader(doc.data(), doc.data() + doc.size());
+		Xml::Inspector<Xml::Encoding::Utf8Writer, ReaderType> inspector(&reader);
+
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetAttributeAt(0).Value == "1");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == "text & \xE2\x82\xAC");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Other sources still work.
+		inspector.Reset(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetColumn() == 1);
+
+		// Invalid byte.
+		std::string invalid = "<root>a\xFF</root>";
+		MemBuf buf(&invalid[0], invalid.size());
+		std::istream is(&buf);
+		Xml::Encoding::Utf8StreamReader streamReader(&is);
+		Xml::Inspector<Xml::Encoding::Utf16Writer, Xml::Encoding::Utf8StreamReader> inspector2(&streamReader);
+		assert(inspector2.Inspect());
+		assert(inspector2.GetInspected() == Xml::Inspected::StartTag);
+		assert(!inspector2.Inspect());
+		assert(inspector2.GetErrorCode() == Xml::ErrorCode::InvalidByteSequence);
+		assert(inspector2.GetRow() == 1);
+		assert(inspector2.GetColumn() == 8);
+
+		std::cout << "OK\n";
+	}
+	// Describes every node and the final error code. Document is fed
+	// by chunks of the specified size or parsed at once if chunkSize == 0.
+	std::string FeedNodes(const std::string& doc, std::size_t chunkSize)
+	{
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector;
+		std::string result;
+		std::size_t fed = 0;
+		bool finished = false;
+		if (chunkSize == 0)
+		{
+			inspector.Reset(doc.begin(), doc.end());
+		}
+		else
+		{
+			fed = std::min(chunkSize, doc.size());
+			inspector.Feed(doc.data(), fed);
+		}
+
+		while (true)
+		{
+			if (inspector.Inspect())
+			{
+				result += std::to_string(static_cast<int>(inspector.GetInspected())) + "|" +
+					inspector.GetName() + "|" + inspector.GetValue() + "|" +
+					inspector.GetLocalName() + "|" + inspector.GetPrefix() + "|" +
+					inspector.GetNamespaceUri() + "|" +
+					std::to_string(inspector.GetRow()) + ":" +
+					std::to_string(inspector.GetColumn()) + ":" +
+					std::to_string(inspector.GetDepth());
+				for (std::size_t i = 0; i < inspector.GetAttributesCount(); ++i)
+				{
+					const Xml::Inspector<Xml::Encoding::Utf8Writer>::AttributeType& attr =
+						inspector.GetAttributeAt(i);
+					result += "|" + attr.Name + "=" + attr.Value + "@" +
+						std::to_string(attr.Row) + ":" + std::to_string(attr.Column);
+				}
+				result += "\n";
+				continue;
+			}
+
+			if (inspector.GetErrorCode() != Xml::ErrorCode::NeedMoreData)
+				break;
+
+			assert(chunkSize != 0 && !finished);
+			assert(inspector.GetErrorMessage() != nullptr);
+			if (fed == doc.size())
+			{
+				inspector.FinishFeed();
+				finished = true;
+			}
+			else
+			{
+				std::size_t count = std::min(chunkSize, doc.size() - fed);
+				inspector.Feed(doc.data() + fed, count);
+				fed += count;
+			}
+		}
+
+		result += "Error " + std::to_string(static_cast<int>(inspector.GetErrorCode())) + " " +
+			std::to_string(inspector.GetRow()) + ":" + std::to_string(inspector.GetColumn());
+		return result;
+	}
+
+	void FeedTest()
+	{
+		std::cout << "Feed test... ";
+
+		std::vector<std::string> docs;
+		docs.push_back(
+			"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+			"<!DOCTYPE root [ <!ENTITY e \"x>y\"> <!ELEMENT root ANY> ] >\r\n"
+			"<!-- comment - with > inside -->\n"
+			"<?pi data > more ?>"
+			"<root xmlns=\"urn:a\" xmlns:p=\"urn:p\" a='1 > 0' p:b=\"\xE2\x82\xAC\">\r\n"
+			"\ttext &amp; &lt; &#x20AC; &unknown; \xF0\x9F\x98\x80 tail\r"
+			"<p:child/>"
+			"<![CDATA[ <not a tag> ]] ]]]>"
+			"<empty></empty>\r\n"
+			"</root>\n<!-- after -->\n");
+		docs.push_back("  <root/>  ");
+		docs.push_back("<!DOCTYPE root><root>a]b</root>");
+		docs.push_back(
+			"<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root a=\"\xC6\">\x88</root>");
+		docs.push_back("<root><a></root>");
+		docs.push_back("<root><a>text");
+		docs.push_back("<root attr=\"x");
+		docs.push_back("<root>text</root><second/>");
+		docs.push_back("<root>a\xFF</root>");
+		docs.push_back("");
+		docs.push_back(" \n");
+		docs.push_back("<");
+		// Entity reference leaves '<' of the next token unparsed.
+		docs.push_back("<r>&o;<a/></r>");
+		docs.push_back("<?l?><a>&f;<![CDATA[]]></a>");
+
+		std::string big = "<root>";
+		for (int i = 0; i < 2000; ++i)
+			big += "<item id=\"" + std::to_string(i) + "\">value " + std::to_string(i) + "</item>\n";
+		big += "</root>";
+		docs.push_back(big);
+
+		// UTF-16 (little endian) with BOM.
+		std::string ascii = "<root a=\"1\">text<b/>\xE9</root>";
+		std::string utf16 = "\xFF\xFE";
+		for (std::size_t i = 0; i < ascii.size(); ++i)
+		{
+			utf16 += ascii[i];
+			utf16 += '\0';
+		}
+		docs.push_back(utf16);
+
+		ascii = "<r>&o;<a/></r>";
+		utf16 = "\xFF\xFE";
+		for (std::size_t i = 0; i < ascii.size(); ++i)
+		{
+			utf16 += ascii[i];
+			utf16 += '\0';
+		}
+		docs.push_back(utf16);
+
+		// UTF-32 (big endian) with BOM.
+		ascii = "<?xml version=\"1.0\" encoding=\"UTF-32\"?><root>x<!--c--></root>";
+		std::string utf32("\x00\x00\xFE\xFF", 4);
+		for (std::size_t i = 0; i < ascii.size(); ++i)
+		{
+			utf32 += std::string(3, '\0');
+			utf32 += ascii[i];
+		}
+		docs.push_back(utf32);
+
+		const std::size_t chunkSizes[] = { 1, 2, 3, 5, 7, 16, 1000 };
+		for (std::size_t i = 0; i < docs.size(); ++i)
+		{
+			std::string expected = FeedNodes(docs[i], 0);
+			for (std::size_t j = 0; j < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++j)
+				assert(FeedNodes(docs[i], chunkSizes[j]) == expected);
+		}
+
+		// Tokens are inspected as soon as they are fed completely.
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector;
+		inspector.Feed("<ro", 3);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::NeedMoreData);
+		inspector.Feed("ot>te", 5);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::StartTag);
+		assert(inspector.GetName() == "root");
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::NeedMoreData);
+		inspector.Feed("xt</root", 8);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == "text");
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::NeedMoreData);
+		inspector.Feed(">", 1);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EndTag);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::NeedMoreData);
+		inspector.FinishFeed();
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Next document.
+		inspector.Feed("<a/>", 4);
+		inspector.FinishFeed();
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EmptyElementTag);
+		assert(inspector.GetName() == "a");
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Empty document finished without any fed bytes.
+		Xml::Inspector<Xml::Encoding::Utf8Writer> emptyInspector;
+		emptyInspector.FinishFeed();
+		assert(!emptyInspector.Inspect());
+		assert(emptyInspector.GetErrorCode() == Xml::ErrorCode::NoElement);
+
+		std::cout << "OK\n";
+	}
+	void ReadAheadTest()
+	{
+		std::cout << "Read-ahead test... ";
+
+		std::string doc = "<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root>";
+		for (int i = 0; i < 1000; ++i)
+			doc += "<item a=\"\xC6\">" + std::to_string(i) + "\x88</item>\n";
+		doc += "</root>";
+		std::string expected = FeedNodes(doc, 0);
+
+		const std::size_t blockSizes[] = { 1, 7, 4096, Xml::ReadAheadStream::DefaultBlockSize };
+		for (std::size_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); ++i)
+		{
+			std::istringstream source(doc);
+			Xml::ReadAheadStream stream(&source, blockSizes[i], 2 + i);
+			assert(stream.IsOpen());
+			assert(stream.GetBlockSize() == blockSizes[i]);
+			assert(stream.GetRingDepth() == 2 + i);
+
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+			std::size_t count = 0;
+			while (inspector.Inspect())
+			{
+				if (inspector.GetInspected() == Xml::Inspected::Text &&
+					inspector.GetValue() != "\n")
+				{
+					assert(inspector.GetValue() == std::to_string(count) + u8"\U000020AC");
+					++count;
+				}
+			}
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+			assert(count == 1000);
+			assert(stream.GetReadTime().count() >= 0);
+			assert(stream.GetWaitTime().count() >= 0);
+		}
+
+		// Stream destroyed before the end of the source.
+		{
+			std::istringstream source(doc);
+			Xml::ReadAheadStream stream(&source, 16, 2);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		}
+
+		// File.
+		const char* path = "read_ahead_test.xml";
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(doc.data(), doc.size());
+		}
+		{
+			Xml::ReadAheadStream stream(path, 100);
+			assert(stream.IsOpen());
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+			std::size_t count = 0;
+			while (inspector.Inspect())
+				++count;
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+			assert(count == 4004);
+		}
+		std::remove(path);
+
+		Xml::ReadAheadStream missing(std::string("read_ahead_missing.xml"));
+		assert(!missing.IsOpen());
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&missing);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		std::cout << "OK\n";
+	}
+#if !defined(_WIN32)
+	void UringFileTest()
+	{
+		std::cout << "io_uring file test... ";
+
+		std::string doc = "<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root>";
+		for (int i = 0; i < 1000; ++i)
+			doc += "<item a=\"\xC6\">" + std::to_string(i) + "\x88</item>\n";
+		doc += "</root>";
+
+		const char* path = "uring_test.xml";
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(doc.data(), doc.size());
+		}
+
+		const std::size_t blockSizes[] = { 1, 7, 4096, Xml::UringFileStream::DefaultBlockSize };
+		for (std::size_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); ++i)
+		{
+			for (int useUring = 0; useUring < 2; ++useUring)
+			{
+				Xml::UringFileStream stream(path, blockSizes[i], 1 + i, useUring != 0);
+				assert(stream.IsOpen());
+				assert(stream.GetBlockSize() == blockSizes[i]);
+				if (useUring == 0)
+					assert(!stream.IsUringUsed());
+
+				Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+				std::size_t count = 0;
+				while (inspector.Inspect())
+				{
+					if (inspector.GetInspected() == Xml::Inspected::Text &&
+						inspector.GetValue() != "\n")
+					{
+						assert(inspector.GetValue() == std::to_string(count) + u8"\U000020AC");
+						++count;
+					}
+				}
+				assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+				assert(count == 1000);
+			}
+		}
+
+		// Stream destroyed while reads are in flight.
+		{
+			Xml::UringFileStream stream(path, 16, 4);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		}
+		std::remove(path);
+
+		// Empty file.
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+		}
+		{
+			Xml::UringFileStream stream(path);
+			assert(stream.IsOpen());
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+			assert(!inspector.Inspect());
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::NoElement);
+		}
+		std::remove(path);
+
+		Xml::UringFileStream missing(std::string("uring_missing.xml"));
+		assert(!missing.IsOpen());
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&missing);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		std::cout << "OK\n";
+	}
+#endif
+#if defined(XML_INSPECTOR_ZLIB)
+	// Compresses the bytes as a single gzip member or zlib stream.
+	std::string Compress(const std::string& data, bool gzip)
+	{
+		z_stream deflater;
+		std::memset(&deflater, 0, sizeof(deflater));
+		int result = deflateInit2(&deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+			gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY);
+		assert(result == Z_OK);
+		std::string compressed(deflateBound(&deflater, static_cast<uLong>(data.size())), '\0');
+		deflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+		deflater.avail_in = static_cast<uInt>(data.size());
+		deflater.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+		deflater.avail_out = static_cast<uInt>(compressed.size());
+		result = deflate(&deflater, Z_FINISH);
+		assert(result == Z_STREAM_END);
+		compressed.resize(deflater.total_out);
+		deflateEnd(&deflater);
+		return compressed;
+	}
+
+	void GzipTest()
+	{
+		std::cout << "Gzip test... ";
+
+		std::string doc = "<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root>";
+		for (int i = 0; i < 20000; ++i)
+			doc += "<item a=\"\xC6\">" + std::to_string(i) + "\x88</item>\n";
+		doc += "</root>";
+
+		std::vector<std::string> sources;
+		sources.push_back(Compress(doc, true));
+		sources.push_back(Compress(doc, false));
+		// Concatenated gzip members.
+		sources.push_back(Compress(doc.substr(0, 1000), true) +
+			Compress(doc.substr(1000, 200000), true) +
+			Compress(std::string(), true) +
+			Compress(doc.substr(201000), true));
+
+		const char* path = "gzip_test.xml.gz";
+		for (std::size_t i = 0; i < sources.size() * 2; ++i)
+		{
+			std::istringstream source(sources[i / 2]);
+			std::unique_ptr<Xml::GzipStream> stream;
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector;
+			// Only gzip header is recognized by the path source.
+			if (i % 2 == 0 || i / 2 == 1)
+			{
+				stream.reset(new Xml::GzipStream(&source));
+				assert(stream->IsOpen());
+				inspector.Reset(stream.get());
+			}
+			else
+			{
+				// Recognized by the path source.
+				std::ofstream ofs(path, std::ofstream::binary);
+				ofs.write(sources[i / 2].data(), sources[i / 2].size());
+				ofs.close();
+				inspector.Reset(path);
+			}
+
+			std::size_t count = 0;
+			while (inspector.Inspect())
+			{
+				if (inspector.GetInspected() == Xml::Inspected::Text &&
+					inspector.GetValue() != "\n")
+				{
+					assert(inspector.GetValue() == std::to_string(count) + u8"\U000020AC");
+					++count;
+				}
+			}
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+			assert(count == 20000);
+		}
+
+		// Truncated data.
+		std::string truncated = sources[0].substr(0, sources[0].size() / 2);
+		std::istringstream source(truncated);
+		Xml::GzipStream stream(&source);
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+		while (inspector.Inspect())
+			;
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(truncated.data(), truncated.size());
+		}
+		inspector.Reset(path);
+		while (inspector.Inspect())
+			;
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		// Path source still reads not compressed files.
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(doc.data(), doc.size());
+		}
+		inspector.Reset(path);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		std::remove(path);
+
+		Xml::GzipStream missing("gzip_missing.xml.gz");
+		assert(!missing.IsOpen());
+
+		std::cout << "OK\n";
+	}
+
+	// Compresses the bytes as BGZF: gzip members of up to 64 KiB of input
+	// with the member size in the "BC" extra subfield, and the end marker.
+	std::string CompressBgzf(const std::string& data, std::size_t blockSize)
+	{
+		std::string compressed;
+		for (std::size_t offset = 0; ; offset += blockSize)
+		{
+			std::string block = offset < data.size() ? data.substr(offset, blockSize) : std::string();
+			z_stream deflater;
+			std::memset(&deflater, 0, sizeof(deflater));
+			int result = deflateInit2(&deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				15 + 16, 8, Z_DEFAULT_STRATEGY);
+			assert(result == Z_OK);
+			unsigned char extra[6] = { 'B', 'C', 2, 0, 0, 0 };
+			gz_header header;
+			std::memset(&header, 0, sizeof(header));
+			header.extra = extra;
+			header.extra_len = sizeof(extra);
+			header.os = 255;
+			result = deflateSetHeader(&deflater, &header);
+			assert(result == Z_OK);
+			std::string member(deflateBound(&deflater, static_cast<uLong>(block.size())) + 64, '\0');
+			deflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+			deflater.avail_in = static_cast<uInt>(block.size());
+			deflater.next_out = reinterpret_cast<Bytef*>(&member[0]);
+			deflater.avail_out = static_cast<uInt>(member.size());
+			result = deflate(&deflater, Z_FINISH);
+			assert(result == Z_STREAM_END);
+			member.resize(deflater.total_out);
+			deflateEnd(&deflater);
+			member[16] = static_cast<char>((member.size() - 1) & 0xFF);
+			member[17] = static_cast<char>((member.size() - 1) >> 8);
+			compressed += member;
+			if (block.empty())
+				break;
+		}
+		return compressed;
+	}
+
+	void ParallelGzipTest()
+	{
+		std::cout << "Parallel gzip test... ";
+
+		std::string doc = "<?xml version=\"1.0\"?>\n<root>";
+		for (int i = 0; i < 30000; ++i)
+			doc += "<item>" + std::to_string(i) + "</item>\n";
+		doc += "</root>";
+
+		std::vector<std::string> sources;
+		sources.push_back(CompressBgzf(doc, 65280));
+		sources.push_back(CompressBgzf(doc, 1000));
+		// Not BGZF.
+		sources.push_back(Compress(doc, true));
+		// BGZF members followed by ordinary gzip members.
+		std::string bgzf = CompressBgzf(doc.substr(0, 100000), 4096);
+		sources.push_back(bgzf.substr(0, bgzf.size() - 28) +
+			Compress(doc.substr(100000, 100000), true) +
+			Compress(doc.substr(200000), true));
+
+		std::size_t threads[] = { 1, 2, 4 };
+		for (std::size_t i = 0; i < sources.size(); ++i)
+		{
+			for (std::size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+			{
+				std::istringstream source(sources[i]);
+				Xml::ParallelGzipStream stream(&source, threads[t], t + 1);
+				assert(stream.IsOpen());
+				Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+
+				std::size_t count = 0;
+				while (inspector.Inspect())
+				{
+					if (inspector.GetInspected() == Xml::Inspected::Text &&
+						inspector.GetValue() != "\n")
+					{
+						assert(inspector.GetValue() == std::to_string(count));
+						++count;
+					}
+				}
+				assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+				assert(count == 30000);
+			}
+		}
+
+		// Corrupted member in the middle.
+		std::string corrupted = sources[1];
+		corrupted[corrupted.size() / 2] ^= 0x55;
+		std::istringstream corruptedSource(corrupted);
+		Xml::ParallelGzipStream corruptedStream(&corruptedSource, 4);
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&corruptedStream);
+		while (inspector.Inspect())
+			;
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		// Truncated member.
+		std::string truncated = sources[0].substr(0, sources[0].size() / 2);
+		std::istringstream truncatedSource(truncated);
+		Xml::ParallelGzipStream truncatedStream(&truncatedSource, 4);
+		inspector.Reset(&truncatedStream);
+		while (inspector.Inspect())
+			;
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+
+		// Destroyed before the end of the data.
+		{
+			std::istringstream source(sources[1]);
+			Xml::ParallelGzipStream stream(&source, 4);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> partial(&stream);
+			for (int i = 0; i < 100; ++i)
+				assert(partial.Inspect());
+		}
+
+		const char* path = "parallel_gzip_test.xml.gz";
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(sources[0].data(), sources[0].size());
+		}
+		Xml::ParallelGzipStream file(path);
+		assert(file.IsOpen());
+		assert(file.GetThreadsCount() > 0);
+		inspector.Reset(&file);
+		std::size_t count = 0;
+		while (inspector.Inspect())
+			++count;
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+		assert(count > 60000);
+		std::remove(path);
+
+		Xml::ParallelGzipStream missing("parallel_gzip_missing.xml.gz");
+		assert(!missing.IsOpen());
+
+		std::cout << "OK\n";
+	}
+#endif
+
+#if !defined(_WIN32)
+	void FdTest()
+	{
+		std::cout << "File descriptor test... ";
+
+		std::string doc = "<?xml version=\"1.0\"?>\n<root>";
+		for (int i = 0; i < 5000; ++i)
+			doc += "<item a=\"\xE2\x82\xAC\">" + std::to_string(i) + "\xF0\x9F\x98\x80</item>\n";
+		doc += "</root>";
+
+		// Pipe written in small pieces, so characters are split between reads.
+		const std::size_t bufferSizes[] = { 1, 5, 7, 4096, Xml::Inspector<Xml::Encoding::Utf8Writer>::DefaultFdBufferSize };
+		for (std::size_t i = 0; i < sizeof(bufferSizes) / sizeof(bufferSizes[0]); ++i)
+		{
+			int fds[2];
+			assert(pipe(fds) == 0);
+			std::thread writer([&]()
+			{
+				for (std::size_t offset = 0; offset < doc.size(); offset += 3 + offset % 5)
+				{
+					std::size_t size = std::min<std::size_t>(3 + offset % 5, doc.size() - offset);
+					ssize_t written = write(fds[1], doc.data() + offset, size);
+					assert(written == static_cast<ssize_t>(size));
+					(void)written;
+				}
+				close(fds[1]);
+			});
+
+			Xml::FileDescriptor fd(fds[0]);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(fd, bufferSizes[i]);
+			std::size_t count = 0;
+			while (inspector.Inspect())
+			{
+				if (inspector.GetInspected() == Xml::Inspected::StartTag &&
+					inspector.HasAttributes())
+				{
+					assert(inspector.GetAttributeAt(0).Value == u8"\u20AC");
+				}
+				else if (inspector.GetInspected() == Xml::Inspected::Text &&
+					inspector.GetValue() != "\n")
+				{
+					assert(inspector.GetValue() == std::to_string(count) + u8"\U0001F600");
+					++count;
+				}
+			}
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+			assert(count == 5000);
+			writer.join();
+			close(fds[0]);
+		}
+
+		// File with the encoding declaration.
+		std::string declared = "<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root>\xC6\x88</root>";
+		// UTF-16 with BOM.
+		std::string utf16("\xFF\xFE", 2);
+		const char* utf16Doc = "<root>\xC6</root>";
+		for (const char* c = utf16Doc; *c != '\0'; ++c)
+		{
+			utf16 += *c;
+			utf16 += '\0';
+		}
+		// Truncated UTF-8 character at the end.
+		std::string truncated = "<root>\xE2\x82";
+
+		const char* path = "fd_test.xml";
+		std::string sources[] = { declared, utf16, truncated };
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			{
+				std::ofstream ofs(path, std::ofstream::binary);
+				ofs.write(sources[i].data(), sources[i].size());
+			}
+			int fd = open(path, O_RDONLY);
+			assert(fd >= 0);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector;
+			inspector.Reset(Xml::FileDescriptor(fd), 8);
+			while (inspector.Inspect())
+			{
+				if (inspector.GetInspected() == Xml::Inspected::Text)
+				{
+					if (i == 0)
+						assert(inspector.GetValue() == u8"\u0416\u20AC");
+					else
+						assert(inspector.GetValue() == u8"\u00C6");
+				}
+			}
+			if (i < 2)
+				assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+			else
+				assert(inspector.GetErrorCode() == Xml::ErrorCode::InvalidByteSequence);
+			close(fd);
+		}
+		std::remove(path);
+
+		// Descriptor which can't be read.
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(Xml::FileDescriptor(-1));
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+		int fds[2];
+		assert(pipe(fds) == 0);
+		inspector.Reset(Xml::FileDescriptor(fds[1]));
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::StreamError);
+		close(fds[0]);
+		close(fds[1]);
+
+		std::cout << "OK\n";
+	}
+
+	void DirectFileTest()
+	{
+		std::cout << "Direct file test... ";
+
+		const char* path = "direct_test.xml";
+
+		// Unaligned tails.
+		const std::size_t sizes[] = { 0, 1, 4095, 4096, 4097, 3 * 4096 + 17 };
+		for (std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+		{
+			std::string bytes;
+			for (std::size_t j = 0; j < sizes[i]; ++j)
+				bytes += static_cast<char>('a' + j % 26);
+			{
+				std::ofstream ofs(path, std::ofstream::binary);
+				ofs.write(bytes.data(), bytes.size());
+			}
+			for (int useDirect = 0; useDirect < 2; ++useDirect)
+			{
+				Xml::DirectFileStream stream(path, 4096, useDirect != 0);
+				assert(stream.IsOpen());
+				if (useDirect == 0)
+					assert(!stream.IsDirect());
+				std::string read((std::istreambuf_iterator<char>(stream)),
+					std::istreambuf_iterator<char>());
+				assert(read == bytes);
+			}
+		}
+
+		std::string doc = "<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root>";
+		for (int i = 0; i < 3000; ++i)
+			doc += "<item a=\"\xC6\">" + std::to_string(i) + "\x88</item>\n";
+		doc += "</root>";
+		{
+			std::ofstream ofs(path, std::ofstream::binary);
+			ofs.write(doc.data(), doc.size());
+		}
+
+		const std::size_t blockSizes[] = { 1, 8192, Xml::DirectFileStream::DefaultBlockSize };
+		for (std::size_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); ++i)
+		{
+			for (int useDirect = 0; useDirect < 2; ++useDirect)
+			{
+				Xml::DirectFileStream stream(path, blockSizes[i], useDirect != 0);
+				assert(stream.IsOpen());
+				assert(stream.GetBlockSize() % 4096 == 0);
+				assert(stream.GetBlockSize() >= blockSizes[i]);
+
+				Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(&stream);
+				std::size_t count = 0;
+				while (inspector.Inspect())
+				{
+					if (inspector.GetInspected() == Xml::Inspected::Text &&
+						inspector.GetValue() != "\n")
+					{
+						assert(inspector.GetValue() == std::to_string(count) + u8"\u20AC");
+						++count;
+					}
+				}
+				assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+				assert(count == 3000);
+			}
+		}
+		std::remove(path);
+
+		Xml::DirectFileStream missing("direct_missing.xml");
+		assert(!missing.IsOpen());
+
+		std::cout << "OK\n";
+	}
+#endif
+
+	// Encodes the code points in UTF-8, UTF-16LE or UTF-32BE with BOM.
+	std::string EncodeWithBom(const std::u32string& text, int unitSize)
+	{
+		std::string bytes;
+		if (unitSize == 1)
+			bytes = "\xEF\xBB\xBF";
+		else if (unitSize == 2)
+			bytes = std::string("\xFF\xFE", 2);
+		else
+			bytes = std::string("\x00\x00\xFE\xFF", 4);
+		for (std::size_t i = 0; i < text.size(); ++i)
+		{
+			char32_t c = text[i];
+			if (unitSize == 1)
+			{
+				if (c < 0x80)
+					bytes += static_cast<char>(c);
+				else if (c < 0x800)
+				{
+					bytes += static_cast<char>(0xC0 | (c >> 6));
+					bytes += static_cast<char>(0x80 | (c & 0x3F));
+				}
+				else if (c < 0x10000)
+				{
+					bytes += static_cast<char>(0xE0 | (c >> 12));
+					bytes += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					bytes += static_cast<char>(0x80 | (c & 0x3F));
+				}
+				else
+				{
+					bytes += static_cast<char>(0xF0 | (c >> 18));
+					bytes += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+					bytes += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					bytes += static_cast<char>(0x80 | (c & 0x3F));
+				}
+			}
+			else if (unitSize == 2)
+			{
+				char32_t units[2] = { c, 0 };
+				if (c > 0xFFFF)
+				{
+					units[0] = 0xD800 + ((c - 0x10000) >> 10);
+					units[1] = 0xDC00 + ((c - 0x10000) & 0x3FF);
+				}
+				for (std::size_t j = 0; j < 2 && units[j] != 0; ++j)
+				{
+					bytes += static_cast<char>(units[j] & 0xFF);
+					bytes += static_cast<char>(units[j] >> 8);
+				}
+			}
+			else
+			{
+				bytes += static_cast<char>(c >> 24);
+				bytes += static_cast<char>((c >> 16) & 0xFF);
+				bytes += static_cast<char>((c >> 8) & 0xFF);
+				bytes += static_cast<char>(c & 0xFF);
+			}
+		}
+		return bytes;
+	}
+
+	void ByteOffsetTest()
+	{
+		std::cout << "Byte offset test... ";
+
+		std::u32string text = U"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+			U"<!DOCTYPE r [ <!ENTITY e \"x\"> ]>\r"
+			U"<r \u00E9t\u00E9=\"\U0001F600\" b=\'1\'>\r\n"
+			U"  <a>\u0416&amp;\u20AC\r\U0001F600</a>&e;\u0416&e;&e;<![CDATA[\u20AC]]>"
+			U"<!--\u00E9--><?pi \u00E9?>\n<b/>\r\n"
+			U"</r>\n";
+
+		for (int unitSize = 1; unitSize <= 4; unitSize *= 2)
+		{
+			std::u32string source = text;
+			if (unitSize == 2)
+				source.replace(source.find(U"UTF-8"), 5, U"UTF-16");
+			else if (unitSize == 4)
+				source.replace(source.find(U"UTF-8"), 5, U"UTF-32");
+			std::string doc = EncodeWithBom(source, unitSize);
+			std::size_t bomSize = (unitSize == 1) ? 3 : unitSize;
+
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+			Xml::Inspector<Xml::Encoding::Utf8Writer>::SizeType end = bomSize;
+			std::size_t count = 0;
+			while (inspector.Inspect())
+			{
+				// Nodes cover the whole document one by one.
+				assert(inspector.GetByteOffset() == end);
+				assert(inspector.GetEndByteOffset() > inspector.GetByteOffset());
+				end = inspector.GetEndByteOffset();
+				++count;
+
+				if (inspector.GetInspected() == Xml::Inspected::StartTag &&
+					inspector.GetName() == "r")
+				{
+					// \u00E9t\u00E9 starts 3 characters after '<'.
+					std::size_t offset = static_cast<std::size_t>(inspector.GetByteOffset());
+					assert(inspector.GetAttributeAt(0).ByteOffset == offset + 3 * unitSize);
+					// Both \u00E9 take 2 bytes in UTF-8, \U0001F600 takes 4 bytes in every encoding.
+					std::size_t nameSize = (unitSize == 1) ? 5 : 3 * unitSize;
+					assert(inspector.GetAttributeAt(1).ByteOffset ==
+						offset + 3 * unitSize + nameSize + 4 * unitSize + 4);
+				}
+				else if (inspector.GetInspected() == Xml::Inspected::XmlDeclaration)
+				{
+					assert(inspector.GetAttributeAt(0).ByteOffset == bomSize + 6 * unitSize);
+				}
+			}
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+			assert(count == 21);
+			assert(end == doc.size());
+		}
+
+		// Single-byte encoding.
+		std::string doc = "<?xml version=\"1.0\" encoding=\"windows-1251\"?>\r\n<r a=\"\xC6\">\xC6\x88</r>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+		while (inspector.Inspect())
+		{
+			std::size_t first = static_cast<std::size_t>(inspector.GetByteOffset());
+			std::size_t last = static_cast<std::size_t>(inspector.GetEndByteOffset());
+			if (inspector.GetInspected() == Xml::Inspected::StartTag)
+				assert(doc.substr(first, last - first) == "<r a=\"\xC6\">");
+			else if (inspector.GetInspected() == Xml::Inspected::Text)
+				assert(doc.substr(first, last - first) == "\xC6\x88");
+			else if (inspector.GetInspected() == Xml::Inspected::EndTag)
+				assert(doc.substr(first, last - first) == "</r>" && last == doc.size());
+		}
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		std::cout << "OK\n";
+	}
+
+	// Parses the document and returns the inspected nodes.
+	template <typename TPositionPolicy>
+	std::string InspectAll(const std::string& doc, Xml::ErrorCode& err,
+		std::uint_least64_t& row, std::uint_least64_t& column)
+	{
+		Xml::Inspector<Xml::Encoding::Utf8Writer,
+			Xml::Encoding::CharactersReader, TPositionPolicy> inspector(doc.begin(), doc.end());
+		std::string nodes;
+		while (inspector.Inspect())
+		{
+			nodes += std::to_string(static_cast<int>(inspector.GetInspected())) +
+				inspector.GetName() + "=" + inspector.GetValue() +
+				"@" + std::to_string(inspector.GetRow()) + ":" + std::to_string(inspector.GetColumn()) + ";";
+			for (std::size_t i = 0; i < inspector.GetAttributesCount(); ++i)
+				nodes += inspector.GetAttributeAt(i).Name + "=" + inspector.GetAttributeAt(i).Value + ";";
+		}
+		err = inspector.GetErrorCode();
+		row = inspector.GetRow();
+		column = inspector.GetColumn();
+		return nodes;
+	}
+
+	void LazyPositionsTest()
+	{
+		std::cout << "Lazy positions test... ";
+
+		std::string longText;
+		for (int i = 0; i < 300; ++i)
+			longText += "a\r\nb\rc\n\xE2\x82\xAC";
+
+		// Errors are reported at the character at which they are detected,
+		// at the start of the token or at the start of the reference. Positions
+		// saved before the end of the characters buffer are checked too.
+		const std::string docs[] =
+		{
+			"<root>\r\n  <a x=\"1\">text</a>\r<b/>\n</root>\r\n",
+			"<root>" + longText + "</root>" + longText.substr(0, 9),
+			"<root>" + longText + "<a>\xFF</a></root>",
+			"<root>\r\r\n\r<a>\r\xC0",
+			"<root>" + longText + "<\x01",
+			"\xEF\xBB\xBF<?xml version=\"1.0\"?>\r\n<root>" + longText + "</root>\r\n\r\n",
+			"<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\r\n<root>\xE9\r\n\x01</root>",
+			"<root>" + longText + "\r",
+			"<root>" + longText + "<a>" + longText,
+			"<root>" + longText + "<a:b/></root>",
+			"<root>" + longText + "<a b:c=\"1\"/></root>",
+			"<root>" + longText + "<xmlns:a/></root>",
+			"<root " + longText + " a=\"1\" a=\"1\"/>",
+			"<root>" + longText + "<a:1/></root>",
+			"<root>" + longText + "</1a></root>",
+			"<root>" + longText + "</a></root>",
+			"<root>" + longText + "<!-- a -- b --></root>",
+			"<root>" + longText + "<![CDATA[abc",
+			"<root>" + longText + "]]></root>",
+			"<root>" + longText + "&#0;</root>",
+			"<root>" + longText + "&#12a;</root>",
+			"<root>" + longText + "&unknown;<a/></root>",
+			"<root>" + longText + "<a x=\"&#0;\"/></root>",
+			"<root>" + longText + "<a x=\"&b\"/></root>",
+			"<root/>\r\n<![CDATA[x]]>",
+			"<root>" + longText + "<?xml version=\"1.0\"?></root>",
+			"<?xml version=\"1.0\" encoding=\"unknown\"?><root/>",
+			"<root>" + std::string(1022, 'a') + "&#0;</root>",
+			"<root>" + std::string(1021, 'a') + "\r\n&#0;</root>",
+			"<root>" + std::string(1019, 'a') + "<a:1/></root>",
+			"<root>" + std::string(1017, 'a') + "</1a></root>",
+			"<root>" + std::string(1017, 'a') + "<!-- -- --></root>"
+		};
+
+		for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+		{
+			Xml::ErrorCode trackedError;
+			Xml::ErrorCode lazyError;
+			std::uint_least64_t trackedRow;
+			std::uint_least64_t trackedColumn;
+			std::uint_least64_t lazyRow;
+			std::uint_least64_t lazyColumn;
+			std::string tracked = InspectAll<Xml::TrackedPositions>(docs[i],
+				trackedError, trackedRow, trackedColumn);
+			std::string lazy = InspectAll<Xml::LazyPositions>(docs[i],
+				lazyError, lazyRow, lazyColumn);
+			assert(tracked == lazy);
+			assert(trackedError == lazyError);
+			assert(trackedRow == lazyRow);
+			assert(trackedColumn == lazyColumn);
+		}
+
+		// Unclosed tag is reported at its start tag.
+		Xml::ErrorCode err;
+		std::uint_least64_t row;
+		std::uint_least64_t column;
+		InspectAll<Xml::LazyPositions>("<root>" + longText + "\r", err, row, column);
+		assert(err == Xml::ErrorCode::UnclosedTag);
+		assert(row == 1);
+		assert(column == 1);
+
+		// Byte offsets aren't tracked.
+		std::string doc = "<root>\n<a x=\"1\"/></root>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer,
+			Xml::Encoding::CharactersReader, Xml::LazyPositions> inspector(doc.begin(), doc.end());
+		while (inspector.Inspect())
+		{
+			assert(inspector.GetByteOffset() == 0);
+			assert(inspector.GetEndByteOffset() == 0);
+		}
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+		assert(inspector.GetRow() == 2);
+		assert(inspector.GetColumn() == 18);
+
+		// Position of the previous document isn't reported for the next one.
+		inspector.Reset(doc.begin(), doc.end());
+		assert(inspector.GetRow() == 0);
+		assert(inspector.Inspect());
+
+		// Nor if the previous document is reset in the middle.
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		inspector.Reset(doc.begin(), doc.end());
+		assert(inspector.GetRow() == 0);
+		assert(inspector.GetColumn() == 0);
+		assert(inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+		inspector.Reset();
+		assert(inspector.GetRow() == 0);
+		assert(inspector.GetColumn() == 0);
+
+		std::cout << "OK\n";
+	}
+
+	// Appends the inspected nodes, until Inspect method returns false.
+	void DumpNodes(Xml::Inspector<Xml::Encoding::Utf8Writer>& inspector, std::string& nodes)
+	{
+		while (inspector.Inspect())
+		{
+			nodes += std::to_string(static_cast<int>(inspector.GetInspected())) +
+				inspector.GetName() + "=" + inspector.GetValue() +
+				"@" + std::to_string(inspector.GetByteOffset()) + ";";
+			for (std::size_t i = 0; i < inspector.GetAttributesCount(); ++i)
+				nodes += inspector.GetAttributeAt(i).Name + "=" + inspector.GetAttributeAt(i).Value + ";";
+		}
+	}
+
+	// Appends the error and its position.
+	void DumpError(Xml::Inspector<Xml::Encoding::Utf8Writer>& inspector, std::string& nodes)
+	{
+		nodes += "error" + std::to_string(static_cast<int>(inspector.GetErrorCode())) +
+			"@" + std::to_string(inspector.GetRow()) + ":" + std::to_string(inspector.GetColumn());
+	}
+
+	void EncodingSniffTest()
+	{
+		std::cout << "Encoding sniff test... ";
+
+		std::string longText;
+		for (int i = 0; i < 200; ++i)
+			longText += "abc \x80\xC0\xFF\r\n";
+
+		const std::string docs[] =
+		{
+			"<?xml version=\"1.0\" encoding=\"windows-1251\"?>\n<root a=\"\xC0\xC1\">\xE0\xE1\xE2</root>",
+			"<?xml version='1.0' encoding='ISO-8859-2' standalone='yes'?><root>\xA1</root>",
+			"<?xml\tversion = \"1.0\"\r\n encoding\t=\t'Latin2' ?><root>\xA1</root>",
+			"<?xml version=\"1.0\" encoding=\"csISOLatin1\"?><root>\xE9\x01</root>",
+			"<?xml version=\"1.0\" encoding=\"windows-1252\"?><root>" + longText + "</root>",
+			"<?xml version=\"1.0\" encoding=\"UTF-16\"?><root/>",
+			"<?xml version=\"1.0\" encoding=\"unknown-1\"?><root/>",
+			"<?xml version=\"1.0\" encoding=\"windows-1251\" ?>\xC0<root/>",
+			"<?xml version=\"1.0\" encoding=\"UTF-8\"?><root>\xC3\xA9</root>",
+			"<?xml version=\"1.0\"?><root>\xC3\xA9</root>",
+			"<?xml-stylesheet href=\"a\"?><root>\xC3\xA9</root>",
+			"<?xml encoding=\"windows-1251\"?><root/>",
+			"<root>\xC3\xA9</root>",
+			"\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"windows-1251\"?><root/>"
+		};
+
+		Xml::Inspector<Xml::Encoding::Utf8Writer> reused;
+		for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+		{
+			// Stream source replaces the reader after the XML declaration.
+			std::string expected;
+			std::istringstream stream(docs[i]);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> streamInspector(&stream);
+			DumpNodes(streamInspector, expected);
+			DumpError(streamInspector, expected);
+
+			// Memory source chooses the reader before the first character.
+			std::string nodes;
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(docs[i].begin(), docs[i].end());
+			DumpNodes(inspector, nodes);
+			DumpError(inspector, nodes);
+			assert(nodes == expected);
+
+			// The same reader is reused for the next documents.
+			nodes.clear();
+			reused.Reset(docs[i].data(), docs[i].data() + docs[i].size());
+			DumpNodes(reused, nodes);
+			DumpError(reused, nodes);
+			assert(nodes == expected);
+
+			// Bytes fed one by one, so the declaration isn't complete at first.
+			nodes.clear();
+			Xml::Inspector<Xml::Encoding::Utf8Writer> feedInspector;
+			for (std::size_t j = 0; j < docs[i].size(); ++j)
+			{
+				feedInspector.Feed(docs[i].data() + j, 1);
+				DumpNodes(feedInspector, nodes);
+				if (feedInspector.GetErrorCode() != Xml::ErrorCode::NeedMoreData)
+					break;
+			}
+			feedInspector.FinishFeed();
+			DumpNodes(feedInspector, nodes);
+			DumpError(feedInspector, nodes);
+			assert(nodes == expected);
+
+#if !defined(_WIN32)
+			int fds[2];
+			assert(pipe(fds) == 0);
+			ssize_t written = write(fds[1], docs[i].data(), docs[i].size());
+			assert(written == static_cast<ssize_t>(docs[i].size()));
+			(void)written;
+			close(fds[1]);
+			nodes.clear();
+			Xml::FileDescriptor fd(fds[0]);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> fdInspector(fd);
+			DumpNodes(fdInspector, nodes);
+			DumpError(fdInspector, nodes);
+			close(fds[0]);
+			assert(nodes == expected);
+#endif
+		}
+
+		std::string doc = docs[0];
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetName() == "root");
+		assert(inspector.GetAttributeAt(0).Value == u8"\u0410\u0411");
+		assert(inspector.Inspect());
+		assert(inspector.GetValue() == u8"\u0430\u0431\u0432");
+		assert(inspector.GetByteOffset() == doc.size() - 10);
+
+		std::cout << "OK\n";
+	}
+
+	void CharsetNamesTest()
+	{
+		std::cout << "Charset names test... ";
+
+		struct Name
+		{
+			const char* Name;
+			Xml::Details::Charset Value;
+		};
+
+		static const Name names[] =
+		{
+			{ "UTF-8", Xml::Details::Charset::Utf8 },
+			{ "csUTF8", Xml::Details::Charset::Utf8 },
+			{ "UTF-16", Xml::Details::Charset::Utf16 },
+			{ "csUTF16", Xml::Details::Charset::Utf16 },
+			{ "UTF-16BE", Xml::Details::Charset::Utf16BE },
+			{ "csUTF16BE", Xml::Details::Charset::Utf16BE },
+			{ "UTF-16LE", Xml::Details::Charset::Utf16LE },
+			{ "csUTF16LE", Xml::Details::Charset::Utf16LE },
+			{ "UTF-32", Xml::Details::Charset::Utf32 },
+			{ "csUTF32", Xml::Details::Charset::Utf32 },
+			{ "UTF-32BE", Xml::Details::Charset::Utf32BE },
+			{ "csUTF32BE", Xml::Details::Charset::Utf32BE },
+			{ "UTF-32LE", Xml::Details::Charset::Utf32LE },
+			{ "csUTF32LE", Xml::Details::Charset::Utf32LE },
+			{ "ISO-8859-1", Xml::Details::Charset::ISO_8859_1 },
+			{ "iso-ir-100", Xml::Details::Charset::ISO_8859_1 },
+			{ "ISO_8859-1", Xml::Details::Charset::ISO_8859_1 },
+			{ "latin1", Xml::Details::Charset::ISO_8859_1 },
+			{ "l1", Xml::Details::Charset::ISO_8859_1 },
+			{ "IBM819", Xml::Details::Charset::ISO_8859_1 },
+			{ "CP819", Xml::Details::Charset::ISO_8859_1 },
+			{ "csISOLatin1", Xml::Details::Charset::ISO_8859_1 },
+			{ "ISO-8859-2", Xml::Details::Charset::ISO_8859_2 },
+			{ "iso-ir-101", Xml::Details::Charset::ISO_8859_2 },
+			{ "ISO_8859-2", Xml::Details::Charset::ISO_8859_2 },
+			{ "latin2", Xml::Details::Charset::ISO_8859_2 },
+			{ "l2", Xml::Details::Charset::ISO_8859_2 },
+			{ "csISOLatin2", Xml::Details::Charset::ISO_8859_2 },
+			{ "ISO-8859-3", Xml::Details::Charset::ISO_8859_3 },
+			{ "iso-ir-109", Xml::Details::Charset::ISO_8859_3 },
+			{ "ISO_8859-3", Xml::Details::Charset::ISO_8859_3 },
+			{ "latin3", Xml::Details::Charset::ISO_8859_3 },
+			{ "l3", Xml::Details::Charset::ISO_8859_3 },
+			{ "csISOLatin3", Xml::Details::Charset::ISO_8859_3 },
+			{ "ISO-8859-4", Xml::Details::Charset::ISO_8859_4 },
+			{ "iso-ir-110", Xml::Details::Charset::ISO_8859_4 },
+			{ "ISO_8859-4", Xml::Details::Charset::ISO_8859_4 },
+			{ "latin4", Xml::Details::Charset::ISO_8859_4 },
+			{ "l4", Xml::Details::Charset::ISO_8859_4 },
+			{ "csISOLatin4", Xml::Details::Charset::ISO_8859_4 },
+			{ "ISO-8859-5", Xml::Details::Charset::ISO_8859_5 },
+			{ "iso-ir-144", Xml::Details::Charset::ISO_8859_5 },
+			{ "ISO_8859-5", Xml::Details::Charset::ISO_8859_5 },
+			{ "cyrillic", Xml::Details::Charset::ISO_8859_5 },
+			{ "csISOLatinCyrillic", Xml::Details::Charset::ISO_8859_5 },
+			{ "ISO-8859-6", Xml::Details::Charset::ISO_8859_6 },
+			{ "iso-ir-127", Xml::Details::Charset::ISO_8859_6 },
+			{ "ISO_8859-6", Xml::Details::Charset::ISO_8859_6 },
+			{ "ECMA-114", Xml::Details::Charset::ISO_8859_6 },
+			{ "ASMO-708", Xml::Details::Charset::ISO_8859_6 },
+			{ "arabic", Xml::Details::Charset::ISO_8859_6 },
+			{ "csISOLatinArabic", Xml::Details::Charset::ISO_8859_6 },
+			{ "ISO-8859-7", Xml::Details::Charset::ISO_8859_7 },
+			{ "iso-ir-126", Xml::Details::Charset::ISO_8859_7 },
+			{ "ISO_8859-7", Xml::Details::Charset::ISO_8859_7 },
+			{ "ELOT_928", Xml::Details::Charset::ISO_8859_7 },
+			{ "ECMA-118", Xml::Details::Charset::ISO_8859_7 },
+			{ "greek", Xml::Details::Charset::ISO_8859_7 },
+			{ "greek8", Xml::Details::Charset::ISO_8859_7 },
+			{ "csISOLatinGreek", Xml::Details::Charset::ISO_8859_7 },
+			{ "ISO-8859-8", Xml::Details::Charset::ISO_8859_8 },
+			{ "iso-ir-138", Xml::Details::Charset::ISO_8859_8 },
+			{ "ISO_8859-8", Xml::Details::Charset::ISO_8859_8 },
+			{ "hebrew", Xml::Details::Charset::ISO_8859_8 },
+			{ "csISOLatinHebrew", Xml::Details::Charset::ISO_8859_8 },
+			{ "ISO-8859-9", Xml::Details::Charset::ISO_8859_9 },
+			{ "iso-ir-148", Xml::Details::Charset::ISO_8859_9 },
+			{ "ISO_8859-9", Xml::Details::Charset::ISO_8859_9 },
+			{ "latin5", Xml::Details::Charset::ISO_8859_9 },
+			{ "l5", Xml::Details::Charset::ISO_8859_9 },
+			{ "csISOLatin5", Xml::Details::Charset::ISO_8859_9 },
+			{ "ISO-8859-10", Xml::Details::Charset::ISO_8859_10 },
+			{ "iso-ir-157", Xml::Details::Charset::ISO_8859_10 },
+			{ "l6", Xml::Details::Charset::ISO_8859_10 },
+			{ "ISO_8859-10", Xml::Details::Charset::ISO_8859_10 },
+			{ "csISOLatin6", Xml::Details::Charset::ISO_8859_10 },
+			{ "latin6", Xml::Details::Charset::ISO_8859_10 },
+			{ "ISO-8859-13", Xml::Details::Charset::ISO_8859_13 },
+			{ "csISO885913", Xml::Details::Charset::ISO_8859_13 },
+			{ "ISO-8859-14", Xml::Details::Charset::ISO_8859_14 },
+			{ "iso-ir-199", Xml::Details::Charset::ISO_8859_14 },
+			{ "ISO_8859-14", Xml::Details::Charset::ISO_8859_14 },
+			{ "latin8", Xml::Details::Charset::ISO_8859_14 },
+			{ "iso-celtic", Xml::Details::Charset::ISO_8859_14 },
+			{ "l8", Xml::Details::Charset::ISO_8859_14 },
+			{ "csISO885914", Xml::Details::Charset::ISO_8859_14 },
+			{ "ISO-8859-15", Xml::Details::Charset::ISO_8859_15 },
+			{ "ISO_8859-15", Xml::Details::Charset::ISO_8859_15 },
+			{ "Latin-9", Xml::Details::Charset::ISO_8859_15 },
+			{ "csISO885915", Xml::Details::Charset::ISO_8859_15 },
+			{ "ISO-8859-16", Xml::Details::Charset::ISO_8859_16 },
+			{ "iso-ir-226", Xml::Details::Charset::ISO_8859_16 },
+			{ "ISO_8859-16", Xml::Details::Charset::ISO_8859_16 },
+			{ "latin10", Xml::Details::Charset::ISO_8859_16 },
+			{ "l10", Xml::Details::Charset::ISO_8859_16 },
+			{ "csISO885916", Xml::Details::Charset::ISO_8859_16 },
+			{ "TIS-620", Xml::Details::Charset::TIS620 },
+			{ "csTIS620", Xml::Details::Charset::TIS620 },
+			{ "windows-874", Xml::Details::Charset::Windows874 },
+			{ "cswindows874", Xml::Details::Charset::Windows874 },
+			{ "windows-1250", Xml::Details::Charset::Windows1250 },
+			{ "cswindows1250", Xml::Details::Charset::Windows1250 },
+			{ "windows-1251", Xml::Details::Charset::Windows1251 },
+			{ "cswindows1251", Xml::Details::Charset::Windows1251 },
+			{ "windows-1252", Xml::Details::Charset::Windows1252 },
+			{ "cswindows1252", Xml::Details::Charset::Windows1252 },
+			{ "windows-1253", Xml::Details::Charset::Windows1253 },
+			{ "cswindows1253", Xml::Details::Charset::Windows1253 },
+			{ "windows-1254", Xml::Details::Charset::Windows1254 },
+			{ "cswindows1254", Xml::Details::Charset::Windows1254 },
+			{ "windows-1255", Xml::Details::Charset::Windows1255 },
+			{ "cswindows1255", Xml::Details::Charset::Windows1255 },
+			{ "windows-1256", Xml::Details::Charset::Windows1256 },
+			{ "cswindows1256", Xml::Details::Charset::Windows1256 },
+			{ "windows-1257", Xml::Details::Charset::Windows1257 },
+			{ "cswindows1257", Xml::Details::Charset::Windows1257 },
+			{ "windows-1258", Xml::Details::Charset::Windows1258 },
+			{ "cswindows1258", Xml::Details::Charset::Windows1258 }
+		};
+
+		for (std::size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+		{
+			std::string name = names[i].Name;
+			assert(Xml::Details::FindCharset(name.data(), name.data() + name.size()) == names[i].Value);
+
+			std::u32string upper;
+			std::u32string lower;
+			for (std::size_t j = 0; j < name.size(); ++j)
+			{
+				upper.push_back(static_cast<char32_t>(std::toupper(static_cast<unsigned char>(name[j]))));
+				lower.push_back(static_cast<char32_t>(std::tolower(static_cast<unsigned char>(name[j]))));
+			}
+			assert(Xml::Details::FindCharset(upper.data(), upper.data() + upper.size()) == names[i].Value);
+			assert(Xml::Details::FindCharset(lower.data(), lower.data() + lower.size()) == names[i].Value);
+
+			// Prefixes and longer names are unknown, unless they are other names (like "greek").
+			std::string others[] = { name.substr(0, name.size() - 1), name + "1", name + "-" };
+			for (std::size_t j = 0; j < sizeof(others) / sizeof(others[0]); ++j)
+			{
+				Xml::Details::Charset expected = Xml::Details::Charset::Unknown;
+				for (std::size_t k = 0; k < sizeof(names) / sizeof(names[0]); ++k)
+				{
+					if (others[j] == names[k].Name)
+						expected = names[k].Value;
+				}
+				assert(Xml::Details::FindCharset(others[j].data(),
+					others[j].data() + others[j].size()) == expected);
+			}
+		}
+
+		const char* unknown[] =
+		{
+			"", "UTF-7", "UTF8", "latin", "latin7", "windows-1259", "ISO-8859-11", "csISOLatin",
+			"UTF_8", "UTF-8 ", "l1\xC0", "cswindows", "\xE9"
+		};
+		for (std::size_t i = 0; i < sizeof(unknown) / sizeof(unknown[0]); ++i)
+		{
+			const char* last = unknown[i] + std::strlen(unknown[i]);
+			assert(Xml::Details::FindCharset(unknown[i], last) == Xml::Details::Charset::Unknown);
+		}
+
+		std::string doc = "<?xml version=\"1.0\" encoding=\"CsIsoLatinCyrillic\"?><root>\xB0</root>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetValue() == u8"\u0410");
+
+		doc = "<?xml version=\"1.0\" encoding=\"Windows-1251x\"?><root/>";
+		inspector.Reset(doc.begin(), doc.end());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::UnknownEncoding);
+
+		std::cout << "OK\n";
+	}
+
+	void TextRunTest()
+	{
+		std::cout << "Text run test... ";
+
+		std::string text;
+		for (int i = 0; i < 500; ++i)
+			text += "line " + std::to_string(i) + "\t'\"=>\n" + std::string(i % 7, ' ');
+
+		// Rows and columns after the line feeds of the runs.
+		std::string doc = "<root>\n" + text + "<a/>" + text + "\x01</root>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(inspector.GetValue() == "\n" + text);
+		assert(inspector.Inspect());
+		assert(inspector.GetName() == "a");
+		assert(inspector.GetRow() == 502);
+		assert(inspector.GetColumn() == 3);
+		assert(inspector.GetByteOffset() == 7 + text.size());
+		assert(inspector.GetEndByteOffset() == 11 + text.size());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::InvalidByteSequence);
+		assert(inspector.GetRow() == 1002);
+		assert(inspector.GetColumn() == 3);
+
+		// Whitespace node with many rows.
+		doc = "<root>" + std::string(100, '\n') + "\t \n<a/>]]></root>";
+		inspector.Reset(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Whitespace);
+		assert(inspector.Inspect());
+		assert(inspector.GetRow() == 102);
+		assert(inspector.GetColumn() == 1);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::InvalidSyntax);
+		assert(inspector.GetRow() == 102);
+		assert(inspector.GetColumn() == 5);
+
+		// Line feed normalized from CR before the run.
+		doc = "<root>a\r\nbc\rde\r</root>";
+		inspector.Reset(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetValue() == "a\nbc\nde\n");
+		assert(inspector.Inspect());
+		assert(inspector.GetRow() == 4);
+		assert(inspector.GetColumn() == 1);
+
+		std::cout << "OK\n";
+	}
+
+	void TerminatorRunTest()
+	{
+		std::cout << "Terminator run test... ";
+
+		const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string blob;
+		for (int i = 0; i < 60; ++i)
+		{
+			for (int j = 0; j < 76; ++j)
+				blob += base64[(i * 76 + j) % 64];
+			blob += "\n";
+		}
+		std::string license;
+		std::string normalizedLicense;
+		for (int i = 0; i < 40; ++i)
+		{
+			std::string line = "Copyright (c) - line " + std::to_string(i) + ". <All> rights ]] reserved?";
+			license += line + ((i % 2 == 0) ? "\r\n" : "\n");
+			normalizedLicense += line + "\n";
+		}
+
+		std::string doc = "<root><!--" + license + "--><![CDATA[" + blob +
+			"]]]><?pi " + license + "? >?><a/></root>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Comment);
+		assert(inspector.GetValue() == normalizedLicense);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::CDATA);
+		assert(inspector.GetValue() == blob + "]");
+		assert(inspector.GetRow() == 41);
+		assert(inspector.GetColumn() == 4);
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::ProcessingInstruction);
+		assert(inspector.GetName() == "pi");
+		assert(inspector.GetValue() == normalizedLicense + "? >");
+		assert(inspector.GetRow() == 101);
+		assert(inspector.GetColumn() == 5);
+		assert(inspector.Inspect());
+		assert(inspector.GetName() == "a");
+		assert(inspector.GetRow() == 141);
+		assert(inspector.GetColumn() == 6);
+		assert(inspector.GetByteOffset() == doc.size() - 11);
+		assert(inspector.Inspect());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Double minus inside the comment.
+		std::string badComment = "<root><!--" + license + "a--b--></root>";
+		inspector.Reset(badComment.begin(), badComment.end());
+		assert(inspector.Inspect());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::InvalidSyntax);
+		assert(inspector.GetRow() == 41);
+		assert(inspector.GetColumn() == 2);
+
+		// Unclosed CDATA section.
+		std::string unclosed = "<root><![CDATA[" + blob + "]]";
+		inspector.Reset(unclosed.begin(), unclosed.end());
+		assert(inspector.Inspect());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::UnclosedToken);
+		assert(inspector.GetRow() == 1);
+		assert(inspector.GetColumn() == 7);
+
+		// Documents which errors are reported at the character
+		// at which they are detected.
+		const std::string docs[] = { doc,
+			"<root><?pi " + blob + "\x01?></root>" };
+		for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+		{
+			Xml::ErrorCode trackedError;
+			Xml::ErrorCode lazyError;
+			std::uint_least64_t trackedRow;
+			std::uint_least64_t trackedColumn;
+			std::uint_least64_t lazyRow;
+			std::uint_least64_t lazyColumn;
+			std::string tracked = InspectAll<Xml::TrackedPositions>(docs[i],
+				trackedError, trackedRow, trackedColumn);
+			std::string lazy = InspectAll<Xml::LazyPositions>(docs[i],
+				lazyError, lazyRow, lazyColumn);
+			assert(tracked == lazy);
+			assert(trackedError == lazyError);
+			assert(trackedRow == lazyRow);
+			assert(trackedColumn == lazyColumn);
+		}
+
+		std::cout << "OK\n";
+	}
+
+	void AttributeValueRunTest()
+	{
+		std::cout << "Attribute value run test... ";
+
+		const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string token;
+		for (int i = 0; i < 3000; ++i)
+			token += base64[(i * 7) % 64];
+
+		// Other quote, entities and white spaces between the long runs.
+		std::string value = token + "'\t" + token + "&amp;&#x41;\r\n" + token + " 'x'\n=";
+		std::string expected = token + "' " + token + "&A " + token + " 'x' =";
+		std::string doc = "<root a=\"" + token + "\" b=\"" + value + "\" c='" + token + "\"" + token + "'/>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.begin(), doc.end());
+		assert(inspector.Inspect());
+		assert(inspector.GetAttributesCount() == 3);
+		assert(inspector.GetAttributeAt(0).Value == token);
+		assert(inspector.GetAttributeAt(1).Name == "b");
+		assert(inspector.GetAttributeAt(1).Value == expected);
+		assert(inspector.GetAttributeAt(2).Name == "c");
+		assert(inspector.GetAttributeAt(2).Value == token + "\"" + token);
+		assert(inspector.GetAttributeAt(2).Row == 3);
+		assert(inspector.GetAttributeAt(2).Column == 4);
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Less-than sign after the long run.
+		doc = "<root a=\"" + token + "<\"/>";
+		inspector.Reset(doc.begin(), doc.end());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::InvalidSyntax);
+		assert(inspector.GetRow() == 1);
+		assert(inspector.GetColumn() == 10 + token.size());
+
+		std::cout << "OK\n";
+	}
+
+	void DumpPositions(Xml::Inspector<Xml::Encoding::Utf8Writer>& inspector, std::string& nodes)
+	{
+		while (inspector.Inspect())
+		{
+			assert(inspector.GetValueView().ToString() == inspector.GetValue());
+			nodes += std::to_string(static_cast<int>(inspector.GetInspected())) +
+				inspector.GetName() + "=" + inspector.GetValue() +
+				"@" + std::to_string(inspector.GetRow()) + ":" + std::to_string(inspector.GetColumn()) +
+				"@" + std::to_string(inspector.GetByteOffset()) +
+				"-" + std::to_string(inspector.GetEndByteOffset()) + ";";
+			for (std::size_t i = 0; i < inspector.GetAttributesCount(); ++i)
+			{
+				const Xml::Inspector<Xml::Encoding::Utf8Writer>::AttributeType& attribute =
+					inspector.GetAttributeAt(i);
+				nodes += attribute.Name + "=" + attribute.Value +
+					"@" + std::to_string(attribute.Row) + ":" + std::to_string(attribute.Column) + ";";
+			}
+		}
+	}
+
+	void BytesRunTest()
+	{
+		std::cout << "Bytes run test... ";
+
+		// Cyrillic, CJK and emoji characters.
+		std::string words;
+		for (int i = 0; i < 400; ++i)
+		{
+			words += "\xD0\xBC\xD0\xB8\xD1\x80 \xE4\xB8\x96\xE7\x95\x8C " + std::to_string(i) +
+				((i % 3 == 0) ? "\r\n" : (i % 3 == 1) ? "\n" : "\t\xF0\x9F\x98\x80");
+		}
+
+		const std::string docs[] =
+		{
+			"<root a=\"" + words + "\" b='&amp;" + words + "'>" + words + "&lt;" + words +
+				"<!--" + words + "- -->\r\n<![CDATA[" + words + "]]]>\n<?pi " + words + "?\?>" +
+				"<\xD0\xB8\xD0\xBC\xD1\x8F>" + words + "</\xD0\xB8\xD0\xBC\xD1\x8F></root>",
+			"<root>" + words + "\xC0\x80</root>",
+			"<root>" + words + "\xE4\xB8</root>",
+			"<root>" + words + "]]></root>",
+			"<root x='" + words + "<'/>",
+			"<root><!--" + words + "--" + words + "--></root>",
+			"<root><![CDATA[" + words,
+			"\xEF\xBB\xBF<root>" + words + "</root>"
+		};
+
+		for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+		{
+			// Characters from the stream are written by the characters writer.
+			std::istringstream stream(docs[i]);
+			Xml::Inspector<Xml::Encoding::Utf8Writer> streamInspector(&stream);
+			std::string expected;
+			DumpPositions(streamInspector, expected);
+			DumpError(streamInspector, expected);
+
+			// Bytes of the runs are copied from the memory.
+			Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(docs[i].data(),
+				docs[i].data() + docs[i].size());
+			std::string nodes;
+			DumpPositions(inspector, nodes);
+			DumpError(inspector, nodes);
+			assert(nodes == expected);
+
+			// Fed bytes can be moved between the runs.
+			for (std::size_t chunk = 1; chunk <= 1000; chunk *= 10)
+			{
+				Xml::Inspector<Xml::Encoding::Utf8Writer> feedInspector;
+				nodes.clear();
+				for (std::size_t j = 0; j < docs[i].size(); j += chunk)
+				{
+					feedInspector.Feed(docs[i].data() + j, std::min(chunk, docs[i].size() - j));
+					DumpPositions(feedInspector, nodes);
+					if (feedInspector.GetErrorCode() != Xml::ErrorCode::NeedMoreData)
+						break;
+				}
+				feedInspector.FinishFeed();
+				DumpPositions(feedInspector, nodes);
+				DumpError(feedInspector, nodes);
+				assert(nodes == expected);
+			}
+		}
+
+		std::cout << "OK\n";
+	}
+
+	// Checks if the view points to the bytes of the document.
+	static bool IsInDocument(const Xml::StringView<char>& view, const std::string& doc)
+	{
+		return view.GetData() >= doc.data() && view.GetData() + view.GetSize() <= doc.data() + doc.size();
+	}
+
+	void ValueViewTest()
+	{
+		std::cout << "Value view test... ";
+
+		std::string words;
+		for (int i = 0; i < 300; ++i)
+			words += "\xD0\xBC\xD0\xB8\xD1\x80 \xE4\xB8\x96 " + std::to_string(i) + "\n";
+
+		// Line feeds in attribute values are normalized.
+		std::string spacedWords = words;
+		std::replace(spacedWords.begin(), spacedWords.end(), '\n', ' ');
+
+		std::string doc = "<root a=\"1 2\" b='x&lt;y' c=\"a\tb\" d=\"" + spacedWords + "\">" + words +
+			"<!--" + words + "--><![CDATA[" + words + "]]><?pi " + words + "?>" +
+			"<e>a&amp;b</e><e>a\r\nb</e><e>a\rb</e><e>]]]</e><![CDATA[x]]]></root>";
+		Xml::Inspector<Xml::Encoding::Utf8Writer> inspector(doc.data(), doc.data() + doc.size());
+
+		assert(inspector.Inspect());
+		assert(inspector.GetValueView().IsEmpty());
+		assert(inspector.GetAttributesCount() == 4);
+		assert(inspector.GetAttributeAt(0).Value == "1 2");
+		assert(inspector.GetAttributeAt(1).Value == "x<y");
+		assert(inspector.GetAttributeAt(2).Value == "a b");
+		assert(inspector.GetAttributeAt(3).Value == spacedWords);
+
+		// Text, comment, CDATA and processing instruction aren't copied.
+		Xml::Inspected expectedNodes[] = { Xml::Inspected::Text, Xml::Inspected::Comment,
+			Xml::Inspected::CDATA, Xml::Inspected::ProcessingInstruction };
+		std::vector<Xml::StringView<char> > views;
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == expectedNodes[i]);
+			Xml::StringView<char> view = inspector.GetValueView();
+			assert(IsInDocument(view, doc));
+			assert(std::string(view.begin(), view.end()) == words);
+			views.push_back(view);
+		}
+		assert(inspector.GetValue() == words);
+		assert(IsInDocument(inspector.GetValueView(), doc));
+
+		// Values changed by the normalization are copied.
+		const char* values[] = { "a&b", "a\nb", "a\nb", "]]]" };
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			assert(inspector.Inspect());
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::Text);
+			assert(!IsInDocument(inspector.GetValueView(), doc) || i == 3);
+			assert(inspector.GetValueView().ToString() == values[i]);
+			assert(inspector.GetValue() == values[i]);
+			assert(inspector.Inspect());
+		}
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::CDATA);
+		assert(inspector.GetValueView().ToString() == "x]");
+		assert(inspector.Inspect());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Views of the document are valid after the inspection.
+		for (std::size_t i = 0; i < views.size(); ++i)
+			assert(views[i].ToString() == words);
+
+		// Values from the stream are always copied.
+		std::istringstream stream(doc);
+		Xml::Inspector<Xml::Encoding::Utf8Writer> streamInspector(&stream);
+		while (streamInspector.Inspect())
+		{
+			assert(!IsInDocument(streamInspector.GetValueView(), doc));
+			assert(streamInspector.GetValueView().ToString() == streamInspector.GetValue());
+		}
+		assert(streamInspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Other writers.
+		Xml::Inspector<Xml::Encoding::Utf16Writer> utf16Inspector(doc.data(), doc.data() + doc.size());
+		while (utf16Inspector.Inspect())
+			assert(utf16Inspector.GetValueView().ToString() == utf16Inspector.GetValue());
+		assert(utf16Inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// Entity reference after the text.
+		doc = "<!DOCTYPE root><root>abc&ent;def</root>";
+		inspector.Reset(doc.data(), doc.data() + doc.size());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::Text);
+		assert(IsInDocument(inspector.GetValueView(), doc));
+		assert(inspector.GetValue() == "abc");
+		assert(inspector.Inspect());
+		assert(inspector.GetInspected() == Xml::Inspected::EntityReference);
+		assert(inspector.GetName() == "ent");
+		assert(inspector.GetValueView().IsEmpty());
+		assert(inspector.Inspect());
+		assert(inspector.GetValue() == "def");
+		assert(inspector.Inspect());
+		assert(!inspector.Inspect());
+		assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+
+		// XML declaration of the next document.
+		for (int i = 0; i < 2; ++i)
+		{
+			std::string declaration = i == 0 ?
+				"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?><r/>" :
+				"<?xml version='1.0' encoding='UTF-8'?><r/>";
+			inspector.Reset(declaration.data(), declaration.data() + declaration.size());
+			assert(inspector.Inspect());
+			assert(inspector.GetInspected() == Xml::Inspected::XmlDeclaration);
+			assert(inspector.GetValueView().ToString() == inspector.GetValue());
+			assert(inspector.GetAttributesCount() == static_cast<std::size_t>(3 - i));
+			assert(inspector.GetAttributeAt(0).Value == "1.0");
+			assert(inspector.GetAttributeAt(1).Value == "UTF-8");
+			assert(inspector.Inspect());
+			assert(!inspector.Inspect());
+			assert(inspector.GetErrorCode() == Xml::ErrorCode::None);
+		}
+
+		std::cout << "OK\n";
+	}
 };
 
 int main()